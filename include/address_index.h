@@ -0,0 +1,232 @@
+/**
+ * @brief Lists the transactions that name each public key.
+ * 
+ * The index is an open-addressing hash table keyed by the SHA-256 digest of
+ * each public key, laid out like the ledger. Every transaction adds a posting,
+ * its height and position in its block, for its sender and one for its
+ * recipient. All postings live in one array in the order they were added, and
+ * each links back to the previous posting for the same key. Applying a block
+ * therefore only appends, reverting it only truncates, and a key's history
+ * reads newest first without scanning any blocks. Each posting also links to
+ * one older posting for the same key, picked as for block skip pointers in
+ * Bitcoin, so that any page of a key's history is reached in a logarithmic
+ * number of steps.
+ */
+
+#ifndef INCLUDE_ADDRESS_INDEX_H_
+#define INCLUDE_ADDRESS_INDEX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "include/block.h"
+#include "include/cryptography.h"
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+#define ADDRESS_INDEX_MIN_CAPACITY 16
+#define ADDRESS_INDEX_NO_POSTING UINT64_MAX
+#define ADDRESS_INDEX_FILE_SUFFIX ".addresses"
+#define ADDRESS_INDEX_FILE_MAGIC "LEOA"
+#define ADDRESS_INDEX_FILE_MAGIC_SIZE 4
+
+/**
+ * @brief One transaction that names a key.
+ * 
+ * @param height The height of the transaction's block.
+ * @param transaction_index The transaction's position in its block. The
+ * minting transaction is at position 0.
+ * @param previous_posting The position in the index's postings of the previous
+ * posting for the same key, or ADDRESS_INDEX_NO_POSTING if there is none.
+ * @param skip_posting The position in the index's postings of the key's
+ * posting with rank address_index_skip_rank of this one's, where a key's
+ * oldest posting has rank 0, or ADDRESS_INDEX_NO_POSTING for rank 0.
+ */
+typedef struct address_index_posting_t {
+    uint64_t height;
+    uint64_t transaction_index;
+    uint64_t previous_posting;
+    uint64_t skip_posting;
+} address_index_posting_t;
+
+/**
+ * @brief One key in the index.
+ * 
+ * @param key_digest The SHA-256 digest of the public key.
+ * @param last_posting The position in the index's postings of the key's
+ * newest posting, or ADDRESS_INDEX_NO_POSTING if there is none.
+ * @param num_postings The number of postings for the key.
+ * @param is_occupied Whether the slot holds a key.
+ */
+typedef struct address_index_entry_t {
+    sha_256_t key_digest;
+    uint64_t last_posting;
+    uint64_t num_postings;
+    bool is_occupied;
+} address_index_entry_t;
+
+/**
+ * @brief The transaction history of every key along a sequence of blocks.
+ * 
+ * @param entries The slots. Their number is always a power of two.
+ * @param capacity The number of slots.
+ * @param num_entries The number of occupied slots. The index grows before
+ * more than half of the slots are occupied. Keys stay in the index once
+ * added, even if they lose all their postings.
+ * @param postings Every posting, in the order the blocks were applied.
+ * @param num_postings The number of postings.
+ * @param postings_capacity The number of postings allocated.
+ * @param num_blocks The number of blocks applied.
+ */
+typedef struct address_index_t {
+    address_index_entry_t *entries;
+    size_t capacity;
+    size_t num_entries;
+    address_index_posting_t *postings;
+    uint64_t num_postings;
+    uint64_t postings_capacity;
+    uint64_t num_blocks;
+} address_index_t;
+
+/**
+ * @brief Fills index with a pointer to a newly allocated, empty index.
+ * 
+ * @param index A pointer to fill with the index's address.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_create(address_index_t **index);
+
+/**
+ * @brief Frees all memory associated with the index.
+ * 
+ * @param index The index.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_destroy(address_index_t *index);
+
+/**
+ * @brief Fills copy with a pointer to a newly allocated copy of the index.
+ * 
+ * @param copy A pointer to fill with the copy's address.
+ * @param index The index to copy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_copy(
+    address_index_t **copy,
+    address_index_t *index
+);
+
+/**
+ * @brief Makes room for num_transactions more transactions.
+ * 
+ * Applying blocks with at most that many transactions in total then cannot
+ * fail.
+ * 
+ * @param index The index.
+ * @param num_transactions The number of transactions to make room for.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_reserve(
+    address_index_t *index,
+    uint64_t num_transactions
+);
+
+/**
+ * @brief Adds postings for the block's transactions.
+ * 
+ * Runs in time linear in the number of transactions in the block. On failure,
+ * the index is unchanged.
+ * 
+ * @param index The index.
+ * @param block The block to apply at height num_blocks.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_apply_block(
+    address_index_t *index,
+    block_t *block
+);
+
+/**
+ * @brief Undoes address_index_apply_block for the last block applied.
+ * 
+ * @param index The index.
+ * @param block The last block applied, with its transactions unchanged since.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_revert_block(
+    address_index_t *index,
+    block_t *block
+);
+
+/**
+ * @brief Returns the rank that a posting with the given rank skips back to.
+ * 
+ * The rank is always lower, except for rank 0, and ranks reach each other by
+ * skips and single steps back in a logarithmic number of steps.
+ * 
+ * @param rank The rank of a posting among its key's postings, oldest first.
+ * @return uint64_t The rank of the posting to skip back to.
+ */
+uint64_t address_index_skip_rank(uint64_t rank);
+
+/**
+ * @brief Fills postings with one page of the key's history, newest first.
+ * 
+ * Runs in time logarithmic in offset plus linear in max_postings, however
+ * long the chain.
+ * 
+ * @param index The index.
+ * @param public_key The key.
+ * @param offset The number of newest postings to skip.
+ * @param max_postings The number of postings the array can hold.
+ * @param postings An array to fill with the postings.
+ * @param num_postings A pointer to fill with the number of postings written.
+ * @param total_num_postings If not NULL, a pointer to fill with the number of
+ * postings for the key across all pages.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_get_postings(
+    address_index_t *index,
+    public_key_t *public_key,
+    uint64_t offset,
+    uint64_t max_postings,
+    address_index_posting_t *postings,
+    uint64_t *num_postings,
+    uint64_t *total_num_postings
+);
+
+/**
+ * @brief Writes the index to a file.
+ * 
+ * The file starts with ADDRESS_INDEX_FILE_MAGIC, the number of blocks, and the
+ * hash of the last block, so that readers can tell whether it still matches
+ * the chain file beside it. The key slots and postings follow as they are, in
+ * big-endian order.
+ * 
+ * @param index The index.
+ * @param tip_hash The hash of the last block applied, or all zeros if none.
+ * @param outfile The path to the output file.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_write_to_file(
+    address_index_t *index,
+    sha_256_t *tip_hash,
+    char *outfile
+);
+
+/**
+ * @brief Fills index with the index stored in a file.
+ * 
+ * @param index A pointer to fill with the index's address.
+ * @param tip_hash A pointer to fill with the hash of the last block the index
+ * covers. Callers compare it with the chain's tip to detect a stale file.
+ * @param infile The path to the input file.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t address_index_read_from_file(
+    address_index_t **index,
+    sha_256_t *tip_hash,
+    char *infile
+);
+
+#endif  // INCLUDE_ADDRESS_INDEX_H_
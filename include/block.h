@@ -5,13 +5,31 @@
 #ifndef INCLUDE_BLOCK_H_
 #define INCLUDE_BLOCK_H_
 #define GENESIS_BLOCK_PROOF_OF_WORK 2017
+// created_at, previous_block_hash, merkle_root, and proof_of_work.
+#define BLOCK_HEADER_SIZE 80
 
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <sys/time.h>
 #include "include/linked_list.h"
 #include "include/hash.h"
 #include "include/return_codes.h"
 
+/**
+ * @brief The header of a single allocation holding many blocks.
+ * 
+ * Deserialization can place blocks, their transaction lists, and their
+ * transactions in one allocation that starts with this header. The arena
+ * frees itself once every block in it has been released.
+ * 
+ * @param reference_count The number of blocks in the arena that are still
+ * referenced.
+ */
+typedef struct block_arena_t {
+    atomic_size_t reference_count;
+} block_arena_t;
+
 /**
  * @brief Represents a block in the blockchain.
  * 
@@ -21,12 +39,34 @@
  * some number of leading zeros. It has no meaning other than as part of the
  * hash.
  * @param previous_block_hash The hash of the previous block.
+ * @param merkle_root The root of the Merkle tree over the block's
+ * transactions. The block commits to its transactions through this value, so
+ * the block hash only covers a small fixed-size header. block_create computes
+ * it; users who modify transaction_list afterwards must recompute it with
+ * block_compute_merkle_root.
+ * @param hash The block's hash, valid only if is_sealed is true.
+ * @param is_sealed Whether the block is final. block_seal computes the hash
+ * once and sets this flag, after which block_hash returns the stored hash.
+ * The header fields of a sealed block must not change; call block_unseal
+ * before changing them. Miners change proof_of_work freely until the block is
+ * sealed, which blockchain_add_block does.
+ * @param reference_count The number of references to the block. Sealed blocks
+ * are immutable, so blockchains share them instead of copying them; each
+ * holder takes a reference with block_retain and gives it up with
+ * block_release.
+ * @param arena The arena holding the block, or NULL if the block has its own
+ * allocation.
  */
 typedef struct block_t {
     time_t created_at;
     linked_list_t *transaction_list;
     uint64_t proof_of_work;
     sha_256_t previous_block_hash;
+    sha_256_t merkle_root;
+    sha_256_t hash;
+    bool is_sealed;
+    atomic_size_t reference_count;
+    block_arena_t *arena;
 } block_t;
 
 /**
@@ -59,21 +99,106 @@ return_code_t block_create(
  */
 return_code_t block_create_genesis_block(block_t **block);
 
+/**
+ * @brief Fills copy with a newly allocated deep copy of the block.
+ * 
+ * The copy has its own allocation, transaction list, and transactions, and a
+ * single reference held by the caller.
+ * 
+ * @param copy The pointer to fill with the copy.
+ * @param block The block to copy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_copy(block_t **copy, block_t *block);
+
 /**
  * @brief Frees all memory associated with the block.
  * 
+ * Only the sole holder of a block that is not in an arena may destroy it;
+ * everyone else should use block_release.
+ * 
  * @param block The block to destroy.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t block_destroy(block_t *block);
 
+/**
+ * @brief Takes another reference to the block.
+ * 
+ * @param block The block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_retain(block_t *block);
+
+/**
+ * @brief Gives up a reference to the block.
+ * 
+ * Releasing the last reference destroys the block, or, for a block in an
+ * arena, gives up the block's reference to the arena.
+ * 
+ * @param block The block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_release(block_t *block);
+
+/**
+ * @brief Fills merkle_root with the Merkle root of the block's transactions.
+ * 
+ * The leaves are the transaction hashes in list order. Each interior node is
+ * the hash of a 0x01 byte followed by its two children. A node without a
+ * sibling is promoted to the next level unchanged. A block with no
+ * transactions has a Merkle root of all zeros.
+ * 
+ * @param block The block.
+ * @param merkle_root A pointer to fill with the Merkle root. This may point to
+ * the block's own merkle_root field, in which case the block is unsealed.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_compute_merkle_root(block_t *block, sha_256_t *merkle_root);
+
+/**
+ * @brief Fills header with the bytes that the block hash covers.
+ * 
+ * The header is created_at, previous_block_hash, merkle_root, and
+ * proof_of_work, in that order, with integers in big endian. The proof of work
+ * comes last so that miners can reuse the hash state of everything before it.
+ * 
+ * @param block The block.
+ * @param header An array of length BLOCK_HEADER_SIZE to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_serialize_header(block_t *block, unsigned char *header);
+
 /**
  * @brief Fills hash with the block's hash.
  * 
+ * The hash covers only the block header, so its cost does not depend on the
+ * number of transactions in the block. The header includes the stored Merkle
+ * root; use blockchain_verify to check that root against the transactions.
+ * Sealed blocks return their stored hash without hashing again.
+ * 
  * @param block The block.
  * @param hash A pointer to fill with the block's hash.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t block_hash(block_t *block, sha_256_t *hash);
 
+/**
+ * @brief Computes and stores the block's hash, marking the block final.
+ * 
+ * Sealing an already sealed block does nothing.
+ * 
+ * @param block The block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_seal(block_t *block);
+
+/**
+ * @brief Discards the block's stored hash so that its header may change.
+ * 
+ * @param block The block.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_unseal(block_t *block);
+
 #endif  // INCLUDE_BLOCK_H_
@@ -0,0 +1,144 @@
+/**
+ * @brief Maps block hashes to blocks.
+ * 
+ * The index is an open-addressing hash table keyed by sha_256_t. Proof of work
+ * forces the leading bytes of every block hash to zero, but the trailing bytes
+ * are uniformly distributed, so the table uses the last bytes of the hash as
+ * the slot number and probes linearly from there.
+ */
+
+#ifndef INCLUDE_BLOCK_HASH_INDEX_H_
+#define INCLUDE_BLOCK_HASH_INDEX_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "include/block.h"
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+#define BLOCK_HASH_INDEX_MIN_CAPACITY 16
+
+/**
+ * @brief One block in the index.
+ * 
+ * @param hash The block's hash.
+ * @param block The block, or NULL if the slot is empty. The index does not own
+ * the block.
+ * @param height The block's height in its chain.
+ * @param is_side_block Whether the block is on a side branch rather than the
+ * active chain. Insertion clears the flag; the owner of the index sets it.
+ * @param side_block_position The block's position in its owner's array of side
+ * blocks, so that removing it from the array does not need a search. Only
+ * meaningful if is_side_block is true.
+ */
+typedef struct block_hash_index_entry_t {
+    sha_256_t hash;
+    block_t *block;
+    uint64_t height;
+    bool is_side_block;
+    uint64_t side_block_position;
+} block_hash_index_entry_t;
+
+/**
+ * @brief A hash table from block hash to block and height.
+ * 
+ * @param entries The slots. Their number is always a power of two.
+ * @param capacity The number of slots.
+ * @param num_entries The number of occupied slots. The index grows before
+ * more than half of the slots are occupied, which keeps probe sequences short.
+ */
+typedef struct block_hash_index_t {
+    block_hash_index_entry_t *entries;
+    size_t capacity;
+    size_t num_entries;
+} block_hash_index_t;
+
+/**
+ * @brief Fills index with a pointer to a newly allocated, empty index.
+ * 
+ * @param index A pointer to fill with the index's address.
+ * @param expected_num_blocks The number of blocks the index should hold
+ * without growing. The index still grows past this number as needed.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_hash_index_create(
+    block_hash_index_t **index,
+    size_t expected_num_blocks
+);
+
+/**
+ * @brief Fills copy with a pointer to a newly allocated copy of the index.
+ * 
+ * The copy maps to the same blocks. Copying the slots as they are avoids
+ * hashing every entry again.
+ * 
+ * @param copy A pointer to fill with the copy's address.
+ * @param index The index to copy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_hash_index_copy(
+    block_hash_index_t **copy,
+    block_hash_index_t *index
+);
+
+/**
+ * @brief Frees all memory associated with the index, but not the blocks.
+ * 
+ * @param index The index.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_hash_index_destroy(block_hash_index_t *index);
+
+/**
+ * @brief Adds a block to the index.
+ * 
+ * If the index already holds a block with the same hash, the new block
+ * replaces it.
+ * 
+ * @param index The index.
+ * @param hash The block's hash.
+ * @param block The block.
+ * @param height The block's height in its chain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t block_hash_index_insert(
+    block_hash_index_t *index,
+    sha_256_t *hash,
+    block_t *block,
+    uint64_t height
+);
+
+/**
+ * @brief Fills entry with the index's entry for the hash.
+ * 
+ * @param index The index.
+ * @param hash The hash to look up.
+ * @param entry A pointer to fill with the entry. The entry stays valid until
+ * the next insertion or removal.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if no block in the index has the hash.
+ */
+return_code_t block_hash_index_find(
+    block_hash_index_t *index,
+    sha_256_t *hash,
+    block_hash_index_entry_t **entry
+);
+
+/**
+ * @brief Removes the block with the hash from the index.
+ * 
+ * Entries later in the same probe sequence shift back into the freed slot, so
+ * lookups never stop early at a hole and the index needs no tombstones.
+ * 
+ * @param index The index.
+ * @param hash The hash of the block to remove.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if no block in the index has the hash.
+ */
+return_code_t block_hash_index_remove(
+    block_hash_index_t *index,
+    sha_256_t *hash
+);
+
+#endif  // INCLUDE_BLOCK_HASH_INDEX_H_
@@ -9,39 +9,338 @@
 #define INCLUDE_BLOCKCHAIN_H_
 
 #include <stdint.h>
+#include <stdio.h>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <stdatomic.h>
 #include <pthread.h>
+#include "include/address_index.h"
 #include "include/block.h"
+#include "include/block_hash_index.h"
+#include "include/ledger.h"
 #include "include/return_codes.h"
+// Serialized blockchains start with this magic string and a big endian 32 bit
+// format version. Buffers without the magic string predate Merkle roots in
+// block headers and are rejected, since their block hashes and proofs of work
+// do not hold under the current rules. The legacy format stores every key and
+// signature at its maximum size. The compact keys format stores only the bytes
+// each key and signature use, and the varints format also writes every
+// integer as a varint.
+#define BLOCKCHAIN_SERIALIZATION_MAGIC "LEOC"
+#define BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE 4
+#define BLOCKCHAIN_SERIALIZATION_VERSION_LEGACY 1
+#define BLOCKCHAIN_SERIALIZATION_VERSION_COMPACT_KEYS 2
+#define BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS 3
+#define BLOCKCHAIN_SERIALIZATION_VERSION \
+    BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS
+// A varint holds 7 bits of its value in each byte, least significant first,
+// and sets the high bit of every byte but the last. Each value has exactly one
+// encoding, so a varint longer than one byte cannot end in a zero byte.
+#define BLOCKCHAIN_VARINT_MAX_SIZE 10
+// Block logs start with this magic string, the big endian 32 bit format
+// version of their blocks, and the big endian 64 bit difficulty. One record
+// per block follows: a big endian 32 bit length and the block in that format.
+#define BLOCKCHAIN_LOG_MAGIC "LEOL"
+#define BLOCKCHAIN_LOG_MAGIC_SIZE 4
+#define BLOCKCHAIN_LOG_HEADER_SIZE \
+    (BLOCKCHAIN_LOG_MAGIC_SIZE + sizeof(uint32_t) + sizeof(uint64_t))
+#define BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE sizeof(uint32_t)
+#define BLOCKCHAIN_LOG_MIN_CAPACITY 16
+// Each block log keeps an index beside it, at the same path followed by this
+// suffix. The index starts with this magic string, the big endian 64 bit size
+// of the log it describes, and the big endian 64 bit number of records. Each
+// record holds a block's height, offset, and record length as big endian 64
+// bit integers, then the block's hash.
+#define BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX ".index"
+#define BLOCKCHAIN_LOG_INDEX_MAGIC "LEOX"
+#define BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE 4
+#define BLOCKCHAIN_LOG_INDEX_HEADER_SIZE \
+    (BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE + 2 * sizeof(uint64_t))
+#define BLOCKCHAIN_LOG_INDEX_RECORD_SIZE \
+    (3 * sizeof(uint64_t) + sizeof(sha_256_t))
+// Side blocks more than this many blocks below the tip of the active chain are
+// pruned from the tree, so no reorganization reaches back further than this.
+#define BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH 100
+// The number of threads that can read a synchronized blockchain at once.
+// Further readers wait for one of them to finish.
+#define SYNCHRONIZED_BLOCKCHAIN_MAX_READERS 64
 
 /**
  * @brief Represents a blockchain.
  * 
- * @param block_list The list of blocks in the chain.
+ * The blockchain is a tree of blocks rooted at the genesis block. Its active
+ * chain is the longest branch; ties go to the branch seen first. Because the
+ * difficulty is fixed for the whole tree, the longest branch is also the one
+ * with the most cumulative work. Blocks on other branches are kept so that a
+ * reorganization only moves the blocks between the fork point and the new tip.
+ * 
+ * @param blocks The blocks in the active chain, indexed by height. The genesis
+ * block is at height 0. The blockchain holds a reference to each block, which
+ * other blockchains may share.
+ * @param num_blocks The number of blocks in the active chain.
+ * @param blocks_capacity The number of block pointers allocated in blocks.
+ * @param side_blocks The blocks that are in the tree but not in the active
+ * chain, in no particular order. The blockchain holds a reference to each.
+ * Each block's hash index entry records its position here, and blocks more
+ * than BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH below the tip are pruned.
+ * @param num_side_blocks The number of blocks in side_blocks.
+ * @param side_blocks_capacity The number of block pointers allocated in
+ * side_blocks.
+ * @param hash_index Maps the hash of every block in the tree to the block and
+ * its height. The index lives in the blockchain, so replacing a chain with
+ * another replaces the index along with it. Blocks must not change after they
+ * are added, or the index will hold stale hashes.
+ * @param ledger The account balances after the active chain. Appends and
+ * reorganizations apply and revert only the blocks they move, and verification
+ * uses the ledger to find overspending blocks.
+ * @param address_index The transactions that name each public key in the
+ * active chain. It moves with the active chain the same way as the ledger.
+ * @param num_leading_zero_bytes_required_in_block_hash The number of leading
+ * zero bytes to make a block hash a valid proof of work.
  */
 typedef struct blockchain_t {
-    linked_list_t *block_list;
+    block_t **blocks;
+    uint64_t num_blocks;
+    uint64_t blocks_capacity;
+    block_t **side_blocks;
+    uint64_t num_side_blocks;
+    uint64_t side_blocks_capacity;
+    block_hash_index_t *hash_index;
+    ledger_t *ledger;
+    address_index_t *address_index;
     size_t num_leading_zero_bytes_required_in_block_hash;
 } blockchain_t;
 
+/**
+ * @brief Identifies a prefix of a blockchain that has already been verified.
+ * 
+ * Because every block commits to the hash of its predecessor, the height and
+ * hash of the last verified block identify the entire prefix. A blockchain
+ * whose block at that height has that hash shares the prefix, provided its
+ * earlier blocks really link up to that block.
+ * 
+ * @param num_blocks The number of blocks in the verified prefix. Zero means
+ * nothing has been verified.
+ * @param tip_block The last block in the verified prefix. If a blockchain
+ * still holds this very block at the same height, its prefix is trusted
+ * outright; blocks in a blockchain must not be modified after verification.
+ * A prefix is only trusted this way while something holds a reference to the
+ * block, or a freed block's address could come back as another chain's block.
+ * @param tip_hash The hash of the last block in the verified prefix.
+ * @param num_leading_zero_bytes_required_in_block_hash The difficulty at which
+ * the prefix was verified.
+ */
+typedef struct blockchain_verified_prefix_t {
+    uint64_t num_blocks;
+    block_t *tip_block;
+    sha_256_t tip_hash;
+    size_t num_leading_zero_bytes_required_in_block_hash;
+} blockchain_verified_prefix_t;
+
+/**
+ * @brief Memory that a synchronized blockchain stopped publishing.
+ * 
+ * @param data The memory: an old snapshot, an old block array, or a replaced
+ * blockchain.
+ * @param free_data The function that frees data.
+ * @param epoch The epoch in which it was retired. Readers that entered in
+ * this epoch or earlier may still hold it.
+ */
+typedef struct synchronized_blockchain_retired_t {
+    void *data;
+    void (*free_data)(void *);
+    size_t epoch;
+} synchronized_blockchain_retired_t;
+
 /**
  * @brief A synchronized blockchain.
  * 
- * @param blockchain The blockchain.
- * @param version A number indicating how many times the blockchain pointer has
- * been changed. It is initially zero. Writer threads can lock, update the
- * blockchain pointer, increment this number to signal an update, and unlock.
- * Reader threads can check this value without locking to know whether they need
- * to lock and update their view of the blockchain.
- * @param mutex The mutex protecting access to this data structure's fields.
+ * Writers lock the mutex and change the blockchain in place. Readers never
+ * lock. They enter a read section with synchronized_blockchain_read_begin,
+ * which announces the current epoch and loads the published snapshot, and
+ * leave it with synchronized_blockchain_read_end. A snapshot holds only the
+ * active chain's blocks and the difficulty, and its blocks array is the
+ * writers' own. Writers therefore never change entries that a snapshot covers
+ * or move the array in place: appending within the array's capacity is safe,
+ * and anything else first switches the writers to a private copy with
+ * synchronized_blockchain_prepare_write. Publishing a change with
+ * synchronized_blockchain_publish costs one small allocation, so appends stay
+ * amortized constant time. Each publication advances the epoch and retires
+ * the old snapshot, along with any block array or blockchain that only it
+ * still reads, which are freed once every reader that announced that epoch or
+ * an earlier one has left.
+ * 
+ * @param blockchain The writers' blockchain. Only writers, holding the mutex,
+ * may use it.
+ * @param snapshot The published snapshot. Its blocks, num_blocks, and
+ * num_leading_zero_bytes_required_in_block_hash are set; every other field is
+ * zero. Only writers store to it.
+ * @param stale_blocks The writers' previous block array if they switched to a
+ * private copy since the last publication, or NULL. The published snapshot
+ * still reads it. The mutex protects it.
+ * @param version A number indicating how many times the active chain has
+ * changed. It is initially zero. Writers increment it after publishing a
+ * blockchain with a new tip. Readers can check this value without locking to
+ * know whether they need to update their view of the blockchain.
+ * @param verified_prefix The longest prefix of the blockchain known to be
+ * valid. Writers that replace the blockchain should also replace this with the
+ * new blockchain's verified prefix. It holds a reference to its tip block. The
+ * mutex protects it.
+ * @param mutex Serializes writers.
+ * @param epoch The current epoch. It starts at one and advances with every
+ * publication.
+ * @param reader_epochs The epoch that each reader announced, or zero for a
+ * free slot.
+ * @param retired The retired memory that readers may still hold. The mutex
+ * protects it.
+ * @param num_retired The number of retired entries.
+ * @param retired_capacity The number of retired entries that fit in the
+ * array.
  */
 typedef struct synchronized_blockchain_t {
     blockchain_t *blockchain;
+    _Atomic(blockchain_t *) snapshot;
+    block_t **stale_blocks;
     atomic_size_t version;
+    blockchain_verified_prefix_t verified_prefix;
     pthread_mutex_t mutex;
+    atomic_size_t epoch;
+    atomic_size_t reader_epochs[SYNCHRONIZED_BLOCKCHAIN_MAX_READERS];
+    synchronized_blockchain_retired_t *retired;
+    size_t num_retired;
+    size_t retired_capacity;
 } synchronized_blockchain_t;
 
+/**
+ * @brief Where one block lies in a block log.
+ * 
+ * @param offset The offset in the file of the block's record.
+ * @param length The length of the record, including its length prefix.
+ * @param block_hash The hash of the block.
+ */
+typedef struct blockchain_log_record_t {
+    uint64_t offset;
+    uint64_t length;
+    sha_256_t block_hash;
+} blockchain_log_record_t;
+
+/**
+ * @brief An append-only file holding the active chain of a blockchain.
+ * 
+ * Saving a chain to the log writes only the blocks that the log lacks. If the
+ * chain switched to another branch, the log first truncates back to the fork
+ * point, so writes stay proportional to the blocks that changed rather than
+ * to the height of the chain. A crash can leave at most one partial record at
+ * the end of the file, which opening the log discards.
+ * 
+ * The records are also kept in an index file beside the log, which saves
+ * update in place the same way. Opening the log reads the index instead of
+ * the whole log, and rebuilds it if it is missing or does not match the log.
+ * The index is never synced to disk; a crash at worst makes it stale.
+ * 
+ * @param file The log file, open for reading and writing.
+ * @param index_file The index file, open for reading and writing.
+ * @param records Where each block lies in the file, indexed by height.
+ * @param num_records The number of blocks in the log.
+ * @param records_capacity The number of records allocated.
+ * @param end_offset The offset just past the last record.
+ * @param num_leading_zero_bytes_required_in_block_hash The difficulty in the
+ * log's header. It is meaningful only if end_offset is not zero.
+ * @param blocks_per_sync The number of appended blocks after which the log
+ * calls fsync. Zero leaves flushing to the operating system, which is fastest
+ * but may lose recent blocks if the machine crashes; one makes every saved
+ * block durable.
+ * @param num_blocks_since_sync The number of blocks appended since the last
+ * fsync.
+ * @param num_indexed_records The number of leading records known to be
+ * written to the index file.
+ * @param address_index_path The path of the address index file beside the
+ * log. See blockchain_log_write_address_index.
+ */
+typedef struct blockchain_log_t {
+    FILE *file;
+    FILE *index_file;
+    blockchain_log_record_t *records;
+    uint64_t num_records;
+    uint64_t records_capacity;
+    uint64_t end_offset;
+    size_t num_leading_zero_bytes_required_in_block_hash;
+    size_t blocks_per_sync;
+    size_t num_blocks_since_sync;
+    uint64_t num_indexed_records;
+    char *address_index_path;
+} blockchain_log_t;
+
+/**
+ * @brief A transaction read in place from a mapped block log.
+ * 
+ * The keys and signature point into the mapping rather than being copied, so
+ * the view is valid only until the log is closed.
+ * 
+ * @param created_at The time at which the transaction was created.
+ * @param sender_public_key The sender's public key.
+ * @param sender_public_key_length The number of bytes in sender_public_key.
+ * @param recipient_public_key The recipient's public key.
+ * @param recipient_public_key_length The number of bytes in
+ * recipient_public_key.
+ * @param amount The amount transferred from sender to recipient.
+ * @param sender_signature The sender's signature.
+ * @param sender_signature_length The number of bytes in sender_signature.
+ */
+typedef struct blockchain_transaction_view_t {
+    time_t created_at;
+    unsigned char *sender_public_key;
+    uint16_t sender_public_key_length;
+    unsigned char *recipient_public_key;
+    uint16_t recipient_public_key_length;
+    uint64_t amount;
+    unsigned char *sender_signature;
+    size_t sender_signature_length;
+} blockchain_transaction_view_t;
+
+/**
+ * @brief One block of a mapped block log, with its transactions undecoded.
+ * 
+ * @param header The block's header fields, from which block_hash computes its
+ * hash. Its transaction_list is NULL.
+ * @param num_transactions The number of transactions in the block.
+ * @param record The start of the block's bytes in the mapping.
+ * @param record_length The number of bytes in the block.
+ * @param transactions The start of the block's first transaction in the
+ * mapping.
+ */
+typedef struct blockchain_mapped_block_t {
+    block_t header;
+    uint64_t num_transactions;
+    unsigned char *record;
+    uint64_t record_length;
+    unsigned char *transactions;
+} blockchain_mapped_block_t;
+
+/**
+ * @brief A block log mapped into memory for reading.
+ * 
+ * Opening the log reads only the block headers. Transactions are decoded when
+ * asked for, straight from the mapping, so the operating system pages in only
+ * the blocks that are read.
+ * 
+ * @param mapping The log's bytes.
+ * @param mapping_size The number of bytes mapped.
+ * @param blocks The blocks in the log, indexed by height.
+ * @param num_blocks The number of blocks in the log.
+ * @param blocks_capacity The number of blocks allocated.
+ * @param num_leading_zero_bytes_required_in_block_hash The difficulty in the
+ * log's header.
+ */
+typedef struct blockchain_mapped_log_t {
+    unsigned char *mapping;
+    uint64_t mapping_size;
+    blockchain_mapped_block_t *blocks;
+    uint64_t num_blocks;
+    uint64_t blocks_capacity;
+    uint64_t num_leading_zero_bytes_required_in_block_hash;
+} blockchain_mapped_log_t;
+
 /**
  * @brief Fills blockchain with a pointer to the newly allocated blockchain.
  * 
@@ -58,11 +357,28 @@ return_code_t blockchain_create(
 /**
  * @brief Frees all memory associated with a blockchain.
  * 
+ * The blockchain releases its reference to each of its blocks, so blocks that
+ * another blockchain shares survive it.
+ * 
  * @param blockchain The blockchain to destroy.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t blockchain_destroy(blockchain_t *blockchain);
 
+/**
+ * @brief Fills clone with a new blockchain that shares blockchain's blocks.
+ * 
+ * The clone holds a reference to each block in blockchain's tree, active chain
+ * and side blocks alike, rather than a copy, so cloning costs one pointer per
+ * block plus a copy of the hash index. Either blockchain may then grow or be
+ * destroyed independently.
+ * 
+ * @param clone A pointer to fill with the clone's address.
+ * @param blockchain The blockchain to clone.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_clone(blockchain_t **clone, blockchain_t *blockchain);
+
 /**
  * @brief Fills sync with a newly allocated synchronized blockchain.
  * 
@@ -85,14 +401,238 @@ return_code_t synchronized_blockchain_create(
 return_code_t synchronized_blockchain_destroy(synchronized_blockchain_t *sync);
 
 /**
- * @brief Appends a block to the blockchain.
+ * @brief Enters a read section and fills blockchain with the published
+ * snapshot.
+ * 
+ * The snapshot stays valid, and unchanged, until the matching call to
+ * synchronized_blockchain_read_end. The function never blocks on writers. The
+ * snapshot holds the active chain's blocks and the difficulty, which is enough
+ * to serialize it; the block tree, hash index, ledger, and address index stay
+ * with the writers.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param blockchain A pointer to fill with the published snapshot.
+ * @param reader A pointer to fill with the reader's slot, which the caller
+ * passes to synchronized_blockchain_read_end.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_read_begin(
+    synchronized_blockchain_t *sync,
+    blockchain_t **blockchain,
+    size_t *reader
+);
+
+/**
+ * @brief Leaves a read section.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param reader The slot that synchronized_blockchain_read_begin filled.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_read_end(
+    synchronized_blockchain_t *sync,
+    size_t reader
+);
+
+/**
+ * @brief Prepares sync's blockchain to be changed in place.
+ * 
+ * If the change only appends to the active chain and the block array already
+ * has room, the array is left as is. Otherwise, the writers switch to a
+ * private copy of the array with at least num_blocks entries of room, and the
+ * next publication retires the old array. The caller must hold sync's mutex.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param num_blocks The most blocks the active chain can hold after the
+ * change.
+ * @param appends_only Whether the change can only append blocks to the active
+ * chain, as opposed to reorganizing it.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_prepare_write(
+    synchronized_blockchain_t *sync,
+    uint64_t num_blocks,
+    bool appends_only
+);
+
+/**
+ * @brief Publishes a snapshot of blockchain's active chain.
+ * 
+ * If blockchain is sync's blockchain, this publishes the writers' changes to
+ * it. Otherwise, sync takes ownership of blockchain, which replaces sync's
+ * blockchain. The old snapshot, and the old blockchain if it was replaced,
+ * are retired and freed once no reader can still hold them. The caller must
+ * hold sync's mutex and is responsible for updating the version and verified
+ * prefix.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param blockchain The blockchain to publish.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_publish(
+    synchronized_blockchain_t *sync,
+    blockchain_t *blockchain
+);
+
+/**
+ * @brief Appends a block to the blockchain in amortized constant time.
+ * 
+ * Seals the block and adds it to the blockchain's hash index, so the block
+ * must be final: its header must not change after this call.
  * 
  * @param blockchain The blockchain.
- * @param block The block to add.
+ * @param block The block to add. The blockchain takes ownership of it.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t blockchain_add_block(blockchain_t *blockchain, block_t *block);
 
+/**
+ * @brief Adds a block to the tree under the block whose hash it references.
+ * 
+ * If the block extends the active chain, it becomes the new tip. Otherwise it
+ * starts or extends a side branch, and if that branch becomes longer than the
+ * active chain, the blockchain reorganizes onto it. A reorganization moves
+ * only the blocks above the fork point. An empty blockchain accepts any block
+ * as its genesis block. Whenever the tip changes, side blocks more than
+ * BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH below it are pruned, and a new side block
+ * that is already that deep is released right away.
+ * 
+ * @param blockchain The blockchain.
+ * @param block The block to add. The blockchain takes ownership of it on
+ * success; it is sealed either way.
+ * @param tip_changed A pointer to fill with true if the active chain's tip
+ * changed, or false if the block went to a side branch.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if the tree does not hold the block's parent or, for
+ * a branch that would become the longest, any block between the branch and the
+ * active chain. Returns FAILURE_DUPLICATE_BLOCK if the tree already holds the
+ * block.
+ */
+return_code_t blockchain_add_block_to_tree(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool *tip_changed
+);
+
+/**
+ * @brief Copies into the tree the blocks of other that it does not hold.
+ * 
+ * Only the blocks of other above the highest block the two have in common are
+ * copied, and the blockchain reorganizes onto them if other is longer.
+ * 
+ * @param blockchain The blockchain to add blocks to.
+ * @param other The blockchain to copy blocks from. It is not modified.
+ * @param tip_changed A pointer to fill with true if the active chain's tip
+ * changed.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if the two blockchains have no block in common, in
+ * which case nothing is copied.
+ */
+return_code_t blockchain_merge(
+    blockchain_t *blockchain,
+    blockchain_t *other,
+    bool *tip_changed
+);
+
+/**
+ * @brief Fills length with the number of blocks in the blockchain.
+ * 
+ * @param blockchain The blockchain.
+ * @param length A pointer to fill with the number of blocks.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_length(blockchain_t *blockchain, uint64_t *length);
+
+/**
+ * @brief Fills block with the block at the given height.
+ * 
+ * @param blockchain The blockchain.
+ * @param height The block's height. The genesis block is at height 0.
+ * @param block A pointer to fill with the block. The blockchain still owns it.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if there is no block at that height.
+ */
+return_code_t blockchain_get_block(
+    blockchain_t *blockchain,
+    uint64_t height,
+    block_t **block
+);
+
+/**
+ * @brief Fills block with the last block in the blockchain.
+ * 
+ * @param blockchain The blockchain.
+ * @param block A pointer to fill with the block. The blockchain still owns it.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if the blockchain is empty.
+ */
+return_code_t blockchain_get_last_block(
+    blockchain_t *blockchain,
+    block_t **block
+);
+
+/**
+ * @brief Fills block and height with the block that has the given hash.
+ * 
+ * Looks the hash up in the blockchain's hash index in expected constant time.
+ * 
+ * @param blockchain The blockchain.
+ * @param block_hash The hash of the block to find.
+ * @param block A pointer to fill with the block. The blockchain still owns it.
+ * @param height A pointer to fill with the block's height.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_BLOCK_NOT_FOUND if no block in the chain has that hash.
+ */
+return_code_t blockchain_find_block_by_hash(
+    blockchain_t *blockchain,
+    sha_256_t *block_hash,
+    block_t **block,
+    uint64_t *height
+);
+
+/**
+ * @brief Fills balance with the account's balance after the active chain.
+ * 
+ * Reads the blockchain's ledger in expected constant time.
+ * 
+ * @param blockchain The blockchain.
+ * @param public_key The account's public key.
+ * @param balance A pointer to fill with the balance.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_get_balance(
+    blockchain_t *blockchain,
+    public_key_t *public_key,
+    int64_t *balance
+);
+
+/**
+ * @brief Fills postings with one page of the key's transactions, newest first.
+ * 
+ * Each posting gives the height of a block in the active chain and the
+ * position of the transaction in that block. The lookup does not scan any
+ * blocks, so it takes the same time however long the chain is.
+ * 
+ * @param blockchain The blockchain.
+ * @param public_key The key, as sender or recipient.
+ * @param offset The number of newest postings to skip.
+ * @param max_postings The number of postings the array can hold.
+ * @param postings An array to fill with the postings.
+ * @param num_postings A pointer to fill with the number of postings written.
+ * @param total_num_postings If not NULL, a pointer to fill with the number of
+ * postings for the key across all pages.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_get_transaction_history(
+    blockchain_t *blockchain,
+    public_key_t *public_key,
+    uint64_t offset,
+    uint64_t max_postings,
+    address_index_posting_t *postings,
+    uint64_t *num_postings,
+    uint64_t *total_num_postings
+);
+
 /**
  * @brief Fills is_valid_block_hash with true or false.
  * 
@@ -110,31 +650,66 @@ return_code_t blockchain_is_valid_block_hash(
     bool *is_valid_block_hash
 );
 
+/**
+ * @brief Fills first_proof_of_work and last_proof_of_work with the range of
+ * proofs of work that one of num_workers mining workers searches.
+ * 
+ * The ranges are contiguous, do not overlap, and together cover every proof of
+ * work from 0 to UINT64_MAX.
+ * 
+ * @param worker_idx The worker, from 0 to num_workers - 1.
+ * @param num_workers The number of workers. Must be at least 1.
+ * @param first_proof_of_work A pointer to fill with the first proof of work in
+ * the worker's range.
+ * @param last_proof_of_work A pointer to fill with the last proof of work in
+ * the worker's range, inclusive.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_get_proof_of_work_range(
+    size_t worker_idx,
+    size_t num_workers,
+    uint64_t *first_proof_of_work,
+    uint64_t *last_proof_of_work
+);
+
 /**
  * @brief Fills block's proof_of_work with a number that produces a valid hash.
  * 
+ * The search space of proofs of work is split into num_threads contiguous
+ * ranges. Each worker thread searches its own range on a private copy of the
+ * block, and the first worker to find a valid hash cancels the others. The
+ * calling thread acts as the first worker.
+ * 
  * @param blockchain The blockchain.
  * @param block The block for which to calculate a proof of work.
- * @param print_progress If true, display progress on the screen.
+ * @param print_progress If true, display progress and per-thread and aggregate
+ * hash rates on the screen.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
  * order of seconds), but not necessarily immediately.
+ * @param num_threads The number of threads with which to search. Must be at
+ * least 1. With exactly 1 thread, the search runs on the calling thread and
+ * checks proofs of work in order starting from zero.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t blockchain_mine_block(
     blockchain_t *blockchain,
     block_t *block,
     bool print_progress,
-    atomic_bool *should_stop
+    atomic_bool *should_stop,
+    size_t num_threads
 );
 
 /**
  * @brief Fills block's proof_of_work with a number that produces a valid hash.
  * 
+ * See blockchain_mine_block for how the search is split across threads.
+ * 
  * @param sync The synchronized blockchain.
  * @param block The block for which to calculate a proof of work.
- * @param print_progress If true, display progress on the screen.
+ * @param print_progress If true, display progress and per-thread and aggregate
+ * hash rates on the screen.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
@@ -143,6 +718,8 @@ return_code_t blockchain_mine_block(
  * synchronized blockchain that this function is currently mining. When the user
  * updates this number (from another thread), this function stops and returns
  * FAILURE_LONGER_BLOCKCHAIN_DETECTED.
+ * @param num_threads The number of threads with which to search. Must be at
+ * least 1.
  * @return return_code_t A return code indicating success or failure.
  */
 return_code_t synchronized_blockchain_mine_block(
@@ -150,7 +727,8 @@ return_code_t synchronized_blockchain_mine_block(
     block_t *block,
     bool print_progress,
     atomic_bool *should_stop,
-    atomic_size_t *sync_version_currently_mined
+    atomic_size_t *sync_version_currently_mined,
+    size_t num_threads
 );
 
 /**
@@ -170,10 +748,15 @@ void blockchain_print(blockchain_t *blockchain);
  * first block.
  * 2. Every block must have a correct previous block hash. For the genesis
  * block, the previous block hash must be zero.
- * 3. Every block except the genesis block must have a minting transaction as
+ * 3. Every block's Merkle root must match its transactions. The genesis block
+ * has no transactions, so its Merkle root must be zero.
+ * 4. Every block except the genesis block must have a minting transaction as
  * its first transaction. The minting transaction has an amount of 1 and has
  * both sender and recipient keys set to the miner.
- * 4. Every transaction in every block must have a valid digital signature.
+ * 5. Every transaction in every block must have a valid digital signature.
+ * 6. No transaction may send more than its sender holds, counting every
+ * earlier transaction in the chain and in the block. The blockchain's ledger
+ * tracks this as blocks are added, so the check costs nothing here.
  * 
  * @param blockchain The blockchain.
  * @param is_valid_blockchain A pointer to fill with the result.
@@ -187,9 +770,127 @@ return_code_t blockchain_verify(
     block_t **first_invalid_block
 );
 
+/**
+ * @brief Verifies that the blockchain is valid using several threads.
+ * 
+ * The checks are those of blockchain_verify. Worker threads claim chunks of
+ * consecutive blocks and check each block's proof of work, previous block
+ * hash, Merkle root and transaction signatures. Once a worker finds an invalid
+ * block, the workers skip every later block, but still finish the earlier
+ * ones, so the result is the same as that of blockchain_verify. The calling
+ * thread acts as the first worker.
+ * 
+ * @param blockchain The blockchain.
+ * @param is_valid_blockchain A pointer to fill with the result.
+ * @param first_invalid_block If the blockchain is invalid and this argument is
+ * not NULL, the function fills this pointer with the first invalid block.
+ * @param num_threads The number of threads with which to verify. Must be at
+ * least 1. With exactly 1 thread, this is the same as blockchain_verify.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_verify_parallel(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    size_t num_threads
+);
+
+/**
+ * @brief Verifies the blockchain, skipping a prefix verified previously.
+ * 
+ * If the blockchain contains verified_prefix, only the blocks after it are
+ * checked in full. When the blockchain is the one the prefix came from, the
+ * prefix costs one block hash; for any other blockchain, the prefix's hash
+ * links and Merkle roots are rechecked, but not its signatures. Otherwise the
+ * whole blockchain is checked as in blockchain_verify.
+ * 
+ * @param blockchain The blockchain.
+ * @param verified_prefix The prefix verified previously; zero it if there is
+ * none. If the blockchain is valid, this is updated to cover the whole
+ * blockchain.
+ * @param is_valid_blockchain A pointer to fill with the result.
+ * @param first_invalid_block If the blockchain is invalid and this argument is
+ * not NULL, the function fills this pointer with the first invalid block.
+ * @param num_threads The number of threads with which to verify the blocks
+ * after the prefix. Must be at least 1. See blockchain_verify_parallel.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_verify_incremental(
+    blockchain_t *blockchain,
+    blockchain_verified_prefix_t *verified_prefix,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    size_t num_threads
+);
+
+/**
+ * @brief Verifies a blockchain using the synchronized blockchain's verified
+ * prefix.
+ * 
+ * The blockchain may be the one in sync, or a candidate replacement such as a
+ * peer's blockchain. Either way, only blocks beyond the shared verified prefix
+ * are checked. If blockchain is the one in sync and is valid, sync's verified
+ * prefix is extended. The lock is not held while verifying.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param blockchain The blockchain to verify.
+ * @param is_valid_blockchain A pointer to fill with the result.
+ * @param first_invalid_block If the blockchain is invalid and this argument is
+ * not NULL, the function fills this pointer with the first invalid block.
+ * @param verified_prefix If not NULL and the blockchain is valid, this is
+ * filled with the blockchain's verified prefix. Callers that then install
+ * blockchain in sync should install this prefix with it.
+ * @param num_threads The number of threads with which to verify. Must be at
+ * least 1.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_verify(
+    synchronized_blockchain_t *sync,
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    blockchain_verified_prefix_t *verified_prefix,
+    size_t num_threads
+);
+
+/**
+ * @brief Brings a valid peer blockchain into the synchronized blockchain.
+ * 
+ * If the two blockchains share blocks, the peer's new blocks are merged into
+ * the tree in place and a new snapshot is published, and the active chain
+ * moves only if the peer's is longer. If they share none, a longer peer
+ * blockchain is published in place of the blockchain. Merged blocks are shared
+ * with the peer blockchain rather than copied, unless they live in its arena.
+ * A peer blockchain with a different difficulty is ignored. Whenever the
+ * active chain changes, sync's version is incremented so that miners switch
+ * to it. The caller must hold sync's mutex.
+ * 
+ * @param sync The synchronized blockchain.
+ * @param peer_blockchain The peer blockchain, already found to be valid.
+ * @param peer_verified_prefix The peer blockchain's verified prefix, as filled
+ * by synchronized_blockchain_verify.
+ * @param tip_changed A pointer to fill with true if the active chain changed.
+ * @param took_ownership A pointer to fill with true if sync now owns
+ * peer_blockchain. Otherwise, the caller must still destroy it.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t synchronized_blockchain_adopt_peer_blockchain(
+    synchronized_blockchain_t *sync,
+    blockchain_t *peer_blockchain,
+    blockchain_verified_prefix_t *peer_verified_prefix,
+    bool *tip_changed,
+    bool *took_ownership
+);
+
 /**
  * @brief Serializes the blockchain into a buffer for file or network I/O.
  * 
+ * The buffer is in format BLOCKCHAIN_SERIALIZATION_VERSION. It stores only the
+ * bytes each key and signature actually use, and writes counts, timestamps,
+ * amounts, and proofs of work as varints, so small values take a byte or two.
+ * Block hashes and Merkle roots stay at their full size. The exact size is
+ * computed first, so the buffer takes a single allocation.
+ * 
  * @param blockchain The blockchain.
  * @param buffer A pointer to fill with the bytes representing the blockchain.
  * Callers can write the bytes to a file or send on the network and reconstruct
@@ -204,14 +905,78 @@ return_code_t blockchain_serialize(
     uint64_t *buffer_size
 );
 
+/**
+ * @brief Fills size with the exact length of the blockchain's serialization.
+ * 
+ * @param blockchain The blockchain.
+ * @param size A pointer to fill with the number of bytes blockchain_serialize
+ * would produce.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_serialized_size(
+    blockchain_t *blockchain,
+    uint64_t *size
+);
+
+/**
+ * @brief Serializes the blockchain into a buffer the caller provides.
+ * 
+ * The bytes are the same as those from blockchain_serialize. Callers that
+ * reuse a buffer, or that need room before the blockchain for a message
+ * header, avoid an allocation and a copy.
+ * 
+ * @param blockchain The blockchain.
+ * @param buffer The buffer to fill.
+ * @param buffer_size The length of the buffer.
+ * @param bytes_written A pointer to fill with the number of bytes written.
+ * @return return_code_t A return code indicating success or failure. If the
+ * buffer is smaller than blockchain_serialized_size, returns
+ * FAILURE_BUFFER_TOO_SMALL and writes nothing.
+ */
+return_code_t blockchain_serialize_into_buffer(
+    blockchain_t *blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size,
+    uint64_t *bytes_written
+);
+
+/**
+ * @brief Serializes the blockchain across a list of buffers, as for writev.
+ * 
+ * Fills each buffer completely before moving to the next, so fields may span
+ * buffers. The bytes are the same as those from blockchain_serialize.
+ * 
+ * @param blockchain The blockchain.
+ * @param buffers The buffers to fill, in order.
+ * @param num_buffers The number of buffers.
+ * @param bytes_written A pointer to fill with the number of bytes written.
+ * @return return_code_t A return code indicating success or failure. If the
+ * buffers hold fewer bytes in total than blockchain_serialized_size, returns
+ * FAILURE_BUFFER_TOO_SMALL and writes nothing.
+ */
+return_code_t blockchain_serialize_into_iovec(
+    blockchain_t *blockchain,
+    struct iovec *buffers,
+    size_t num_buffers,
+    uint64_t *bytes_written
+);
+
 /**
  * @brief Reconstructs the blockchain from a buffer.
  * 
+ * The format is detected from the buffer's header. The buffer may be in the
+ * current format or any earlier one with a Merkle root in each block header,
+ * so blockchains saved or sent by older versions still load; saving them again
+ * migrates them to the current format. Transactions keep their hashes and
+ * signatures across the migration.
+ * 
  * @param blockchain A pointer to fill with the reconstructed blockchain.
  * Callers are responsible for calling blockchain_destroy when finished.
  * @param buffer An array containing the serialized blockchain.
  * @param buffer_size The length of the serialized blockchain.
- * @return return_code_t A return code indicating success or failure.
+ * @return return_code_t A return code indicating success or failure. Returns
+ * FAILURE_UNSUPPORTED_SERIALIZATION_VERSION for a buffer from before Merkle
+ * roots, which has no magic string, or with an unknown format version.
  */
 return_code_t blockchain_deserialize(
     blockchain_t **blockchain,
@@ -219,9 +984,36 @@ return_code_t blockchain_deserialize(
     uint64_t buffer_size
 );
 
+/**
+ * @brief Reconstructs the blockchain from a buffer with a single allocation for
+ * all of its blocks and transactions.
+ * 
+ * This is the same as blockchain_deserialize, but the blockchain loads with a
+ * handful of allocations instead of several per block and transaction, and
+ * blockchain_destroy frees it in constant time. It suits chains that are read
+ * and then discarded or extended, like those peers send during consensus.
+ * Blocks added to the blockchain later are allocated and freed as usual.
+ * 
+ * @param blockchain A pointer to fill with the reconstructed blockchain.
+ * Callers are responsible for calling blockchain_destroy when finished.
+ * @param buffer An array containing the serialized blockchain.
+ * @param buffer_size The length of the serialized blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_deserialize_into_arena(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size
+);
+
 /**
  * @brief Saves the blockchain to a file.
  * 
+ * The address index is saved beside it, at the same path followed by
+ * ADDRESS_INDEX_FILE_SUFFIX, so that wallets can list a key's transactions
+ * without loading the chain. The index file records the chain's tip hash so
+ * that readers can tell when it is stale.
+ * 
  * @param blockchain The blockchain.
  * @param outfile The path to the file to which to write the blockchain.
  * @return return_code_t A return code indicating success or failure.
@@ -234,6 +1026,11 @@ return_code_t blockchain_write_to_file(
 /**
  * @brief Reads the blockchain from a file.
  * 
+ * The address index is loaded from the file that blockchain_write_to_file
+ * saves beside the chain, rather than rebuilt from every block. If that file
+ * is missing, invalid, or stale because it records a different number of
+ * blocks or tip hash than the chain's, the index is rebuilt instead.
+ * 
  * @param blockchain A pointer to fill with the reconstructed blockchain.
  * Callers are responsible for calling blockchain_destroy when finished.
  * @param infile The path to the file from which to read the blockchain.
@@ -244,4 +1041,176 @@ return_code_t blockchain_read_from_file(
     char *infile
 );
 
+/**
+ * @brief Opens the block log at path, creating it if it does not exist.
+ * 
+ * Where each block lies comes from the log's index file. If the index is
+ * missing or stale, opening instead streams through the log's records once,
+ * holding only one record in memory at a time, drops a partial record left at
+ * the end of the file by an interrupted write, and rebuilds the index.
+ * 
+ * @param log A pointer to fill with the log. Callers are responsible for
+ * calling blockchain_log_close when finished.
+ * @param path The path to the log file.
+ * @param blocks_per_sync The number of appended blocks after which to call
+ * fsync, or zero to never call it. See blockchain_log_t.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_log_open(
+    blockchain_log_t **log,
+    char *path,
+    size_t blocks_per_sync
+);
+
+/**
+ * @brief Makes the log hold the blockchain's active chain.
+ * 
+ * The log keeps its blocks up to the last one the active chain shares with
+ * it, truncating any after that, and appends the rest of the active chain. In
+ * the common case of a chain that grew by one block, this writes one record.
+ * If the write fails, the log is left holding a prefix of the active chain.
+ * 
+ * @param log The log.
+ * @param blockchain The blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_log_save(
+    blockchain_log_t *log,
+    blockchain_t *blockchain
+);
+
+/**
+ * @brief Fills blocks with newly allocated copies of a range of logged blocks.
+ * 
+ * The log's records say where each block lies, so this reads only the range
+ * asked for, in a single read, however long the log is.
+ * 
+ * @param log The log.
+ * @param first_height The height of the first block to read.
+ * @param num_blocks The number of blocks to read.
+ * @param blocks An array of length num_blocks to fill with the blocks, in
+ * order of height. The caller holds the only reference to each and may add
+ * them to a blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_log_read_blocks(
+    blockchain_log_t *log,
+    uint64_t first_height,
+    uint64_t num_blocks,
+    block_t **blocks
+);
+
+/**
+ * @brief Closes the log and frees all memory associated with it.
+ * 
+ * If the log calls fsync at all, it first calls it for any blocks appended
+ * since the last call, so that a clean shutdown never loses blocks.
+ * 
+ * @param log The log.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_log_close(blockchain_log_t *log);
+
+/**
+ * @brief Saves the blockchain's address index beside the log.
+ * 
+ * The index goes to the log's path followed by ADDRESS_INDEX_FILE_SUFFIX,
+ * stamped with the hash of the log's last block like the file that
+ * blockchain_write_to_file saves. Writing it costs time proportional to the
+ * whole index, so callers save it when they stop rather than with every
+ * block. blockchain_log_read_from_file then loads it instead of rebuilding
+ * the index, unless blocks were saved to the log since.
+ * 
+ * @param log The log.
+ * @param blockchain The blockchain, whose active chain the log must hold.
+ * @return return_code_t A return code indicating success or failure.
+ * Returns FAILURE_INVALID_INPUT if the log does not hold the active chain.
+ */
+return_code_t blockchain_log_write_address_index(
+    blockchain_log_t *log,
+    blockchain_t *blockchain
+);
+
+/**
+ * @brief Reads the blockchain from a block log.
+ * 
+ * The blocks are decoded one record at a time as the file streams in, so
+ * memory use beyond the blockchain itself is bounded by the largest block. A
+ * partial record at the end of the file is ignored, and the file is not
+ * modified. The address index is loaded from the file that
+ * blockchain_log_write_address_index saves if that still matches the log's
+ * length and tip, and is rebuilt from the blocks otherwise.
+ * 
+ * @param blockchain A pointer to fill with the blockchain. Callers are
+ * responsible for calling blockchain_destroy when finished.
+ * @param path The path to the log file.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_log_read_from_file(
+    blockchain_t **blockchain,
+    char *path
+);
+
+/**
+ * @brief Maps the block log at path into memory and indexes its blocks.
+ * 
+ * Unlike blockchain_log_read_from_file, this decodes no transactions, so
+ * opening takes time proportional to the number of blocks rather than the
+ * size of the file. Like it, this ignores a partial record at the end of the
+ * file.
+ * 
+ * @param mapped_log A pointer to fill with the mapped log. Callers are
+ * responsible for calling blockchain_mapped_log_close when finished.
+ * @param path The path to the log file.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_mapped_log_open(
+    blockchain_mapped_log_t **mapped_log,
+    char *path
+);
+
+/**
+ * @brief Unmaps the log and frees all memory associated with it.
+ * 
+ * Views into the log are invalid afterwards.
+ * 
+ * @param mapped_log The mapped log.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_mapped_log_close(blockchain_mapped_log_t *mapped_log);
+
+/**
+ * @brief Fills views with the transactions of the block at height.
+ * 
+ * @param mapped_log The mapped log.
+ * @param height The height of the block.
+ * @param views An array to fill with one view per transaction, in order.
+ * @param max_views The number of views the array can hold. It must be at least
+ * the block's num_transactions.
+ * @param num_views A pointer to fill with the number of views written.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_mapped_log_get_transactions(
+    blockchain_mapped_log_t *mapped_log,
+    uint64_t height,
+    blockchain_transaction_view_t *views,
+    uint64_t max_views,
+    uint64_t *num_views
+);
+
+/**
+ * @brief Fills block with a newly allocated copy of the block at height.
+ * 
+ * @param mapped_log The mapped log.
+ * @param height The height of the block.
+ * @param block A pointer to fill with the block. The caller holds its only
+ * reference and may add it to a blockchain.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t blockchain_mapped_log_get_block(
+    blockchain_mapped_log_t *mapped_log,
+    uint64_t height,
+    block_t **block
+);
+
 #endif  // INCLUDE_BLOCKCHAIN_H_
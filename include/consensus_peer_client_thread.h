@@ -26,6 +26,8 @@
  * entry is a peer_info_t struct.
  * @param peer_info_list_mutex Protects peer_info_list.
  * @param print_progress If true, display progress on the screen.
+ * @param num_verification_threads The number of threads with which to verify
+ * blockchains received from peers. Zero is treated as one.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
@@ -47,6 +49,7 @@ typedef struct run_consensus_peer_client_args_t {
     linked_list_t **peer_info_list;
     pthread_mutex_t *peer_info_list_mutex;
     bool print_progress;
+    size_t num_verification_threads;
     atomic_bool *should_stop;
     bool *exit_ready;
     pthread_cond_t exit_ready_cond;
@@ -25,6 +25,8 @@
  * update the synchronized blockchain whenever it receives a longer chain that
  * is valid and has the same number of leading zeros required.
  * @param print_progress If true, display progress on the screen.
+ * @param num_verification_threads The number of threads with which to verify
+ * blockchains received from peers. Zero is treated as one.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
@@ -45,6 +47,7 @@ typedef struct run_consensus_peer_server_args_t {
     struct sockaddr_in6 consensus_peer_server_addr;
     synchronized_blockchain_t *sync;
     bool print_progress;
+    size_t num_verification_threads;
     atomic_bool *should_stop;
     bool *exit_ready;
     pthread_cond_t exit_ready_cond;
@@ -12,6 +12,9 @@
 #define MAX_SSH_KEY_LENGTH 4096
 // OpenSSL digital signatures are 1/8 the size of the key length.
 #define MAX_SSH_SIGNATURE_LENGTH 512
+// The DER encoding of an RSA-4096 public key, the largest key whose
+// signatures fit in MAX_SSH_SIGNATURE_LENGTH.
+#define MAX_PUBLIC_KEY_LENGTH 550
 
 /**
  * @brief Contains an SSH key.
@@ -22,6 +25,22 @@ typedef struct ssh_key_t {
     char bytes[MAX_SSH_KEY_LENGTH];
 } ssh_key_t;
 
+/**
+ * @brief Contains a public key in compact, DER-encoded form.
+ * 
+ * An ssh_key_t spends MAX_SSH_KEY_LENGTH bytes on a PEM string; this type
+ * keeps only the DER bytes the PEM string encodes, about 300 bytes for an
+ * RSA-2048 key. Serialization writes only the first length bytes.
+ * 
+ * @param length The number of bytes in use. Zero represents the empty key.
+ * @param bytes The DER-encoded SubjectPublicKeyInfo. Bytes past length are
+ * zero, so two keys are equal exactly when their structs are.
+ */
+typedef struct public_key_t {
+    uint16_t length;
+    unsigned char bytes[MAX_PUBLIC_KEY_LENGTH];
+} public_key_t;
+
 /**
  * @brief Contains an SSH signature.
  * 
@@ -32,4 +51,33 @@ typedef struct ssh_signature_t {
     unsigned char bytes[MAX_SSH_SIGNATURE_LENGTH];
 } ssh_signature_t;
 
+/**
+ * @brief Fills public_key with the compact form of a PEM public key.
+ * 
+ * @param public_key The pointer to fill with the compact key.
+ * @param ssh_key The PEM-encoded public key. An all-zero ssh_key_t converts to
+ * the empty key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_from_ssh_key(
+    public_key_t *public_key,
+    ssh_key_t *ssh_key
+);
+
+/**
+ * @brief Fills ssh_key with the PEM form of a compact public key.
+ * 
+ * The PEM string has the layout OpenSSL writes: the base 64 body wraps at 64
+ * characters and every line ends in a newline. The rest of ssh_key is zero.
+ * 
+ * @param ssh_key The pointer to fill with the PEM-encoded key.
+ * @param public_key The compact key. The empty key converts to an all-zero
+ * ssh_key_t.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_to_ssh_key(
+    ssh_key_t *ssh_key,
+    public_key_t *public_key
+);
+
 #endif  // INCLUDE_CRYPTOGRAPHY_H_
@@ -4,17 +4,167 @@
 
 #ifndef INCLUDE_HASH_H_
 #define INCLUDE_HASH_H_
+#define SHA_256_BLOCK_SIZE 64
+#define SHA_256_STATE_NUM_WORDS 8
+#define SHA_256_NUM_MESSAGE_WORDS 16
+#define SHA_256_NUM_ROUNDS 64
+#define SHA_256_PADDING_START_BYTE 0x80
+#define HASH_BACKEND_OPENSSL "openssl"
+#define HASH_BACKEND_GENERIC "generic"
+#define HASH_BACKEND_SHA_NI "sha-ni"
+#define HASH_BACKEND_ARMV8 "armv8"
+#define HASH_NUM_BACKENDS 4
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <openssl/sha.h>
+#include "include/return_codes.h"
 
 typedef struct sha_256_t {
     unsigned char digest[SHA256_DIGEST_LENGTH];
 } sha_256_t;
 
+/**
+ * @brief Represents the intermediate state of a SHA-256 computation.
+ * 
+ * @param words The eight 32 bit chaining values. After the final compression,
+ * these words in big endian order are the digest.
+ */
+typedef struct sha_256_state_t {
+    uint32_t words[SHA_256_STATE_NUM_WORDS];
+} sha_256_state_t;
+
+/**
+ * @brief A function that runs the SHA-256 compression function on one block.
+ * 
+ * @param state The chaining state, which is updated in place.
+ * @param block The SHA_256_BLOCK_SIZE byte message block.
+ */
+typedef void hash_sha_256_compress_function_t(
+    sha_256_state_t *state,
+    const unsigned char *block
+);
+
+/**
+ * @brief A function that fills hash with the SHA-256 digest of a message.
+ * 
+ * @param data The data to hash. May be NULL if size is 0.
+ * @param size The number of bytes in data.
+ * @param hash The hash to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+typedef return_code_t hash_sha_256_digest_function_t(
+    const void *data,
+    size_t size,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Represents an implementation of SHA-256.
+ * 
+ * @param name The name users pass to hash_set_backend.
+ * @param compress The compression function. NULL if this build cannot compile
+ * the backend for its target architecture, or if the backend only hashes
+ * whole messages.
+ * @param digest Hashes whole messages. NULL if hash_sha_256 should instead pad
+ * the message and run compress on each block.
+ * @param is_supported Returns true if the CPU running this process has the
+ * instructions the backend needs.
+ */
+typedef struct hash_backend_t {
+    const char *name;
+    hash_sha_256_compress_function_t *compress;
+    hash_sha_256_digest_function_t *digest;
+    bool (*is_supported)();
+} hash_backend_t;
+
+// The available backends, from most to least preferred. OpenSSL is first
+// because its assembly beats the hand-written backends on whole messages. It
+// exposes no compression function, so compression uses the most preferred
+// hand-written backend. The generic C backend is always last and always
+// supported.
+extern const hash_backend_t HASH_BACKENDS[HASH_NUM_BACKENDS];
+
+// The SHA-256 round constants, for implementations of the compression function
+// outside of hash.c.
+extern const uint32_t SHA_256_ROUND_CONSTANTS[SHA_256_NUM_ROUNDS];
+
 /**
  * @brief Prints the hash value.
  */
 void hash_print(sha_256_t *hash);
 
+/**
+ * @brief Returns true if backend is compiled in and the CPU supports it.
+ */
+bool hash_backend_is_supported(const hash_backend_t *backend);
+
+/**
+ * @brief Returns the backend that hash_sha_256 uses.
+ * 
+ * On first use, this selects the most preferred supported backend, which is
+ * OpenSSL. hash_set_backend overrides the selection.
+ */
+const hash_backend_t *hash_get_backend();
+
+/**
+ * @brief Returns the backend that hash_sha_256_compress uses.
+ * 
+ * This is the selected backend if it has a compression function. Otherwise,
+ * it is the most preferred supported backend that does, based on CPU features
+ * (cpuid on x86, hwcaps on ARM).
+ */
+const hash_backend_t *hash_get_compress_backend();
+
+/**
+ * @brief Forces SHA-256 hashing in the process to use the named backend.
+ * 
+ * This is meant to be called at startup, e.g., to benchmark backends against
+ * each other. All backends produce identical digests.
+ * 
+ * @param name The backend name, e.g., HASH_BACKEND_GENERIC.
+ * @return return_code_t FAILURE_INVALID_INPUT if there is no such backend, or
+ * FAILURE_HASH_BACKEND_NOT_SUPPORTED if this CPU or build cannot run it.
+ */
+return_code_t hash_set_backend(const char *name);
+
+/**
+ * @brief Fills hash with the SHA-256 digest of data using the selected backend.
+ * 
+ * @param data The data to hash. May be NULL if size is 0.
+ * @param size The number of bytes in data.
+ * @param hash The hash to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t hash_sha_256(const void *data, size_t size, sha_256_t *hash);
+
+/**
+ * @brief Sets state to the SHA-256 initial hash value.
+ * 
+ * @param state The state to initialize.
+ */
+void hash_sha_256_init_state(sha_256_state_t *state);
+
+/**
+ * @brief Runs the SHA-256 compression function on one 64 byte block.
+ * 
+ * This uses hash_get_compress_backend. Callers are responsible for message
+ * padding. This is the building block for hashing many messages that share a
+ * prefix: compress the prefix once, copy the state, and compress only the
+ * blocks that differ.
+ * 
+ * @param state The chaining state, which is updated in place.
+ * @param block The SHA_256_BLOCK_SIZE byte message block.
+ */
+void hash_sha_256_compress(sha_256_state_t *state, const unsigned char *block);
+
+/**
+ * @brief Fills hash with the digest corresponding to the final state.
+ * 
+ * @param state The state after the last (padded) block has been compressed.
+ * @param hash The hash to fill.
+ */
+void hash_sha_256_state_to_digest(sha_256_state_t *state, sha_256_t *hash);
+
 #endif  // INCLUDE_HASH_H_
@@ -0,0 +1,147 @@
+/**
+ * @brief Tracks account balances along a chain of blocks.
+ * 
+ * The ledger is an open-addressing hash table keyed by the SHA-256 digest of
+ * each account's public key, laid out like the block hash index. Applying a
+ * block updates only the accounts its transactions touch, and reverting it
+ * undoes exactly those updates, so following a chain through appends and
+ * reorganizations never rescans it.
+ */
+
+#ifndef INCLUDE_LEDGER_H_
+#define INCLUDE_LEDGER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "include/block.h"
+#include "include/cryptography.h"
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+#define LEDGER_MIN_CAPACITY 16
+
+/**
+ * @brief One account in the ledger.
+ * 
+ * @param key_digest The SHA-256 digest of the account's public key.
+ * @param balance The account's balance. It is negative only if the chain
+ * overspends.
+ * @param is_occupied Whether the slot holds an account.
+ */
+typedef struct ledger_entry_t {
+    sha_256_t key_digest;
+    int64_t balance;
+    bool is_occupied;
+} ledger_entry_t;
+
+/**
+ * @brief Account balances after a sequence of blocks.
+ * 
+ * The first transaction of every block is its minting transaction, which
+ * credits its recipient without debiting anyone. Every other transaction moves
+ * its amount from its sender to its recipient. A transaction overspends if its
+ * sender's balance just before it is less than its amount. The ledger applies
+ * overspending transactions anyway, so that reverting them is exact, and
+ * records where the first one occurred.
+ * 
+ * @param entries The slots. Their number is always a power of two.
+ * @param capacity The number of slots.
+ * @param num_entries The number of occupied slots. The ledger grows before
+ * more than half of the slots are occupied. Accounts stay in the ledger once
+ * added, even if their balance returns to zero.
+ * @param num_blocks The number of blocks applied.
+ * @param num_blocks_without_overspend The number of applied blocks before the
+ * first block with an overspending transaction. It equals num_blocks if no
+ * applied block overspends.
+ */
+typedef struct ledger_t {
+    ledger_entry_t *entries;
+    size_t capacity;
+    size_t num_entries;
+    uint64_t num_blocks;
+    uint64_t num_blocks_without_overspend;
+} ledger_t;
+
+/**
+ * @brief Fills ledger with a pointer to a newly allocated, empty ledger.
+ * 
+ * @param ledger A pointer to fill with the ledger's address.
+ * @param expected_num_accounts The number of accounts the ledger should hold
+ * without growing. The ledger still grows past this number as needed.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_create(ledger_t **ledger, size_t expected_num_accounts);
+
+/**
+ * @brief Frees all memory associated with the ledger.
+ * 
+ * @param ledger The ledger.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_destroy(ledger_t *ledger);
+
+/**
+ * @brief Fills copy with a pointer to a newly allocated copy of the ledger.
+ * 
+ * @param copy A pointer to fill with the copy's address.
+ * @param ledger The ledger to copy.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_copy(ledger_t **copy, ledger_t *ledger);
+
+/**
+ * @brief Makes room for num_accounts more accounts.
+ * 
+ * Applying blocks whose transactions name at most that many new accounts then
+ * cannot fail.
+ * 
+ * @param ledger The ledger.
+ * @param num_accounts The number of accounts to make room for.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_reserve(ledger_t *ledger, size_t num_accounts);
+
+/**
+ * @brief Applies the block's transactions to the balances.
+ * 
+ * Runs in time linear in the number of transactions in the block. On failure,
+ * the ledger is unchanged.
+ * 
+ * @param ledger The ledger.
+ * @param block The block to apply after the blocks already applied.
+ * @param overspends If not NULL, a pointer to fill with true if any of the
+ * block's transactions overspends.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_apply_block(
+    ledger_t *ledger,
+    block_t *block,
+    bool *overspends
+);
+
+/**
+ * @brief Undoes ledger_apply_block for the last block applied.
+ * 
+ * @param ledger The ledger.
+ * @param block The last block applied, with its transactions unchanged since.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_revert_block(ledger_t *ledger, block_t *block);
+
+/**
+ * @brief Fills balance with the account's balance in constant time.
+ * 
+ * @param ledger The ledger.
+ * @param public_key The account's public key.
+ * @param balance A pointer to fill with the balance. Accounts that no applied
+ * transaction names have a balance of zero.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t ledger_get_balance(
+    ledger_t *ledger,
+    public_key_t *public_key,
+    int64_t *balance
+);
+
+#endif  // INCLUDE_LEDGER_H_
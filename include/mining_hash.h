@@ -0,0 +1,145 @@
+/**
+ * @brief Defines a hash engine for searching proofs of work.
+ * 
+ * Mining hashes the same block header over and over, changing only the proof
+ * of work. The header places the proof of work in its last bytes, so the
+ * SHA-256 state after the first 64 byte block (the midstate) is the same for
+ * every attempt. The engine computes the midstate once per block and runs only
+ * the final compression for each proof of work. The resulting digests are
+ * identical to those from block_hash.
+ */
+
+#ifndef INCLUDE_MINING_HASH_H_
+#define INCLUDE_MINING_HASH_H_
+// The header bytes, the 0x80 padding byte, and the 64 bit message length must
+// fit in two blocks for the engine to need only one compression per attempt.
+#define MINING_HASH_NUM_BLOCKS 2
+#define MINING_HASH_PROOF_OF_WORK_OFFSET \
+    (BLOCK_HEADER_SIZE - sizeof(uint64_t) - SHA_256_BLOCK_SIZE)
+// The number of consecutive proofs of work each call to mining_hash_sweep
+// tries. This is a multiple of every kernel's lane count.
+#define MINING_HASH_SWEEP_SIZE 16
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "include/block.h"
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+/**
+ * @brief Holds the precomputed state for mining a block.
+ * 
+ * A template is not safe to share between threads that call
+ * mining_hash_compute concurrently; each mining thread needs its own.
+ * 
+ * @param midstate The SHA-256 state after compressing the first header block.
+ * @param final_block The last header block, already padded. Only the proof of
+ * work bytes change between attempts.
+ */
+typedef struct mining_hash_template_t {
+    sha_256_state_t midstate;
+    unsigned char final_block[SHA_256_BLOCK_SIZE];
+} mining_hash_template_t;
+
+/**
+ * @brief Identifies an implementation of mining_hash_sweep.
+ * 
+ * The SIMD kernels evaluate several proofs of work at once, one per vector
+ * lane: 8 for AVX2 and 16 for AVX-512. The scalar kernel runs everywhere.
+ */
+typedef enum mining_hash_kernel_t {
+    MINING_HASH_KERNEL_SCALAR,
+    MINING_HASH_KERNEL_AVX2,
+    MINING_HASH_KERNEL_AVX512,
+} mining_hash_kernel_t;
+
+/**
+ * @brief Holds the outcome of a sweep over MINING_HASH_SWEEP_SIZE proofs of
+ * work.
+ * 
+ * @param found True if any proof of work in the sweep is valid.
+ * @param valid_proof_of_work The lowest valid proof of work. Only meaningful
+ * if found is true.
+ * @param best_proof_of_work The proof of work whose hash has the smallest
+ * first 32 bits, i.e., the most leading zeroes. Useful for progress reporting.
+ * @param best_first_word The first 32 bits of the hash of best_proof_of_work,
+ * read as a big endian integer.
+ */
+typedef struct mining_hash_sweep_result_t {
+    bool found;
+    uint64_t valid_proof_of_work;
+    uint64_t best_proof_of_work;
+    uint32_t best_first_word;
+} mining_hash_sweep_result_t;
+
+/**
+ * @brief Fills mining_template with the precomputed state for block.
+ * 
+ * The template captures every header field except the proof of work. Callers
+ * must reinitialize it if they change any other header field.
+ * 
+ * @param mining_template The template to fill.
+ * @param block The block to mine.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_hash_template_init(
+    mining_hash_template_t *mining_template,
+    block_t *block
+);
+
+/**
+ * @brief Fills hash with the block hash for the given proof of work.
+ * 
+ * The result is the same as setting the block's proof_of_work and calling
+ * block_hash, but costs one SHA-256 compression instead of a full digest.
+ * 
+ * @param mining_template The template for the block being mined.
+ * @param proof_of_work The proof of work to try.
+ * @param hash The hash to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_hash_compute(
+    mining_hash_template_t *mining_template,
+    uint64_t proof_of_work,
+    sha_256_t *hash
+);
+
+/**
+ * @brief Returns true if the CPU running this process supports kernel.
+ */
+bool mining_hash_kernel_is_supported(mining_hash_kernel_t kernel);
+
+/**
+ * @brief Returns the fastest kernel the CPU running this process supports.
+ */
+mining_hash_kernel_t mining_hash_best_kernel();
+
+/**
+ * @brief Returns a printable name for kernel.
+ */
+const char *mining_hash_kernel_name(mining_hash_kernel_t kernel);
+
+/**
+ * @brief Tries MINING_HASH_SWEEP_SIZE consecutive proofs of work.
+ * 
+ * Tries first_proof_of_work, first_proof_of_work + 1, and so on. Kernels only
+ * finish the first 32 bit word of each hash, which decides up to 4 leading
+ * zero bytes; candidates that need more are confirmed with
+ * mining_hash_compute. Callers must ensure the range does not wrap around.
+ * 
+ * @param mining_template The template for the block being mined.
+ * @param kernel The kernel to use. It must be supported by the CPU.
+ * @param first_proof_of_work The first proof of work to try.
+ * @param num_leading_zero_bytes_required_in_block_hash The difficulty.
+ * @param result The result to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t mining_hash_sweep(
+    mining_hash_template_t *mining_template,
+    mining_hash_kernel_t kernel,
+    uint64_t first_proof_of_work,
+    size_t num_leading_zero_bytes_required_in_block_hash,
+    mining_hash_sweep_result_t *result
+);
+
+#endif  // INCLUDE_MINING_HASH_H_
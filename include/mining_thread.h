@@ -9,6 +9,9 @@
 #include "include/blockchain.h"
 #include "include/cryptography.h"
 
+#define DEFAULT_NUM_MINING_THREADS 1
+#define DEFAULT_OUTFILE_BLOCKS_PER_SYNC 1
+
 /**
  * @brief Contains the arguments to the mine_blocks function.
  * 
@@ -18,8 +21,9 @@
  * @param sync A synchronized blockchain on which to mine. This function will
  * generate new blocks on this blockchain. Periodically, this function will
  * check the version number to see if the networking thread has received a
- * longer blockchain. If so, this function will begin mining on the new
- * blockchain and free all memory associated with the old blockchain.
+ * longer blockchain. If so, this function will begin mining on the new tip.
+ * The function mines on a private view of the blockchain that shares its
+ * blocks, and adds each mined block to both.
  * @param miner_public_key The public key with which to mine blocks. This
  * function uses it to create the minting transaction.
  * @param miner_private_key The private key with which to mine blocks. This
@@ -28,11 +32,21 @@
  * entry is a peer_info_t struct.
  * @param peer_info_list_mutex Protects peer_info_list.
  * @param print_progress If true, display progress on the screen.
- * @param outfile If not NULL, this function will save the blockchain to this
- * filename every time it mines a new block. If NULL, this function will only
- * keep the blockchain in memory. Unless you are just testing, you should
- * provide this argument. Otherwise there is no local record of your mining and
- * you may lose all the coin you have mined thus far.
+ * @param num_mining_threads The number of threads with which to search for
+ * each block's proof of work and to verify the blockchain. Zero is treated as
+ * one.
+ * @param outfile If not NULL, this function will save the blockchain to a block
+ * log at this path every time it mines a new block. Each save appends only the
+ * blocks the log lacks, after truncating it to the fork point if the miner
+ * switched chains; see blockchain_log_t. A failed save is reported on stderr
+ * and mining continues, since the next save writes whatever the log lacks.
+ * When the function stops, it also saves the address index beside the log;
+ * see blockchain_log_write_address_index. If NULL, this function will only keep
+ * the blockchain in memory. Unless you are just testing, you should provide
+ * this argument. Otherwise there is no local record of your mining and you may
+ * lose all the coin you have mined thus far.
+ * @param outfile_blocks_per_sync The number of saved blocks after which the
+ * log calls fsync. Zero leaves flushing to the operating system.
  * @param should_stop This should initially be false. Setting this flag while
  * the function is running requests that the function terminate gracefully.
  * Users should expect the function to terminate in a timely manner (on the
@@ -67,7 +81,9 @@ typedef struct mine_blocks_args_t {
     linked_list_t **peer_info_list;
     pthread_mutex_t *peer_info_list_mutex;
     bool print_progress;
+    size_t num_mining_threads;
     char *outfile;
+    size_t outfile_blocks_per_sync;
     atomic_bool *should_stop;
     bool *exit_ready;
     pthread_cond_t exit_ready_cond;
@@ -0,0 +1,129 @@
+/**
+ * @brief Caches parsed public keys for signature verification.
+ * 
+ * Parsing a public key costs more than checking a signature with it, and the
+ * same few miners sign most transactions, so verifiers look keys up here
+ * instead of parsing them every time. Entries are addressed by the SHA-256
+ * digest of the key bytes, so callers only need the raw public_key_t.
+ */
+
+#ifndef INCLUDE_PUBLIC_KEY_CACHE_H_
+#define INCLUDE_PUBLIC_KEY_CACHE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <openssl/evp.h>
+#include "include/cryptography.h"
+#include "include/hash.h"
+#include "include/return_codes.h"
+
+#define DEFAULT_PUBLIC_KEY_CACHE_CAPACITY 64
+
+/**
+ * @brief One parsed public key in the cache.
+ * 
+ * @param key_digest The SHA-256 digest of the key's DER bytes.
+ * @param public_key The parsed key. The cache holds one reference.
+ * @param last_used The cache's clock value when the entry was last looked up.
+ * The entry with the smallest value is the least recently used.
+ */
+typedef struct public_key_cache_entry_t {
+    sha_256_t key_digest;
+    EVP_PKEY *public_key;
+    uint64_t last_used;
+} public_key_cache_entry_t;
+
+/**
+ * @brief A thread-safe, bounded cache of parsed public keys.
+ * 
+ * @param entries The cached keys. Only the first num_entries are in use.
+ * @param capacity The maximum number of entries. When the cache is full, the
+ * least recently used entry is evicted.
+ * @param num_entries The number of entries in use.
+ * @param clock Incremented on every lookup to order entries by recency.
+ * @param num_hits The number of lookups that found the key in the cache.
+ * @param num_misses The number of lookups that had to parse the key.
+ * @param mutex The mutex protecting access to this data structure's fields.
+ */
+typedef struct public_key_cache_t {
+    public_key_cache_entry_t *entries;
+    size_t capacity;
+    size_t num_entries;
+    uint64_t clock;
+    uint64_t num_hits;
+    uint64_t num_misses;
+    pthread_mutex_t mutex;
+} public_key_cache_t;
+
+/**
+ * @brief Fills cache with a pointer to a newly allocated, empty cache.
+ * 
+ * @param cache A pointer to fill with the cache's address.
+ * @param capacity The maximum number of keys to hold. Must be at least 1.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_cache_create(
+    public_key_cache_t **cache,
+    size_t capacity
+);
+
+/**
+ * @brief Frees all memory associated with the cache.
+ * 
+ * Keys that callers obtained from the cache stay valid until the callers free
+ * them.
+ * 
+ * @param cache The cache.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_cache_destroy(public_key_cache_t *cache);
+
+/**
+ * @brief Fills public_key with the parsed form of key.
+ * 
+ * If the key is not cached, this function parses it and caches the result.
+ * Parsing happens without holding the lock, so threads that miss on different
+ * keys do not wait for each other.
+ * 
+ * @param cache The cache.
+ * @param key The DER-encoded public key.
+ * @param public_key A pointer to fill with the parsed key. The caller owns a
+ * reference to it and must release it with EVP_PKEY_free, even if the cache
+ * evicts the key in the meantime.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_cache_get(
+    public_key_cache_t *cache,
+    public_key_t *key,
+    EVP_PKEY **public_key
+);
+
+/**
+ * @brief Fills num_hits and num_misses with the cache's lookup counters.
+ * 
+ * @param cache The cache.
+ * @param num_hits A pointer to fill with the number of lookups that found the
+ * key in the cache.
+ * @param num_misses A pointer to fill with the number of lookups that had to
+ * parse the key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_cache_get_stats(
+    public_key_cache_t *cache,
+    uint64_t *num_hits,
+    uint64_t *num_misses
+);
+
+/**
+ * @brief Fills cache with the process-wide cache that signature verification
+ * uses.
+ * 
+ * The cache is created with DEFAULT_PUBLIC_KEY_CACHE_CAPACITY entries on first
+ * use and lives until the process exits.
+ * 
+ * @param cache A pointer to fill with the cache's address.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t public_key_cache_get_default(public_key_cache_t **cache);
+
+#endif  // INCLUDE_PUBLIC_KEY_CACHE_H_
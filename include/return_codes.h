@@ -26,6 +26,11 @@ typedef enum return_code_t {
     FAILURE_INVALID_COMMAND,
     FAILURE_INVALID_COMMAND_LEN,
     FAILURE_SLEEP,
+    FAILURE_HASH_BACKEND_NOT_SUPPORTED,
+    FAILURE_BLOCK_NOT_FOUND,
+    FAILURE_KEY_TOO_LONG,
+    FAILURE_UNSUPPORTED_SERIALIZATION_VERSION,
+    FAILURE_DUPLICATE_BLOCK,
 } return_code_t;
 
 #endif  // INCLUDE_RETURN_CODES_H_
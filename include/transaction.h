@@ -8,10 +8,22 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <sys/time.h>
+#include <openssl/evp.h>
 #include "include/return_codes.h"
 #include "include/cryptography.h"
+#include "include/hash.h"
 
 #define AMOUNT_GENERATED_DURING_MINTING 1
+// Transactions used to store their keys as ssh_key_t and were hashed and
+// signed as their raw bytes. The preimage rebuilds that layout so that
+// transactions created before keys became compact keep their hashes and
+// signatures.
+#define TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE ( \
+    sizeof(time_t) + 2 * sizeof(ssh_key_t) + sizeof(uint64_t))
+#define TRANSACTION_PREIMAGE_SIZE ( \
+    TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE + \
+    sizeof(size_t) + \
+    MAX_SSH_SIGNATURE_LENGTH)
 
 /**
  * @brief Represents a transaction.
@@ -28,12 +40,31 @@
  */
 typedef struct transaction_t {
     time_t created_at;
-    ssh_key_t sender_public_key;
-    ssh_key_t recipient_public_key;
+    public_key_t sender_public_key;
+    public_key_t recipient_public_key;
     uint64_t amount;
     ssh_signature_t sender_signature;
 } transaction_t;
 
+/**
+ * @brief Signs transactions with one parsed private key.
+ * 
+ * Parsing a PEM private key costs more than a signature, so callers that sign
+ * many transactions with the same key should create a signer once and reuse
+ * it. A signer is not thread-safe; threads that sign concurrently need their
+ * own signers.
+ * 
+ * @param private_key The parsed private key.
+ * @param initialized_md_ctx A digest context initialized for signing with
+ * private_key. It is copied, never updated, so it stays ready for reuse.
+ * @param md_ctx The digest context that computes each signature.
+ */
+typedef struct transaction_signer_t {
+    EVP_PKEY *private_key;
+    EVP_MD_CTX *initialized_md_ctx;
+    EVP_MD_CTX *md_ctx;
+} transaction_signer_t;
+
 /**
  * @brief Fills transaction with a newly allocated transaction.
  * 
@@ -55,6 +86,28 @@ return_code_t transaction_create(
     ssh_key_t *sender_private_key
 );
 
+/**
+ * @brief Fills transaction with a newly allocated transaction signed by signer.
+ * 
+ * This is the same as transaction_create, but it does not parse the private
+ * key again.
+ * 
+ * @param transaction The pointer to fill with the new transaction.
+ * @param sender_public_key The sender's public key. Set to zero to represent
+ * coins generated during the mining process.
+ * @param recipient_public_key The recipient's public key.
+ * @param amount The amount transferred from sender to recipient.
+ * @param signer A signer holding the sender's private key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_create_with_signer(
+    transaction_t **transaction,
+    ssh_key_t *sender_public_key,
+    ssh_key_t *recipient_public_key,
+    uint64_t amount,
+    transaction_signer_t *signer
+);
+
 /**
  * @brief Frees all memory associated with the transaction.
  * 
@@ -63,6 +116,88 @@ return_code_t transaction_create(
  */
 return_code_t transaction_destroy(transaction_t *transaction);
 
+/**
+ * @brief Fills hash with the transaction's hash.
+ * 
+ * The hash covers every field in the transaction, including the signature.
+ * 
+ * @param transaction The transaction.
+ * @param hash A pointer to fill with the transaction's hash.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_hash(transaction_t *transaction, sha_256_t *hash);
+
+/**
+ * @brief Fills preimage with the bytes that the transaction's hash and
+ * signature cover.
+ * 
+ * The preimage is the transaction laid out as it was when keys were PEM
+ * strings: created_at, both keys as zero-padded ssh_key_t values, amount, the
+ * signature length, and the zero-padded signature, with integers in host byte
+ * order. The signature covers the first
+ * TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE bytes; the hash covers all of
+ * them.
+ * 
+ * @param transaction The transaction.
+ * @param preimage A buffer of at least TRANSACTION_PREIMAGE_SIZE bytes to fill.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_get_preimage(
+    transaction_t *transaction,
+    unsigned char *preimage
+);
+
+/**
+ * @brief Fills signer with a newly allocated signer for the private key.
+ * 
+ * @param signer The pointer to fill with the new signer.
+ * @param sender_private_key The sender's PEM-encoded RSA private key.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_create(
+    transaction_signer_t **signer,
+    ssh_key_t *sender_private_key
+);
+
+/**
+ * @brief Frees all memory associated with the signer.
+ * 
+ * @param signer The signer.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_destroy(transaction_signer_t *signer);
+
+/**
+ * @brief Fills signature with the signer's signature for the transaction.
+ * 
+ * @param signer The signer.
+ * @param signature The pointer to fill with the signature.
+ * @param transaction The transaction for which to generate a signature. The
+ * signature covers all fields except sender_signature.
+ * @return return_code_t A return code indicating success or failure.
+ */
+return_code_t transaction_signer_sign(
+    transaction_signer_t *signer,
+    ssh_signature_t *signature,
+    transaction_t *transaction
+);
+
+/**
+ * @brief Fills the sender_signature of each transaction.
+ * 
+ * @param signer The signer. Every transaction should name the signer's key as
+ * the sender.
+ * @param transactions The transactions to sign.
+ * @param num_transactions The number of transactions.
+ * @return return_code_t A return code indicating success or failure. On
+ * failure, the transactions before the failing one are signed.
+ */
+return_code_t transaction_signer_sign_batch(
+    transaction_signer_t *signer,
+    transaction_t **transactions,
+    size_t num_transactions
+);
+
 /**
  * @brief Fills signature with the sender's signature for the transaction.
  * 
@@ -0,0 +1,583 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/address_index.h"
+#include "include/endian.h"
+#include "include/linked_list.h"
+#include "include/transaction.h"
+
+#define ADDRESS_INDEX_FILE_HEADER_SIZE \
+    (ADDRESS_INDEX_FILE_MAGIC_SIZE + sizeof(sha_256_t) + 4 * sizeof(uint64_t))
+#define ADDRESS_INDEX_FILE_ENTRY_SIZE \
+    (sizeof(sha_256_t) + 2 * sizeof(uint64_t))
+#define ADDRESS_INDEX_FILE_POSTING_SIZE (4 * sizeof(uint64_t))
+
+return_code_t address_index_create(address_index_t **index) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    address_index_t *new_index = calloc(1, sizeof(address_index_t));
+    if (NULL == new_index) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_index->entries = calloc(
+        ADDRESS_INDEX_MIN_CAPACITY, sizeof(address_index_entry_t));
+    if (NULL == new_index->entries) {
+        free(new_index);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_index->capacity = ADDRESS_INDEX_MIN_CAPACITY;
+    *index = new_index;
+end:
+    return return_code;
+}
+
+return_code_t address_index_destroy(address_index_t *index) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    free(index->entries);
+    free(index->postings);
+    free(index);
+end:
+    return return_code;
+}
+
+return_code_t address_index_copy(
+    address_index_t **copy,
+    address_index_t *index
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == copy || NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    address_index_t *new_index = malloc(sizeof(address_index_t));
+    if (NULL == new_index) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    *new_index = *index;
+    // Only the postings in use are copied; the copy grows on its own.
+    new_index->entries = malloc(
+        index->capacity * sizeof(address_index_entry_t));
+    new_index->postings = malloc(
+        (index->num_postings + 1) * sizeof(address_index_posting_t));
+    if (NULL == new_index->entries || NULL == new_index->postings) {
+        free(new_index->entries);
+        free(new_index->postings);
+        free(new_index);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    memcpy(
+        new_index->entries,
+        index->entries,
+        index->capacity * sizeof(address_index_entry_t));
+    if (0 != index->num_postings) {
+        memcpy(
+            new_index->postings,
+            index->postings,
+            index->num_postings * sizeof(address_index_posting_t));
+    }
+    new_index->postings_capacity = index->num_postings + 1;
+    *copy = new_index;
+end:
+    return return_code;
+}
+
+address_index_entry_t *address_index_probe(
+    address_index_entry_t *entries,
+    size_t capacity,
+    sha_256_t *key_digest
+) {
+    uint64_t slot = 0;
+    memcpy(&slot, key_digest->digest, sizeof(slot));
+    size_t mask = capacity - 1;
+    for (size_t idx = slot & mask; ; idx = (idx + 1) & mask) {
+        if (!entries[idx].is_occupied ||
+            0 == memcmp(
+                &entries[idx].key_digest, key_digest, sizeof(sha_256_t))) {
+            return &entries[idx];
+        }
+    }
+}
+
+return_code_t address_index_reserve(
+    address_index_t *index,
+    uint64_t num_transactions
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Each transaction names at most two keys and adds at most two postings.
+    uint64_t new_postings_capacity = index->postings_capacity;
+    if (0 == new_postings_capacity) {
+        new_postings_capacity = ADDRESS_INDEX_MIN_CAPACITY;
+    }
+    while (index->num_postings + 2 * num_transactions >
+        new_postings_capacity) {
+        new_postings_capacity *= 2;
+    }
+    if (new_postings_capacity != index->postings_capacity) {
+        address_index_posting_t *new_postings = realloc(
+            index->postings,
+            new_postings_capacity * sizeof(address_index_posting_t));
+        if (NULL == new_postings) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        index->postings = new_postings;
+        index->postings_capacity = new_postings_capacity;
+    }
+    size_t new_capacity = index->capacity;
+    while (2 * (index->num_entries + 2 * num_transactions) > new_capacity) {
+        new_capacity *= 2;
+    }
+    if (new_capacity == index->capacity) {
+        goto end;
+    }
+    address_index_entry_t *new_entries = calloc(
+        new_capacity, sizeof(address_index_entry_t));
+    if (NULL == new_entries) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    for (size_t idx = 0; idx < index->capacity; idx++) {
+        if (index->entries[idx].is_occupied) {
+            *address_index_probe(
+                new_entries, new_capacity, &index->entries[idx].key_digest) =
+                index->entries[idx];
+        }
+    }
+    free(index->entries);
+    index->entries = new_entries;
+    index->capacity = new_capacity;
+end:
+    return return_code;
+}
+
+void address_index_hash_key(public_key_t *public_key, sha_256_t *key_digest) {
+    // Hashing cannot fail on a valid key.
+    hash_sha_256(public_key->bytes, public_key->length, key_digest);
+}
+
+uint64_t address_index_skip_rank(uint64_t rank) {
+    // Clearing the lowest set bit, or two of them for odd ranks, gives skips
+    // of every power of two without two neighbours skipping alike.
+    if (rank < 2) {
+        return 0;
+    }
+    if (0 != (rank & 1)) {
+        uint64_t lower = rank - 1;
+        lower &= lower - 1;
+        lower &= lower - 1;
+        return lower + 1;
+    }
+    return rank & (rank - 1);
+}
+
+uint64_t address_index_find_posting(
+    address_index_t *index,
+    uint64_t posting_idx,
+    uint64_t rank,
+    uint64_t target_rank
+) {
+    // Follows the skip whenever it does not overshoot the target, and is not
+    // beaten by the previous posting's skip.
+    while (rank > target_rank && ADDRESS_INDEX_NO_POSTING != posting_idx) {
+        address_index_posting_t *posting = &index->postings[posting_idx];
+        uint64_t skip_rank = address_index_skip_rank(rank);
+        uint64_t previous_skip_rank = address_index_skip_rank(rank - 1);
+        if (ADDRESS_INDEX_NO_POSTING != posting->skip_posting &&
+            (skip_rank == target_rank ||
+            (skip_rank > target_rank &&
+            !(previous_skip_rank + 2 < skip_rank &&
+            previous_skip_rank >= target_rank)))) {
+            posting_idx = posting->skip_posting;
+            rank = skip_rank;
+        } else {
+            posting_idx = posting->previous_posting;
+            rank--;
+        }
+    }
+    return posting_idx;
+}
+
+void address_index_add_posting(
+    address_index_t *index,
+    sha_256_t *key_digest,
+    uint64_t transaction_index
+) {
+    // The caller has reserved room for the key and the posting.
+    address_index_entry_t *entry = address_index_probe(
+        index->entries, index->capacity, key_digest);
+    if (!entry->is_occupied) {
+        entry->key_digest = *key_digest;
+        entry->last_posting = ADDRESS_INDEX_NO_POSTING;
+        entry->num_postings = 0;
+        entry->is_occupied = true;
+        index->num_entries++;
+    }
+    address_index_posting_t *posting = &index->postings[index->num_postings];
+    posting->height = index->num_blocks;
+    posting->transaction_index = transaction_index;
+    posting->previous_posting = entry->last_posting;
+    posting->skip_posting = ADDRESS_INDEX_NO_POSTING;
+    uint64_t rank = entry->num_postings;
+    if (0 != rank) {
+        posting->skip_posting = address_index_find_posting(
+            index,
+            entry->last_posting,
+            rank - 1,
+            address_index_skip_rank(rank));
+    }
+    entry->last_posting = index->num_postings;
+    entry->num_postings++;
+    index->num_postings++;
+}
+
+return_code_t address_index_apply_block(
+    address_index_t *index,
+    block_t *block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Each transaction names at most two keys, so reserving room for them up
+    // front means nothing below can fail.
+    uint64_t num_transactions = 0;
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        num_transactions++;
+    }
+    return_code = address_index_reserve(index, num_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t transaction_index = 0;
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        transaction_t *transaction = (transaction_t *)node->data;
+        sha_256_t sender_digest = {0};
+        address_index_hash_key(&transaction->sender_public_key, &sender_digest);
+        sha_256_t recipient_digest = {0};
+        address_index_hash_key(
+            &transaction->recipient_public_key, &recipient_digest);
+        address_index_add_posting(index, &sender_digest, transaction_index);
+        // A transaction to oneself, like minting, appears once.
+        if (0 != memcmp(&sender_digest, &recipient_digest, sizeof(sha_256_t))) {
+            address_index_add_posting(
+                index, &recipient_digest, transaction_index);
+        }
+        transaction_index++;
+    }
+    index->num_blocks++;
+end:
+    return return_code;
+}
+
+void address_index_remove_postings_at_height(
+    address_index_t *index,
+    public_key_t *public_key,
+    uint64_t height
+) {
+    sha_256_t key_digest = {0};
+    address_index_hash_key(public_key, &key_digest);
+    address_index_entry_t *entry = address_index_probe(
+        index->entries, index->capacity, &key_digest);
+    // The key's postings at the last height are its newest, so this stops as
+    // soon as it reaches an older one. A key named twice is done the first
+    // time.
+    while (entry->is_occupied &&
+        ADDRESS_INDEX_NO_POSTING != entry->last_posting &&
+        height == index->postings[entry->last_posting].height) {
+        entry->last_posting =
+            index->postings[entry->last_posting].previous_posting;
+        entry->num_postings--;
+    }
+}
+
+return_code_t address_index_revert_block(
+    address_index_t *index,
+    block_t *block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == block || 0 == index->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t height = index->num_blocks - 1;
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        transaction_t *transaction = (transaction_t *)node->data;
+        address_index_remove_postings_at_height(
+            index, &transaction->sender_public_key, height);
+        address_index_remove_postings_at_height(
+            index, &transaction->recipient_public_key, height);
+    }
+    while (0 != index->num_postings &&
+        height == index->postings[index->num_postings - 1].height) {
+        index->num_postings--;
+    }
+    index->num_blocks--;
+end:
+    return return_code;
+}
+
+return_code_t address_index_get_postings(
+    address_index_t *index,
+    public_key_t *public_key,
+    uint64_t offset,
+    uint64_t max_postings,
+    address_index_posting_t *postings,
+    uint64_t *num_postings,
+    uint64_t *total_num_postings
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index ||
+        NULL == public_key ||
+        (NULL == postings && 0 != max_postings) ||
+        NULL == num_postings) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    sha_256_t key_digest = {0};
+    return_code = hash_sha_256(
+        public_key->bytes, public_key->length, &key_digest);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    address_index_entry_t *entry = address_index_probe(
+        index->entries, index->capacity, &key_digest);
+    uint64_t posting_idx = ADDRESS_INDEX_NO_POSTING;
+    uint64_t key_num_postings = 0;
+    if (entry->is_occupied) {
+        posting_idx = entry->last_posting;
+        key_num_postings = entry->num_postings;
+    }
+    if (offset >= key_num_postings) {
+        posting_idx = ADDRESS_INDEX_NO_POSTING;
+    } else if (0 != offset) {
+        posting_idx = address_index_find_posting(
+            index,
+            posting_idx,
+            key_num_postings - 1,
+            key_num_postings - 1 - offset);
+    }
+    uint64_t num_written = 0;
+    while (num_written < max_postings &&
+        ADDRESS_INDEX_NO_POSTING != posting_idx) {
+        postings[num_written] = index->postings[posting_idx];
+        num_written++;
+        posting_idx = index->postings[posting_idx].previous_posting;
+    }
+    *num_postings = num_written;
+    if (NULL != total_num_postings) {
+        *total_num_postings = key_num_postings;
+    }
+end:
+    return return_code;
+}
+
+void address_index_write_uint64(unsigned char **next_spot, uint64_t value) {
+    uint64_t value_big_endian = htobe64(value);
+    memcpy(*next_spot, &value_big_endian, sizeof(value_big_endian));
+    *next_spot += sizeof(value_big_endian);
+}
+
+uint64_t address_index_read_uint64(unsigned char **next_spot) {
+    uint64_t value_big_endian = 0;
+    memcpy(&value_big_endian, *next_spot, sizeof(value_big_endian));
+    *next_spot += sizeof(value_big_endian);
+    return betoh64(value_big_endian);
+}
+
+return_code_t address_index_write_to_file(
+    address_index_t *index,
+    sha_256_t *tip_hash,
+    char *outfile
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == tip_hash || NULL == outfile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Build the whole file in memory so that it takes a single write.
+    size_t buffer_size =
+        ADDRESS_INDEX_FILE_HEADER_SIZE +
+        index->num_entries * ADDRESS_INDEX_FILE_ENTRY_SIZE +
+        index->num_postings * ADDRESS_INDEX_FILE_POSTING_SIZE;
+    unsigned char *buffer = malloc(buffer_size);
+    if (NULL == buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    unsigned char *next_spot = buffer;
+    memcpy(next_spot, ADDRESS_INDEX_FILE_MAGIC, ADDRESS_INDEX_FILE_MAGIC_SIZE);
+    next_spot += ADDRESS_INDEX_FILE_MAGIC_SIZE;
+    address_index_write_uint64(&next_spot, index->num_blocks);
+    memcpy(next_spot, tip_hash, sizeof(sha_256_t));
+    next_spot += sizeof(sha_256_t);
+    address_index_write_uint64(&next_spot, index->capacity);
+    address_index_write_uint64(&next_spot, index->num_entries);
+    address_index_write_uint64(&next_spot, index->num_postings);
+    for (size_t idx = 0; idx < index->capacity; idx++) {
+        address_index_entry_t *entry = &index->entries[idx];
+        if (!entry->is_occupied) {
+            continue;
+        }
+        memcpy(next_spot, &entry->key_digest, sizeof(sha_256_t));
+        next_spot += sizeof(sha_256_t);
+        address_index_write_uint64(&next_spot, entry->last_posting);
+        address_index_write_uint64(&next_spot, entry->num_postings);
+    }
+    for (uint64_t idx = 0; idx < index->num_postings; idx++) {
+        address_index_posting_t *posting = &index->postings[idx];
+        address_index_write_uint64(&next_spot, posting->height);
+        address_index_write_uint64(&next_spot, posting->transaction_index);
+        address_index_write_uint64(&next_spot, posting->previous_posting);
+        address_index_write_uint64(&next_spot, posting->skip_posting);
+    }
+    FILE *f = fopen(outfile, "wb");
+    if (NULL == f) {
+        free(buffer);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    size_t bytes_written = fwrite(buffer, 1, buffer_size, f);
+    fclose(f);
+    free(buffer);
+    if (bytes_written != buffer_size) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t address_index_read_from_file(
+    address_index_t **index,
+    sha_256_t *tip_hash,
+    char *infile
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == tip_hash || NULL == infile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    FILE *f = fopen(infile, "rb");
+    if (NULL == f) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    fseek(f, 0, SEEK_END);
+    uint64_t buffer_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *buffer = malloc(buffer_size + 1);
+    address_index_t *new_index = calloc(1, sizeof(address_index_t));
+    if (NULL == buffer || NULL == new_index) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto cleanup;
+    }
+    size_t read_size = fread(buffer, 1, buffer_size, f);
+    if (read_size != (size_t)buffer_size) {
+        return_code = FAILURE_FILE_IO;
+        goto cleanup;
+    }
+    // Check every count against the file's size before trusting it.
+    return_code = FAILURE_INVALID_INPUT;
+    if (buffer_size < ADDRESS_INDEX_FILE_HEADER_SIZE ||
+        0 != memcmp(
+            buffer, ADDRESS_INDEX_FILE_MAGIC, ADDRESS_INDEX_FILE_MAGIC_SIZE)) {
+        goto cleanup;
+    }
+    unsigned char *next_spot = buffer + ADDRESS_INDEX_FILE_MAGIC_SIZE;
+    new_index->num_blocks = address_index_read_uint64(&next_spot);
+    memcpy(tip_hash, next_spot, sizeof(sha_256_t));
+    next_spot += sizeof(sha_256_t);
+    uint64_t capacity = address_index_read_uint64(&next_spot);
+    uint64_t num_entries = address_index_read_uint64(&next_spot);
+    uint64_t num_postings = address_index_read_uint64(&next_spot);
+    uint64_t body_size = buffer_size - ADDRESS_INDEX_FILE_HEADER_SIZE;
+    if (capacity < ADDRESS_INDEX_MIN_CAPACITY ||
+        0 != (capacity & (capacity - 1)) ||
+        num_entries > capacity / 2 ||
+        num_postings > body_size / ADDRESS_INDEX_FILE_POSTING_SIZE ||
+        body_size !=
+            num_entries * ADDRESS_INDEX_FILE_ENTRY_SIZE +
+            num_postings * ADDRESS_INDEX_FILE_POSTING_SIZE) {
+        goto cleanup;
+    }
+    new_index->entries = calloc(capacity, sizeof(address_index_entry_t));
+    new_index->postings = malloc(
+        (num_postings + 1) * sizeof(address_index_posting_t));
+    if (NULL == new_index->entries || NULL == new_index->postings) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto cleanup;
+    }
+    new_index->capacity = capacity;
+    new_index->postings_capacity = num_postings + 1;
+    for (uint64_t idx = 0; idx < num_entries; idx++) {
+        sha_256_t key_digest = {0};
+        memcpy(&key_digest, next_spot, sizeof(sha_256_t));
+        next_spot += sizeof(sha_256_t);
+        address_index_entry_t *entry = address_index_probe(
+            new_index->entries, capacity, &key_digest);
+        if (entry->is_occupied) {
+            goto cleanup;
+        }
+        entry->key_digest = key_digest;
+        entry->last_posting = address_index_read_uint64(&next_spot);
+        entry->num_postings = address_index_read_uint64(&next_spot);
+        entry->is_occupied = true;
+        if (entry->num_postings > num_postings ||
+            (ADDRESS_INDEX_NO_POSTING != entry->last_posting &&
+            entry->last_posting >= num_postings)) {
+            goto cleanup;
+        }
+        new_index->num_entries++;
+    }
+    // Postings only link back to earlier ones, so following the links always
+    // ends.
+    for (uint64_t idx = 0; idx < num_postings; idx++) {
+        address_index_posting_t *posting = &new_index->postings[idx];
+        posting->height = address_index_read_uint64(&next_spot);
+        posting->transaction_index = address_index_read_uint64(&next_spot);
+        posting->previous_posting = address_index_read_uint64(&next_spot);
+        posting->skip_posting = address_index_read_uint64(&next_spot);
+        if ((ADDRESS_INDEX_NO_POSTING != posting->previous_posting &&
+            posting->previous_posting >= idx) ||
+            (ADDRESS_INDEX_NO_POSTING != posting->skip_posting &&
+            posting->skip_posting >= idx)) {
+            goto cleanup;
+        }
+        new_index->num_postings++;
+    }
+    *index = new_index;
+    new_index = NULL;
+    return_code = SUCCESS;
+cleanup:
+    fclose(f);
+    free(buffer);
+    if (NULL != new_index) {
+        free(new_index->entries);
+        free(new_index->postings);
+        free(new_index);
+    }
+end:
+    return return_code;
+}
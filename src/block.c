@@ -1,10 +1,14 @@
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
-#include <openssl/evp.h>
 #include "include/block.h"
+#include "include/endian.h"
+#include "include/hash.h"
 #include "include/linked_list.h"
 #include "include/transaction.h"
 
+#define MERKLE_TREE_INTERIOR_NODE_PREFIX 0x01
+
 return_code_t block_create(
     block_t **block,
     linked_list_t *transaction_list,
@@ -26,6 +30,14 @@ return_code_t block_create(
     new_block->transaction_list = transaction_list;
     new_block->proof_of_work = proof_of_work;
     new_block->previous_block_hash = previous_block_hash;
+    new_block->is_sealed = false;
+    atomic_init(&new_block->reference_count, 1);
+    new_block->arena = NULL;
+    return_code = block_compute_merkle_root(new_block, &new_block->merkle_root);
+    if (SUCCESS != return_code) {
+        free(new_block);
+        goto end;
+    }
     *block = new_block;
 end:
     return return_code;
@@ -55,6 +67,52 @@ end:
     return return_code;
 }
 
+return_code_t block_copy(block_t **copy, block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == copy || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list,
+        (free_function_t *)transaction_destroy,
+        NULL);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        transaction_t *transaction = malloc(sizeof(transaction_t));
+        if (NULL == transaction) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            linked_list_destroy(transaction_list);
+            goto end;
+        }
+        *transaction = *(transaction_t *)node->data;
+        return_code = linked_list_append(transaction_list, transaction);
+        if (SUCCESS != return_code) {
+            free(transaction);
+            linked_list_destroy(transaction_list);
+            goto end;
+        }
+    }
+    block_t *new_block = malloc(sizeof(block_t));
+    if (NULL == new_block) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        linked_list_destroy(transaction_list);
+        goto end;
+    }
+    *new_block = *block;
+    new_block->transaction_list = transaction_list;
+    atomic_init(&new_block->reference_count, 1);
+    new_block->arena = NULL;
+    *copy = new_block;
+end:
+    return return_code;
+}
+
 return_code_t block_destroy(block_t *block) {
     return_code_t return_code = SUCCESS;
     if (NULL == block) {
@@ -67,34 +125,182 @@ end:
     return return_code;
 }
 
-return_code_t block_hash(block_t *block, sha_256_t *hash) {
+return_code_t block_retain(block_t *block) {
     return_code_t return_code = SUCCESS;
-    if (NULL == block || NULL == hash) {
+    if (NULL == block) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    const EVP_MD *md = EVP_sha256();
-    EVP_MD_CTX *mdctx = EVP_MD_CTX_new();
-    EVP_DigestInit_ex(mdctx, md, NULL);
-    EVP_DigestUpdate(
-        mdctx, (void *)&block->created_at, sizeof(block->created_at));
-    EVP_DigestUpdate(
-        mdctx, (void *)&block->proof_of_work, sizeof(block->proof_of_work));
-    EVP_DigestUpdate(
-        mdctx,
-        (void *)&block->previous_block_hash,
-        sizeof(block->previous_block_hash));
+    atomic_fetch_add(&block->reference_count, 1);
+end:
+    return return_code;
+}
+
+return_code_t block_release(block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (1 != atomic_fetch_sub(&block->reference_count, 1)) {
+        goto end;
+    }
+    block_arena_t *arena = block->arena;
+    if (NULL == arena) {
+        return_code = block_destroy(block);
+        goto end;
+    }
+    // The arena owns the block's transactions, so there is nothing to free
+    // until the last block in the arena goes.
+    if (1 == atomic_fetch_sub(&arena->reference_count, 1)) {
+        free(arena);
+    }
+end:
+    return return_code;
+}
+
+return_code_t block_compute_merkle_root(
+    block_t *block,
+    sha_256_t *merkle_root
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == merkle_root) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (merkle_root == &block->merkle_root) {
+        block->is_sealed = false;
+    }
+    uint64_t num_transactions = 0;
+    return_code = linked_list_length(
+        block->transaction_list, &num_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 == num_transactions) {
+        memset(merkle_root, 0, sizeof(sha_256_t));
+        goto end;
+    }
+    sha_256_t *level = malloc(num_transactions * sizeof(sha_256_t));
+    if (NULL == level) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    size_t level_size = 0;
     for (node_t *node = block->transaction_list->head;
         NULL != node;
         node = node->next) {
-        transaction_t *transaction = (transaction_t *)node->data;
-        // We can just hash the entire transaction directly because it contains
-        // no pointers. Memory locations don't have meaning, so we can't hash
-        // pointers.
-        EVP_DigestUpdate(mdctx, (void *)transaction, sizeof(*transaction));
-    }
-    EVP_DigestFinal_ex(mdctx, hash->digest, NULL);
-    EVP_MD_CTX_free(mdctx);
+        return_code = transaction_hash(
+            (transaction_t *)node->data, &level[level_size]);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        level_size++;
+    }
+    // Reduce each level in place until only the root remains.
+    unsigned char interior_node[1 + 2 * sizeof(sha_256_t)];
+    interior_node[0] = MERKLE_TREE_INTERIOR_NODE_PREFIX;
+    while (level_size > 1) {
+        size_t next_level_size = 0;
+        for (size_t idx = 0; idx < level_size; idx += 2) {
+            if (idx + 1 == level_size) {
+                level[next_level_size] = level[idx];
+            } else {
+                memcpy(interior_node + 1, &level[idx], sizeof(sha_256_t));
+                memcpy(
+                    interior_node + 1 + sizeof(sha_256_t),
+                    &level[idx + 1],
+                    sizeof(sha_256_t));
+                return_code = hash_sha_256(
+                    interior_node,
+                    sizeof(interior_node),
+                    &level[next_level_size]);
+                if (SUCCESS != return_code) {
+                    goto cleanup;
+                }
+            }
+            next_level_size++;
+        }
+        level_size = next_level_size;
+    }
+    *merkle_root = level[0];
+cleanup:
+    free(level);
+end:
+    return return_code;
+}
+
+return_code_t block_serialize_header(block_t *block, unsigned char *header) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == header) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *next_spot_in_header = header;
+    uint64_t created_at = htobe64(block->created_at);
+    memcpy(next_spot_in_header, &created_at, sizeof(created_at));
+    next_spot_in_header += sizeof(created_at);
+    memcpy(
+        next_spot_in_header,
+        &block->previous_block_hash,
+        sizeof(block->previous_block_hash));
+    next_spot_in_header += sizeof(block->previous_block_hash);
+    memcpy(
+        next_spot_in_header,
+        &block->merkle_root,
+        sizeof(block->merkle_root));
+    next_spot_in_header += sizeof(block->merkle_root);
+    uint64_t proof_of_work = htobe64(block->proof_of_work);
+    memcpy(next_spot_in_header, &proof_of_work, sizeof(proof_of_work));
+end:
+    return return_code;
+}
+
+return_code_t block_hash(block_t *block, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (block->is_sealed) {
+        *hash = block->hash;
+        goto end;
+    }
+    unsigned char header[BLOCK_HEADER_SIZE];
+    return_code = block_serialize_header(block, header);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = hash_sha_256(header, sizeof(header), hash);
+end:
+    return return_code;
+}
+
+return_code_t block_seal(block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (block->is_sealed) {
+        goto end;
+    }
+    return_code = block_hash(block, &block->hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    block->is_sealed = true;
+end:
+    return return_code;
+}
+
+return_code_t block_unseal(block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block->is_sealed = false;
 end:
     return return_code;
 }
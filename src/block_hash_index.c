@@ -0,0 +1,212 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/block_hash_index.h"
+
+return_code_t block_hash_index_create(
+    block_hash_index_t **index,
+    size_t expected_num_blocks
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t capacity = BLOCK_HASH_INDEX_MIN_CAPACITY;
+    while (capacity < 2 * expected_num_blocks) {
+        capacity *= 2;
+    }
+    block_hash_index_t *new_index = calloc(1, sizeof(block_hash_index_t));
+    if (NULL == new_index) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_index->entries = calloc(capacity, sizeof(block_hash_index_entry_t));
+    if (NULL == new_index->entries) {
+        free(new_index);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_index->capacity = capacity;
+    *index = new_index;
+end:
+    return return_code;
+}
+
+return_code_t block_hash_index_copy(
+    block_hash_index_t **copy,
+    block_hash_index_t *index
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == copy || NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block_hash_index_t *new_index = calloc(1, sizeof(block_hash_index_t));
+    if (NULL == new_index) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_index->entries = malloc(
+        index->capacity * sizeof(block_hash_index_entry_t));
+    if (NULL == new_index->entries) {
+        free(new_index);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    memcpy(
+        new_index->entries,
+        index->entries,
+        index->capacity * sizeof(block_hash_index_entry_t));
+    new_index->capacity = index->capacity;
+    new_index->num_entries = index->num_entries;
+    *copy = new_index;
+end:
+    return return_code;
+}
+
+return_code_t block_hash_index_destroy(block_hash_index_t *index) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    free(index->entries);
+    free(index);
+end:
+    return return_code;
+}
+
+uint64_t block_hash_index_slot(sha_256_t *hash) {
+    uint64_t slot = 0;
+    memcpy(
+        &slot,
+        hash->digest + sizeof(hash->digest) - sizeof(slot),
+        sizeof(slot));
+    return slot;
+}
+
+block_hash_index_entry_t *block_hash_index_probe(
+    block_hash_index_entry_t *entries,
+    size_t capacity,
+    sha_256_t *hash
+) {
+    size_t mask = capacity - 1;
+    for (size_t idx = block_hash_index_slot(hash) & mask;
+        ;
+        idx = (idx + 1) & mask) {
+        if (NULL == entries[idx].block ||
+            0 == memcmp(&entries[idx].hash, hash, sizeof(sha_256_t))) {
+            return &entries[idx];
+        }
+    }
+}
+
+return_code_t block_hash_index_grow(block_hash_index_t *index) {
+    return_code_t return_code = SUCCESS;
+    size_t new_capacity = index->capacity * 2;
+    block_hash_index_entry_t *new_entries = calloc(
+        new_capacity, sizeof(block_hash_index_entry_t));
+    if (NULL == new_entries) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    for (size_t idx = 0; idx < index->capacity; idx++) {
+        if (NULL != index->entries[idx].block) {
+            *block_hash_index_probe(
+                new_entries, new_capacity, &index->entries[idx].hash) =
+                index->entries[idx];
+        }
+    }
+    free(index->entries);
+    index->entries = new_entries;
+    index->capacity = new_capacity;
+end:
+    return return_code;
+}
+
+return_code_t block_hash_index_insert(
+    block_hash_index_t *index,
+    sha_256_t *hash,
+    block_t *block,
+    uint64_t height
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == hash || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (2 * (index->num_entries + 1) > index->capacity) {
+        return_code = block_hash_index_grow(index);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    block_hash_index_entry_t *entry = block_hash_index_probe(
+        index->entries, index->capacity, hash);
+    if (NULL == entry->block) {
+        index->num_entries++;
+    }
+    entry->hash = *hash;
+    entry->block = block;
+    entry->height = height;
+    entry->is_side_block = false;
+    entry->side_block_position = 0;
+end:
+    return return_code;
+}
+
+return_code_t block_hash_index_find(
+    block_hash_index_t *index,
+    sha_256_t *hash,
+    block_hash_index_entry_t **entry
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == hash || NULL == entry) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block_hash_index_entry_t *found_entry = block_hash_index_probe(
+        index->entries, index->capacity, hash);
+    if (NULL == found_entry->block) {
+        return_code = FAILURE_BLOCK_NOT_FOUND;
+        goto end;
+    }
+    *entry = found_entry;
+end:
+    return return_code;
+}
+
+return_code_t block_hash_index_remove(
+    block_hash_index_t *index,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == index || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block_hash_index_entry_t *entry = block_hash_index_probe(
+        index->entries, index->capacity, hash);
+    if (NULL == entry->block) {
+        return_code = FAILURE_BLOCK_NOT_FOUND;
+        goto end;
+    }
+    size_t mask = index->capacity - 1;
+    size_t hole = (size_t)(entry - index->entries);
+    for (size_t idx = (hole + 1) & mask;
+        NULL != index->entries[idx].block;
+        idx = (idx + 1) & mask) {
+        // An entry may fill the hole only if its probe sequence passes
+        // through the hole, that is, if its home slot is not between the hole
+        // and the entry.
+        size_t home = block_hash_index_slot(&index->entries[idx].hash) & mask;
+        if (((idx - home) & mask) >= ((idx - hole) & mask)) {
+            index->entries[hole] = index->entries[idx];
+            hole = idx;
+        }
+    }
+    memset(&index->entries[hole], 0, sizeof(block_hash_index_entry_t));
+    index->num_entries--;
+end:
+    return return_code;
+}
@@ -1,18 +1,38 @@
+#include <errno.h>
+#include <fcntl.h>
 #include <stdatomic.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "include/address_index.h"
 #include "include/block.h"
+#include "include/block_hash_index.h"
 #include "include/blockchain.h"
 #include "include/endian.h"
 #include "include/hash.h"
+#include "include/ledger.h"
 #include "include/linked_list.h"
+#include "include/mining_hash.h"
 #include "include/return_codes.h"
 #include "include/transaction.h"
 
 #define ANSI_COLOR_GREEN "\x1b[32m"
 #define ANSI_COLOR_LIGHT_BLUE "\x1b[94m"
 #define ANSI_COLOR_RESET "\x1b[0m"
+#define ANSI_ERASE_LINE "\x1b[2K"
+#define MINING_PROGRESS_REPORT_INTERVAL_NANOSECONDS 250000000
+#define BLOCKCHAIN_VERIFY_CHUNKS_PER_THREAD 4
+#define BLOCKCHAIN_VERIFY_MAX_CHUNK_SIZE 64
+#define BLOCKCHAIN_MIN_CAPACITY 16
+// Rounds the arena header up so that whatever follows it is aligned.
+#define BLOCKCHAIN_ARENA_HEADER_SIZE \
+    ((sizeof(block_arena_t) + _Alignof(max_align_t) - 1) / \
+        _Alignof(max_align_t) * _Alignof(max_align_t))
 
 return_code_t blockchain_create(
     blockchain_t **blockchain,
@@ -23,21 +43,29 @@ return_code_t blockchain_create(
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    blockchain_t *new_blockchain = malloc(sizeof(blockchain_t));
+    blockchain_t *new_blockchain = calloc(1, sizeof(blockchain_t));
     if (NULL == new_blockchain) {
         return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
-    linked_list_t *block_list = NULL;
-    return_code = linked_list_create(
-        &block_list,
-        (free_function_t *)block_destroy,
-        NULL);
+    return_code = block_hash_index_create(&new_blockchain->hash_index, 0);
+    if (SUCCESS != return_code) {
+        free(new_blockchain);
+        goto end;
+    }
+    return_code = ledger_create(&new_blockchain->ledger, 0);
+    if (SUCCESS != return_code) {
+        block_hash_index_destroy(new_blockchain->hash_index);
+        free(new_blockchain);
+        goto end;
+    }
+    return_code = address_index_create(&new_blockchain->address_index);
     if (SUCCESS != return_code) {
+        ledger_destroy(new_blockchain->ledger);
+        block_hash_index_destroy(new_blockchain->hash_index);
         free(new_blockchain);
         goto end;
     }
-    new_blockchain->block_list = block_list;
     new_blockchain->num_leading_zero_bytes_required_in_block_hash =
         num_leading_zero_bytes_required_in_block_hash;
     *blockchain = new_blockchain;
@@ -51,12 +79,58 @@ return_code_t blockchain_destroy(blockchain_t *blockchain) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    return_code = linked_list_destroy(blockchain->block_list);
+    // Blocks that other blockchains still hold outlive this one.
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        return_code_t block_return_code = block_release(
+            blockchain->blocks[height]);
+        if (SUCCESS != block_return_code) {
+            return_code = block_return_code;
+        }
+    }
+    for (uint64_t idx = 0; idx < blockchain->num_side_blocks; idx++) {
+        return_code_t block_return_code = block_release(
+            blockchain->side_blocks[idx]);
+        if (SUCCESS != block_return_code) {
+            return_code = block_return_code;
+        }
+    }
+    block_hash_index_destroy(blockchain->hash_index);
+    if (NULL != blockchain->ledger) {
+        ledger_destroy(blockchain->ledger);
+    }
+    if (NULL != blockchain->address_index) {
+        address_index_destroy(blockchain->address_index);
+    }
+    free(blockchain->blocks);
+    free(blockchain->side_blocks);
     free(blockchain);
 end:
     return return_code;
 }
 
+return_code_t synchronized_blockchain_create_snapshot(
+    blockchain_t **snapshot,
+    blockchain_t *blockchain
+) {
+    return_code_t return_code = SUCCESS;
+    blockchain_t *new_snapshot = calloc(1, sizeof(blockchain_t));
+    if (NULL == new_snapshot) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_snapshot->blocks = blockchain->blocks;
+    new_snapshot->num_blocks = blockchain->num_blocks;
+    new_snapshot->num_leading_zero_bytes_required_in_block_hash =
+        blockchain->num_leading_zero_bytes_required_in_block_hash;
+    *snapshot = new_snapshot;
+end:
+    return return_code;
+}
+
+void synchronized_blockchain_free_retired_blockchain(void *blockchain) {
+    blockchain_destroy((blockchain_t *)blockchain);
+}
+
 return_code_t synchronized_blockchain_create(
     synchronized_blockchain_t **sync,
     blockchain_t *initial_blockchain
@@ -68,20 +142,73 @@ return_code_t synchronized_blockchain_create(
     }
     synchronized_blockchain_t *new_sync = malloc(sizeof(
         synchronized_blockchain_t));
+    if (NULL == new_sync) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto done;
+    }
+    blockchain_t *snapshot = NULL;
+    return_code = synchronized_blockchain_create_snapshot(
+        &snapshot, initial_blockchain);
+    if (SUCCESS != return_code) {
+        free(new_sync);
+        goto done;
+    }
     new_sync->blockchain = initial_blockchain;
+    atomic_init(&new_sync->snapshot, snapshot);
+    new_sync->stale_blocks = NULL;
     atomic_init(&new_sync->version, 0);
+    memset(
+        &new_sync->verified_prefix, 0, sizeof(blockchain_verified_prefix_t));
     pthread_mutex_init(&new_sync->mutex, NULL);
+    atomic_init(&new_sync->epoch, 1);
+    for (size_t reader = 0;
+        reader < SYNCHRONIZED_BLOCKCHAIN_MAX_READERS;
+        reader++) {
+        atomic_init(&new_sync->reader_epochs[reader], 0);
+    }
+    new_sync->retired = NULL;
+    new_sync->num_retired = 0;
+    new_sync->retired_capacity = 0;
     *sync = new_sync;
 done:
     return return_code;
 }
 
+void synchronized_blockchain_set_verified_prefix(
+    synchronized_blockchain_t *sync,
+    blockchain_verified_prefix_t *verified_prefix
+) {
+    // The stored prefix holds a reference to its tip block, so no other
+    // block can be allocated at that address while the prefix trusts it.
+    block_t *old_tip_block = sync->verified_prefix.tip_block;
+    if (NULL == verified_prefix) {
+        memset(
+            &sync->verified_prefix, 0, sizeof(blockchain_verified_prefix_t));
+    } else {
+        sync->verified_prefix = *verified_prefix;
+        if (NULL != sync->verified_prefix.tip_block) {
+            block_retain(sync->verified_prefix.tip_block);
+        }
+    }
+    if (NULL != old_tip_block) {
+        block_release(old_tip_block);
+    }
+}
+
 return_code_t synchronized_blockchain_destroy(synchronized_blockchain_t *sync) {
     return_code_t return_code = SUCCESS;
     if (NULL == sync) {
         return_code = FAILURE_INVALID_INPUT;
         goto done;
     }
+    // There are no readers left, so nothing holds the retired memory.
+    for (size_t idx = 0; idx < sync->num_retired; idx++) {
+        sync->retired[idx].free_data(sync->retired[idx].data);
+    }
+    free(sync->retired);
+    free(atomic_load(&sync->snapshot));
+    free(sync->stale_blocks);
+    synchronized_blockchain_set_verified_prefix(sync, NULL);
     return_code = blockchain_destroy(sync->blockchain);
     if (SUCCESS != return_code) {
         goto done;
@@ -92,774 +219,4511 @@ done:
     return return_code;
 }
 
-return_code_t blockchain_add_block(blockchain_t *blockchain, block_t *block) {
-    return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == block) {
-        return_code = FAILURE_INVALID_INPUT;
-        goto end;
-    }
-    return_code = linked_list_append(blockchain->block_list, block);
-end:
-    return return_code;
-}
-
-return_code_t blockchain_is_valid_block_hash(
-    blockchain_t *blockchain,
-    sha_256_t block_hash,
-    bool *is_valid_block_hash
+return_code_t synchronized_blockchain_read_begin(
+    synchronized_blockchain_t *sync,
+    blockchain_t **blockchain,
+    size_t *reader
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == is_valid_block_hash) {
+    if (NULL == sync || NULL == blockchain || NULL == reader) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    bool is_valid = true;
-    for (size_t idx = 0;
-        idx < blockchain->num_leading_zero_bytes_required_in_block_hash;
-        idx++) {
-        if (block_hash.digest[idx] != 0) {
-            is_valid = false;
+    // Announce the epoch before loading the pointer. A writer that misses
+    // the announcement published before the load, so the load sees its
+    // blockchain rather than the one it retired.
+    size_t epoch = atomic_load(&sync->epoch);
+    for (size_t slot = 0; ; slot = (slot + 1) %
+        SYNCHRONIZED_BLOCKCHAIN_MAX_READERS) {
+        size_t free_slot_epoch = 0;
+        if (atomic_compare_exchange_weak(
+            &sync->reader_epochs[slot], &free_slot_epoch, epoch)) {
+            *reader = slot;
             break;
         }
     }
-    *is_valid_block_hash = is_valid;
+    *blockchain = atomic_load(&sync->snapshot);
 end:
     return return_code;
 }
 
-return_code_t blockchain_mine_block(
-    blockchain_t *blockchain,
-    block_t *block,
-    bool print_progress,
-    atomic_bool *should_stop
+return_code_t synchronized_blockchain_read_end(
+    synchronized_blockchain_t *sync,
+    size_t reader
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == block || NULL == should_stop) {
+    if (NULL == sync || reader >= SYNCHRONIZED_BLOCKCHAIN_MAX_READERS) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    size_t best_leading_zeroes = 0;
-    size_t print_frequency = 20000;
-    sha_256_t hash = {0};
-    bool is_valid_block_hash = false;
-    for (uint64_t new_proof = 0; new_proof < UINT64_MAX; new_proof++) {
-        if (*should_stop) {
-            return_code = FAILURE_STOPPED_EARLY;
-            goto end;
-        }
-        block->proof_of_work = new_proof;
-        return_code = block_hash(block, &hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (print_progress) {
-            size_t num_zeroes = 0;
-            for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                unsigned char upper_nybble = hash.digest[idx] >> 4;
-                if (upper_nybble != 0) {
-                    break;
-                }
-                num_zeroes++;
-                if (hash.digest[idx] != 0) {
-                    break;
-                }
-                num_zeroes++;
-            }
-            bool print_this_iteration = new_proof % print_frequency == 0;
-            if (num_zeroes > best_leading_zeroes) {
-                best_leading_zeroes = num_zeroes;
-                print_this_iteration = true;
-            }
-            if (print_this_iteration) {
-                // Remove the previous block hash from output.
-                printf("\rMining LeoCoin block: ");
-                // Print the best number of leading zeroes.
-                for (size_t idx = 0; idx < best_leading_zeroes; idx++) {
-                    printf("0");
-                }
-                // Add the part of the new hash following the best number of
-                // leading zeroes. It's not the accurate hash, but it does give
-                // an idea of progress.
-                for (size_t idx = best_leading_zeroes;
-                    idx < 2 * sizeof(hash.digest);
-                    idx++) {
-                    size_t hash_idx = idx / 2;
-                    unsigned char nybble = 0;
-                    if (idx % 2 == 0) {
-                        nybble = hash.digest[hash_idx] >> 4;
-                    } else {
-                        nybble = hash.digest[hash_idx] & 0x0f;
-                    }
-                    // To give a better sense of progress, don't allow a
-                    // non-leading zero to follow the best number of leading
-                    // zeroes.
-                    if (idx == best_leading_zeroes && 0 == nybble) {
-                        nybble += 1;
-                    }
-                    printf("%01x", nybble);
-                }
-                fflush(stdout);
-            }
-        }
-        return_code = blockchain_is_valid_block_hash(
-            blockchain, hash, &is_valid_block_hash);
-        if (SUCCESS != return_code) {
-            goto end;
+    atomic_store(&sync->reader_epochs[reader], 0);
+end:
+    return return_code;
+}
+
+void synchronized_blockchain_reclaim(synchronized_blockchain_t *sync) {
+    size_t oldest_reader_epoch = SIZE_MAX;
+    for (size_t reader = 0;
+        reader < SYNCHRONIZED_BLOCKCHAIN_MAX_READERS;
+        reader++) {
+        size_t epoch = atomic_load(&sync->reader_epochs[reader]);
+        if (0 != epoch && epoch < oldest_reader_epoch) {
+            oldest_reader_epoch = epoch;
         }
-        if (is_valid_block_hash) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_GREEN);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            goto end;
+    }
+    size_t idx = 0;
+    while (idx < sync->num_retired) {
+        if (sync->retired[idx].epoch < oldest_reader_epoch) {
+            sync->retired[idx].free_data(sync->retired[idx].data);
+            sync->num_retired--;
+            sync->retired[idx] = sync->retired[sync->num_retired];
+        } else {
+            idx++;
         }
     }
-    return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
-end:
-    return return_code;
 }
 
-return_code_t synchronized_blockchain_mine_block(
+return_code_t synchronized_blockchain_reserve_retired(
     synchronized_blockchain_t *sync,
-    block_t *block,
-    bool print_progress,
-    atomic_bool *should_stop,
-    atomic_size_t *sync_version_currently_mined
+    size_t num_entries
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == sync ||
-        NULL == block ||
-        NULL == should_stop ||
-        NULL == sync_version_currently_mined) {
-        return_code = FAILURE_INVALID_INPUT;
-        goto end;
+    size_t new_capacity = sync->retired_capacity;
+    if (0 == new_capacity) {
+        new_capacity = 4;
     }
-    if (0 != pthread_mutex_lock(&sync->mutex)) {
-        return_code = FAILURE_PTHREAD_FUNCTION;
-        goto end;
+    while (new_capacity < sync->num_retired + num_entries) {
+        new_capacity *= 2;
     }
-    blockchain_t *blockchain = sync->blockchain;
-    if (0 != pthread_mutex_unlock(&sync->mutex)) {
-        return_code = FAILURE_PTHREAD_FUNCTION;
+    if (new_capacity == sync->retired_capacity) {
         goto end;
     }
-    size_t best_leading_zeroes = 0;
-    size_t print_frequency = 20000;
-    sha_256_t hash = {0};
-    bool is_valid_block_hash = false;
-    for (uint64_t new_proof = 0; new_proof < UINT64_MAX; new_proof++) {
-        if (*should_stop) {
-            return_code = FAILURE_STOPPED_EARLY;
-            goto end;
-        }
-        if (atomic_load(sync_version_currently_mined) !=
-            atomic_load(&sync->version)) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_LIGHT_BLUE);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            return_code = FAILURE_LONGER_BLOCKCHAIN_DETECTED;
-            goto end;
-        }
-        block->proof_of_work = new_proof;
-        return_code = block_hash(block, &hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (print_progress) {
-            size_t num_zeroes = 0;
-            for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                unsigned char upper_nybble = hash.digest[idx] >> 4;
-                if (upper_nybble != 0) {
-                    break;
-                }
-                num_zeroes++;
-                if (hash.digest[idx] != 0) {
-                    break;
-                }
-                num_zeroes++;
-            }
-            bool print_this_iteration = new_proof % print_frequency == 0;
-            if (num_zeroes > best_leading_zeroes) {
-                best_leading_zeroes = num_zeroes;
-                print_this_iteration = true;
-            }
-            if (print_this_iteration) {
-                // Remove the previous block hash from output.
-                printf("\rMining LeoCoin block: ");
-                // Print the best number of leading zeroes.
-                for (size_t idx = 0; idx < best_leading_zeroes; idx++) {
-                    printf("0");
-                }
-                // Add the part of the new hash following the best number of
-                // leading zeroes. It's not the accurate hash, but it does give
-                // an idea of progress.
-                for (size_t idx = best_leading_zeroes;
-                    idx < 2 * sizeof(hash.digest);
-                    idx++) {
-                    size_t hash_idx = idx / 2;
-                    unsigned char nybble = 0;
-                    if (idx % 2 == 0) {
-                        nybble = hash.digest[hash_idx] >> 4;
-                    } else {
-                        nybble = hash.digest[hash_idx] & 0x0f;
-                    }
-                    // To give a better sense of progress, don't allow a
-                    // non-leading zero to follow the best number of leading
-                    // zeroes.
-                    if (idx == best_leading_zeroes && 0 == nybble) {
-                        nybble += 1;
-                    }
-                    printf("%01x", nybble);
-                }
-                fflush(stdout);
-            }
-        }
-        return_code = blockchain_is_valid_block_hash(
-            blockchain, hash, &is_valid_block_hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (is_valid_block_hash) {
-            if (print_progress) {
-                printf("\rMining LeoCoin block: %s", ANSI_COLOR_GREEN);
-                for (size_t idx = 0; idx < sizeof(hash.digest); idx++) {
-                    printf("%02x", hash.digest[idx]);
-                }
-                printf("%s\n", ANSI_COLOR_RESET);
-            }
-            goto end;
-        }
+    synchronized_blockchain_retired_t *new_retired = realloc(
+        sync->retired,
+        new_capacity * sizeof(synchronized_blockchain_retired_t));
+    if (NULL == new_retired) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
     }
-    return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+    sync->retired = new_retired;
+    sync->retired_capacity = new_capacity;
 end:
     return return_code;
 }
 
-void blockchain_print(blockchain_t *blockchain) {
-    if (NULL == blockchain) {
-        return;
-    }
-    for (node_t *node = blockchain->block_list->head;
-        NULL != node;
-        node = node->next) {
-        block_t *block = (block_t *)node->data;
-        printf("%"PRIu64"->", block->proof_of_work);
-    }
-    printf("\n");
+void synchronized_blockchain_retire(
+    synchronized_blockchain_t *sync,
+    void *data,
+    void (*free_data)(void *),
+    size_t epoch
+) {
+    // The caller reserved room for the entry.
+    sync->retired[sync->num_retired].data = data;
+    sync->retired[sync->num_retired].free_data = free_data;
+    sync->retired[sync->num_retired].epoch = epoch;
+    sync->num_retired++;
 }
 
-return_code_t blockchain_verify(
-    blockchain_t *blockchain,
-    bool *is_valid_blockchain,
-    block_t **first_invalid_block
+return_code_t synchronized_blockchain_prepare_write(
+    synchronized_blockchain_t *sync,
+    uint64_t num_blocks,
+    bool appends_only
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == is_valid_blockchain) {
+    if (NULL == sync) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    if (NULL == blockchain->block_list->head) {
-        *is_valid_blockchain = true;
+    blockchain_t *blockchain = sync->blockchain;
+    // No snapshot reads a private copy, and appends within capacity only
+    // write entries past every snapshot.
+    if (NULL != sync->stale_blocks ||
+        (appends_only && num_blocks <= blockchain->blocks_capacity)) {
         goto end;
     }
-    // Check the genesis block, which is unique.
-    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
-    bool genesis_block_transaction_list_is_empty = false;
-    return_code = linked_list_is_empty(
-        genesis_block->transaction_list,
-        &genesis_block_transaction_list_is_empty);
-    if (SUCCESS != return_code) {
-        goto end;
+    uint64_t new_capacity = 2 * blockchain->blocks_capacity;
+    if (new_capacity < num_blocks) {
+        new_capacity = num_blocks;
     }
-    sha_256_t empty_block_hash = {0};
-    if (!genesis_block_transaction_list_is_empty ||
-        genesis_block->proof_of_work != GENESIS_BLOCK_PROOF_OF_WORK ||
-        0 != memcmp(
-            &genesis_block->previous_block_hash,
-            &empty_block_hash,
-            sizeof(sha_256_t))) {
-        *is_valid_blockchain = false;
-        if (NULL != first_invalid_block) {
-            *first_invalid_block = genesis_block;
-        }
+    if (new_capacity < BLOCKCHAIN_MIN_CAPACITY) {
+        new_capacity = BLOCKCHAIN_MIN_CAPACITY;
+    }
+    block_t **new_blocks = malloc(new_capacity * sizeof(block_t *));
+    if (NULL == new_blocks) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
-    sha_256_t previous_block_hash = {0};
-    block_hash(genesis_block, &previous_block_hash);
-    // Check the remaining blocks.
-    for (node_t *current_node = blockchain->block_list->head->next;
-        NULL != current_node;
-        current_node = current_node->next) {
-        block_t *current_block = (block_t *)current_node->data;
-        sha_256_t current_block_hash = {0};
-        return_code = block_hash(current_block, &current_block_hash);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (0 != memcmp(
-                &current_block_hash,
-                &empty_block_hash,
-                blockchain->num_leading_zero_bytes_required_in_block_hash)) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
-            }
-            goto end;
-        }
-        if (0 != memcmp(
-            &current_block->previous_block_hash,
-            &previous_block_hash,
-            sizeof(sha_256_t))) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
-            }
-            goto end;
-        }
-        // Every block must contain at least the minting transaction.
-        bool block_transaction_list_is_empty = false;
-        return_code = linked_list_is_empty(
-            current_block->transaction_list,
-            &block_transaction_list_is_empty);
-        if (SUCCESS != return_code) {
-            goto end;
-        }
-        if (block_transaction_list_is_empty) {
-            *is_valid_blockchain = false;
-            goto end;
-        }
-        node_t *minting_transaction_node =
-            current_block->transaction_list->head;
-        transaction_t *minting_transaction =
-            (transaction_t *)minting_transaction_node->data;
-        if (AMOUNT_GENERATED_DURING_MINTING != minting_transaction->amount ||
-            0 != memcmp(
-                &minting_transaction->sender_public_key,
-                &minting_transaction->recipient_public_key,
-                sizeof(ssh_key_t))) {
-            *is_valid_blockchain = false;
-            if (NULL != first_invalid_block) {
-                *first_invalid_block = current_block;
-            }
-            goto end;
-        }
-        // Check that every transaction has a valid signature.
-        for (node_t *transaction_node = minting_transaction_node;
-            NULL != transaction_node;
-            transaction_node = transaction_node->next) {
-            transaction_t *transaction =
-                (transaction_t *)transaction_node->data;
-            bool is_valid_signature = false;
-            return_code = transaction_verify_signature(
-                &is_valid_signature, transaction);
-            if (SUCCESS != return_code) {
-                goto end;
-            }
-            if (!is_valid_signature) {
-                *is_valid_blockchain = false;
-                if (NULL != first_invalid_block) {
-                    *first_invalid_block = current_block;
-                }
-                goto end;
-            }
-        }
-        memcpy(&previous_block_hash, &current_block_hash, sizeof(sha_256_t));
+    if (0 != blockchain->num_blocks) {
+        memcpy(
+            new_blocks,
+            blockchain->blocks,
+            blockchain->num_blocks * sizeof(block_t *));
     }
-    *is_valid_blockchain = true;
+    sync->stale_blocks = blockchain->blocks;
+    blockchain->blocks = new_blocks;
+    blockchain->blocks_capacity = new_capacity;
 end:
     return return_code;
 }
 
-return_code_t blockchain_serialize(
-    blockchain_t *blockchain,
-    unsigned char **buffer,
-    uint64_t *buffer_size
+return_code_t synchronized_blockchain_publish(
+    synchronized_blockchain_t *sync,
+    blockchain_t *blockchain
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == buffer || NULL == buffer_size) {
+    if (NULL == sync || NULL == blockchain) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    uint64_t num_blocks = 0;
-    return_code = linked_list_length(blockchain->block_list, &num_blocks);
+    // The old snapshot, the stale block array, and a replaced blockchain.
+    return_code = synchronized_blockchain_reserve_retired(sync, 3);
     if (SUCCESS != return_code) {
         goto end;
     }
-    uint64_t size =
-        sizeof(blockchain->num_leading_zero_bytes_required_in_block_hash) +
-        sizeof(num_blocks);
-    unsigned char *serialization_buffer = calloc(1, size);
-    if (NULL == serialization_buffer) {
-        return_code = FAILURE_COULD_NOT_MALLOC;
+    blockchain_t *snapshot = NULL;
+    return_code = synchronized_blockchain_create_snapshot(
+        &snapshot, blockchain);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    unsigned char *next_spot_in_buffer = serialization_buffer;
-    *(uint64_t *)next_spot_in_buffer = htobe64(
-        blockchain->num_leading_zero_bytes_required_in_block_hash);
-    next_spot_in_buffer += sizeof(
-        blockchain->num_leading_zero_bytes_required_in_block_hash);
-    *(uint64_t *)next_spot_in_buffer = htobe64(num_blocks);
-    next_spot_in_buffer += sizeof(num_blocks);
-    for (node_t *block_node = blockchain->block_list->head;
-        NULL != block_node;
-        block_node = block_node->next) {
-        block_t *block = (block_t *)block_node->data;
-        uint64_t num_transactions_in_block = 0;
-        return_code = linked_list_length(
-            block->transaction_list, &num_transactions_in_block);
-        if (SUCCESS != return_code) {
-            free(serialization_buffer);
-            goto end;
-        }
-        uint64_t next_spot_in_buffer_offset = size;
-        size += sizeof(block->created_at);
-        size += sizeof(block->previous_block_hash);
-        size += sizeof(block->proof_of_work);
-        size += sizeof(num_transactions_in_block);
-        serialization_buffer = realloc(serialization_buffer, size);
-        if (NULL == serialization_buffer) {
-            return_code = FAILURE_COULD_NOT_MALLOC;
-            goto end;
-        }
-        // When we realloc, serialization_buffer may move. We need to use an
-        // offset so we can get the next memory location to write.
-        next_spot_in_buffer = serialization_buffer + next_spot_in_buffer_offset;
-        *(uint64_t *)next_spot_in_buffer = htobe64(block->created_at);
-        next_spot_in_buffer += sizeof(block->created_at);
-        for (size_t idx = 0; idx < sizeof(block->previous_block_hash); idx++) {
-            *next_spot_in_buffer = block->previous_block_hash.digest[idx];
-            next_spot_in_buffer++;
-        }
-        *(uint64_t *)next_spot_in_buffer = htobe64(block->proof_of_work);
-        next_spot_in_buffer += sizeof(block->proof_of_work);
-        *(uint64_t *)next_spot_in_buffer = htobe64(num_transactions_in_block);
-        next_spot_in_buffer += sizeof(num_transactions_in_block);
-        for (node_t *transaction_node = block->transaction_list->head;
-            NULL != transaction_node;
-            transaction_node = transaction_node->next) {
-            transaction_t *transaction = (transaction_t *)
-                transaction_node->data;
-            next_spot_in_buffer_offset = size;
-            size += sizeof(transaction->created_at);
-            size += sizeof(transaction->sender_public_key);
-            size += sizeof(transaction->recipient_public_key);
-            size += sizeof(transaction->amount);
-            size += sizeof(transaction->sender_signature.length);
-            size += sizeof(transaction->sender_signature.bytes);
-            serialization_buffer = realloc(serialization_buffer, size);
-            if (NULL == serialization_buffer) {
-                return_code = FAILURE_COULD_NOT_MALLOC;
-                goto end;
-            }
-            // When we realloc, serialization_buffer may move. We need to use an
-            // offset so we can get the next memory location to write.
-            next_spot_in_buffer =
-                serialization_buffer + next_spot_in_buffer_offset;
-            *(uint64_t *)next_spot_in_buffer = htobe64(transaction->created_at);
-            next_spot_in_buffer += sizeof(transaction->created_at);
-            for (size_t idx = 0;
-                 idx < sizeof(transaction->sender_public_key);
-                 idx++) {
-                *next_spot_in_buffer =
-                    transaction->sender_public_key.bytes[idx];
-                next_spot_in_buffer++;
-            }
-            for (size_t idx = 0;
-                 idx < sizeof(transaction->recipient_public_key);
-                 idx++) {
-                *next_spot_in_buffer =
-                    transaction->recipient_public_key.bytes[idx];
-                next_spot_in_buffer++;
-            }
-            *(uint64_t *)next_spot_in_buffer = htobe64(transaction->amount);
-            next_spot_in_buffer += sizeof(transaction->amount);
-            *(uint64_t *)next_spot_in_buffer = htobe64(
-                transaction->sender_signature.length);
-            next_spot_in_buffer += sizeof(transaction->sender_signature.length);
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_signature.bytes);
-                idx++) {
-                *next_spot_in_buffer = transaction->sender_signature.bytes[idx];
-                next_spot_in_buffer++;
-            }
-        }
+    blockchain_t *old_snapshot = atomic_exchange(&sync->snapshot, snapshot);
+    // Readers that announce a later epoch cannot load the old snapshot, so
+    // everything it reads retires with it.
+    size_t epoch = atomic_fetch_add(&sync->epoch, 1);
+    synchronized_blockchain_retire(sync, old_snapshot, free, epoch);
+    if (NULL != sync->stale_blocks) {
+        synchronized_blockchain_retire(sync, sync->stale_blocks, free, epoch);
+        sync->stale_blocks = NULL;
     }
-    *buffer = serialization_buffer;
-    *buffer_size = size;
+    if (blockchain != sync->blockchain) {
+        synchronized_blockchain_retire(
+            sync,
+            sync->blockchain,
+            synchronized_blockchain_free_retired_blockchain,
+            epoch);
+        sync->blockchain = blockchain;
+    }
+    synchronized_blockchain_reclaim(sync);
 end:
     return return_code;
 }
 
-return_code_t blockchain_deserialize(
-    blockchain_t **blockchain,
-    unsigned char *buffer,
-    uint64_t buffer_size
+return_code_t blockchain_seal_and_index_block(
+    blockchain_t *blockchain,
+    block_t *block,
+    uint64_t height
 ) {
-    return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == buffer) {
-        return_code = FAILURE_INVALID_INPUT;
+    return_code_t return_code = block_seal(block);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    unsigned char *next_spot_in_buffer = buffer;
-    ptrdiff_t total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-    if (total_read_size > buffer_size) {
-        return_code = FAILURE_BUFFER_TOO_SMALL;
+    return_code = block_hash_index_insert(
+        blockchain->hash_index, &block->hash, block, height);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_reserve_block_array(
+    block_t ***blocks,
+    uint64_t *capacity,
+    uint64_t min_capacity
+) {
+    return_code_t return_code = SUCCESS;
+    if (min_capacity <= *capacity) {
         goto end;
     }
-    uint64_t num_leading_zero_bytes_required_in_block_hash = betoh64(
-        *(uint64_t *)next_spot_in_buffer);
-    next_spot_in_buffer += sizeof(
-        num_leading_zero_bytes_required_in_block_hash);
-    blockchain_t *new_blockchain = NULL;
-    return_code = blockchain_create(
-        &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+    // Doubling the capacity makes appends amortized O(1).
+    uint64_t new_capacity = *capacity * 2;
+    if (new_capacity < BLOCKCHAIN_MIN_CAPACITY) {
+        new_capacity = BLOCKCHAIN_MIN_CAPACITY;
+    }
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    block_t **new_blocks = realloc(*blocks, new_capacity * sizeof(block_t *));
+    if (NULL == new_blocks) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    *blocks = new_blocks;
+    *capacity = new_capacity;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_append_block(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool apply_to_address_index
+) {
+    return_code_t return_code = blockchain_reserve_block_array(
+        &blockchain->blocks,
+        &blockchain->blocks_capacity,
+        blockchain->num_blocks + 1);
     if (SUCCESS != return_code) {
         goto end;
     }
-    total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-    if (total_read_size > buffer_size) {
-        return_code = FAILURE_BUFFER_TOO_SMALL;
-        blockchain_destroy(new_blockchain);
+    return_code = ledger_apply_block(blockchain->ledger, block, NULL);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    uint64_t num_blocks = betoh64(*(uint64_t *)next_spot_in_buffer);
-    next_spot_in_buffer += sizeof(num_blocks);
-    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
-        block_t *block = NULL;
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+    if (apply_to_address_index) {
+        return_code = address_index_apply_block(
+            blockchain->address_index, block);
+        if (SUCCESS != return_code) {
+            ledger_revert_block(blockchain->ledger, block);
             goto end;
         }
-        time_t block_created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(block_created_at);
-        total_read_size = next_spot_in_buffer + sizeof(sha_256_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+    }
+    return_code = blockchain_seal_and_index_block(
+        blockchain, block, blockchain->num_blocks);
+    if (SUCCESS != return_code) {
+        if (apply_to_address_index) {
+            address_index_revert_block(blockchain->address_index, block);
+        }
+        ledger_revert_block(blockchain->ledger, block);
+        goto end;
+    }
+    blockchain->blocks[blockchain->num_blocks] = block;
+    blockchain->num_blocks++;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_add_block(blockchain_t *blockchain, block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = blockchain_append_block(blockchain, block, true);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_clone(blockchain_t **clone, blockchain_t *blockchain) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == clone || NULL == blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_t *new_blockchain = calloc(1, sizeof(blockchain_t));
+    if (NULL == new_blockchain) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_blockchain->num_leading_zero_bytes_required_in_block_hash =
+        blockchain->num_leading_zero_bytes_required_in_block_hash;
+    // The index maps hashes to the same blocks, so copy it wholesale.
+    return_code = block_hash_index_copy(
+        &new_blockchain->hash_index, blockchain->hash_index);
+    if (SUCCESS != return_code) {
+        free(new_blockchain);
+        goto end;
+    }
+    return_code = ledger_copy(&new_blockchain->ledger, blockchain->ledger);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    return_code = address_index_copy(
+        &new_blockchain->address_index, blockchain->address_index);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    return_code = blockchain_reserve_block_array(
+        &new_blockchain->blocks,
+        &new_blockchain->blocks_capacity,
+        blockchain->num_blocks);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    return_code = blockchain_reserve_block_array(
+        &new_blockchain->side_blocks,
+        &new_blockchain->side_blocks_capacity,
+        blockchain->num_side_blocks);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        block_t *block = blockchain->blocks[height];
+        block_retain(block);
+        new_blockchain->blocks[height] = block;
+        new_blockchain->num_blocks++;
+    }
+    for (uint64_t idx = 0; idx < blockchain->num_side_blocks; idx++) {
+        block_t *block = blockchain->side_blocks[idx];
+        block_retain(block);
+        new_blockchain->side_blocks[idx] = block;
+        new_blockchain->num_side_blocks++;
+    }
+    *clone = new_blockchain;
+end:
+    return return_code;
+}
+
+void blockchain_insert_side_block(
+    blockchain_t *blockchain,
+    block_hash_index_entry_t *entry
+) {
+    entry->is_side_block = true;
+    entry->side_block_position = blockchain->num_side_blocks;
+    blockchain->side_blocks[blockchain->num_side_blocks] = entry->block;
+    blockchain->num_side_blocks++;
+}
+
+return_code_t blockchain_remove_side_block(
+    blockchain_t *blockchain,
+    block_hash_index_entry_t *entry
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t position = entry->side_block_position;
+    entry->is_side_block = false;
+    blockchain->num_side_blocks--;
+    if (position == blockchain->num_side_blocks) {
+        goto end;
+    }
+    // Fill the gap with the last side block, which then needs its new
+    // position recorded.
+    block_t *moved_block = blockchain->side_blocks[blockchain->num_side_blocks];
+    blockchain->side_blocks[position] = moved_block;
+    block_hash_index_entry_t *moved_entry = NULL;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &moved_block->hash, &moved_entry);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    moved_entry->side_block_position = position;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_prune_side_blocks(blockchain_t *blockchain) {
+    return_code_t return_code = SUCCESS;
+    uint64_t tip_height = blockchain->num_blocks - 1;
+    uint64_t idx = 0;
+    while (idx < blockchain->num_side_blocks) {
+        block_t *block = blockchain->side_blocks[idx];
+        block_hash_index_entry_t *entry = NULL;
+        return_code = block_hash_index_find(
+            blockchain->hash_index, &block->hash, &entry);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        sha_256_t previous_block_hash = {0};
-        for (size_t idx = 0; idx < sizeof(previous_block_hash); idx++) {
-            previous_block_hash.digest[idx] = *next_spot_in_buffer;
-            next_spot_in_buffer++;
+        if (entry->height + BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH >= tip_height) {
+            idx++;
+            continue;
         }
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+        // Removal moves the last side block into this position, so the
+        // loop looks at the same position again.
+        return_code = blockchain_remove_side_block(blockchain, entry);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        uint64_t proof_of_work = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(proof_of_work);
-        total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-        if (total_read_size > buffer_size) {
-            return_code = FAILURE_BUFFER_TOO_SMALL;
-            blockchain_destroy(new_blockchain);
+        return_code = block_hash_index_remove(
+            blockchain->hash_index, &block->hash);
+        if (SUCCESS != return_code) {
             goto end;
         }
-        uint64_t num_transactions = betoh64(*(uint64_t *)next_spot_in_buffer);
-        next_spot_in_buffer += sizeof(num_transactions);
-        linked_list_t *transaction_list = NULL;
-        return_code = linked_list_create(
-            &transaction_list, (free_function_t *)transaction_destroy, NULL);
+        block_release(block);
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_reorganize(
+    blockchain_t *blockchain,
+    block_t *new_tip,
+    uint64_t new_tip_height
+) {
+    return_code_t return_code = SUCCESS;
+    // Walk back from the new tip to the highest block it shares with the
+    // active chain. Every block in the tree descends from the genesis block,
+    // so the walk always ends.
+    block_t *fork_block = new_tip;
+    uint64_t fork_height = new_tip_height;
+    while (fork_height >= blockchain->num_blocks ||
+        blockchain->blocks[fork_height] != fork_block) {
+        block_hash_index_entry_t *parent_entry = NULL;
+        return_code = block_hash_index_find(
+            blockchain->hash_index,
+            &fork_block->previous_block_hash,
+            &parent_entry);
         if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
             goto end;
         }
-        for (uint64_t transaction_idx = 0;
-            transaction_idx < num_transactions;
-            transaction_idx++) {
-            transaction_t *transaction = calloc(1, sizeof(transaction_t));
-            if (NULL == transaction) {
-                return_code = FAILURE_COULD_NOT_MALLOC;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                goto end;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->created_at = betoh64(*(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->created_at);
-            total_read_size = next_spot_in_buffer + sizeof(ssh_key_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_public_key);
-                idx++) {
-                transaction->sender_public_key.bytes[idx] =
-                    *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(ssh_key_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->recipient_public_key);
-                idx++) {
-                transaction->recipient_public_key.bytes[idx] =
-                    *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->amount = betoh64(*(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->amount);
-            total_read_size = next_spot_in_buffer + sizeof(uint64_t) - buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            transaction->sender_signature.length = betoh64(
-                *(uint64_t *)next_spot_in_buffer);
-            next_spot_in_buffer += sizeof(transaction->sender_signature.length);
-            if (transaction->sender_signature.length > MAX_SSH_KEY_LENGTH) {
-                return_code = FAILURE_SIGNATURE_TOO_LONG;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            total_read_size =
-                next_spot_in_buffer +
-                transaction->sender_signature.length -
-                buffer;
-            if (total_read_size > buffer_size) {
-                return_code = FAILURE_BUFFER_TOO_SMALL;
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
-            for (size_t idx = 0;
-                idx < sizeof(transaction->sender_signature.bytes);
-                idx++) {
-                transaction->sender_signature.bytes[idx] = *next_spot_in_buffer;
-                next_spot_in_buffer++;
-            }
-            return_code = linked_list_append(transaction_list, transaction);
-            if (SUCCESS != return_code) {
-                blockchain_destroy(new_blockchain);
-                linked_list_destroy(transaction_list);
-                free(transaction);
-                goto end;
-            }
+        if (0 == fork_height) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
         }
-        return_code = block_create(
-            &block, transaction_list, proof_of_work, previous_block_hash);
+        fork_block = parent_entry->block;
+        fork_height--;
+    }
+    // Reserve everything first so that moving the blocks cannot fail.
+    size_t num_new_transactions = 0;
+    block_t *branch_block = new_tip;
+    for (uint64_t height = new_tip_height; height > fork_height; height--) {
+        for (node_t *node = branch_block->transaction_list->head;
+            NULL != node;
+            node = node->next) {
+            num_new_transactions++;
+        }
+        block_hash_index_entry_t *parent_entry = NULL;
+        return_code = block_hash_index_find(
+            blockchain->hash_index,
+            &branch_block->previous_block_hash,
+            &parent_entry);
         if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
-            linked_list_destroy(transaction_list);
             goto end;
         }
-        block->created_at = block_created_at;
-        return_code = blockchain_add_block(new_blockchain, block);
+        branch_block = parent_entry->block;
+    }
+    return_code = ledger_reserve(blockchain->ledger, 2 * num_new_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = address_index_reserve(
+        blockchain->address_index, num_new_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t num_disconnected_blocks = blockchain->num_blocks - fork_height - 1;
+    return_code = blockchain_reserve_block_array(
+        &blockchain->blocks, &blockchain->blocks_capacity, new_tip_height + 1);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_reserve_block_array(
+        &blockchain->side_blocks,
+        &blockchain->side_blocks_capacity,
+        blockchain->num_side_blocks + num_disconnected_blocks);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Find every entry to update before changing anything.
+    block_hash_index_entry_t *new_tip_entry = NULL;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &new_tip->hash, &new_tip_entry);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (uint64_t height = fork_height + 1;
+        height < blockchain->num_blocks;
+        height++) {
+        block_hash_index_entry_t *entry = NULL;
+        return_code = block_hash_index_find(
+            blockchain->hash_index, &blockchain->blocks[height]->hash, &entry);
         if (SUCCESS != return_code) {
-            blockchain_destroy(new_blockchain);
-            block_destroy(block);
             goto end;
         }
+        blockchain_insert_side_block(blockchain, entry);
+    }
+    // Roll the balances and histories back to the fork point, newest block
+    // first.
+    for (uint64_t height = blockchain->num_blocks - 1;
+        height > fork_height;
+        height--) {
+        ledger_revert_block(blockchain->ledger, blockchain->blocks[height]);
+        address_index_revert_block(
+            blockchain->address_index, blockchain->blocks[height]);
+    }
+    block_hash_index_entry_t *entry = new_tip_entry;
+    for (uint64_t height = new_tip_height; height > fork_height; height--) {
+        return_code = blockchain_remove_side_block(blockchain, entry);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        blockchain->blocks[height] = entry->block;
+        if (height > fork_height + 1) {
+            return_code = block_hash_index_find(
+                blockchain->hash_index,
+                &entry->block->previous_block_hash,
+                &entry);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+    }
+    blockchain->num_blocks = new_tip_height + 1;
+    // The ledger and address index already have room for the new branch.
+    for (uint64_t height = fork_height + 1;
+        height < blockchain->num_blocks;
+        height++) {
+        ledger_apply_block(
+            blockchain->ledger, blockchain->blocks[height], NULL);
+        address_index_apply_block(
+            blockchain->address_index, blockchain->blocks[height]);
     }
-    *blockchain = new_blockchain;
 end:
     return return_code;
 }
 
-return_code_t blockchain_write_to_file(
+return_code_t blockchain_add_block_to_tree(
     blockchain_t *blockchain,
-    char *outfile
+    block_t *block,
+    bool *tip_changed
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == outfile) {
+    if (NULL == blockchain || NULL == block || NULL == tip_changed) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    unsigned char *buffer = NULL;
-    size_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    *tip_changed = false;
+    if (0 == blockchain->num_blocks) {
+        return_code = blockchain_add_block(blockchain, block);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        *tip_changed = true;
+        goto end;
+    }
+    return_code = block_seal(block);
     if (SUCCESS != return_code) {
         goto end;
     }
-    FILE *f = fopen(outfile, "wb");
-    if (NULL == f) {
-        return_code = FAILURE_FILE_IO;
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &block->hash, &entry);
+    if (SUCCESS == return_code) {
+        return_code = FAILURE_DUPLICATE_BLOCK;
         goto end;
     }
-    size_t bytes_written = fwrite(buffer, 1, buffer_size, f);
-    fclose(f);
-    free(buffer);
-    if (bytes_written != buffer_size) {
-        return_code = FAILURE_FILE_IO;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &block->previous_block_hash, &entry);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t height = entry->height + 1;
+    if (entry->block == blockchain->blocks[blockchain->num_blocks - 1]) {
+        return_code = blockchain_add_block(blockchain, block);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        *tip_changed = true;
+        // Pruning only frees memory, so its failure does not undo the block.
+        blockchain_prune_side_blocks(blockchain);
+        goto end;
+    }
+    // The block would be pruned as soon as it arrived.
+    if (height + BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH < blockchain->num_blocks - 1) {
+        block_release(block);
+        goto end;
+    }
+    return_code = blockchain_reserve_block_array(
+        &blockchain->side_blocks,
+        &blockchain->side_blocks_capacity,
+        blockchain->num_side_blocks + 1);
+    if (SUCCESS != return_code) {
         goto end;
     }
+    return_code = block_hash_index_insert(
+        blockchain->hash_index, &block->hash, block, height);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &block->hash, &entry);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    blockchain_insert_side_block(blockchain, entry);
+    if (height >= blockchain->num_blocks) {
+        // The reorganization fails before moving any block, for instance if
+        // the branch descends from a pruned block, so the block can simply be
+        // taken out again.
+        return_code = blockchain_reorganize(blockchain, block, height);
+        if (SUCCESS != return_code) {
+            blockchain_remove_side_block(blockchain, entry);
+            block_hash_index_remove(blockchain->hash_index, &block->hash);
+            goto end;
+        }
+        *tip_changed = true;
+        blockchain_prune_side_blocks(blockchain);
+    }
 end:
     return return_code;
 }
 
-return_code_t blockchain_read_from_file(
-    blockchain_t **blockchain,
-    char *infile
+return_code_t blockchain_merge(
+    blockchain_t *blockchain,
+    blockchain_t *other,
+    bool *tip_changed
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == blockchain || NULL == infile) {
+    if (NULL == blockchain || NULL == other || NULL == tip_changed) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    FILE *f = fopen(infile, "rb");
-    if (NULL == f) {
-        return_code = FAILURE_FILE_IO;
-        goto end;
+    *tip_changed = false;
+    // A block is only ever in the tree along with all of its ancestors, so
+    // the highest block of other that the tree holds is the fork point.
+    uint64_t num_common_blocks = other->num_blocks;
+    while (num_common_blocks > 0) {
+        sha_256_t hash = {0};
+        return_code = block_hash(other->blocks[num_common_blocks - 1], &hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        block_hash_index_entry_t *entry = NULL;
+        if (SUCCESS == block_hash_index_find(
+            blockchain->hash_index, &hash, &entry)) {
+            break;
+        }
+        num_common_blocks--;
     }
-    fseek(f, 0, SEEK_END);
-    uint64_t buffer_size = ftell(f);
-    fseek(f, 0, SEEK_SET);
-    unsigned char *buffer = malloc(buffer_size);
-    if (NULL == buffer) {
-        return_code = FAILURE_COULD_NOT_MALLOC;
+    if (0 == num_common_blocks) {
+        return_code = FAILURE_BLOCK_NOT_FOUND;
         goto end;
     }
-    size_t read_size = fread(buffer, 1, buffer_size, f);
-    if (read_size != (size_t)buffer_size) {
-        return_code = FAILURE_FILE_IO;
-        goto cleanup;
+    for (uint64_t height = num_common_blocks;
+        height < other->num_blocks;
+        height++) {
+        // Share heap blocks, but copy arena blocks so that a few new blocks
+        // do not keep the whole of other's arena alive.
+        block_t *block = other->blocks[height];
+        if (NULL == block->arena) {
+            block_retain(block);
+        } else {
+            return_code = block_copy(&block, other->blocks[height]);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+        bool block_changed_tip = false;
+        return_code = blockchain_add_block_to_tree(
+            blockchain, block, &block_changed_tip);
+        if (SUCCESS != return_code) {
+            block_release(block);
+            goto end;
+        }
+        *tip_changed = *tip_changed || block_changed_tip;
     }
-    return_code = blockchain_deserialize(blockchain, buffer, buffer_size);
-cleanup:
-    fclose(f);
-    free(buffer);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_length(blockchain_t *blockchain, uint64_t *length) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == length) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *length = blockchain->num_blocks;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_get_block(
+    blockchain_t *blockchain,
+    uint64_t height,
+    block_t **block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (height >= blockchain->num_blocks) {
+        return_code = FAILURE_BLOCK_NOT_FOUND;
+        goto end;
+    }
+    *block = blockchain->blocks[height];
+end:
+    return return_code;
+}
+
+return_code_t blockchain_get_last_block(
+    blockchain_t *blockchain,
+    block_t **block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 == blockchain->num_blocks) {
+        return_code = FAILURE_BLOCK_NOT_FOUND;
+        goto end;
+    }
+    *block = blockchain->blocks[blockchain->num_blocks - 1];
+end:
+    return return_code;
+}
+
+return_code_t blockchain_find_block_by_hash(
+    blockchain_t *blockchain,
+    sha_256_t *block_hash,
+    block_t **block,
+    uint64_t *height
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain ||
+        NULL == block_hash ||
+        NULL == block ||
+        NULL == height) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, block_hash, &entry);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *block = entry->block;
+    *height = entry->height;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_get_balance(
+    blockchain_t *blockchain,
+    public_key_t *public_key,
+    int64_t *balance
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == public_key || NULL == balance) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = ledger_get_balance(blockchain->ledger, public_key, balance);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_get_transaction_history(
+    blockchain_t *blockchain,
+    public_key_t *public_key,
+    uint64_t offset,
+    uint64_t max_postings,
+    address_index_posting_t *postings,
+    uint64_t *num_postings,
+    uint64_t *total_num_postings
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = address_index_get_postings(
+        blockchain->address_index,
+        public_key,
+        offset,
+        max_postings,
+        postings,
+        num_postings,
+        total_num_postings);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_is_valid_block_hash(
+    blockchain_t *blockchain,
+    sha_256_t block_hash,
+    bool *is_valid_block_hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == is_valid_block_hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    bool is_valid = true;
+    for (size_t idx = 0;
+        idx < blockchain->num_leading_zero_bytes_required_in_block_hash;
+        idx++) {
+        if (block_hash.digest[idx] != 0) {
+            is_valid = false;
+            break;
+        }
+    }
+    *is_valid_block_hash = is_valid;
+end:
+    return return_code;
+}
+
+/**
+ * @brief Contains the progress shared between mining workers and the progress
+ * reporter.
+ * 
+ * Workers only touch this when they find a better hash than any they have
+ * seen, which happens a logarithmic number of times, so the mutex never
+ * contends with the search itself.
+ * 
+ * @param mutex Guards the other fields.
+ * @param reporter_cond Signaled to wake the reporter when mining ends.
+ * @param has_best_hash True once any worker has recorded a hash.
+ * @param best_hash The hash with the most leading zeroes found so far.
+ * @param is_done Set when mining ends so the reporter exits.
+ */
+typedef struct mining_progress_t {
+    pthread_mutex_t mutex;
+    pthread_cond_t reporter_cond;
+    bool has_best_hash;
+    sha_256_t best_hash;
+    bool is_done;
+} mining_progress_t;
+
+/**
+ * @brief Contains the state of one proof of work search thread.
+ * 
+ * @param blockchain The blockchain whose difficulty the hash must meet.
+ * @param sync The synchronized blockchain, or NULL if the caller is mining on
+ * an unsynchronized blockchain.
+ * @param block A private copy of the block being mined. The worker only
+ * modifies the proof of work in its own copy, so workers never contend on it.
+ * @param first_proof_of_work The first proof of work in this worker's range.
+ * @param last_proof_of_work The last proof of work in this worker's range,
+ * inclusive, so that a range can end at UINT64_MAX.
+ * @param progress Where this worker records its best hash, or NULL if
+ * progress is not displayed.
+ * @param should_stop See synchronized_blockchain_mine_block.
+ * @param sync_version_currently_mined See synchronized_blockchain_mine_block.
+ * May be NULL if sync is NULL.
+ * @param found_valid_proof_of_work Shared by all workers. The first worker to
+ * find a valid hash sets this flag, which signals the others to stop.
+ * @param is_winner Set if this worker was the first to find a valid hash.
+ * @param hash If is_winner is set, the valid block hash.
+ * @param num_hashes The number of hashes this worker has computed so far. The
+ * worker updates it with relaxed stores; the reporter samples it.
+ * @param elapsed_seconds The time this worker spent searching.
+ * @param return_code The worker's return code.
+ */
+typedef struct mine_block_worker_args_t {
+    blockchain_t *blockchain;
+    synchronized_blockchain_t *sync;
+    block_t block;
+    uint64_t first_proof_of_work;
+    uint64_t last_proof_of_work;
+    mining_progress_t *progress;
+    atomic_bool *should_stop;
+    atomic_size_t *sync_version_currently_mined;
+    atomic_bool *found_valid_proof_of_work;
+    bool is_winner;
+    sha_256_t hash;
+    atomic_uint_fast64_t num_hashes;
+    double elapsed_seconds;
+    return_code_t return_code;
+} mine_block_worker_args_t;
+
+/**
+ * @brief Contains the arguments to the mining progress reporter thread.
+ * 
+ * @param workers The mining workers whose counters the reporter samples.
+ * @param num_workers The number of workers.
+ * @param progress The progress shared with the workers.
+ */
+typedef struct report_mining_progress_args_t {
+    mine_block_worker_args_t *workers;
+    size_t num_workers;
+    mining_progress_t *progress;
+} report_mining_progress_args_t;
+
+double get_elapsed_seconds(struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) +
+        (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+size_t count_leading_zero_nybbles(sha_256_t *hash) {
+    size_t num_zeroes = 0;
+    for (size_t idx = 0; idx < sizeof(hash->digest); idx++) {
+        unsigned char upper_nybble = hash->digest[idx] >> 4;
+        if (upper_nybble != 0) {
+            break;
+        }
+        num_zeroes++;
+        if (hash->digest[idx] != 0) {
+            break;
+        }
+        num_zeroes++;
+    }
+    return num_zeroes;
+}
+
+void print_mining_progress(sha_256_t *hash, double hash_rate) {
+    size_t best_leading_zeroes = count_leading_zero_nybbles(hash);
+    // Remove the previous progress line from output.
+    printf("\rMining LeoCoin block: ");
+    // Print the best number of leading zeroes.
+    for (size_t idx = 0; idx < best_leading_zeroes; idx++) {
+        printf("0");
+    }
+    // Add the part of the best hash following the best number of leading
+    // zeroes. It's not the hash of the current attempt, but it does give an
+    // idea of progress.
+    for (size_t idx = best_leading_zeroes;
+        idx < 2 * sizeof(hash->digest);
+        idx++) {
+        size_t hash_idx = idx / 2;
+        unsigned char nybble = 0;
+        if (idx % 2 == 0) {
+            nybble = hash->digest[hash_idx] >> 4;
+        } else {
+            nybble = hash->digest[hash_idx] & 0x0f;
+        }
+        printf("%01x", nybble);
+    }
+    printf(" %.2f MH/s", hash_rate / 1e6);
+    fflush(stdout);
+}
+
+void print_mining_result(sha_256_t *hash, char *color) {
+    printf("\r%sMining LeoCoin block: %s", ANSI_ERASE_LINE, color);
+    for (size_t idx = 0; idx < sizeof(hash->digest); idx++) {
+        printf("%02x", hash->digest[idx]);
+    }
+    printf("%s\n", ANSI_COLOR_RESET);
+}
+
+return_code_t record_mining_progress(
+    mining_progress_t *progress,
+    mining_hash_template_t *mining_template,
+    uint64_t proof_of_work
+) {
+    return_code_t return_code = SUCCESS;
+    sha_256_t hash = {0};
+    return_code = mining_hash_compute(mining_template, proof_of_work, &hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&progress->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    if (!progress->has_best_hash ||
+        memcmp(&hash, &progress->best_hash, sizeof(hash)) < 0) {
+        progress->best_hash = hash;
+        progress->has_best_hash = true;
+    }
+    if (0 != pthread_mutex_unlock(&progress->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t report_mining_progress(report_mining_progress_args_t *args) {
+    return_code_t return_code = SUCCESS;
+    mining_progress_t *progress = args->progress;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (0 != pthread_mutex_lock(&progress->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    while (!progress->is_done) {
+        // Condition variables time out against the realtime clock.
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += MINING_PROGRESS_REPORT_INTERVAL_NANOSECONDS;
+        deadline.tv_sec += deadline.tv_nsec / 1000000000;
+        deadline.tv_nsec %= 1000000000;
+        while (!progress->is_done) {
+            int result = pthread_cond_timedwait(
+                &progress->reporter_cond, &progress->mutex, &deadline);
+            if (ETIMEDOUT == result) {
+                break;
+            }
+        }
+        if (progress->is_done || !progress->has_best_hash) {
+            continue;
+        }
+        sha_256_t best_hash = progress->best_hash;
+        uint64_t num_hashes = 0;
+        for (size_t idx = 0; idx < args->num_workers; idx++) {
+            num_hashes += atomic_load_explicit(
+                &args->workers[idx].num_hashes, memory_order_relaxed);
+        }
+        double elapsed_seconds = get_elapsed_seconds(&start);
+        double hash_rate = elapsed_seconds > 0 ?
+            num_hashes / elapsed_seconds : 0;
+        print_mining_progress(&best_hash, hash_rate);
+    }
+    if (0 != pthread_mutex_unlock(&progress->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+void *report_mining_progress_pthread_wrapper(void *args) {
+    report_mining_progress((report_mining_progress_args_t *)args);
+    return NULL;
+}
+
+return_code_t blockchain_get_proof_of_work_range(
+    size_t worker_idx,
+    size_t num_workers,
+    uint64_t *first_proof_of_work,
+    uint64_t *last_proof_of_work
+) {
+    return_code_t return_code = SUCCESS;
+    if (0 == num_workers ||
+        worker_idx >= num_workers ||
+        NULL == first_proof_of_work ||
+        NULL == last_proof_of_work) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t range_size = UINT64_MAX / num_workers;
+    *first_proof_of_work = worker_idx * range_size;
+    // The last range also takes the remainder of the division, up to and
+    // including UINT64_MAX.
+    *last_proof_of_work = worker_idx == num_workers - 1 ?
+        UINT64_MAX : (worker_idx + 1) * range_size - 1;
+end:
+    return return_code;
+}
+
+return_code_t mine_block_worker(mine_block_worker_args_t *args) {
+    return_code_t return_code = SUCCESS;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t num_hashes = 0;
+    // The first 32 bits of the best hash this worker has recorded.
+    uint32_t best_first_word = UINT32_MAX;
+    bool is_valid_block_hash = false;
+    // Only the proof of work changes while mining, so hash the rest of the
+    // header once and run a single compression per attempt. The SIMD kernels
+    // run several attempts at once.
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, &args->block);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    mining_hash_kernel_t kernel = mining_hash_best_kernel();
+    uint64_t new_proof = args->first_proof_of_work;
+    for (;;) {
+        if (atomic_load(args->found_valid_proof_of_work)) {
+            goto end;
+        }
+        if (*args->should_stop) {
+            return_code = FAILURE_STOPPED_EARLY;
+            goto end;
+        }
+        if (NULL != args->sync &&
+            atomic_load(args->sync_version_currently_mined) !=
+            atomic_load(&args->sync->version)) {
+            return_code = FAILURE_LONGER_BLOCKCHAIN_DETECTED;
+            goto end;
+        }
+        // Try a whole sweep of proofs of work at once, falling back to one at
+        // a time at the end of the range. The candidate is the valid proof of
+        // work if there is one, and otherwise the best attempt.
+        uint64_t candidate_proof = new_proof;
+        uint64_t num_proofs_tried = 1;
+        uint32_t candidate_first_word = 0;
+        if (args->last_proof_of_work - new_proof >=
+            MINING_HASH_SWEEP_SIZE - 1) {
+            mining_hash_sweep_result_t result;
+            return_code = mining_hash_sweep(
+                &mining_template,
+                kernel,
+                new_proof,
+                args->blockchain->num_leading_zero_bytes_required_in_block_hash,
+                &result);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            num_proofs_tried = MINING_HASH_SWEEP_SIZE;
+            is_valid_block_hash = result.found;
+            candidate_proof = result.found ?
+                result.valid_proof_of_work : result.best_proof_of_work;
+            candidate_first_word = result.best_first_word;
+        } else {
+            return_code = mining_hash_compute(
+                &mining_template, candidate_proof, &args->hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            return_code = blockchain_is_valid_block_hash(
+                args->blockchain, args->hash, &is_valid_block_hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            candidate_first_word = (uint32_t)args->hash.digest[0] << 24 |
+                (uint32_t)args->hash.digest[1] << 16 |
+                (uint32_t)args->hash.digest[2] << 8 |
+                (uint32_t)args->hash.digest[3];
+        }
+        num_hashes += num_proofs_tried;
+        atomic_store_explicit(
+            &args->num_hashes, num_hashes, memory_order_relaxed);
+        if (NULL != args->progress && candidate_first_word < best_first_word) {
+            best_first_word = candidate_first_word;
+            return_code = record_mining_progress(
+                args->progress, &mining_template, candidate_proof);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+        if (is_valid_block_hash) {
+            args->block.proof_of_work = candidate_proof;
+            return_code = mining_hash_compute(
+                &mining_template, candidate_proof, &args->hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            // Only the first worker to find a valid hash wins; any others
+            // that finish at the same time discard their result.
+            if (!atomic_exchange(args->found_valid_proof_of_work, true)) {
+                args->is_winner = true;
+            }
+            goto end;
+        }
+        // Stop before the next proof of work would pass the end of the range,
+        // which may also be the end of the proof of work space.
+        if (args->last_proof_of_work - new_proof < num_proofs_tried) {
+            break;
+        }
+        new_proof += num_proofs_tried;
+    }
+    return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+end:
+    args->elapsed_seconds = get_elapsed_seconds(&start);
+    args->return_code = return_code;
+    return return_code;
+}
+
+void *mine_block_worker_pthread_wrapper(void *args) {
+    mine_block_worker((mine_block_worker_args_t *)args);
+    return NULL;
+}
+
+return_code_t mine_block_with_workers(
+    blockchain_t *blockchain,
+    synchronized_blockchain_t *sync,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    atomic_size_t *sync_version_currently_mined,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    mine_block_worker_args_t *workers = calloc(
+        num_threads, sizeof(mine_block_worker_args_t));
+    if (NULL == workers) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    if (NULL == threads) {
+        free(workers);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    mining_progress_t progress = {0};
+    pthread_mutex_init(&progress.mutex, NULL);
+    pthread_cond_init(&progress.reporter_cond, NULL);
+    atomic_bool found_valid_proof_of_work = false;
+    for (size_t idx = 0; idx < num_threads; idx++) {
+        mine_block_worker_args_t *worker = &workers[idx];
+        worker->blockchain = blockchain;
+        worker->sync = sync;
+        worker->block = *block;
+        blockchain_get_proof_of_work_range(
+            idx,
+            num_threads,
+            &worker->first_proof_of_work,
+            &worker->last_proof_of_work);
+        worker->progress = print_progress ? &progress : NULL;
+        worker->should_stop = should_stop;
+        worker->sync_version_currently_mined = sync_version_currently_mined;
+        worker->found_valid_proof_of_work = &found_valid_proof_of_work;
+        atomic_init(&worker->num_hashes, 0);
+    }
+    // Rendering progress happens on its own thread so that it costs the
+    // workers nothing.
+    report_mining_progress_args_t reporter_args = {0};
+    reporter_args.workers = workers;
+    reporter_args.num_workers = num_threads;
+    reporter_args.progress = &progress;
+    pthread_t reporter_thread;
+    bool reporter_started = false;
+    if (print_progress) {
+        if (0 != pthread_create(
+            &reporter_thread,
+            NULL,
+            report_mining_progress_pthread_wrapper,
+            &reporter_args)) {
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            goto cleanup;
+        }
+        reporter_started = true;
+    }
+    // The calling thread searches the first range itself.
+    size_t num_threads_started = 1;
+    for (; num_threads_started < num_threads; num_threads_started++) {
+        if (0 != pthread_create(
+            &threads[num_threads_started],
+            NULL,
+            mine_block_worker_pthread_wrapper,
+            &workers[num_threads_started])) {
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            // Cancel the workers that did start.
+            atomic_store(&found_valid_proof_of_work, true);
+            break;
+        }
+    }
+    if (SUCCESS == return_code) {
+        mine_block_worker(&workers[0]);
+    }
+    for (size_t idx = 1; idx < num_threads_started; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+    if (reporter_started) {
+        pthread_mutex_lock(&progress.mutex);
+        progress.is_done = true;
+        pthread_cond_signal(&progress.reporter_cond);
+        pthread_mutex_unlock(&progress.mutex);
+        pthread_join(reporter_thread, NULL);
+    }
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    mine_block_worker_args_t *winner = NULL;
+    bool stopped_early = false;
+    bool longer_blockchain_detected = false;
+    for (size_t idx = 0; idx < num_threads; idx++) {
+        mine_block_worker_args_t *worker = &workers[idx];
+        if (worker->is_winner) {
+            winner = worker;
+        }
+        switch (worker->return_code) {
+            case SUCCESS:
+            case FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK:
+                break;
+            case FAILURE_STOPPED_EARLY:
+                stopped_early = true;
+                break;
+            case FAILURE_LONGER_BLOCKCHAIN_DETECTED:
+                longer_blockchain_detected = true;
+                break;
+            default:
+                return_code = worker->return_code;
+                goto cleanup;
+        }
+    }
+    if (NULL != winner) {
+        block->proof_of_work = winner->block.proof_of_work;
+        if (print_progress) {
+            print_mining_result(&winner->hash, ANSI_COLOR_GREEN);
+        }
+    } else if (stopped_early) {
+        return_code = FAILURE_STOPPED_EARLY;
+    } else if (longer_blockchain_detected) {
+        if (print_progress && progress.has_best_hash) {
+            print_mining_result(&progress.best_hash, ANSI_COLOR_LIGHT_BLUE);
+        }
+        return_code = FAILURE_LONGER_BLOCKCHAIN_DETECTED;
+    } else {
+        return_code = FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK;
+    }
+    if (print_progress && FAILURE_STOPPED_EARLY != return_code) {
+        double aggregate_hash_rate = 0;
+        for (size_t idx = 0; idx < num_threads; idx++) {
+            if (workers[idx].elapsed_seconds > 0) {
+                aggregate_hash_rate +=
+                    atomic_load(&workers[idx].num_hashes) /
+                    workers[idx].elapsed_seconds;
+            }
+        }
+        printf(
+            "Hash rate: %.0f hashes/sec across %zu thread(s)\n",
+            aggregate_hash_rate,
+            num_threads);
+        for (size_t idx = 0; num_threads > 1 && idx < num_threads; idx++) {
+            double hash_rate = 0;
+            if (workers[idx].elapsed_seconds > 0) {
+                hash_rate = atomic_load(&workers[idx].num_hashes) /
+                    workers[idx].elapsed_seconds;
+            }
+            printf("  Thread %zu: %.0f hashes/sec\n", idx, hash_rate);
+        }
+    }
+cleanup:
+    pthread_cond_destroy(&progress.reporter_cond);
+    pthread_mutex_destroy(&progress.mutex);
+    free(threads);
+    free(workers);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_mine_block(
+    blockchain_t *blockchain,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain ||
+        NULL == block ||
+        NULL == should_stop ||
+        0 == num_threads) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    return_code = mine_block_with_workers(
+        blockchain,
+        NULL,
+        block,
+        print_progress,
+        should_stop,
+        NULL,
+        num_threads);
+end:
+    return return_code;
+}
+
+return_code_t synchronized_blockchain_mine_block(
+    synchronized_blockchain_t *sync,
+    block_t *block,
+    bool print_progress,
+    atomic_bool *should_stop,
+    atomic_size_t *sync_version_currently_mined,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == sync ||
+        NULL == block ||
+        NULL == should_stop ||
+        NULL == sync_version_currently_mined ||
+        0 == num_threads) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_t *published_blockchain = NULL;
+    size_t reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        sync, &published_blockchain, &reader);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // The workers only read the difficulty, so give them a copy of it that
+    // outlives any blockchain that sync replaces meanwhile.
+    blockchain_t blockchain = {0};
+    blockchain.num_leading_zero_bytes_required_in_block_hash =
+        published_blockchain->num_leading_zero_bytes_required_in_block_hash;
+    synchronized_blockchain_read_end(sync, reader);
+    return_code = mine_block_with_workers(
+        &blockchain,
+        sync,
+        block,
+        print_progress,
+        should_stop,
+        sync_version_currently_mined,
+        num_threads);
+end:
+    return return_code;
+}
+
+void blockchain_print(blockchain_t *blockchain) {
+    if (NULL == blockchain) {
+        return;
+    }
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        printf("%"PRIu64"->", blockchain->blocks[height]->proof_of_work);
+    }
+    printf("\n");
+}
+
+return_code_t blockchain_verify_genesis_block(
+    block_t *genesis_block,
+    bool *is_valid_block
+) {
+    return_code_t return_code = SUCCESS;
+    bool genesis_block_transaction_list_is_empty = false;
+    return_code = linked_list_is_empty(
+        genesis_block->transaction_list,
+        &genesis_block_transaction_list_is_empty);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    sha_256_t empty_block_hash = {0};
+    *is_valid_block = genesis_block_transaction_list_is_empty &&
+        genesis_block->proof_of_work == GENESIS_BLOCK_PROOF_OF_WORK &&
+        0 == memcmp(
+            &genesis_block->previous_block_hash,
+            &empty_block_hash,
+            sizeof(sha_256_t)) &&
+        0 == memcmp(
+            &genesis_block->merkle_root,
+            &empty_block_hash,
+            sizeof(sha_256_t));
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify_block(
+    blockchain_t *blockchain,
+    block_t *block,
+    sha_256_t *previous_block_hash,
+    sha_256_t *block_hash_out,
+    bool *is_valid_block
+) {
+    return_code_t return_code = SUCCESS;
+    *is_valid_block = false;
+    return_code = block_hash(block, block_hash_out);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    sha_256_t empty_block_hash = {0};
+    if (0 != memcmp(
+            block_hash_out,
+            &empty_block_hash,
+            blockchain->num_leading_zero_bytes_required_in_block_hash)) {
+        goto end;
+    }
+    if (0 != memcmp(
+        &block->previous_block_hash,
+        previous_block_hash,
+        sizeof(sha_256_t))) {
+        goto end;
+    }
+    // The header must commit to exactly the transactions in the block.
+    sha_256_t merkle_root = {0};
+    return_code = block_compute_merkle_root(block, &merkle_root);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != memcmp(&block->merkle_root, &merkle_root, sizeof(sha_256_t))) {
+        goto end;
+    }
+    // Every block must contain at least the minting transaction.
+    bool block_transaction_list_is_empty = false;
+    return_code = linked_list_is_empty(
+        block->transaction_list,
+        &block_transaction_list_is_empty);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (block_transaction_list_is_empty) {
+        goto end;
+    }
+    node_t *minting_transaction_node = block->transaction_list->head;
+    transaction_t *minting_transaction =
+        (transaction_t *)minting_transaction_node->data;
+    if (AMOUNT_GENERATED_DURING_MINTING != minting_transaction->amount ||
+        0 != memcmp(
+            &minting_transaction->sender_public_key,
+            &minting_transaction->recipient_public_key,
+            sizeof(public_key_t))) {
+        goto end;
+    }
+    // Check that every transaction has a valid signature.
+    for (node_t *transaction_node = minting_transaction_node;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        transaction_t *transaction = (transaction_t *)transaction_node->data;
+        bool is_valid_signature = false;
+        return_code = transaction_verify_signature(
+            &is_valid_signature, transaction);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (!is_valid_signature) {
+            goto end;
+        }
+    }
+    *is_valid_block = true;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+) {
+    blockchain_verified_prefix_t verified_prefix = {0};
+    return blockchain_verify_incremental(
+        blockchain,
+        &verified_prefix,
+        is_valid_blockchain,
+        first_invalid_block,
+        1);
+}
+
+return_code_t blockchain_verify_parallel(
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    size_t num_threads
+) {
+    blockchain_verified_prefix_t verified_prefix = {0};
+    return blockchain_verify_incremental(
+        blockchain,
+        &verified_prefix,
+        is_valid_blockchain,
+        first_invalid_block,
+        num_threads);
+}
+
+/**
+ * @brief Contains the state of one block verification thread.
+ * 
+ * Workers claim chunks of consecutive blocks in increasing order. Each block
+ * can be checked independently because its predecessor's hash can be
+ * recomputed from the predecessor's header.
+ * 
+ * @param blockchain The blockchain whose difficulty the blocks must meet.
+ * @param blocks The blocks to verify, in order.
+ * @param num_blocks The number of blocks to verify.
+ * @param chunk_size The number of blocks claimed at a time.
+ * @param previous_block_hash The hash of the block before blocks[0].
+ * @param next_chunk_start Shared by all workers. The index of the first block
+ * in the next unclaimed chunk.
+ * @param first_invalid_index Shared by all workers. The lowest index of an
+ * invalid block found so far, or num_blocks if none has been found. Blocks
+ * after it no longer matter, so workers skip them.
+ * @param should_stop Shared by all workers. Set if any worker fails.
+ * @param return_code The worker's return code.
+ */
+typedef struct verify_blocks_worker_args_t {
+    blockchain_t *blockchain;
+    block_t **blocks;
+    uint64_t num_blocks;
+    uint64_t chunk_size;
+    sha_256_t *previous_block_hash;
+    atomic_uint_fast64_t *next_chunk_start;
+    atomic_uint_fast64_t *first_invalid_index;
+    atomic_bool *should_stop;
+    return_code_t return_code;
+} verify_blocks_worker_args_t;
+
+void record_invalid_block_index(
+    atomic_uint_fast64_t *first_invalid_index,
+    uint_fast64_t index
+) {
+    uint_fast64_t current_index = atomic_load(first_invalid_index);
+    while (index < current_index &&
+        !atomic_compare_exchange_weak(
+            first_invalid_index, &current_index, index)) {
+    }
+}
+
+return_code_t verify_blocks_worker(verify_blocks_worker_args_t *args) {
+    return_code_t return_code = SUCCESS;
+    while (!atomic_load(args->should_stop)) {
+        uint64_t chunk_start = atomic_fetch_add(
+            args->next_chunk_start, args->chunk_size);
+        // Chunks are claimed in increasing order, so once one starts past an
+        // invalid block, so do all the rest.
+        if (chunk_start >= args->num_blocks ||
+            chunk_start >= atomic_load(args->first_invalid_index)) {
+            break;
+        }
+        uint64_t chunk_end = chunk_start + args->chunk_size;
+        if (chunk_end > args->num_blocks) {
+            chunk_end = args->num_blocks;
+        }
+        sha_256_t previous_block_hash = *args->previous_block_hash;
+        if (0 != chunk_start) {
+            return_code = block_hash(
+                args->blocks[chunk_start - 1], &previous_block_hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+        for (uint64_t idx = chunk_start; idx < chunk_end; idx++) {
+            if (idx >= atomic_load(args->first_invalid_index) ||
+                atomic_load(args->should_stop)) {
+                break;
+            }
+            sha_256_t current_block_hash = {0};
+            bool is_valid_block = false;
+            return_code = blockchain_verify_block(
+                args->blockchain,
+                args->blocks[idx],
+                &previous_block_hash,
+                &current_block_hash,
+                &is_valid_block);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            if (!is_valid_block) {
+                record_invalid_block_index(args->first_invalid_index, idx);
+                break;
+            }
+            previous_block_hash = current_block_hash;
+        }
+    }
+end:
+    if (SUCCESS != return_code) {
+        atomic_store(args->should_stop, true);
+    }
+    args->return_code = return_code;
+    return return_code;
+}
+
+void *verify_blocks_worker_pthread_wrapper(void *args) {
+    verify_blocks_worker((verify_blocks_worker_args_t *)args);
+    return NULL;
+}
+
+return_code_t verify_blocks_with_workers(
+    blockchain_t *blockchain,
+    block_t **blocks,
+    uint64_t num_blocks,
+    sha_256_t *previous_block_hash,
+    size_t num_threads,
+    uint64_t *first_invalid_index
+) {
+    return_code_t return_code = SUCCESS;
+    // Several chunks per thread balance the load when some blocks hold more
+    // transactions than others.
+    uint64_t chunk_size =
+        num_blocks / (num_threads * BLOCKCHAIN_VERIFY_CHUNKS_PER_THREAD);
+    if (chunk_size < 1) {
+        chunk_size = 1;
+    }
+    if (chunk_size > BLOCKCHAIN_VERIFY_MAX_CHUNK_SIZE) {
+        chunk_size = BLOCKCHAIN_VERIFY_MAX_CHUNK_SIZE;
+    }
+    uint64_t num_chunks = (num_blocks + chunk_size - 1) / chunk_size;
+    if (num_threads > num_chunks) {
+        num_threads = num_chunks;
+    }
+    verify_blocks_worker_args_t *workers = calloc(
+        num_threads, sizeof(verify_blocks_worker_args_t));
+    if (NULL == workers) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    if (NULL == threads) {
+        free(workers);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    atomic_uint_fast64_t next_chunk_start;
+    atomic_init(&next_chunk_start, 0);
+    atomic_uint_fast64_t shared_first_invalid_index;
+    atomic_init(&shared_first_invalid_index, num_blocks);
+    atomic_bool should_stop = false;
+    for (size_t idx = 0; idx < num_threads; idx++) {
+        verify_blocks_worker_args_t *worker = &workers[idx];
+        worker->blockchain = blockchain;
+        worker->blocks = blocks;
+        worker->num_blocks = num_blocks;
+        worker->chunk_size = chunk_size;
+        worker->previous_block_hash = previous_block_hash;
+        worker->next_chunk_start = &next_chunk_start;
+        worker->first_invalid_index = &shared_first_invalid_index;
+        worker->should_stop = &should_stop;
+    }
+    // The calling thread acts as the first worker.
+    size_t num_threads_started = 1;
+    for (; num_threads_started < num_threads; num_threads_started++) {
+        if (0 != pthread_create(
+            &threads[num_threads_started],
+            NULL,
+            verify_blocks_worker_pthread_wrapper,
+            &workers[num_threads_started])) {
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            // Cancel the workers that did start.
+            atomic_store(&should_stop, true);
+            break;
+        }
+    }
+    if (SUCCESS == return_code) {
+        verify_blocks_worker(&workers[0]);
+    }
+    for (size_t idx = 1; idx < num_threads_started; idx++) {
+        pthread_join(threads[idx], NULL);
+    }
+    if (SUCCESS != return_code) {
+        goto cleanup;
+    }
+    for (size_t idx = 0; idx < num_threads; idx++) {
+        if (SUCCESS != workers[idx].return_code) {
+            return_code = workers[idx].return_code;
+            goto cleanup;
+        }
+    }
+    *first_invalid_index = atomic_load(&shared_first_invalid_index);
+cleanup:
+    free(threads);
+    free(workers);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify_blocks(
+    blockchain_t *blockchain,
+    uint64_t first_height,
+    uint64_t end_height,
+    sha_256_t *previous_block_hash,
+    size_t num_threads,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block
+) {
+    return_code_t return_code = SUCCESS;
+    *is_valid_blockchain = false;
+    uint64_t num_blocks_to_verify = end_height - first_height;
+    if (0 == num_blocks_to_verify) {
+        *is_valid_blockchain = true;
+        goto end;
+    }
+    block_t **blocks = &blockchain->blocks[first_height];
+    if (1 == num_threads || 1 == num_blocks_to_verify) {
+        for (uint64_t idx = 0; idx < num_blocks_to_verify; idx++) {
+            sha_256_t current_block_hash = {0};
+            bool is_valid_block = false;
+            return_code = blockchain_verify_block(
+                blockchain,
+                blocks[idx],
+                previous_block_hash,
+                &current_block_hash,
+                &is_valid_block);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            if (!is_valid_block) {
+                if (NULL != first_invalid_block) {
+                    *first_invalid_block = blocks[idx];
+                }
+                goto end;
+            }
+            *previous_block_hash = current_block_hash;
+        }
+        *is_valid_blockchain = true;
+        goto end;
+    }
+    uint64_t first_invalid_index = num_blocks_to_verify;
+    return_code = verify_blocks_with_workers(
+        blockchain,
+        blocks,
+        num_blocks_to_verify,
+        previous_block_hash,
+        num_threads,
+        &first_invalid_index);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Every block before the lowest invalid index was checked, so this is the
+    // block a sequential verification would have reported.
+    if (first_invalid_index < num_blocks_to_verify) {
+        if (NULL != first_invalid_block) {
+            *first_invalid_block = blocks[first_invalid_index];
+        }
+        goto end;
+    }
+    return_code = block_hash(
+        blocks[num_blocks_to_verify - 1], previous_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *is_valid_blockchain = true;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify_prefix_matches(
+    blockchain_t *blockchain,
+    blockchain_verified_prefix_t *verified_prefix,
+    bool *prefix_matches
+) {
+    return_code_t return_code = SUCCESS;
+    *prefix_matches = false;
+    block_t *tip_block = blockchain->blocks[verified_prefix->num_blocks - 1];
+    sha_256_t tip_hash = {0};
+    return_code = block_hash(tip_block, &tip_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != memcmp(&tip_hash, &verified_prefix->tip_hash, sizeof(sha_256_t))) {
+        goto end;
+    }
+    if (tip_block == verified_prefix->tip_block) {
+        // This is the very blockchain that was verified, so its prefix is
+        // already known to be valid.
+        *prefix_matches = true;
+        goto end;
+    }
+    // Another blockchain (e.g., a peer's) with the same tip block has the same
+    // prefix only if its earlier blocks really are the ones the tip commits
+    // to. Checking the hash links and Merkle roots establishes that without
+    // repeating the signature checks.
+    for (uint64_t height = 0; height < verified_prefix->num_blocks; height++) {
+        block_t *block = blockchain->blocks[height];
+        if (height + 1 < verified_prefix->num_blocks) {
+            sha_256_t hash = {0};
+            return_code = block_hash(block, &hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            if (0 != memcmp(
+                &hash,
+                &blockchain->blocks[height + 1]->previous_block_hash,
+                sizeof(sha_256_t))) {
+                goto end;
+            }
+        }
+        sha_256_t merkle_root = {0};
+        return_code = block_compute_merkle_root(block, &merkle_root);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (0 != memcmp(&merkle_root, &block->merkle_root, sizeof(sha_256_t))) {
+            goto end;
+        }
+    }
+    *prefix_matches = true;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_verify_incremental(
+    blockchain_t *blockchain,
+    blockchain_verified_prefix_t *verified_prefix,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain ||
+        NULL == verified_prefix ||
+        NULL == is_valid_blockchain ||
+        0 == num_threads) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 == blockchain->num_blocks) {
+        *is_valid_blockchain = true;
+        memset(verified_prefix, 0, sizeof(blockchain_verified_prefix_t));
+        goto end;
+    }
+    // The ledger found any overspending block as blocks were added, so the
+    // other checks only need to cover the blocks before it.
+    uint64_t num_blocks_to_check =
+        blockchain->ledger->num_blocks_without_overspend;
+    if (num_blocks_to_check > blockchain->num_blocks) {
+        num_blocks_to_check = blockchain->num_blocks;
+    }
+    // Find where verification needs to resume. The prefix only applies if
+    // this blockchain has the same block at the same height.
+    uint64_t num_verified_blocks = 0;
+    sha_256_t previous_block_hash = {0};
+    if (0 != verified_prefix->num_blocks &&
+        verified_prefix->num_blocks <= num_blocks_to_check &&
+        verified_prefix->num_leading_zero_bytes_required_in_block_hash ==
+        blockchain->num_leading_zero_bytes_required_in_block_hash) {
+        bool prefix_matches = false;
+        return_code = blockchain_verify_prefix_matches(
+            blockchain, verified_prefix, &prefix_matches);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (prefix_matches) {
+            num_verified_blocks = verified_prefix->num_blocks;
+            previous_block_hash = verified_prefix->tip_hash;
+        }
+    }
+    if (0 == num_verified_blocks) {
+        // Check the genesis block, which is unique.
+        block_t *genesis_block = blockchain->blocks[0];
+        bool is_valid_block = false;
+        return_code = blockchain_verify_genesis_block(
+            genesis_block, &is_valid_block);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (!is_valid_block) {
+            *is_valid_blockchain = false;
+            if (NULL != first_invalid_block) {
+                *first_invalid_block = genesis_block;
+            }
+            goto end;
+        }
+        return_code = block_hash(genesis_block, &previous_block_hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        num_verified_blocks = 1;
+    }
+    // Check the remaining blocks. A valid genesis block has no transactions,
+    // so it never overspends.
+    if (num_blocks_to_check < num_verified_blocks) {
+        num_blocks_to_check = num_verified_blocks;
+    }
+    return_code = blockchain_verify_blocks(
+        blockchain,
+        num_verified_blocks,
+        num_blocks_to_check,
+        &previous_block_hash,
+        num_threads,
+        is_valid_blockchain,
+        first_invalid_block);
+    if (SUCCESS != return_code || !*is_valid_blockchain) {
+        goto end;
+    }
+    if (num_blocks_to_check < blockchain->num_blocks) {
+        *is_valid_blockchain = false;
+        if (NULL != first_invalid_block) {
+            *first_invalid_block = blockchain->blocks[num_blocks_to_check];
+        }
+        goto end;
+    }
+    verified_prefix->num_blocks = blockchain->num_blocks;
+    verified_prefix->tip_block = blockchain->blocks[blockchain->num_blocks - 1];
+    verified_prefix->tip_hash = previous_block_hash;
+    verified_prefix->num_leading_zero_bytes_required_in_block_hash =
+        blockchain->num_leading_zero_bytes_required_in_block_hash;
+end:
+    return return_code;
+}
+
+return_code_t synchronized_blockchain_verify(
+    synchronized_blockchain_t *sync,
+    blockchain_t *blockchain,
+    bool *is_valid_blockchain,
+    block_t **first_invalid_block,
+    blockchain_verified_prefix_t *verified_prefix,
+    size_t num_threads
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == sync ||
+        NULL == blockchain ||
+        NULL == is_valid_blockchain ||
+        0 == num_threads) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    blockchain_verified_prefix_t new_verified_prefix = sync->verified_prefix;
+    // Keep the copied tip block alive for the same reason sync does.
+    block_t *prefix_tip_block = new_verified_prefix.tip_block;
+    if (NULL != prefix_tip_block) {
+        block_retain(prefix_tip_block);
+    }
+    if (0 != pthread_mutex_unlock(&sync->mutex)) {
+        if (NULL != prefix_tip_block) {
+            block_release(prefix_tip_block);
+        }
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    // Verify without holding the lock; the prefix is checked against the
+    // blockchain itself, so it does not matter if it changes meanwhile.
+    return_code = blockchain_verify_incremental(
+        blockchain,
+        &new_verified_prefix,
+        is_valid_blockchain,
+        first_invalid_block,
+        num_threads);
+    if (NULL != prefix_tip_block) {
+        block_release(prefix_tip_block);
+    }
+    if (SUCCESS != return_code || !*is_valid_blockchain) {
+        goto end;
+    }
+    if (NULL != verified_prefix) {
+        *verified_prefix = new_verified_prefix;
+    }
+    if (0 != pthread_mutex_lock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    // Views share their blocks with sync's blockchain, so the prefix carries
+    // over whenever sync's active chain holds the same tip block.
+    uint64_t tip_height = new_verified_prefix.num_blocks - 1;
+    if (new_verified_prefix.num_blocks > sync->verified_prefix.num_blocks &&
+        tip_height < sync->blockchain->num_blocks &&
+        new_verified_prefix.tip_block ==
+            sync->blockchain->blocks[tip_height]) {
+        synchronized_blockchain_set_verified_prefix(
+            sync, &new_verified_prefix);
+    }
+    if (0 != pthread_mutex_unlock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t synchronized_blockchain_adopt_peer_blockchain(
+    synchronized_blockchain_t *sync,
+    blockchain_t *peer_blockchain,
+    blockchain_verified_prefix_t *peer_verified_prefix,
+    bool *tip_changed,
+    bool *took_ownership
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == sync ||
+        NULL == peer_blockchain ||
+        NULL == peer_verified_prefix ||
+        NULL == tip_changed ||
+        NULL == took_ownership) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    *tip_changed = false;
+    *took_ownership = false;
+    blockchain_t *blockchain = sync->blockchain;
+    if (blockchain->num_leading_zero_bytes_required_in_block_hash !=
+        peer_blockchain->num_leading_zero_bytes_required_in_block_hash ||
+        0 == peer_blockchain->num_blocks) {
+        goto end;
+    }
+    // Nothing changes when the tree already holds the peer's whole chain.
+    sha_256_t peer_tip_hash = {0};
+    return_code = block_hash(
+        peer_blockchain->blocks[peer_blockchain->num_blocks - 1],
+        &peer_tip_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    block_hash_index_entry_t *entry = NULL;
+    if (SUCCESS == block_hash_index_find(
+        blockchain->hash_index, &peer_tip_hash, &entry)) {
+        goto end;
+    }
+    // A peer chain that extends ours only appends to it, which snapshots
+    // allow in place.
+    bool appends_only = false;
+    if (peer_blockchain->num_blocks > blockchain->num_blocks) {
+        sha_256_t hash = {0};
+        return_code = block_hash(
+            peer_blockchain->blocks[blockchain->num_blocks - 1], &hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        appends_only = 0 == memcmp(
+            &hash,
+            &blockchain->blocks[blockchain->num_blocks - 1]->hash,
+            sizeof(sha_256_t));
+    }
+    return_code = synchronized_blockchain_prepare_write(
+        sync, peer_blockchain->num_blocks, appends_only);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_merge(blockchain, peer_blockchain, tip_changed);
+    if (FAILURE_BLOCK_NOT_FOUND == return_code) {
+        return_code = SUCCESS;
+        if (peer_blockchain->num_blocks > blockchain->num_blocks) {
+            return_code = synchronized_blockchain_publish(
+                sync, peer_blockchain);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            synchronized_blockchain_set_verified_prefix(
+                sync, peer_verified_prefix);
+            atomic_fetch_add(&sync->version, 1);
+            *tip_changed = true;
+            *took_ownership = true;
+        }
+        goto end;
+    }
+    // Each block the merge added left the blockchain valid, so publish even
+    // if a later one failed.
+    return_code_t merge_return_code = return_code;
+    if (!*tip_changed) {
+        goto end;
+    }
+    return_code = synchronized_blockchain_publish(sync, blockchain);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // The active chain now ends in the peer's verified blocks.
+    blockchain_verified_prefix_t verified_prefix = *peer_verified_prefix;
+    uint64_t tip_height = 0;
+    return_code = blockchain_find_block_by_hash(
+        blockchain,
+        &verified_prefix.tip_hash,
+        &verified_prefix.tip_block,
+        &tip_height);
+    if (SUCCESS == return_code &&
+        tip_height + 1 == verified_prefix.num_blocks) {
+        synchronized_blockchain_set_verified_prefix(sync, &verified_prefix);
+    } else {
+        synchronized_blockchain_set_verified_prefix(sync, NULL);
+    }
+    return_code = merge_return_code;
+    atomic_fetch_add(&sync->version, 1);
+end:
+    return return_code;
+}
+
+void blockchain_write_uint16(unsigned char *buffer, uint16_t value) {
+    buffer[0] = value >> 8;
+    buffer[1] = value & 0xff;
+}
+
+uint16_t blockchain_read_uint16(unsigned char *buffer) {
+    return ((uint16_t)buffer[0] << 8) | buffer[1];
+}
+
+void blockchain_write_uint32(unsigned char *buffer, uint32_t value) {
+    blockchain_write_uint16(buffer, value >> 16);
+    blockchain_write_uint16(buffer + sizeof(uint16_t), value & 0xffff);
+}
+
+uint32_t blockchain_read_uint32(unsigned char *buffer) {
+    return ((uint32_t)blockchain_read_uint16(buffer) << 16) |
+        blockchain_read_uint16(buffer + sizeof(uint16_t));
+}
+
+uint64_t blockchain_varint_size(uint64_t value) {
+    uint64_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+return_code_t blockchain_read_varint(
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint64_t *value
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t result = 0;
+    for (size_t idx = 0; ; idx++) {
+        if (*next_spot_in_buffer == buffer_end) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        unsigned char byte = **next_spot_in_buffer;
+        (*next_spot_in_buffer)++;
+        // The last byte of a 64 bit value can only hold its top bit.
+        if (BLOCKCHAIN_VARINT_MAX_SIZE - 1 == idx && byte > 1) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+        // A last byte of zero only pads the value, and accepting padding
+        // would give one value several encodings.
+        if (idx > 0 && 0 == byte) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+        result |= (uint64_t)(byte & 0x7f) << (7 * idx);
+        if (0 == (byte & 0x80)) {
+            break;
+        }
+    }
+    *value = result;
+end:
+    return return_code;
+}
+
+uint64_t blockchain_serialized_transaction_size(transaction_t *transaction) {
+    return blockchain_varint_size(transaction->created_at) +
+        blockchain_varint_size(transaction->sender_public_key.length) +
+        transaction->sender_public_key.length +
+        blockchain_varint_size(transaction->recipient_public_key.length) +
+        transaction->recipient_public_key.length +
+        blockchain_varint_size(transaction->amount) +
+        blockchain_varint_size(transaction->sender_signature.length) +
+        transaction->sender_signature.length;
+}
+
+/**
+ * @brief A position in a list of output buffers.
+ * 
+ * @param buffers The buffers, filled in order.
+ * @param num_buffers The number of buffers.
+ * @param buffer_idx The buffer holding the next byte.
+ * @param offset The position of the next byte in that buffer.
+ */
+typedef struct blockchain_serialization_cursor_t {
+    struct iovec *buffers;
+    size_t num_buffers;
+    size_t buffer_idx;
+    size_t offset;
+} blockchain_serialization_cursor_t;
+
+void blockchain_cursor_write(
+    blockchain_serialization_cursor_t *cursor,
+    const void *data,
+    size_t size
+) {
+    // The caller has checked that the buffers hold the whole serialization,
+    // so this never runs past the last one. Most writes fit in the current
+    // buffer and take a single memcpy.
+    const unsigned char *next_byte = data;
+    while (0 != size) {
+        struct iovec *buffer = &cursor->buffers[cursor->buffer_idx];
+        size_t num_available_bytes = buffer->iov_len - cursor->offset;
+        if (0 == num_available_bytes) {
+            cursor->buffer_idx++;
+            cursor->offset = 0;
+            continue;
+        }
+        size_t num_bytes_to_copy =
+            size < num_available_bytes ? size : num_available_bytes;
+        memcpy(
+            (unsigned char *)buffer->iov_base + cursor->offset,
+            next_byte,
+            num_bytes_to_copy);
+        cursor->offset += num_bytes_to_copy;
+        next_byte += num_bytes_to_copy;
+        size -= num_bytes_to_copy;
+    }
+}
+
+void blockchain_cursor_write_varint(
+    blockchain_serialization_cursor_t *cursor,
+    uint64_t value
+) {
+    unsigned char bytes[BLOCKCHAIN_VARINT_MAX_SIZE];
+    size_t size = 0;
+    while (value >= 0x80) {
+        bytes[size] = (unsigned char)(value | 0x80);
+        value >>= 7;
+        size++;
+    }
+    bytes[size] = (unsigned char)value;
+    size++;
+    blockchain_cursor_write(cursor, bytes, size);
+}
+
+void blockchain_serialize_transaction(
+    blockchain_serialization_cursor_t *cursor,
+    transaction_t *transaction
+) {
+    blockchain_cursor_write_varint(cursor, transaction->created_at);
+    public_key_t *keys[] = {
+        &transaction->sender_public_key,
+        &transaction->recipient_public_key};
+    for (size_t idx = 0; idx < sizeof(keys) / sizeof(keys[0]); idx++) {
+        blockchain_cursor_write_varint(cursor, keys[idx]->length);
+        blockchain_cursor_write(cursor, keys[idx]->bytes, keys[idx]->length);
+    }
+    blockchain_cursor_write_varint(cursor, transaction->amount);
+    blockchain_cursor_write_varint(
+        cursor, transaction->sender_signature.length);
+    blockchain_cursor_write(
+        cursor,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length);
+}
+
+return_code_t blockchain_deserialize_transaction(
+    transaction_t *transaction,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_end - *next_spot_in_buffer < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t created_at = 0;
+    memcpy(&created_at, *next_spot_in_buffer, sizeof(created_at));
+    transaction->created_at = betoh64(created_at);
+    *next_spot_in_buffer += sizeof(created_at);
+    public_key_t *keys[] = {
+        &transaction->sender_public_key,
+        &transaction->recipient_public_key};
+    for (size_t idx = 0; idx < sizeof(keys) / sizeof(keys[0]); idx++) {
+        if (buffer_end - *next_spot_in_buffer < sizeof(uint16_t)) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        uint16_t key_length = blockchain_read_uint16(*next_spot_in_buffer);
+        *next_spot_in_buffer += sizeof(uint16_t);
+        if (key_length > MAX_PUBLIC_KEY_LENGTH) {
+            return_code = FAILURE_KEY_TOO_LONG;
+            goto end;
+        }
+        if (buffer_end - *next_spot_in_buffer < key_length) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        memcpy(keys[idx]->bytes, *next_spot_in_buffer, key_length);
+        keys[idx]->length = key_length;
+        *next_spot_in_buffer += key_length;
+    }
+    if (buffer_end - *next_spot_in_buffer <
+        sizeof(uint64_t) + sizeof(uint16_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t amount = 0;
+    memcpy(&amount, *next_spot_in_buffer, sizeof(amount));
+    transaction->amount = betoh64(amount);
+    *next_spot_in_buffer += sizeof(amount);
+    uint16_t signature_length = blockchain_read_uint16(*next_spot_in_buffer);
+    *next_spot_in_buffer += sizeof(uint16_t);
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer < signature_length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    memcpy(
+        transaction->sender_signature.bytes,
+        *next_spot_in_buffer,
+        signature_length);
+    transaction->sender_signature.length = signature_length;
+    *next_spot_in_buffer += signature_length;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_read_varint_length_prefixed(
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint64_t max_length,
+    return_code_t too_long_return_code,
+    unsigned char *bytes,
+    size_t *length
+) {
+    uint64_t field_length = 0;
+    return_code_t return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &field_length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (field_length > max_length) {
+        return_code = too_long_return_code;
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer < field_length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    if (NULL != bytes) {
+        memcpy(bytes, *next_spot_in_buffer, field_length);
+    }
+    *length = field_length;
+    *next_spot_in_buffer += field_length;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_varint_transaction(
+    transaction_t *transaction,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    // With no transaction to fill, this only checks and skips the bytes.
+    transaction_t ignored_fields = {0};
+    transaction_t *target = NULL == transaction ? &ignored_fields : transaction;
+    uint64_t created_at = 0;
+    return_code_t return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &created_at);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    target->created_at = (time_t)created_at;
+    public_key_t *keys[] = {
+        &target->sender_public_key,
+        &target->recipient_public_key};
+    for (size_t idx = 0; idx < sizeof(keys) / sizeof(keys[0]); idx++) {
+        size_t key_length = 0;
+        return_code = blockchain_read_varint_length_prefixed(
+            next_spot_in_buffer,
+            buffer_end,
+            MAX_PUBLIC_KEY_LENGTH,
+            FAILURE_KEY_TOO_LONG,
+            NULL == transaction ? NULL : keys[idx]->bytes,
+            &key_length);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        keys[idx]->length = (uint16_t)key_length;
+    }
+    return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &target->amount);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_read_varint_length_prefixed(
+        next_spot_in_buffer,
+        buffer_end,
+        MAX_SSH_SIGNATURE_LENGTH,
+        FAILURE_SIGNATURE_TOO_LONG,
+        NULL == transaction ? NULL : target->sender_signature.bytes,
+        &target->sender_signature.length);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_legacy_transaction(
+    transaction_t *transaction,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t legacy_transaction_size =
+        sizeof(uint64_t) +
+        2 * sizeof(ssh_key_t) +
+        sizeof(transaction->amount) +
+        sizeof(uint64_t) +
+        MAX_SSH_SIGNATURE_LENGTH;
+    if (buffer_end - *next_spot_in_buffer < legacy_transaction_size) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t created_at = 0;
+    memcpy(&created_at, *next_spot_in_buffer, sizeof(created_at));
+    transaction->created_at = betoh64(created_at);
+    *next_spot_in_buffer += sizeof(created_at);
+    public_key_t *keys[] = {
+        &transaction->sender_public_key,
+        &transaction->recipient_public_key};
+    for (size_t idx = 0; idx < sizeof(keys) / sizeof(keys[0]); idx++) {
+        ssh_key_t legacy_key = {0};
+        memcpy(legacy_key.bytes, *next_spot_in_buffer, sizeof(ssh_key_t));
+        *next_spot_in_buffer += sizeof(ssh_key_t);
+        return_code = public_key_from_ssh_key(keys[idx], &legacy_key);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        // The transaction's hash and signature cover the PEM string, so the
+        // compact key must convert back to exactly the same bytes.
+        ssh_key_t converted_key = {0};
+        return_code = public_key_to_ssh_key(&converted_key, keys[idx]);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (0 != memcmp(&legacy_key, &converted_key, sizeof(ssh_key_t))) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+    }
+    uint64_t amount = 0;
+    memcpy(&amount, *next_spot_in_buffer, sizeof(amount));
+    transaction->amount = betoh64(amount);
+    *next_spot_in_buffer += sizeof(amount);
+    uint64_t signature_length = 0;
+    memcpy(&signature_length, *next_spot_in_buffer, sizeof(signature_length));
+    signature_length = betoh64(signature_length);
+    *next_spot_in_buffer += sizeof(signature_length);
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    memcpy(
+        transaction->sender_signature.bytes,
+        *next_spot_in_buffer,
+        signature_length);
+    transaction->sender_signature.length = signature_length;
+    *next_spot_in_buffer += MAX_SSH_SIGNATURE_LENGTH;
+end:
+    return return_code;
+}
+
+uint64_t blockchain_serialized_block_size(block_t *block) {
+    uint64_t size = 0;
+    uint64_t num_transactions_in_block = 0;
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        size += blockchain_serialized_transaction_size(
+            (transaction_t *)transaction_node->data);
+        num_transactions_in_block++;
+    }
+    return size +
+        blockchain_varint_size(block->created_at) +
+        sizeof(block->previous_block_hash) +
+        sizeof(block->merkle_root) +
+        blockchain_varint_size(block->proof_of_work) +
+        blockchain_varint_size(num_transactions_in_block);
+}
+
+void blockchain_serialize_block(
+    blockchain_serialization_cursor_t *cursor,
+    block_t *block
+) {
+    uint64_t num_transactions_in_block = 0;
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        num_transactions_in_block++;
+    }
+    blockchain_cursor_write_varint(cursor, block->created_at);
+    blockchain_cursor_write(
+        cursor,
+        &block->previous_block_hash,
+        sizeof(block->previous_block_hash));
+    blockchain_cursor_write(
+        cursor, &block->merkle_root, sizeof(block->merkle_root));
+    blockchain_cursor_write_varint(cursor, block->proof_of_work);
+    blockchain_cursor_write_varint(cursor, num_transactions_in_block);
+    for (node_t *transaction_node = block->transaction_list->head;
+        NULL != transaction_node;
+        transaction_node = transaction_node->next) {
+        blockchain_serialize_transaction(
+            cursor, (transaction_t *)transaction_node->data);
+    }
+}
+
+return_code_t blockchain_serialized_size(
+    blockchain_t *blockchain,
+    uint64_t *size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t total_size =
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE +
+        sizeof(uint32_t) +
+        blockchain_varint_size(
+            blockchain->num_leading_zero_bytes_required_in_block_hash) +
+        blockchain_varint_size(blockchain->num_blocks);
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        total_size += blockchain_serialized_block_size(
+            blockchain->blocks[height]);
+    }
+    *size = total_size;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize_into_iovec(
+    blockchain_t *blockchain,
+    struct iovec *buffers,
+    size_t num_buffers,
+    uint64_t *bytes_written
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain ||
+        (NULL == buffers && 0 != num_buffers) ||
+        NULL == bytes_written) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint64_t size = 0;
+    return_code = blockchain_serialized_size(blockchain, &size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    uint64_t capacity = 0;
+    for (size_t idx = 0; idx < num_buffers; idx++) {
+        if (NULL == buffers[idx].iov_base && 0 != buffers[idx].iov_len) {
+            return_code = FAILURE_INVALID_INPUT;
+            goto end;
+        }
+        capacity += buffers[idx].iov_len;
+    }
+    if (capacity < size) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    blockchain_serialization_cursor_t cursor = {0};
+    cursor.buffers = buffers;
+    cursor.num_buffers = num_buffers;
+    blockchain_cursor_write(
+        &cursor,
+        BLOCKCHAIN_SERIALIZATION_MAGIC,
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE);
+    unsigned char version[sizeof(uint32_t)];
+    blockchain_write_uint32(version, BLOCKCHAIN_SERIALIZATION_VERSION);
+    blockchain_cursor_write(&cursor, version, sizeof(version));
+    blockchain_cursor_write_varint(
+        &cursor, blockchain->num_leading_zero_bytes_required_in_block_hash);
+    blockchain_cursor_write_varint(&cursor, blockchain->num_blocks);
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        blockchain_serialize_block(&cursor, blockchain->blocks[height]);
+    }
+    *bytes_written = size;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize_into_buffer(
+    blockchain_t *blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size,
+    uint64_t *bytes_written
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == buffer && 0 != buffer_size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    struct iovec whole_buffer = {0};
+    whole_buffer.iov_base = buffer;
+    whole_buffer.iov_len = buffer_size;
+    return_code = blockchain_serialize_into_iovec(
+        blockchain, &whole_buffer, 1, bytes_written);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_serialize(
+    blockchain_t *blockchain,
+    unsigned char **buffer,
+    uint64_t *buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == buffer || NULL == buffer_size) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Size the buffer exactly first, so that it takes a single allocation.
+    uint64_t size = 0;
+    return_code = blockchain_serialized_size(blockchain, &size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    unsigned char *serialization_buffer = malloc(size);
+    if (NULL == serialization_buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    uint64_t bytes_written = 0;
+    return_code = blockchain_serialize_into_buffer(
+        blockchain, serialization_buffer, size, &bytes_written);
+    if (SUCCESS != return_code) {
+        free(serialization_buffer);
+        goto end;
+    }
+    *buffer = serialization_buffer;
+    *buffer_size = bytes_written;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_transaction_in_format(
+    transaction_t *transaction,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint32_t version
+) {
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_LEGACY == version) {
+        return blockchain_deserialize_legacy_transaction(
+            transaction, next_spot_in_buffer, buffer_end);
+    }
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS == version) {
+        return blockchain_deserialize_varint_transaction(
+            transaction, next_spot_in_buffer, buffer_end);
+    }
+    return blockchain_deserialize_transaction(
+        transaction, next_spot_in_buffer, buffer_end);
+}
+
+return_code_t blockchain_skip_transaction(
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint32_t version
+) {
+    return_code_t return_code = SUCCESS;
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_LEGACY == version) {
+        uint64_t legacy_transaction_size =
+            sizeof(uint64_t) +
+            2 * sizeof(ssh_key_t) +
+            sizeof(uint64_t) +
+            sizeof(uint64_t) +
+            MAX_SSH_SIGNATURE_LENGTH;
+        if (buffer_end - *next_spot_in_buffer < legacy_transaction_size) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        *next_spot_in_buffer += legacy_transaction_size;
+        goto end;
+    }
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS == version) {
+        return_code = blockchain_deserialize_varint_transaction(
+            NULL, next_spot_in_buffer, buffer_end);
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer < sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    *next_spot_in_buffer += sizeof(uint64_t);
+    for (size_t idx = 0; idx < 2; idx++) {
+        if (buffer_end - *next_spot_in_buffer < sizeof(uint16_t)) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        uint16_t key_length = blockchain_read_uint16(*next_spot_in_buffer);
+        *next_spot_in_buffer += sizeof(uint16_t);
+        if (key_length > MAX_PUBLIC_KEY_LENGTH) {
+            return_code = FAILURE_KEY_TOO_LONG;
+            goto end;
+        }
+        if (buffer_end - *next_spot_in_buffer < key_length) {
+            return_code = FAILURE_BUFFER_TOO_SMALL;
+            goto end;
+        }
+        *next_spot_in_buffer += key_length;
+    }
+    if (buffer_end - *next_spot_in_buffer <
+        sizeof(uint64_t) + sizeof(uint16_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    *next_spot_in_buffer += sizeof(uint64_t);
+    uint16_t signature_length = blockchain_read_uint16(*next_spot_in_buffer);
+    *next_spot_in_buffer += sizeof(uint16_t);
+    if (signature_length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer < signature_length) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    *next_spot_in_buffer += signature_length;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_header(
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint32_t *version,
+    uint64_t *num_leading_zero_bytes_required_in_block_hash,
+    uint64_t *num_blocks
+) {
+    return_code_t return_code = SUCCESS;
+    if (buffer_end - *next_spot_in_buffer <
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE + sizeof(uint32_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    // Without the magic string, the blocks predate Merkle roots, so neither
+    // their hashes nor their proofs of work hold under the current rules.
+    if (0 != memcmp(
+        *next_spot_in_buffer,
+        BLOCKCHAIN_SERIALIZATION_MAGIC,
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE)) {
+        return_code = FAILURE_UNSUPPORTED_SERIALIZATION_VERSION;
+        goto end;
+    }
+    *next_spot_in_buffer += BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE;
+    *version = blockchain_read_uint32(*next_spot_in_buffer);
+    *next_spot_in_buffer += sizeof(uint32_t);
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_LEGACY != *version &&
+        BLOCKCHAIN_SERIALIZATION_VERSION_COMPACT_KEYS != *version &&
+        BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS != *version) {
+        return_code = FAILURE_UNSUPPORTED_SERIALIZATION_VERSION;
+        goto end;
+    }
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS == *version) {
+        return_code = blockchain_read_varint(
+            next_spot_in_buffer,
+            buffer_end,
+            num_leading_zero_bytes_required_in_block_hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        return_code = blockchain_read_varint(
+            next_spot_in_buffer, buffer_end, num_blocks);
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer < 2 * sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    memcpy(
+        num_leading_zero_bytes_required_in_block_hash,
+        *next_spot_in_buffer,
+        sizeof(uint64_t));
+    *num_leading_zero_bytes_required_in_block_hash = betoh64(
+        *num_leading_zero_bytes_required_in_block_hash);
+    *next_spot_in_buffer += sizeof(uint64_t);
+    memcpy(num_blocks, *next_spot_in_buffer, sizeof(uint64_t));
+    *num_blocks = betoh64(*num_blocks);
+    *next_spot_in_buffer += sizeof(uint64_t);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_varint_block_header(
+    block_t *block,
+    uint64_t *num_transactions,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    uint64_t created_at = 0;
+    return_code_t return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &created_at);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    block->created_at = (time_t)created_at;
+    if (buffer_end - *next_spot_in_buffer < 2 * sizeof(sha_256_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    memcpy(
+        &block->previous_block_hash,
+        *next_spot_in_buffer,
+        sizeof(block->previous_block_hash));
+    *next_spot_in_buffer += sizeof(block->previous_block_hash);
+    memcpy(
+        &block->merkle_root,
+        *next_spot_in_buffer,
+        sizeof(block->merkle_root));
+    *next_spot_in_buffer += sizeof(block->merkle_root);
+    return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &block->proof_of_work);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, num_transactions);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_block_header(
+    block_t *block,
+    uint64_t *num_transactions,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint32_t version
+) {
+    return_code_t return_code = SUCCESS;
+    if (BLOCKCHAIN_SERIALIZATION_VERSION_VARINTS == version) {
+        return_code = blockchain_deserialize_varint_block_header(
+            block, num_transactions, next_spot_in_buffer, buffer_end);
+        goto end;
+    }
+    if (buffer_end - *next_spot_in_buffer <
+        BLOCK_HEADER_SIZE + sizeof(uint64_t)) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    uint64_t created_at = 0;
+    memcpy(&created_at, *next_spot_in_buffer, sizeof(created_at));
+    block->created_at = betoh64(created_at);
+    *next_spot_in_buffer += sizeof(created_at);
+    memcpy(
+        &block->previous_block_hash,
+        *next_spot_in_buffer,
+        sizeof(block->previous_block_hash));
+    *next_spot_in_buffer += sizeof(block->previous_block_hash);
+    // Keep the root the peer sent so that blockchain_verify can check it
+    // against the transactions.
+    memcpy(
+        &block->merkle_root,
+        *next_spot_in_buffer,
+        sizeof(block->merkle_root));
+    *next_spot_in_buffer += sizeof(block->merkle_root);
+    uint64_t proof_of_work = 0;
+    memcpy(&proof_of_work, *next_spot_in_buffer, sizeof(proof_of_work));
+    block->proof_of_work = betoh64(proof_of_work);
+    *next_spot_in_buffer += sizeof(proof_of_work);
+    memcpy(num_transactions, *next_spot_in_buffer, sizeof(uint64_t));
+    *num_transactions = betoh64(*num_transactions);
+    *next_spot_in_buffer += sizeof(uint64_t);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize_block(
+    block_t **block,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end,
+    uint32_t version
+) {
+    block_t block_header = {0};
+    uint64_t num_transactions = 0;
+    return_code_t return_code = blockchain_deserialize_block_header(
+        &block_header,
+        &num_transactions,
+        next_spot_in_buffer,
+        buffer_end,
+        version);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    for (uint64_t transaction_idx = 0;
+        transaction_idx < num_transactions;
+        transaction_idx++) {
+        transaction_t *transaction = calloc(1, sizeof(transaction_t));
+        if (NULL == transaction) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            linked_list_destroy(transaction_list);
+            goto end;
+        }
+        return_code = blockchain_deserialize_transaction_in_format(
+            transaction, next_spot_in_buffer, buffer_end, version);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            free(transaction);
+            goto end;
+        }
+        return_code = linked_list_append(transaction_list, transaction);
+        if (SUCCESS != return_code) {
+            linked_list_destroy(transaction_list);
+            free(transaction);
+            goto end;
+        }
+    }
+    // The header already holds the Merkle root, so there is no need to
+    // compute it again as block_create would.
+    block_t *new_block = malloc(sizeof(block_t));
+    if (NULL == new_block) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        linked_list_destroy(transaction_list);
+        goto end;
+    }
+    *new_block = block_header;
+    new_block->transaction_list = transaction_list;
+    atomic_init(&new_block->reference_count, 1);
+    new_block->arena = NULL;
+    *block = new_block;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_get_address_index_file(
+    char **address_index_file,
+    char *file
+) {
+    return_code_t return_code = SUCCESS;
+    size_t file_length = strlen(file);
+    char *new_address_index_file = malloc(
+        file_length + sizeof(ADDRESS_INDEX_FILE_SUFFIX));
+    if (NULL == new_address_index_file) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    memcpy(new_address_index_file, file, file_length);
+    memcpy(
+        new_address_index_file + file_length,
+        ADDRESS_INDEX_FILE_SUFFIX,
+        sizeof(ADDRESS_INDEX_FILE_SUFFIX));
+    *address_index_file = new_address_index_file;
+end:
+    return return_code;
+}
+
+/**
+ * @brief Gives blockchain, whose blocks were added without applying them to
+ * its address index, a complete address index.
+ * 
+ * If address_index is not NULL and covers the same blocks, that is, it has
+ * as many blocks as the blockchain and tip_hash is the hash of the last one,
+ * the blockchain takes it and *address_index is set to NULL. Otherwise, the
+ * blockchain's own index is rebuilt from its blocks, and the caller still
+ * owns *address_index.
+ */
+return_code_t blockchain_finish_address_index(
+    blockchain_t *blockchain,
+    address_index_t **address_index,
+    sha_256_t *tip_hash
+) {
+    return_code_t return_code = SUCCESS;
+    uint64_t num_blocks = blockchain->num_blocks;
+    if (NULL != *address_index &&
+        num_blocks == (*address_index)->num_blocks &&
+        (0 == num_blocks || 0 == memcmp(
+            tip_hash,
+            &blockchain->blocks[num_blocks - 1]->hash,
+            sizeof(sha_256_t)))) {
+        address_index_destroy(blockchain->address_index);
+        blockchain->address_index = *address_index;
+        *address_index = NULL;
+        goto end;
+    }
+    for (uint64_t height = 0; height < num_blocks; height++) {
+        return_code = address_index_apply_block(
+            blockchain->address_index, blockchain->blocks[height]);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+end:
+    return return_code;
+}
+
+/**
+ * @brief Fills address_index with the index in the file beside file, or with
+ * NULL if that is missing or invalid.
+ */
+void blockchain_read_address_index_file(
+    char *file,
+    address_index_t **address_index,
+    sha_256_t *tip_hash
+) {
+    *address_index = NULL;
+    char *address_index_file = NULL;
+    if (SUCCESS != blockchain_get_address_index_file(
+        &address_index_file, file)) {
+        return;
+    }
+    if (SUCCESS != address_index_read_from_file(
+        address_index, tip_hash, address_index_file)) {
+        *address_index = NULL;
+    }
+    free(address_index_file);
+}
+
+/**
+ * @brief Reconstructs the blockchain from a buffer like blockchain_deserialize,
+ * taking its address index from *address_index if that covers the same
+ * blocks.
+ * 
+ * See blockchain_finish_address_index. If address_index is NULL, the index is
+ * built as the blocks are added.
+ */
+return_code_t blockchain_deserialize_with_address_index(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size,
+    address_index_t **address_index,
+    sha_256_t *address_index_tip_hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == buffer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    uint32_t version = 0;
+    uint64_t num_leading_zero_bytes_required_in_block_hash = 0;
+    uint64_t num_blocks = 0;
+    return_code = blockchain_deserialize_header(
+        &next_spot_in_buffer,
+        buffer_end,
+        &version,
+        &num_leading_zero_bytes_required_in_block_hash,
+        &num_blocks);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_create(
+        &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Applying every block to the address index is most of the work of
+    // loading a long chain, so leave it until the given index is checked.
+    bool use_address_index = NULL != address_index;
+    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        block_t *block = NULL;
+        return_code = blockchain_deserialize_block(
+            &block, &next_spot_in_buffer, buffer_end, version);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+            goto end;
+        }
+        return_code = blockchain_append_block(
+            new_blockchain, block, !use_address_index);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+            block_destroy(block);
+            goto end;
+        }
+    }
+    if (use_address_index) {
+        return_code = blockchain_finish_address_index(
+            new_blockchain, address_index, address_index_tip_hash);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+            goto end;
+        }
+    }
+    *blockchain = new_blockchain;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_deserialize(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size
+) {
+    return blockchain_deserialize_with_address_index(
+        blockchain, buffer, buffer_size, NULL, NULL);
+}
+
+return_code_t blockchain_deserialize_into_arena(
+    blockchain_t **blockchain,
+    unsigned char *buffer,
+    uint64_t buffer_size
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == buffer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *next_spot_in_buffer = buffer;
+    unsigned char *buffer_end = buffer + buffer_size;
+    uint32_t version = 0;
+    uint64_t num_leading_zero_bytes_required_in_block_hash = 0;
+    uint64_t num_blocks = 0;
+    return_code = blockchain_deserialize_header(
+        &next_spot_in_buffer,
+        buffer_end,
+        &version,
+        &num_leading_zero_bytes_required_in_block_hash,
+        &num_blocks);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // First pass: count the transactions so that one allocation can hold
+    // every block, list, node, and transaction.
+    unsigned char *first_block_in_buffer = next_spot_in_buffer;
+    uint64_t total_num_transactions = 0;
+    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        block_t block_header = {0};
+        uint64_t num_transactions = 0;
+        return_code = blockchain_deserialize_block_header(
+            &block_header,
+            &num_transactions,
+            &next_spot_in_buffer,
+            buffer_end,
+            version);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        for (uint64_t transaction_idx = 0;
+            transaction_idx < num_transactions;
+            transaction_idx++) {
+            return_code = blockchain_skip_transaction(
+                &next_spot_in_buffer, buffer_end, version);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+        total_num_transactions += num_transactions;
+    }
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_create(
+        &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 == num_blocks) {
+        *blockchain = new_blockchain;
+        goto end;
+    }
+    // Size the hash index for the whole chain so that it never grows here.
+    block_hash_index_t *hash_index = NULL;
+    return_code = block_hash_index_create(&hash_index, num_blocks);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    block_hash_index_destroy(new_blockchain->hash_index);
+    new_blockchain->hash_index = hash_index;
+    return_code = ledger_reserve(
+        new_blockchain->ledger, 2 * total_num_transactions);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    return_code = address_index_reserve(
+        new_blockchain->address_index, total_num_transactions);
+    if (SUCCESS != return_code) {
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    // Every type in the arena has a size that is a multiple of its
+    // alignment, so laying out the arrays back to back keeps them aligned.
+    uint64_t arena_size =
+        BLOCKCHAIN_ARENA_HEADER_SIZE +
+        num_blocks * (sizeof(block_t) + sizeof(linked_list_t)) +
+        total_num_transactions * (sizeof(transaction_t) + sizeof(node_t));
+    unsigned char *arena = calloc(1, arena_size);
+    block_t **blocks = malloc(num_blocks * sizeof(block_t *));
+    if (NULL == arena || NULL == blocks) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        free(arena);
+        free(blocks);
+        blockchain_destroy(new_blockchain);
+        goto end;
+    }
+    // Each block in the blockchain holds a reference to the arena.
+    block_arena_t *arena_header = (block_arena_t *)arena;
+    atomic_init(&arena_header->reference_count, 0);
+    transaction_t *arena_transactions =
+        (transaction_t *)(arena + BLOCKCHAIN_ARENA_HEADER_SIZE);
+    block_t *arena_blocks =
+        (block_t *)(arena_transactions + total_num_transactions);
+    linked_list_t *arena_lists = (linked_list_t *)(arena_blocks + num_blocks);
+    node_t *arena_nodes = (node_t *)(arena_lists + num_blocks);
+    new_blockchain->blocks = blocks;
+    new_blockchain->blocks_capacity = num_blocks;
+    // Second pass: fill the arena. The first pass checked the buffer's
+    // structure, so only the contents of transactions can fail here.
+    next_spot_in_buffer = first_block_in_buffer;
+    uint64_t next_transaction_idx = 0;
+    for (uint64_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+        block_t *block = &arena_blocks[block_idx];
+        uint64_t num_transactions = 0;
+        return_code = blockchain_deserialize_block_header(
+            block,
+            &num_transactions,
+            &next_spot_in_buffer,
+            buffer_end,
+            version);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        // The arena owns the transactions, so the list has no free function.
+        linked_list_t *transaction_list = &arena_lists[block_idx];
+        node_t **next_node = &transaction_list->head;
+        for (uint64_t transaction_idx = 0;
+            transaction_idx < num_transactions;
+            transaction_idx++) {
+            transaction_t *transaction =
+                &arena_transactions[next_transaction_idx];
+            return_code = blockchain_deserialize_transaction_in_format(
+                transaction, &next_spot_in_buffer, buffer_end, version);
+            if (SUCCESS != return_code) {
+                goto cleanup;
+            }
+            node_t *node = &arena_nodes[next_transaction_idx];
+            node->data = transaction;
+            *next_node = node;
+            next_node = &node->next;
+            next_transaction_idx++;
+        }
+        block->transaction_list = transaction_list;
+        block->arena = arena_header;
+        atomic_init(&block->reference_count, 1);
+        return_code = blockchain_seal_and_index_block(
+            new_blockchain, block, block_idx);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        return_code = ledger_apply_block(new_blockchain->ledger, block, NULL);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        return_code = address_index_apply_block(
+            new_blockchain->address_index, block);
+        if (SUCCESS != return_code) {
+            goto cleanup;
+        }
+        blocks[block_idx] = block;
+        new_blockchain->num_blocks++;
+        atomic_fetch_add(&arena_header->reference_count, 1);
+    }
+    *blockchain = new_blockchain;
+    goto end;
+cleanup:
+    // Blocks already in the blockchain free the arena when released.
+    if (0 == new_blockchain->num_blocks) {
+        free(arena);
+    }
+    blockchain_destroy(new_blockchain);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_write_to_file(
+    blockchain_t *blockchain,
+    char *outfile
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == outfile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *buffer = NULL;
+    size_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    FILE *f = fopen(outfile, "wb");
+    if (NULL == f) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    size_t bytes_written = fwrite(buffer, 1, buffer_size, f);
+    fclose(f);
+    free(buffer);
+    if (bytes_written != buffer_size) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    char *address_index_outfile = NULL;
+    return_code = blockchain_get_address_index_file(
+        &address_index_outfile, outfile);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    sha_256_t tip_hash = {0};
+    if (0 != blockchain->num_blocks) {
+        return_code = block_hash(
+            blockchain->blocks[blockchain->num_blocks - 1], &tip_hash);
+        if (SUCCESS != return_code) {
+            free(address_index_outfile);
+            goto end;
+        }
+    }
+    return_code = address_index_write_to_file(
+        blockchain->address_index, &tip_hash, address_index_outfile);
+    free(address_index_outfile);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_read_from_file(
+    blockchain_t **blockchain,
+    char *infile
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == infile) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    FILE *f = fopen(infile, "rb");
+    if (NULL == f) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    fseek(f, 0, SEEK_END);
+    uint64_t buffer_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *buffer = malloc(buffer_size);
+    if (NULL == buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    size_t read_size = fread(buffer, 1, buffer_size, f);
+    if (read_size != (size_t)buffer_size) {
+        return_code = FAILURE_FILE_IO;
+        goto cleanup;
+    }
+    // A missing or unreadable address index file is rebuilt from the blocks.
+    address_index_t *address_index = NULL;
+    sha_256_t address_index_tip_hash = {0};
+    blockchain_read_address_index_file(
+        infile, &address_index, &address_index_tip_hash);
+    return_code = blockchain_deserialize_with_address_index(
+        blockchain,
+        buffer,
+        buffer_size,
+        &address_index,
+        &address_index_tip_hash);
+    if (NULL != address_index) {
+        address_index_destroy(address_index);
+    }
+cleanup:
+    fclose(f);
+    free(buffer);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_log_reserve_records(
+    blockchain_log_t *log,
+    uint64_t min_capacity
+) {
+    return_code_t return_code = SUCCESS;
+    if (min_capacity <= log->records_capacity) {
+        goto end;
+    }
+    uint64_t new_capacity = log->records_capacity * 2;
+    if (new_capacity < BLOCKCHAIN_LOG_MIN_CAPACITY) {
+        new_capacity = BLOCKCHAIN_LOG_MIN_CAPACITY;
+    }
+    while (new_capacity < min_capacity) {
+        new_capacity *= 2;
+    }
+    blockchain_log_record_t *new_records = realloc(
+        log->records, new_capacity * sizeof(blockchain_log_record_t));
+    if (NULL == new_records) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    log->records = new_records;
+    log->records_capacity = new_capacity;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_log_parse_header(
+    unsigned char *header,
+    uint64_t *num_leading_zero_bytes_required_in_block_hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (0 != memcmp(header, BLOCKCHAIN_LOG_MAGIC, BLOCKCHAIN_LOG_MAGIC_SIZE)) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    uint32_t version = blockchain_read_uint32(
+        header + BLOCKCHAIN_LOG_MAGIC_SIZE);
+    if (BLOCKCHAIN_SERIALIZATION_VERSION != version) {
+        return_code = FAILURE_UNSUPPORTED_SERIALIZATION_VERSION;
+        goto end;
+    }
+    memcpy(
+        num_leading_zero_bytes_required_in_block_hash,
+        header + BLOCKCHAIN_LOG_MAGIC_SIZE + sizeof(uint32_t),
+        sizeof(uint64_t));
+    *num_leading_zero_bytes_required_in_block_hash =
+        betoh64(*num_leading_zero_bytes_required_in_block_hash);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_log_scan(
+    blockchain_log_t *log,
+    blockchain_t **blockchain,
+    bool apply_to_address_index
+) {
+    // Fills the log's records from its file and, if blockchain is not NULL,
+    // decodes the blocks into a new blockchain, whose address index is left
+    // empty unless apply_to_address_index is true.
+    return_code_t return_code = SUCCESS;
+    unsigned char *record = NULL;
+    uint64_t record_capacity = 0;
+    blockchain_t *new_blockchain = NULL;
+    log->num_records = 0;
+    log->end_offset = 0;
+    if (0 != fseek(log->file, 0, SEEK_END)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    long file_size = ftell(log->file);
+    if (file_size < 0 || 0 != fseek(log->file, 0, SEEK_SET)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    // A file too short for a header was interrupted while being created.
+    if ((uint64_t)file_size < BLOCKCHAIN_LOG_HEADER_SIZE) {
+        if (NULL != blockchain) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+        }
+        goto end;
+    }
+    unsigned char header[BLOCKCHAIN_LOG_HEADER_SIZE];
+    if (sizeof(header) != fread(header, 1, sizeof(header), log->file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    uint32_t version = BLOCKCHAIN_SERIALIZATION_VERSION;
+    uint64_t num_leading_zero_bytes_required_in_block_hash = 0;
+    return_code = blockchain_log_parse_header(
+        header, &num_leading_zero_bytes_required_in_block_hash);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (NULL != blockchain) {
+        return_code = blockchain_create(
+            &new_blockchain, num_leading_zero_bytes_required_in_block_hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    uint64_t offset = BLOCKCHAIN_LOG_HEADER_SIZE;
+    while ((uint64_t)file_size - offset >= BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE) {
+        unsigned char length_bytes[BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE];
+        if (sizeof(length_bytes) !=
+            fread(length_bytes, 1, sizeof(length_bytes), log->file)) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+        uint64_t length = blockchain_read_uint32(length_bytes);
+        // A record that runs past the end of the file was interrupted.
+        if (length >
+            (uint64_t)file_size - offset - BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE) {
+            break;
+        }
+        if (length > record_capacity) {
+            unsigned char *new_record = realloc(record, length);
+            if (NULL == new_record) {
+                return_code = FAILURE_COULD_NOT_MALLOC;
+                goto end;
+            }
+            record = new_record;
+            record_capacity = length;
+        }
+        if (length != fread(record, 1, length, log->file)) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+        return_code = blockchain_log_reserve_records(log, log->num_records + 1);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        blockchain_log_record_t *log_record = &log->records[log->num_records];
+        unsigned char *next_spot_in_record = record;
+        unsigned char *record_end = record + length;
+        if (NULL != blockchain) {
+            block_t *block = NULL;
+            return_code = blockchain_deserialize_block(
+                &block, &next_spot_in_record, record_end, version);
+            if (SUCCESS != return_code) {
+                goto invalid_record;
+            }
+            if (next_spot_in_record != record_end) {
+                block_destroy(block);
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+                goto end;
+            }
+            return_code = blockchain_append_block(
+                new_blockchain, block, apply_to_address_index);
+            if (SUCCESS != return_code) {
+                block_destroy(block);
+                goto end;
+            }
+            log_record->block_hash = block->hash;
+        } else {
+            // Only the header determines the block's hash, so the
+            // transactions are checked but not decoded.
+            block_t block_header = {0};
+            uint64_t num_transactions = 0;
+            return_code = blockchain_deserialize_block_header(
+                &block_header,
+                &num_transactions,
+                &next_spot_in_record,
+                record_end,
+                version);
+            for (uint64_t transaction_idx = 0;
+                SUCCESS == return_code && transaction_idx < num_transactions;
+                transaction_idx++) {
+                return_code = blockchain_skip_transaction(
+                    &next_spot_in_record, record_end, version);
+            }
+            if (SUCCESS != return_code) {
+                goto invalid_record;
+            }
+            if (next_spot_in_record != record_end) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+                goto end;
+            }
+            return_code = block_hash(&block_header, &log_record->block_hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+        }
+        log_record->offset = offset;
+        log_record->length = BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE + length;
+        log->num_records++;
+        offset += log_record->length;
+    }
+    log->end_offset = offset;
+    log->num_leading_zero_bytes_required_in_block_hash =
+        num_leading_zero_bytes_required_in_block_hash;
+    if (NULL != blockchain) {
+        *blockchain = new_blockchain;
+        new_blockchain = NULL;
+    }
+    goto end;
+invalid_record:
+    // The record is complete, so running out of bytes means it is corrupt.
+    if (FAILURE_BUFFER_TOO_SMALL == return_code) {
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+    }
+end:
+    free(record);
+    if (NULL != new_blockchain) {
+        blockchain_destroy(new_blockchain);
+    }
+    return return_code;
+}
+
+void blockchain_log_write_index_uint64(unsigned char *buffer, uint64_t value) {
+    uint64_t value_big_endian = htobe64(value);
+    memcpy(buffer, &value_big_endian, sizeof(uint64_t));
+}
+
+uint64_t blockchain_log_read_index_uint64(unsigned char *buffer) {
+    uint64_t value_big_endian = 0;
+    memcpy(&value_big_endian, buffer, sizeof(uint64_t));
+    return betoh64(value_big_endian);
+}
+
+return_code_t blockchain_log_write_index(blockchain_log_t *log) {
+    // Brings the index file up to date with the log's records. The first
+    // num_indexed_records records are already in the file and not rewritten.
+    return_code_t return_code = SUCCESS;
+    unsigned char *buffer = NULL;
+    uint64_t num_kept_records = log->num_indexed_records;
+    uint64_t kept_size =
+        BLOCKCHAIN_LOG_INDEX_HEADER_SIZE +
+        num_kept_records * BLOCKCHAIN_LOG_INDEX_RECORD_SIZE;
+    if (0 != fflush(log->index_file) ||
+        0 != ftruncate(fileno(log->index_file), kept_size)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    log->num_indexed_records = num_kept_records;
+    uint64_t size =
+        (log->num_records - num_kept_records) *
+        BLOCKCHAIN_LOG_INDEX_RECORD_SIZE;
+    if (0 != size) {
+        buffer = malloc(size);
+        if (NULL == buffer) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        unsigned char *next_spot_in_buffer = buffer;
+        for (uint64_t height = num_kept_records;
+            height < log->num_records;
+            height++) {
+            blockchain_log_record_t *log_record = &log->records[height];
+            blockchain_log_write_index_uint64(next_spot_in_buffer, height);
+            next_spot_in_buffer += sizeof(uint64_t);
+            blockchain_log_write_index_uint64(
+                next_spot_in_buffer, log_record->offset);
+            next_spot_in_buffer += sizeof(uint64_t);
+            blockchain_log_write_index_uint64(
+                next_spot_in_buffer, log_record->length);
+            next_spot_in_buffer += sizeof(uint64_t);
+            memcpy(
+                next_spot_in_buffer,
+                &log_record->block_hash,
+                sizeof(sha_256_t));
+            next_spot_in_buffer += sizeof(sha_256_t);
+        }
+        if (0 != fseek(log->index_file, kept_size, SEEK_SET) ||
+            size != fwrite(buffer, 1, size, log->index_file)) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+    }
+    // The header goes last, so an index cut short by a crash still names
+    // the old size of the log and reads as stale.
+    unsigned char header[BLOCKCHAIN_LOG_INDEX_HEADER_SIZE];
+    memcpy(header, BLOCKCHAIN_LOG_INDEX_MAGIC, BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE);
+    blockchain_log_write_index_uint64(
+        header + BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE, log->end_offset);
+    blockchain_log_write_index_uint64(
+        header + BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE + sizeof(uint64_t),
+        log->num_records);
+    if (0 != fseek(log->index_file, 0, SEEK_SET) ||
+        sizeof(header) != fwrite(header, 1, sizeof(header), log->index_file) ||
+        0 != fflush(log->index_file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    log->num_indexed_records = log->num_records;
+end:
+    free(buffer);
+    return return_code;
+}
+
+return_code_t blockchain_log_read_index(
+    blockchain_log_t *log,
+    bool *is_fresh
+) {
+    // Fills the log's records from its index file if the index matches the
+    // log. Any mismatch only makes the index stale; the caller rebuilds it.
+    return_code_t return_code = SUCCESS;
+    unsigned char *buffer = NULL;
+    unsigned char *last_record = NULL;
+    *is_fresh = false;
+    if (0 != fseek(log->file, 0, SEEK_END)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    long log_size = ftell(log->file);
+    if (0 != fseek(log->index_file, 0, SEEK_END)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    long index_size = ftell(log->index_file);
+    if (log_size < 0 || index_size < 0) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    if ((uint64_t)log_size < BLOCKCHAIN_LOG_HEADER_SIZE ||
+        (uint64_t)index_size < BLOCKCHAIN_LOG_INDEX_HEADER_SIZE) {
+        goto end;
+    }
+    unsigned char log_header[BLOCKCHAIN_LOG_HEADER_SIZE];
+    if (0 != fseek(log->file, 0, SEEK_SET) ||
+        sizeof(log_header) !=
+            fread(log_header, 1, sizeof(log_header), log->file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    uint64_t num_leading_zero_bytes_required_in_block_hash = 0;
+    if (SUCCESS != blockchain_log_parse_header(
+        log_header, &num_leading_zero_bytes_required_in_block_hash)) {
+        goto end;
+    }
+    unsigned char header[BLOCKCHAIN_LOG_INDEX_HEADER_SIZE];
+    if (0 != fseek(log->index_file, 0, SEEK_SET) ||
+        sizeof(header) != fread(header, 1, sizeof(header), log->index_file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    if (0 != memcmp(
+        header, BLOCKCHAIN_LOG_INDEX_MAGIC, BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE)) {
+        goto end;
+    }
+    uint64_t end_offset = blockchain_log_read_index_uint64(
+        header + BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE);
+    uint64_t num_records = blockchain_log_read_index_uint64(
+        header + BLOCKCHAIN_LOG_INDEX_MAGIC_SIZE + sizeof(uint64_t));
+    uint64_t records_size =
+        (uint64_t)index_size - BLOCKCHAIN_LOG_INDEX_HEADER_SIZE;
+    if (end_offset != (uint64_t)log_size ||
+        0 != records_size % BLOCKCHAIN_LOG_INDEX_RECORD_SIZE ||
+        num_records != records_size / BLOCKCHAIN_LOG_INDEX_RECORD_SIZE) {
+        goto end;
+    }
+    return_code = blockchain_log_reserve_records(log, num_records);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != records_size) {
+        buffer = malloc(records_size);
+        if (NULL == buffer) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        if (records_size != fread(buffer, 1, records_size, log->index_file)) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+    }
+    // The records must tile the log exactly.
+    uint64_t expected_offset = BLOCKCHAIN_LOG_HEADER_SIZE;
+    unsigned char *next_spot_in_buffer = buffer;
+    for (uint64_t height = 0; height < num_records; height++) {
+        blockchain_log_record_t *log_record = &log->records[height];
+        uint64_t record_height = blockchain_log_read_index_uint64(
+            next_spot_in_buffer);
+        next_spot_in_buffer += sizeof(uint64_t);
+        log_record->offset = blockchain_log_read_index_uint64(
+            next_spot_in_buffer);
+        next_spot_in_buffer += sizeof(uint64_t);
+        log_record->length = blockchain_log_read_index_uint64(
+            next_spot_in_buffer);
+        next_spot_in_buffer += sizeof(uint64_t);
+        memcpy(
+            &log_record->block_hash,
+            next_spot_in_buffer,
+            sizeof(sha_256_t));
+        next_spot_in_buffer += sizeof(sha_256_t);
+        if (record_height != height ||
+            log_record->offset != expected_offset ||
+            log_record->length <= BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE ||
+            log_record->length > end_offset - expected_offset) {
+            goto end;
+        }
+        expected_offset += log_record->length;
+    }
+    if (expected_offset != end_offset) {
+        goto end;
+    }
+    // A log rewritten to the same size would still pass, so check that the
+    // last block really has the indexed hash.
+    if (0 != num_records) {
+        blockchain_log_record_t *log_record = &log->records[num_records - 1];
+        last_record = malloc(log_record->length);
+        if (NULL == last_record) {
+            return_code = FAILURE_COULD_NOT_MALLOC;
+            goto end;
+        }
+        if (0 != fseek(log->file, log_record->offset, SEEK_SET) ||
+            log_record->length !=
+                fread(last_record, 1, log_record->length, log->file)) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+        unsigned char *next_spot_in_record =
+            last_record + BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE;
+        block_t block_header = {0};
+        uint64_t num_transactions = 0;
+        sha_256_t hash = {0};
+        if (log_record->length - BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE !=
+                blockchain_read_uint32(last_record) ||
+            SUCCESS != blockchain_deserialize_block_header(
+                &block_header,
+                &num_transactions,
+                &next_spot_in_record,
+                last_record + log_record->length,
+                BLOCKCHAIN_SERIALIZATION_VERSION) ||
+            SUCCESS != block_hash(&block_header, &hash) ||
+            0 != memcmp(&hash, &log_record->block_hash, sizeof(sha_256_t))) {
+            goto end;
+        }
+    }
+    log->num_records = num_records;
+    log->num_indexed_records = num_records;
+    log->end_offset = end_offset;
+    log->num_leading_zero_bytes_required_in_block_hash =
+        num_leading_zero_bytes_required_in_block_hash;
+    *is_fresh = true;
+end:
+    free(buffer);
+    free(last_record);
+    return return_code;
+}
+
+return_code_t blockchain_log_read_blocks(
+    blockchain_log_t *log,
+    uint64_t first_height,
+    uint64_t num_blocks,
+    block_t **blocks
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *buffer = NULL;
+    uint64_t num_blocks_read = 0;
+    if (NULL == log ||
+        (NULL == blocks && 0 != num_blocks) ||
+        first_height > log->num_records ||
+        num_blocks > log->num_records - first_height) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 == num_blocks) {
+        goto end;
+    }
+    // The records are contiguous, so the whole range takes one read.
+    blockchain_log_record_t *first_record = &log->records[first_height];
+    blockchain_log_record_t *last_record =
+        &log->records[first_height + num_blocks - 1];
+    uint64_t size =
+        last_record->offset + last_record->length - first_record->offset;
+    buffer = malloc(size);
+    if (NULL == buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    if (0 != fflush(log->file) ||
+        0 != fseek(log->file, first_record->offset, SEEK_SET) ||
+        size != fread(buffer, 1, size, log->file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    for (; num_blocks_read < num_blocks; num_blocks_read++) {
+        blockchain_log_record_t *log_record =
+            &log->records[first_height + num_blocks_read];
+        unsigned char *next_spot_in_buffer =
+            buffer +
+            (log_record->offset - first_record->offset) +
+            BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE;
+        unsigned char *record_end =
+            buffer + (log_record->offset - first_record->offset) +
+            log_record->length;
+        return_code = blockchain_deserialize_block(
+            &blocks[num_blocks_read],
+            &next_spot_in_buffer,
+            record_end,
+            BLOCKCHAIN_SERIALIZATION_VERSION);
+        if (SUCCESS != return_code) {
+            if (FAILURE_BUFFER_TOO_SMALL == return_code) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+            }
+            goto end;
+        }
+    }
+end:
+    if (SUCCESS != return_code) {
+        for (uint64_t idx = 0; idx < num_blocks_read; idx++) {
+            block_destroy(blocks[idx]);
+        }
+    }
+    free(buffer);
+    return return_code;
+}
+
+return_code_t blockchain_log_open(
+    blockchain_log_t **log,
+    char *path,
+    size_t blocks_per_sync
+) {
+    return_code_t return_code = SUCCESS;
+    char *index_path = NULL;
+    if (NULL == log || NULL == path) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_log_t *new_log = calloc(1, sizeof(blockchain_log_t));
+    if (NULL == new_log) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_log->blocks_per_sync = blocks_per_sync;
+    new_log->file = fopen(path, "r+b");
+    if (NULL == new_log->file && ENOENT == errno) {
+        new_log->file = fopen(path, "w+b");
+    }
+    if (NULL == new_log->file) {
+        free(new_log);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    size_t path_length = strlen(path);
+    index_path = malloc(path_length + sizeof(BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX));
+    if (NULL == index_path) {
+        blockchain_log_close(new_log);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    memcpy(index_path, path, path_length);
+    memcpy(
+        index_path + path_length,
+        BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX,
+        sizeof(BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX));
+    return_code = blockchain_get_address_index_file(
+        &new_log->address_index_path, path);
+    if (SUCCESS != return_code) {
+        blockchain_log_close(new_log);
+        goto end;
+    }
+    new_log->index_file = fopen(index_path, "r+b");
+    if (NULL != new_log->index_file) {
+        bool is_index_fresh = false;
+        return_code = blockchain_log_read_index(new_log, &is_index_fresh);
+        if (SUCCESS != return_code) {
+            blockchain_log_close(new_log);
+            goto end;
+        }
+        if (is_index_fresh) {
+            *log = new_log;
+            goto end;
+        }
+    }
+    return_code = blockchain_log_scan(new_log, NULL, false);
+    if (SUCCESS != return_code) {
+        blockchain_log_close(new_log);
+        goto end;
+    }
+    // Appends start at end_offset, so drop anything an interrupted write
+    // left past it.
+    if (0 != ftruncate(fileno(new_log->file), new_log->end_offset)) {
+        blockchain_log_close(new_log);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    // The index is only created once the file is known to be a block log.
+    if (NULL == new_log->index_file) {
+        new_log->index_file = fopen(index_path, "w+b");
+        if (NULL == new_log->index_file) {
+            blockchain_log_close(new_log);
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+    }
+    return_code = blockchain_log_write_index(new_log);
+    if (SUCCESS != return_code) {
+        blockchain_log_close(new_log);
+        goto end;
+    }
+    *log = new_log;
+end:
+    free(index_path);
+    return return_code;
+}
+
+return_code_t blockchain_log_save(
+    blockchain_log_t *log,
+    blockchain_t *blockchain
+) {
+    return_code_t return_code = SUCCESS;
+    unsigned char *buffer = NULL;
+    if (NULL == log || NULL == blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // A log at another difficulty holds another chain entirely, so it is
+    // rewritten from the header on.
+    bool write_header =
+        0 == log->end_offset ||
+        log->num_leading_zero_bytes_required_in_block_hash !=
+            blockchain->num_leading_zero_bytes_required_in_block_hash;
+    uint64_t num_kept_records = 0;
+    if (!write_header) {
+        num_kept_records = log->num_records < blockchain->num_blocks ?
+            log->num_records : blockchain->num_blocks;
+    }
+    // Every block commits to its predecessor, so the highest block that the
+    // log and the active chain share is the fork point. It is usually the
+    // log's last block.
+    while (num_kept_records > 0) {
+        sha_256_t hash = {0};
+        return_code = block_hash(
+            blockchain->blocks[num_kept_records - 1], &hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        if (0 == memcmp(
+            &hash,
+            &log->records[num_kept_records - 1].block_hash,
+            sizeof(sha_256_t))) {
+            break;
+        }
+        num_kept_records--;
+    }
+    uint64_t write_offset = log->end_offset;
+    if (write_header) {
+        write_offset = 0;
+    } else if (num_kept_records < log->num_records) {
+        write_offset = log->records[num_kept_records].offset;
+    }
+    // Truncating also drops anything that a failed save left past the end.
+    if (0 != fflush(log->file) ||
+        0 != ftruncate(fileno(log->file), write_offset)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    log->num_records = num_kept_records;
+    log->end_offset = write_offset;
+    if (log->num_indexed_records > num_kept_records) {
+        log->num_indexed_records = num_kept_records;
+    }
+    if (!write_header && num_kept_records == blockchain->num_blocks) {
+        return_code = blockchain_log_write_index(log);
+        goto end;
+    }
+    return_code = blockchain_log_reserve_records(log, blockchain->num_blocks);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Build every new record in one buffer so that the append takes a single
+    // write.
+    uint64_t size = write_header ? BLOCKCHAIN_LOG_HEADER_SIZE : 0;
+    for (uint64_t height = num_kept_records;
+        height < blockchain->num_blocks;
+        height++) {
+        uint64_t block_size = blockchain_serialized_block_size(
+            blockchain->blocks[height]);
+        if (block_size > UINT32_MAX) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+            goto end;
+        }
+        blockchain_log_record_t *log_record = &log->records[height];
+        log_record->offset = write_offset + size;
+        log_record->length = BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE + block_size;
+        return_code = block_hash(
+            blockchain->blocks[height], &log_record->block_hash);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+        size += log_record->length;
+    }
+    buffer = malloc(size);
+    if (NULL == buffer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    struct iovec whole_buffer = {0};
+    whole_buffer.iov_base = buffer;
+    whole_buffer.iov_len = size;
+    blockchain_serialization_cursor_t cursor = {0};
+    cursor.buffers = &whole_buffer;
+    cursor.num_buffers = 1;
+    if (write_header) {
+        blockchain_cursor_write(
+            &cursor, BLOCKCHAIN_LOG_MAGIC, BLOCKCHAIN_LOG_MAGIC_SIZE);
+        unsigned char version[sizeof(uint32_t)];
+        blockchain_write_uint32(version, BLOCKCHAIN_SERIALIZATION_VERSION);
+        blockchain_cursor_write(&cursor, version, sizeof(version));
+        uint64_t num_leading_zero_bytes_big_endian = htobe64(
+            blockchain->num_leading_zero_bytes_required_in_block_hash);
+        blockchain_cursor_write(
+            &cursor, &num_leading_zero_bytes_big_endian, sizeof(uint64_t));
+    }
+    for (uint64_t height = num_kept_records;
+        height < blockchain->num_blocks;
+        height++) {
+        unsigned char length[BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE];
+        blockchain_write_uint32(
+            length,
+            log->records[height].length - BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE);
+        blockchain_cursor_write(&cursor, length, sizeof(length));
+        blockchain_serialize_block(&cursor, blockchain->blocks[height]);
+    }
+    if (0 != fseek(log->file, write_offset, SEEK_SET)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    size_t bytes_written = fwrite(buffer, 1, size, log->file);
+    // If only part of the new records reached the file, the next save or
+    // open truncates them, since they lie past end_offset.
+    if (bytes_written != size || 0 != fflush(log->file)) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    log->num_blocks_since_sync += blockchain->num_blocks - num_kept_records;
+    log->num_records = blockchain->num_blocks;
+    log->end_offset = write_offset + size;
+    log->num_leading_zero_bytes_required_in_block_hash =
+        blockchain->num_leading_zero_bytes_required_in_block_hash;
+    if (0 != log->blocks_per_sync &&
+        log->num_blocks_since_sync >= log->blocks_per_sync) {
+        if (0 != fsync(fileno(log->file))) {
+            return_code = FAILURE_FILE_IO;
+            goto end;
+        }
+        log->num_blocks_since_sync = 0;
+    }
+    return_code = blockchain_log_write_index(log);
+end:
+    free(buffer);
+    return return_code;
+}
+
+return_code_t blockchain_log_close(blockchain_log_t *log) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == log) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != fflush(log->file)) {
+        return_code = FAILURE_FILE_IO;
+    }
+    if (0 != log->blocks_per_sync &&
+        0 != log->num_blocks_since_sync &&
+        0 != fsync(fileno(log->file))) {
+        return_code = FAILURE_FILE_IO;
+    }
+    if (0 != fclose(log->file)) {
+        return_code = FAILURE_FILE_IO;
+    }
+    if (NULL != log->index_file && 0 != fclose(log->index_file)) {
+        return_code = FAILURE_FILE_IO;
+    }
+    free(log->records);
+    free(log->address_index_path);
+    free(log);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_log_write_address_index(
+    blockchain_log_t *log,
+    blockchain_t *blockchain
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == log || NULL == blockchain) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // The index file is tied to the log's tip, so the log must hold exactly
+    // the blockchain's active chain.
+    sha_256_t tip_hash = {0};
+    if (log->num_records != blockchain->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != log->num_records) {
+        tip_hash = log->records[log->num_records - 1].block_hash;
+        if (0 != memcmp(
+            &tip_hash,
+            &blockchain->blocks[blockchain->num_blocks - 1]->hash,
+            sizeof(sha_256_t))) {
+            return_code = FAILURE_INVALID_INPUT;
+            goto end;
+        }
+    }
+    return_code = address_index_write_to_file(
+        blockchain->address_index, &tip_hash, log->address_index_path);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_log_read_from_file(
+    blockchain_t **blockchain,
+    char *path
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == blockchain || NULL == path) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_log_t log = {0};
+    log.file = fopen(path, "rb");
+    if (NULL == log.file) {
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    // A missing or stale address index file is rebuilt from the blocks.
+    address_index_t *address_index = NULL;
+    sha_256_t address_index_tip_hash = {0};
+    blockchain_read_address_index_file(
+        path, &address_index, &address_index_tip_hash);
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_log_scan(&log, &new_blockchain, false);
+    fclose(log.file);
+    free(log.records);
+    if (SUCCESS == return_code) {
+        return_code = blockchain_finish_address_index(
+            new_blockchain, &address_index, &address_index_tip_hash);
+        if (SUCCESS != return_code) {
+            blockchain_destroy(new_blockchain);
+        } else {
+            *blockchain = new_blockchain;
+        }
+    }
+    if (NULL != address_index) {
+        address_index_destroy(address_index);
+    }
+end:
+    return return_code;
+}
+
+return_code_t blockchain_mapped_log_open(
+    blockchain_mapped_log_t **mapped_log,
+    char *path
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mapped_log || NULL == path) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_mapped_log_t *new_mapped_log = calloc(
+        1, sizeof(blockchain_mapped_log_t));
+    if (NULL == new_mapped_log) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        free(new_mapped_log);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    struct stat file_stats = {0};
+    if (0 != fstat(fd, &file_stats)) {
+        close(fd);
+        free(new_mapped_log);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    if ((uint64_t)file_stats.st_size < BLOCKCHAIN_LOG_HEADER_SIZE) {
+        close(fd);
+        free(new_mapped_log);
+        return_code = FAILURE_INVALID_BLOCKCHAIN;
+        goto end;
+    }
+    // The mapping outlives the descriptor.
+    void *mapping = mmap(
+        NULL, file_stats.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == mapping) {
+        free(new_mapped_log);
+        return_code = FAILURE_FILE_IO;
+        goto end;
+    }
+    new_mapped_log->mapping = mapping;
+    new_mapped_log->mapping_size = file_stats.st_size;
+    return_code = blockchain_log_parse_header(
+        new_mapped_log->mapping,
+        &new_mapped_log->num_leading_zero_bytes_required_in_block_hash);
+    if (SUCCESS != return_code) {
+        blockchain_mapped_log_close(new_mapped_log);
+        goto end;
+    }
+    // Only each record's length prefix and block header are read, so opening
+    // touches about one page per block however large the blocks are.
+    unsigned char *next_record =
+        new_mapped_log->mapping + BLOCKCHAIN_LOG_HEADER_SIZE;
+    unsigned char *mapping_end =
+        new_mapped_log->mapping + new_mapped_log->mapping_size;
+    while (mapping_end - next_record >= BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE) {
+        uint64_t length = blockchain_read_uint32(next_record);
+        unsigned char *record_start =
+            next_record + BLOCKCHAIN_LOG_RECORD_LENGTH_SIZE;
+        // A record that runs past the end of the file was interrupted.
+        if (length > mapping_end - record_start) {
+            break;
+        }
+        if (new_mapped_log->num_blocks == new_mapped_log->blocks_capacity) {
+            uint64_t new_capacity = new_mapped_log->blocks_capacity * 2;
+            if (new_capacity < BLOCKCHAIN_LOG_MIN_CAPACITY) {
+                new_capacity = BLOCKCHAIN_LOG_MIN_CAPACITY;
+            }
+            blockchain_mapped_block_t *new_blocks = realloc(
+                new_mapped_log->blocks,
+                new_capacity * sizeof(blockchain_mapped_block_t));
+            if (NULL == new_blocks) {
+                blockchain_mapped_log_close(new_mapped_log);
+                return_code = FAILURE_COULD_NOT_MALLOC;
+                goto end;
+            }
+            new_mapped_log->blocks = new_blocks;
+            new_mapped_log->blocks_capacity = new_capacity;
+        }
+        blockchain_mapped_block_t *mapped_block =
+            &new_mapped_log->blocks[new_mapped_log->num_blocks];
+        memset(mapped_block, 0, sizeof(blockchain_mapped_block_t));
+        unsigned char *next_spot_in_record = record_start;
+        return_code = blockchain_deserialize_block_header(
+            &mapped_block->header,
+            &mapped_block->num_transactions,
+            &next_spot_in_record,
+            record_start + length,
+            BLOCKCHAIN_SERIALIZATION_VERSION);
+        if (SUCCESS != return_code) {
+            // The record is complete, so running out of bytes means it is
+            // corrupt.
+            if (FAILURE_BUFFER_TOO_SMALL == return_code) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+            }
+            blockchain_mapped_log_close(new_mapped_log);
+            goto end;
+        }
+        mapped_block->record = record_start;
+        mapped_block->record_length = length;
+        mapped_block->transactions = next_spot_in_record;
+        new_mapped_log->num_blocks++;
+        next_record = record_start + length;
+    }
+    *mapped_log = new_mapped_log;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_mapped_log_close(blockchain_mapped_log_t *mapped_log) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mapped_log) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != munmap(mapped_log->mapping, mapped_log->mapping_size)) {
+        return_code = FAILURE_FILE_IO;
+    }
+    free(mapped_log->blocks);
+    free(mapped_log);
+end:
+    return return_code;
+}
+
+return_code_t blockchain_read_transaction_view(
+    blockchain_transaction_view_t *view,
+    unsigned char **next_spot_in_buffer,
+    unsigned char *buffer_end
+) {
+    uint64_t created_at = 0;
+    return_code_t return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &created_at);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    view->created_at = (time_t)created_at;
+    // Each field's bytes end where the length-prefixed read stops.
+    size_t length = 0;
+    return_code = blockchain_read_varint_length_prefixed(
+        next_spot_in_buffer,
+        buffer_end,
+        MAX_PUBLIC_KEY_LENGTH,
+        FAILURE_KEY_TOO_LONG,
+        NULL,
+        &length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    view->sender_public_key = *next_spot_in_buffer - length;
+    view->sender_public_key_length = (uint16_t)length;
+    return_code = blockchain_read_varint_length_prefixed(
+        next_spot_in_buffer,
+        buffer_end,
+        MAX_PUBLIC_KEY_LENGTH,
+        FAILURE_KEY_TOO_LONG,
+        NULL,
+        &length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    view->recipient_public_key = *next_spot_in_buffer - length;
+    view->recipient_public_key_length = (uint16_t)length;
+    return_code = blockchain_read_varint(
+        next_spot_in_buffer, buffer_end, &view->amount);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = blockchain_read_varint_length_prefixed(
+        next_spot_in_buffer,
+        buffer_end,
+        MAX_SSH_SIGNATURE_LENGTH,
+        FAILURE_SIGNATURE_TOO_LONG,
+        NULL,
+        &length);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    view->sender_signature = *next_spot_in_buffer - length;
+    view->sender_signature_length = length;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_mapped_log_get_transactions(
+    blockchain_mapped_log_t *mapped_log,
+    uint64_t height,
+    blockchain_transaction_view_t *views,
+    uint64_t max_views,
+    uint64_t *num_views
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mapped_log ||
+        (NULL == views && 0 != max_views) ||
+        NULL == num_views ||
+        height >= mapped_log->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_mapped_block_t *mapped_block = &mapped_log->blocks[height];
+    if (max_views < mapped_block->num_transactions) {
+        return_code = FAILURE_BUFFER_TOO_SMALL;
+        goto end;
+    }
+    unsigned char *next_spot_in_record = mapped_block->transactions;
+    unsigned char *record_end =
+        mapped_block->record + mapped_block->record_length;
+    for (uint64_t idx = 0; idx < mapped_block->num_transactions; idx++) {
+        return_code = blockchain_read_transaction_view(
+            &views[idx], &next_spot_in_record, record_end);
+        if (SUCCESS != return_code) {
+            if (FAILURE_BUFFER_TOO_SMALL == return_code) {
+                return_code = FAILURE_INVALID_BLOCKCHAIN;
+            }
+            goto end;
+        }
+    }
+    *num_views = mapped_block->num_transactions;
+end:
+    return return_code;
+}
+
+return_code_t blockchain_mapped_log_get_block(
+    blockchain_mapped_log_t *mapped_log,
+    uint64_t height,
+    block_t **block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mapped_log ||
+        NULL == block ||
+        height >= mapped_log->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    blockchain_mapped_block_t *mapped_block = &mapped_log->blocks[height];
+    unsigned char *next_spot_in_record = mapped_block->record;
+    unsigned char *record_end =
+        mapped_block->record + mapped_block->record_length;
+    block_t *new_block = NULL;
+    return_code = blockchain_deserialize_block(
+        &new_block,
+        &next_spot_in_record,
+        record_end,
+        BLOCKCHAIN_SERIALIZATION_VERSION);
+    if (SUCCESS != return_code) {
+        if (FAILURE_BUFFER_TOO_SMALL == return_code) {
+            return_code = FAILURE_INVALID_BLOCKCHAIN;
+        }
+        goto end;
+    }
+    *block = new_block;
 end:
     return return_code;
 }
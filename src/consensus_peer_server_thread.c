@@ -50,16 +50,27 @@ return_code_t handle_one_consensus_request(
         goto end;
     }
     blockchain_t *peer_blockchain = NULL;
-    return_code = blockchain_deserialize(
+    return_code = blockchain_deserialize_into_arena(
         &peer_blockchain,
         command_send_blockchain.blockchain_data,
         command_send_blockchain.blockchain_data_len);
     if (SUCCESS != return_code) {
         goto end;
     }
+    // Only the blocks that extend our verified prefix need to be checked.
     bool peer_blockchain_is_valid = false;
-    return_code = blockchain_verify(
-        peer_blockchain, &peer_blockchain_is_valid, NULL);
+    blockchain_verified_prefix_t peer_verified_prefix = {0};
+    size_t num_verification_threads = args->num_verification_threads;
+    if (0 == num_verification_threads) {
+        num_verification_threads = 1;
+    }
+    return_code = synchronized_blockchain_verify(
+        args->sync,
+        peer_blockchain,
+        &peer_blockchain_is_valid,
+        NULL,
+        &peer_verified_prefix,
+        num_verification_threads);
     if (SUCCESS != return_code) {
         goto end;
     }
@@ -67,12 +78,11 @@ return_code_t handle_one_consensus_request(
         printf("Server received invalid blockchain\n");
     }
     uint64_t peer_blockchain_length = 0;
-    return_code = linked_list_length(
-        peer_blockchain->block_list, &peer_blockchain_length);
+    return_code = blockchain_length(peer_blockchain, &peer_blockchain_length);
     if (SUCCESS != return_code) {
         goto end;
     }
-    bool switched_to_peer_chain = false;
+    bool took_ownership_of_peer_blockchain = false;
     return_code = pthread_mutex_lock(&args->sync->mutex);
     if (SUCCESS != return_code) {
         goto end;
@@ -80,46 +90,55 @@ return_code_t handle_one_consensus_request(
     blockchain_t *our_blockchain = args->sync->blockchain;
     if (peer_blockchain_is_valid) {
         uint64_t our_blockchain_length = 0;
-        return_code = linked_list_length(
-            our_blockchain->block_list, &our_blockchain_length);
+        return_code = blockchain_length(
+            our_blockchain, &our_blockchain_length);
         if (SUCCESS != return_code) {
             pthread_mutex_unlock(&args->sync->mutex);
             goto end;
         }
-        bool same_number_leading_zeros =
-            our_blockchain->num_leading_zero_bytes_required_in_block_hash ==
-            peer_blockchain->num_leading_zero_bytes_required_in_block_hash;
-        if (peer_blockchain_length > our_blockchain_length &&
-            same_number_leading_zeros) {
-            args->sync->blockchain = peer_blockchain;
-            atomic_fetch_add(&args->sync->version, 1);
-            switched_to_peer_chain = true;
-            if (args->print_progress) {
-                printf(
-                    "Server switched to longer blockchain: "
-                    "%"PRIu64" -> %"PRIu64"\n",
-                    our_blockchain_length,
-                    peer_blockchain_length);
-            }
+        bool tip_changed = false;
+        return_code = synchronized_blockchain_adopt_peer_blockchain(
+            args->sync,
+            peer_blockchain,
+            &peer_verified_prefix,
+            &tip_changed,
+            &took_ownership_of_peer_blockchain);
+        if (SUCCESS != return_code) {
+            pthread_mutex_unlock(&args->sync->mutex);
+            goto end;
+        }
+        if (tip_changed && args->print_progress) {
+            printf(
+                "Server switched to longer blockchain: "
+                "%"PRIu64" -> %"PRIu64"\n",
+                our_blockchain_length,
+                peer_blockchain_length);
         } else if (args->print_progress) {
             printf("Server did not switch blockchain\n");
         }
     }
-    our_blockchain = args->sync->blockchain;
+    return_code = pthread_mutex_unlock(&args->sync->mutex);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Serializing the whole blockchain takes a while, so do it in a read
+    // section rather than under the writers' lock.
+    size_t reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        args->sync, &our_blockchain, &reader);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
     free(command_send_blockchain.blockchain_data);
     return_code = blockchain_serialize(
         our_blockchain,
         &command_send_blockchain.blockchain_data,
         &command_send_blockchain.blockchain_data_len);
-    if (SUCCESS != return_code) {
-        pthread_mutex_unlock(&args->sync->mutex);
-        goto end;
-    }
-    return_code = pthread_mutex_unlock(&args->sync->mutex);
+    synchronized_blockchain_read_end(args->sync, reader);
     if (SUCCESS != return_code) {
         goto end;
     }
-    if (!switched_to_peer_chain) {
+    if (!took_ownership_of_peer_blockchain) {
         return_code = blockchain_destroy(peer_blockchain);
         if (SUCCESS != return_code) {
             goto end;
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include <openssl/bio.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include "include/cryptography.h"
+
+#define PEM_PUBLIC_KEY_NAME "PUBLIC KEY"
+#define PEM_PUBLIC_KEY_HEADER "-----BEGIN " PEM_PUBLIC_KEY_NAME "-----\n"
+#define PEM_PUBLIC_KEY_FOOTER "-----END " PEM_PUBLIC_KEY_NAME "-----\n"
+// OpenSSL encodes 48 bytes into each 64 character line of a PEM body.
+#define PEM_BYTES_PER_LINE 48
+
+return_code_t public_key_from_ssh_key(
+    public_key_t *public_key,
+    ssh_key_t *ssh_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == public_key || NULL == ssh_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    memset(public_key, 0, sizeof(public_key_t));
+    size_t pem_length = strnlen(ssh_key->bytes, MAX_SSH_KEY_LENGTH);
+    if (0 == pem_length) {
+        goto end;
+    }
+    BIO *bio = BIO_new_mem_buf(ssh_key->bytes, pem_length);
+    if (NULL == bio) {
+        fprintf(stderr, "Error creating BIO object.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    char *name = NULL;
+    char *header = NULL;
+    unsigned char *data = NULL;
+    long data_length = 0;
+    int pem_read_result = PEM_read_bio(
+        bio, &name, &header, &data, &data_length);
+    BIO_free(bio);
+    if (pem_read_result <= 0) {
+        fprintf(stderr, "Error reading public key.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    if (0 != strcmp(name, PEM_PUBLIC_KEY_NAME)) {
+        fprintf(stderr, "Error reading public key.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto cleanup;
+    }
+    if (data_length > MAX_PUBLIC_KEY_LENGTH) {
+        return_code = FAILURE_KEY_TOO_LONG;
+        goto cleanup;
+    }
+    memcpy(public_key->bytes, data, data_length);
+    public_key->length = data_length;
+cleanup:
+    OPENSSL_free(name);
+    OPENSSL_free(header);
+    OPENSSL_free(data);
+end:
+    return return_code;
+}
+
+return_code_t public_key_to_ssh_key(
+    ssh_key_t *ssh_key,
+    public_key_t *public_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ssh_key ||
+        NULL == public_key ||
+        public_key->length > MAX_PUBLIC_KEY_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    memset(ssh_key, 0, sizeof(ssh_key_t));
+    if (0 == public_key->length) {
+        goto end;
+    }
+    // MAX_PUBLIC_KEY_LENGTH bytes always fit: their PEM form is under 1 KB.
+    char *next_spot_in_key = ssh_key->bytes;
+    memcpy(
+        next_spot_in_key,
+        PEM_PUBLIC_KEY_HEADER,
+        sizeof(PEM_PUBLIC_KEY_HEADER) - 1);
+    next_spot_in_key += sizeof(PEM_PUBLIC_KEY_HEADER) - 1;
+    for (size_t offset = 0;
+        offset < public_key->length;
+        offset += PEM_BYTES_PER_LINE) {
+        size_t line_length = public_key->length - offset;
+        if (line_length > PEM_BYTES_PER_LINE) {
+            line_length = PEM_BYTES_PER_LINE;
+        }
+        int encoded_length = EVP_EncodeBlock(
+            (unsigned char *)next_spot_in_key,
+            public_key->bytes + offset,
+            line_length);
+        next_spot_in_key += encoded_length;
+        *next_spot_in_key = '\n';
+        next_spot_in_key++;
+    }
+    memcpy(
+        next_spot_in_key,
+        PEM_PUBLIC_KEY_FOOTER,
+        sizeof(PEM_PUBLIC_KEY_FOOTER) - 1);
+end:
+    return return_code;
+}
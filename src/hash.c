@@ -1,5 +1,57 @@
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
+#include <openssl/evp.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define HASH_HAVE_SHA_NI_BACKEND
+    #include <cpuid.h>
+    #include <immintrin.h>
+#endif
+#if defined(__GNUC__) && defined(__aarch64__) && \
+    (defined(__linux__) || defined(__APPLE__))
+    #define HASH_HAVE_ARMV8_BACKEND
+    #include <arm_neon.h>
+    #ifdef __linux__
+        #include <sys/auxv.h>
+        #include <asm/hwcap.h>
+    #endif
+#endif
+#include "include/endian.h"
 #include "include/hash.h"
+#include "include/return_codes.h"
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define SHA_256_CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define SHA_256_MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SHA_256_BSIG0(x) (ROTR32(x, 2) ^ ROTR32(x, 13) ^ ROTR32(x, 22))
+#define SHA_256_BSIG1(x) (ROTR32(x, 6) ^ ROTR32(x, 11) ^ ROTR32(x, 25))
+#define SHA_256_SSIG0(x) (ROTR32(x, 7) ^ ROTR32(x, 18) ^ ((x) >> 3))
+#define SHA_256_SSIG1(x) (ROTR32(x, 17) ^ ROTR32(x, 19) ^ ((x) >> 10))
+
+const uint32_t SHA_256_ROUND_CONSTANTS[SHA_256_NUM_ROUNDS] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+const uint32_t SHA_256_INITIAL_STATE[SHA_256_STATE_NUM_WORDS] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
 
 void hash_print(sha_256_t *hash) {
     if (NULL == hash) {
@@ -10,3 +62,369 @@ void hash_print(sha_256_t *hash) {
     }
     printf("\n");
 }
+
+void hash_sha_256_init_state(sha_256_state_t *state) {
+    if (NULL == state) {
+        return;
+    }
+    for (size_t idx = 0; idx < SHA_256_STATE_NUM_WORDS; idx++) {
+        state->words[idx] = SHA_256_INITIAL_STATE[idx];
+    }
+}
+
+return_code_t hash_sha_256_digest_openssl(
+    const void *data,
+    size_t size,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (1 != EVP_Digest(data, size, hash->digest, NULL, EVP_sha256(), NULL)) {
+        return_code = FAILURE_OPENSSL_FUNCTION;
+    }
+    return return_code;
+}
+
+bool hash_sha_256_openssl_is_supported() {
+    return true;
+}
+
+void hash_sha_256_compress_generic(
+    sha_256_state_t *state,
+    const unsigned char *block
+) {
+    uint32_t schedule[SHA_256_NUM_ROUNDS];
+    for (size_t idx = 0; idx < SHA_256_NUM_MESSAGE_WORDS; idx++) {
+        schedule[idx] = (uint32_t)block[4 * idx] << 24 |
+            (uint32_t)block[4 * idx + 1] << 16 |
+            (uint32_t)block[4 * idx + 2] << 8 |
+            (uint32_t)block[4 * idx + 3];
+    }
+    for (size_t idx = SHA_256_NUM_MESSAGE_WORDS;
+        idx < SHA_256_NUM_ROUNDS;
+        idx++) {
+        schedule[idx] = SHA_256_SSIG1(schedule[idx - 2]) +
+            schedule[idx - 7] +
+            SHA_256_SSIG0(schedule[idx - 15]) +
+            schedule[idx - 16];
+    }
+    uint32_t a = state->words[0];
+    uint32_t b = state->words[1];
+    uint32_t c = state->words[2];
+    uint32_t d = state->words[3];
+    uint32_t e = state->words[4];
+    uint32_t f = state->words[5];
+    uint32_t g = state->words[6];
+    uint32_t h = state->words[7];
+    for (size_t idx = 0; idx < SHA_256_NUM_ROUNDS; idx++) {
+        uint32_t t1 = h + SHA_256_BSIG1(e) + SHA_256_CH(e, f, g) +
+            SHA_256_ROUND_CONSTANTS[idx] + schedule[idx];
+        uint32_t t2 = SHA_256_BSIG0(a) + SHA_256_MAJ(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state->words[0] += a;
+    state->words[1] += b;
+    state->words[2] += c;
+    state->words[3] += d;
+    state->words[4] += e;
+    state->words[5] += f;
+    state->words[6] += g;
+    state->words[7] += h;
+}
+
+bool hash_sha_256_generic_is_supported() {
+    return true;
+}
+
+#ifdef HASH_HAVE_SHA_NI_BACKEND
+
+// CPUID leaf 7 reports the SHA extensions in EBX bit 29; leaf 1 reports
+// SSE4.1, which the backend also uses, in ECX bit 19.
+#define CPUID_LEAF_7_EBX_SHA (1 << 29)
+#define CPUID_LEAF_1_ECX_SSE4_1 (1 << 19)
+
+bool hash_sha_256_sha_ni_is_supported() {
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) ||
+        !(ecx & CPUID_LEAF_1_ECX_SSE4_1)) {
+        return false;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return ebx & CPUID_LEAF_7_EBX_SHA;
+}
+
+__attribute__((target("sha,sse4.1")))
+void hash_sha_256_compress_sha_ni(
+    sha_256_state_t *state,
+    const unsigned char *block
+) {
+    // The SHA instructions keep the state as ABEF and CDGH vectors.
+    __m128i tmp = _mm_loadu_si128((__m128i *)&state->words[0]);
+    __m128i state1 = _mm_loadu_si128((__m128i *)&state->words[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);
+    state1 = _mm_shuffle_epi32(state1, 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+    __m128i abef_save = state0;
+    __m128i cdgh_save = state1;
+    // Message words are big endian.
+    const __m128i byte_swap_mask = _mm_set_epi64x(
+        0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i message[4];
+    for (size_t idx = 0; idx < 4; idx++) {
+        message[idx] = _mm_shuffle_epi8(
+            _mm_loadu_si128((__m128i *)(block + 16 * idx)), byte_swap_mask);
+    }
+    // Each iteration runs four rounds. message[idx % 4] holds the four most
+    // recent schedule words that are congruent to idx mod 4.
+    for (size_t idx = 0; idx < SHA_256_NUM_ROUNDS / 4; idx++) {
+        if (idx >= 4) {
+            __m128i words = _mm_sha256msg1_epu32(
+                message[idx % 4], message[(idx + 1) % 4]);
+            words = _mm_add_epi32(
+                words,
+                _mm_alignr_epi8(
+                    message[(idx + 3) % 4], message[(idx + 2) % 4], 4));
+            message[idx % 4] = _mm_sha256msg2_epu32(
+                words, message[(idx + 3) % 4]);
+        }
+        __m128i words = _mm_add_epi32(
+            message[idx % 4],
+            _mm_loadu_si128((__m128i *)&SHA_256_ROUND_CONSTANTS[4 * idx]));
+        state1 = _mm_sha256rnds2_epu32(state1, state0, words);
+        words = _mm_shuffle_epi32(words, 0x0e);
+        state0 = _mm_sha256rnds2_epu32(state0, state1, words);
+    }
+    state0 = _mm_add_epi32(state0, abef_save);
+    state1 = _mm_add_epi32(state1, cdgh_save);
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i *)&state->words[0], state0);
+    _mm_storeu_si128((__m128i *)&state->words[4], state1);
+}
+
+#endif  // HASH_HAVE_SHA_NI_BACKEND
+
+#ifdef HASH_HAVE_ARMV8_BACKEND
+
+bool hash_sha_256_armv8_is_supported() {
+    #ifdef __APPLE__
+        // Every 64 bit Apple processor has the SHA-2 instructions.
+        return true;
+    #else
+        return getauxval(AT_HWCAP) & HWCAP_SHA2;
+    #endif
+}
+
+__attribute__((target("+crypto")))
+void hash_sha_256_compress_armv8(
+    sha_256_state_t *state,
+    const unsigned char *block
+) {
+    uint32x4_t state0 = vld1q_u32(&state->words[0]);
+    uint32x4_t state1 = vld1q_u32(&state->words[4]);
+    uint32x4_t abcd_save = state0;
+    uint32x4_t efgh_save = state1;
+    // Message words are big endian.
+    uint32x4_t message[4];
+    for (size_t idx = 0; idx < 4; idx++) {
+        message[idx] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(
+            block + 16 * idx)));
+    }
+    // Each iteration runs four rounds. message[idx % 4] holds the four most
+    // recent schedule words that are congruent to idx mod 4.
+    for (size_t idx = 0; idx < SHA_256_NUM_ROUNDS / 4; idx++) {
+        if (idx >= 4) {
+            message[idx % 4] = vsha256su1q_u32(
+                vsha256su0q_u32(message[idx % 4], message[(idx + 1) % 4]),
+                message[(idx + 2) % 4],
+                message[(idx + 3) % 4]);
+        }
+        uint32x4_t words = vaddq_u32(
+            message[idx % 4], vld1q_u32(&SHA_256_ROUND_CONSTANTS[4 * idx]));
+        uint32x4_t previous_state0 = state0;
+        state0 = vsha256hq_u32(state0, state1, words);
+        state1 = vsha256h2q_u32(state1, previous_state0, words);
+    }
+    vst1q_u32(&state->words[0], vaddq_u32(state0, abcd_save));
+    vst1q_u32(&state->words[4], vaddq_u32(state1, efgh_save));
+}
+
+#endif  // HASH_HAVE_ARMV8_BACKEND
+
+// Ordered from most to least preferred.
+const hash_backend_t HASH_BACKENDS[HASH_NUM_BACKENDS] = {
+    {
+        HASH_BACKEND_OPENSSL,
+        NULL,
+        hash_sha_256_digest_openssl,
+        hash_sha_256_openssl_is_supported},
+#ifdef HASH_HAVE_SHA_NI_BACKEND
+    {
+        HASH_BACKEND_SHA_NI,
+        hash_sha_256_compress_sha_ni,
+        NULL,
+        hash_sha_256_sha_ni_is_supported},
+#else
+    {HASH_BACKEND_SHA_NI, NULL, NULL, NULL},
+#endif
+#ifdef HASH_HAVE_ARMV8_BACKEND
+    {
+        HASH_BACKEND_ARMV8,
+        hash_sha_256_compress_armv8,
+        NULL,
+        hash_sha_256_armv8_is_supported},
+#else
+    {HASH_BACKEND_ARMV8, NULL, NULL, NULL},
+#endif
+    {
+        HASH_BACKEND_GENERIC,
+        hash_sha_256_compress_generic,
+        NULL,
+        hash_sha_256_generic_is_supported},
+};
+
+_Atomic(const hash_backend_t *) hash_selected_backend = NULL;
+_Atomic(const hash_backend_t *) hash_selected_compress_backend = NULL;
+
+bool hash_backend_is_supported(const hash_backend_t *backend) {
+    return NULL != backend &&
+        (NULL != backend->compress || NULL != backend->digest) &&
+        backend->is_supported();
+}
+
+const hash_backend_t *hash_get_backend() {
+    const hash_backend_t *backend = atomic_load(&hash_selected_backend);
+    if (NULL != backend) {
+        return backend;
+    }
+    // Select the best backend on first use. Threads racing here all pick the
+    // same one, so there is no harm in more than one storing it.
+    for (size_t idx = 0; idx < HASH_NUM_BACKENDS; idx++) {
+        if (hash_backend_is_supported(&HASH_BACKENDS[idx])) {
+            backend = &HASH_BACKENDS[idx];
+            break;
+        }
+    }
+    atomic_store(&hash_selected_backend, backend);
+    return backend;
+}
+
+const hash_backend_t *hash_get_compress_backend() {
+    const hash_backend_t *backend = atomic_load(
+        &hash_selected_compress_backend);
+    if (NULL != backend) {
+        return backend;
+    }
+    backend = hash_get_backend();
+    if (NULL == backend->compress) {
+        for (size_t idx = 0; idx < HASH_NUM_BACKENDS; idx++) {
+            if (NULL != HASH_BACKENDS[idx].compress &&
+                hash_backend_is_supported(&HASH_BACKENDS[idx])) {
+                backend = &HASH_BACKENDS[idx];
+                break;
+            }
+        }
+    }
+    atomic_store(&hash_selected_compress_backend, backend);
+    return backend;
+}
+
+return_code_t hash_set_backend(const char *name) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == name) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    for (size_t idx = 0; idx < HASH_NUM_BACKENDS; idx++) {
+        if (0 != strcmp(name, HASH_BACKENDS[idx].name)) {
+            continue;
+        }
+        if (!hash_backend_is_supported(&HASH_BACKENDS[idx])) {
+            return_code = FAILURE_HASH_BACKEND_NOT_SUPPORTED;
+            goto end;
+        }
+        atomic_store(&hash_selected_backend, &HASH_BACKENDS[idx]);
+        atomic_store(&hash_selected_compress_backend, NULL);
+        goto end;
+    }
+    return_code = FAILURE_INVALID_INPUT;
+end:
+    return return_code;
+}
+
+void hash_sha_256_compress(sha_256_state_t *state, const unsigned char *block) {
+    if (NULL == state || NULL == block) {
+        return;
+    }
+    hash_get_compress_backend()->compress(state, block);
+}
+
+void hash_sha_256_state_to_digest(sha_256_state_t *state, sha_256_t *hash) {
+    if (NULL == state || NULL == hash) {
+        return;
+    }
+    for (size_t idx = 0; idx < SHA_256_STATE_NUM_WORDS; idx++) {
+        hash->digest[4 * idx] = state->words[idx] >> 24;
+        hash->digest[4 * idx + 1] = state->words[idx] >> 16;
+        hash->digest[4 * idx + 2] = state->words[idx] >> 8;
+        hash->digest[4 * idx + 3] = state->words[idx];
+    }
+}
+
+return_code_t hash_sha_256(const void *data, size_t size, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if ((NULL == data && 0 != size) || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    const hash_backend_t *backend = hash_get_backend();
+    if (NULL != backend->digest) {
+        return_code = backend->digest(data, size, hash);
+        goto end;
+    }
+    hash_sha_256_compress_function_t *compress = backend->compress;
+    sha_256_state_t state;
+    hash_sha_256_init_state(&state);
+    const unsigned char *next_block = data;
+    size_t size_remaining = size;
+    for (; size_remaining >= SHA_256_BLOCK_SIZE;
+        size_remaining -= SHA_256_BLOCK_SIZE) {
+        compress(&state, next_block);
+        next_block += SHA_256_BLOCK_SIZE;
+    }
+    // Pad the rest of the message with a single 1 bit, zeros, and the message
+    // length in bits. This takes one or two more blocks.
+    unsigned char final_blocks[2 * SHA_256_BLOCK_SIZE] = {0};
+    if (0 != size_remaining) {
+        memcpy(final_blocks, next_block, size_remaining);
+    }
+    final_blocks[size_remaining] = SHA_256_PADDING_START_BYTE;
+    size_t num_final_blocks =
+        size_remaining + 1 + sizeof(uint64_t) > SHA_256_BLOCK_SIZE ? 2 : 1;
+    uint64_t message_length_bits = htobe64((uint64_t)size * 8);
+    memcpy(
+        final_blocks + num_final_blocks * SHA_256_BLOCK_SIZE -
+            sizeof(message_length_bits),
+        &message_length_bits,
+        sizeof(message_length_bits));
+    for (size_t idx = 0; idx < num_final_blocks; idx++) {
+        compress(&state, final_blocks + idx * SHA_256_BLOCK_SIZE);
+    }
+    hash_sha_256_state_to_digest(&state, hash);
+end:
+    return return_code;
+}
@@ -0,0 +1,249 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/ledger.h"
+#include "include/linked_list.h"
+#include "include/transaction.h"
+
+return_code_t ledger_create(ledger_t **ledger, size_t expected_num_accounts) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t capacity = LEDGER_MIN_CAPACITY;
+    while (capacity < 2 * expected_num_accounts) {
+        capacity *= 2;
+    }
+    ledger_t *new_ledger = calloc(1, sizeof(ledger_t));
+    if (NULL == new_ledger) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_ledger->entries = calloc(capacity, sizeof(ledger_entry_t));
+    if (NULL == new_ledger->entries) {
+        free(new_ledger);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_ledger->capacity = capacity;
+    *ledger = new_ledger;
+end:
+    return return_code;
+}
+
+return_code_t ledger_destroy(ledger_t *ledger) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    free(ledger->entries);
+    free(ledger);
+end:
+    return return_code;
+}
+
+return_code_t ledger_copy(ledger_t **copy, ledger_t *ledger) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == copy || NULL == ledger) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    ledger_t *new_ledger = malloc(sizeof(ledger_t));
+    if (NULL == new_ledger) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    *new_ledger = *ledger;
+    new_ledger->entries = malloc(ledger->capacity * sizeof(ledger_entry_t));
+    if (NULL == new_ledger->entries) {
+        free(new_ledger);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    memcpy(
+        new_ledger->entries,
+        ledger->entries,
+        ledger->capacity * sizeof(ledger_entry_t));
+    *copy = new_ledger;
+end:
+    return return_code;
+}
+
+ledger_entry_t *ledger_probe(
+    ledger_entry_t *entries,
+    size_t capacity,
+    sha_256_t *key_digest
+) {
+    uint64_t slot = 0;
+    memcpy(&slot, key_digest->digest, sizeof(slot));
+    size_t mask = capacity - 1;
+    for (size_t idx = slot & mask; ; idx = (idx + 1) & mask) {
+        if (!entries[idx].is_occupied ||
+            0 == memcmp(
+                &entries[idx].key_digest, key_digest, sizeof(sha_256_t))) {
+            return &entries[idx];
+        }
+    }
+}
+
+return_code_t ledger_reserve(ledger_t *ledger, size_t num_accounts) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    size_t new_capacity = ledger->capacity;
+    while (2 * (ledger->num_entries + num_accounts) > new_capacity) {
+        new_capacity *= 2;
+    }
+    if (new_capacity == ledger->capacity) {
+        goto end;
+    }
+    ledger_entry_t *new_entries = calloc(new_capacity, sizeof(ledger_entry_t));
+    if (NULL == new_entries) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    for (size_t idx = 0; idx < ledger->capacity; idx++) {
+        if (ledger->entries[idx].is_occupied) {
+            *ledger_probe(
+                new_entries, new_capacity, &ledger->entries[idx].key_digest) =
+                ledger->entries[idx];
+        }
+    }
+    free(ledger->entries);
+    ledger->entries = new_entries;
+    ledger->capacity = new_capacity;
+end:
+    return return_code;
+}
+
+ledger_entry_t *ledger_get_entry(ledger_t *ledger, public_key_t *public_key) {
+    // Hashing cannot fail on a valid key, and the caller has reserved room
+    // for the account.
+    sha_256_t key_digest = {0};
+    hash_sha_256(public_key->bytes, public_key->length, &key_digest);
+    ledger_entry_t *entry = ledger_probe(
+        ledger->entries, ledger->capacity, &key_digest);
+    if (!entry->is_occupied) {
+        entry->key_digest = key_digest;
+        entry->balance = 0;
+        entry->is_occupied = true;
+        ledger->num_entries++;
+    }
+    return entry;
+}
+
+void ledger_add_to_balance(ledger_entry_t *entry, uint64_t amount) {
+    // Unsigned arithmetic wraps instead of overflowing on hostile amounts.
+    entry->balance = (int64_t)((uint64_t)entry->balance + amount);
+}
+
+void ledger_subtract_from_balance(ledger_entry_t *entry, uint64_t amount) {
+    entry->balance = (int64_t)((uint64_t)entry->balance - amount);
+}
+
+return_code_t ledger_apply_block(
+    ledger_t *ledger,
+    block_t *block,
+    bool *overspends
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Each transaction names at most two accounts, so reserving room for
+    // them up front means nothing below can fail.
+    size_t num_transactions = 0;
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        num_transactions++;
+    }
+    return_code = ledger_reserve(ledger, 2 * num_transactions);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    bool block_overspends = false;
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        transaction_t *transaction = (transaction_t *)node->data;
+        if (node != block->transaction_list->head) {
+            ledger_entry_t *sender_entry = ledger_get_entry(
+                ledger, &transaction->sender_public_key);
+            if (sender_entry->balance < 0 ||
+                (uint64_t)sender_entry->balance < transaction->amount) {
+                block_overspends = true;
+            }
+            ledger_subtract_from_balance(sender_entry, transaction->amount);
+        }
+        ledger_entry_t *recipient_entry = ledger_get_entry(
+            ledger, &transaction->recipient_public_key);
+        ledger_add_to_balance(recipient_entry, transaction->amount);
+    }
+    if (!block_overspends &&
+        ledger->num_blocks_without_overspend == ledger->num_blocks) {
+        ledger->num_blocks_without_overspend++;
+    }
+    ledger->num_blocks++;
+    if (NULL != overspends) {
+        *overspends = block_overspends;
+    }
+end:
+    return return_code;
+}
+
+return_code_t ledger_revert_block(ledger_t *ledger, block_t *block) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger || NULL == block || 0 == ledger->num_blocks) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Applying the block added every account it names, so this only updates
+    // existing entries.
+    for (node_t *node = block->transaction_list->head;
+        NULL != node;
+        node = node->next) {
+        transaction_t *transaction = (transaction_t *)node->data;
+        if (node != block->transaction_list->head) {
+            ledger_entry_t *sender_entry = ledger_get_entry(
+                ledger, &transaction->sender_public_key);
+            ledger_add_to_balance(sender_entry, transaction->amount);
+        }
+        ledger_entry_t *recipient_entry = ledger_get_entry(
+            ledger, &transaction->recipient_public_key);
+        ledger_subtract_from_balance(recipient_entry, transaction->amount);
+    }
+    ledger->num_blocks--;
+    if (ledger->num_blocks_without_overspend > ledger->num_blocks) {
+        ledger->num_blocks_without_overspend = ledger->num_blocks;
+    }
+end:
+    return return_code;
+}
+
+return_code_t ledger_get_balance(
+    ledger_t *ledger,
+    public_key_t *public_key,
+    int64_t *balance
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == ledger || NULL == public_key || NULL == balance) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    sha_256_t key_digest = {0};
+    return_code = hash_sha_256(
+        public_key->bytes, public_key->length, &key_digest);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    ledger_entry_t *entry = ledger_probe(
+        ledger->entries, ledger->capacity, &key_digest);
+    *balance = entry->is_occupied ? entry->balance : 0;
+end:
+    return return_code;
+}
@@ -12,6 +12,8 @@
 #include "include/blockchain.h"
 #include "include/block.h"
 #include "include/consensus_peer_server_thread.h"
+#include "include/hash.h"
+#include "include/mining_hash.h"
 #include "include/mining_thread.h"
 #include "include/peer_discovery.h"
 #include "include/peer_discovery_thread.h"
@@ -34,9 +36,20 @@ void print_usage_statement(char *program_name) {
         "[peer_discovery_bootstrap_server_port] "
         "-i [communication_interval_seconds] "
         "-n [num_leading_zeros] "
+        "-t [num_mining_threads] "
+        "-b [hash_backend] "
+        "-s [blocks_per_sync] "
         "-p [private_key_file_base64_encoded_contents] "
         "-k [public_key_file_base64_encoded_contents]\n",
         program_name);
+    fprintf(
+        stderr,
+        "Hash backends: %s, %s, %s, %s (default: %s)\n",
+        HASH_BACKEND_OPENSSL,
+        HASH_BACKEND_SHA_NI,
+        HASH_BACKEND_ARMV8,
+        HASH_BACKEND_GENERIC,
+        HASH_BACKEND_OPENSSL);
     fprintf(
         stderr,
         "Or supply keys as environment variables %s and %s\n",
@@ -56,13 +69,15 @@ int main(int argc, char **argv) {
     uint64_t communication_interval_seconds =
         DEFAULT_COMMUNICATION_INTERVAL_SECONDS;
     size_t num_leading_zeros = NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH;
+    size_t num_mining_threads = DEFAULT_NUM_MINING_THREADS;
+    size_t outfile_blocks_per_sync = DEFAULT_OUTFILE_BLOCKS_PER_SYNC;
     char *ssh_private_key_contents_base64 = NULL;
     char *ssh_public_key_contents_base64 = NULL;
     int opt;
     while ((opt = getopt(
         argc - num_positional_args,
         argv + num_positional_args,
-        "i:p:k:n:")) != -1) {
+        "i:p:k:n:t:b:s:")) != -1) {
         switch (opt) {
             case 'i':
                 communication_interval_seconds = strtol(optarg, NULL, 10);
@@ -78,6 +93,29 @@ int main(int argc, char **argv) {
             case 'n':
                 num_leading_zeros = strtol(optarg, NULL, 10);
                 break;
+            case 't':
+                if (strtol(optarg, NULL, 10) < 1) {
+                    print_usage_statement(argv[0]);
+                    return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+                    goto end;
+                }
+                num_mining_threads = strtol(optarg, NULL, 10);
+                break;
+            case 's':
+                outfile_blocks_per_sync = strtol(optarg, NULL, 10);
+                break;
+            case 'b':
+                return_code = hash_set_backend(optarg);
+                if (SUCCESS != return_code) {
+                    fprintf(
+                        stderr,
+                        "Hash backend %s is not available on this machine\n",
+                        optarg);
+                    print_usage_statement(argv[0]);
+                    return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
+                    goto end;
+                }
+                break;
             default:
                 print_usage_statement(argv[0]);
                 return_code = FAILURE_INVALID_COMMAND_LINE_ARGS;
@@ -201,6 +239,14 @@ int main(int argc, char **argv) {
         goto end;
     }
     printf("Using public key: %s\n", miner_public_key.bytes);
+    printf("Mining with %zu thread(s)\n", num_mining_threads);
+    printf("Using SHA-256 backend: %s\n", hash_get_backend()->name);
+    printf(
+        "Using SHA-256 compression backend: %s\n",
+        hash_get_compress_backend()->name);
+    printf(
+        "Using proof of work sweep kernel: %s\n",
+        mining_hash_kernel_name(mining_hash_best_kernel()));
     blockchain_t *blockchain = NULL;
     block_t *genesis_block = NULL;
     return_code = blockchain_create(&blockchain, num_leading_zeros);
@@ -234,7 +280,9 @@ int main(int argc, char **argv) {
     mine_blocks_args.peer_info_list_mutex =
         discover_peers_args.peer_info_list_mutex;
     mine_blocks_args.print_progress = true;
-    mine_blocks_args.outfile = "blockchain.bin";
+    mine_blocks_args.num_mining_threads = num_mining_threads;
+    mine_blocks_args.outfile = "blockchain.log";
+    mine_blocks_args.outfile_blocks_per_sync = outfile_blocks_per_sync;
     mine_blocks_args.should_stop = &should_stop;
     bool exit_ready = false;
     mine_blocks_args.exit_ready = &exit_ready;
@@ -270,6 +318,8 @@ int main(int argc, char **argv) {
         htons(peer_port);
     run_consensus_peer_server_args.sync = sync;
     run_consensus_peer_server_args.print_progress = false;
+    run_consensus_peer_server_args.num_verification_threads =
+        num_mining_threads;
     atomic_bool run_consensus_peer_server_should_stop = false;
     run_consensus_peer_server_args.should_stop =
         &run_consensus_peer_server_should_stop;
@@ -0,0 +1,405 @@
+#include <stdbool.h>
+#include <string.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define MINING_HASH_HAVE_X86_KERNELS
+    #include <immintrin.h>
+#endif
+#include "include/block.h"
+#include "include/endian.h"
+#include "include/hash.h"
+#include "include/mining_hash.h"
+#include "include/return_codes.h"
+
+// The final block holds the proof of work in message words 2 (high half) and
+// 3 (low half).
+#define MINING_HASH_PROOF_OF_WORK_HIGH_WORD 2
+#define MINING_HASH_PROOF_OF_WORK_LOW_WORD 3
+#define MINING_HASH_AVX2_NUM_LANES 8
+#define MINING_HASH_AVX512_NUM_LANES 16
+
+return_code_t mining_hash_template_init(
+    mining_hash_template_t *mining_template,
+    block_t *block
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mining_template || NULL == block) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char header[MINING_HASH_NUM_BLOCKS * SHA_256_BLOCK_SIZE] = {0};
+    return_code = block_serialize_header(block, header);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    // Standard SHA-256 padding: a single 1 bit, zeros, then the message length
+    // in bits as a big endian 64 bit integer at the very end.
+    header[BLOCK_HEADER_SIZE] = SHA_256_PADDING_START_BYTE;
+    uint64_t message_length_bits = htobe64((uint64_t)BLOCK_HEADER_SIZE * 8);
+    memcpy(
+        header + sizeof(header) - sizeof(message_length_bits),
+        &message_length_bits,
+        sizeof(message_length_bits));
+    hash_sha_256_init_state(&mining_template->midstate);
+    hash_sha_256_compress(&mining_template->midstate, header);
+    memcpy(
+        mining_template->final_block,
+        header + SHA_256_BLOCK_SIZE,
+        SHA_256_BLOCK_SIZE);
+end:
+    return return_code;
+}
+
+return_code_t mining_hash_compute(
+    mining_hash_template_t *mining_template,
+    uint64_t proof_of_work,
+    sha_256_t *hash
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mining_template || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char final_block[SHA_256_BLOCK_SIZE];
+    memcpy(final_block, mining_template->final_block, SHA_256_BLOCK_SIZE);
+    uint64_t proof_of_work_big_endian = htobe64(proof_of_work);
+    memcpy(
+        final_block + MINING_HASH_PROOF_OF_WORK_OFFSET,
+        &proof_of_work_big_endian,
+        sizeof(proof_of_work_big_endian));
+    sha_256_state_t state = mining_template->midstate;
+    hash_sha_256_compress(&state, final_block);
+    hash_sha_256_state_to_digest(&state, hash);
+end:
+    return return_code;
+}
+
+void mining_hash_parse_final_block(
+    mining_hash_template_t *mining_template,
+    uint32_t *message
+) {
+    unsigned char *block = mining_template->final_block;
+    for (size_t idx = 0; idx < SHA_256_NUM_MESSAGE_WORDS; idx++) {
+        message[idx] = (uint32_t)block[4 * idx] << 24 |
+            (uint32_t)block[4 * idx + 1] << 16 |
+            (uint32_t)block[4 * idx + 2] << 8 |
+            (uint32_t)block[4 * idx + 3];
+    }
+}
+
+void mining_hash_first_words_scalar(
+    mining_hash_template_t *mining_template,
+    uint64_t first_proof_of_work,
+    uint32_t *first_words
+) {
+    unsigned char final_block[SHA_256_BLOCK_SIZE];
+    memcpy(final_block, mining_template->final_block, SHA_256_BLOCK_SIZE);
+    for (size_t idx = 0; idx < MINING_HASH_SWEEP_SIZE; idx++) {
+        uint64_t proof_of_work = htobe64(first_proof_of_work + idx);
+        memcpy(
+            final_block + MINING_HASH_PROOF_OF_WORK_OFFSET,
+            &proof_of_work,
+            sizeof(proof_of_work));
+        sha_256_state_t state = mining_template->midstate;
+        hash_sha_256_compress(&state, final_block);
+        first_words[idx] = state.words[0];
+    }
+}
+
+#ifdef MINING_HASH_HAVE_X86_KERNELS
+
+#define AVX2_ADD(x, y) _mm256_add_epi32(x, y)
+#define AVX2_ROTR(x, n) \
+    _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define AVX2_XOR3(x, y, z) _mm256_xor_si256(_mm256_xor_si256(x, y), z)
+#define AVX2_CH(x, y, z) \
+    _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define AVX2_MAJ(x, y, z) AVX2_XOR3( \
+    _mm256_and_si256(x, y), _mm256_and_si256(x, z), _mm256_and_si256(y, z))
+#define AVX2_BSIG0(x) AVX2_XOR3(AVX2_ROTR(x, 2), AVX2_ROTR(x, 13), \
+    AVX2_ROTR(x, 22))
+#define AVX2_BSIG1(x) AVX2_XOR3(AVX2_ROTR(x, 6), AVX2_ROTR(x, 11), \
+    AVX2_ROTR(x, 25))
+#define AVX2_SSIG0(x) AVX2_XOR3(AVX2_ROTR(x, 7), AVX2_ROTR(x, 18), \
+    _mm256_srli_epi32(x, 3))
+#define AVX2_SSIG1(x) AVX2_XOR3(AVX2_ROTR(x, 17), AVX2_ROTR(x, 19), \
+    _mm256_srli_epi32(x, 10))
+
+__attribute__((target("avx2")))
+void mining_hash_first_words_avx2(
+    mining_hash_template_t *mining_template,
+    uint64_t first_proof_of_work,
+    uint32_t *first_words
+) {
+    uint32_t message[SHA_256_NUM_MESSAGE_WORDS];
+    mining_hash_parse_final_block(mining_template, message);
+    uint32_t *midstate = mining_template->midstate.words;
+    for (size_t pass = 0;
+        pass < MINING_HASH_SWEEP_SIZE / MINING_HASH_AVX2_NUM_LANES;
+        pass++) {
+        // Each lane hashes its own proof of work; the rest of the message is
+        // the same in every lane.
+        uint32_t high_words[MINING_HASH_AVX2_NUM_LANES];
+        uint32_t low_words[MINING_HASH_AVX2_NUM_LANES];
+        for (size_t lane = 0; lane < MINING_HASH_AVX2_NUM_LANES; lane++) {
+            uint64_t proof_of_work = first_proof_of_work +
+                pass * MINING_HASH_AVX2_NUM_LANES + lane;
+            high_words[lane] = proof_of_work >> 32;
+            low_words[lane] = (uint32_t)proof_of_work;
+        }
+        __m256i schedule[SHA_256_NUM_ROUNDS];
+        for (size_t idx = 0; idx < SHA_256_NUM_MESSAGE_WORDS; idx++) {
+            schedule[idx] = _mm256_set1_epi32(message[idx]);
+        }
+        schedule[MINING_HASH_PROOF_OF_WORK_HIGH_WORD] =
+            _mm256_loadu_si256((__m256i *)high_words);
+        schedule[MINING_HASH_PROOF_OF_WORK_LOW_WORD] =
+            _mm256_loadu_si256((__m256i *)low_words);
+        for (size_t idx = SHA_256_NUM_MESSAGE_WORDS;
+            idx < SHA_256_NUM_ROUNDS;
+            idx++) {
+            schedule[idx] = AVX2_ADD(
+                AVX2_ADD(AVX2_SSIG1(schedule[idx - 2]), schedule[idx - 7]),
+                AVX2_ADD(AVX2_SSIG0(schedule[idx - 15]), schedule[idx - 16]));
+        }
+        __m256i a = _mm256_set1_epi32(midstate[0]);
+        __m256i b = _mm256_set1_epi32(midstate[1]);
+        __m256i c = _mm256_set1_epi32(midstate[2]);
+        __m256i d = _mm256_set1_epi32(midstate[3]);
+        __m256i e = _mm256_set1_epi32(midstate[4]);
+        __m256i f = _mm256_set1_epi32(midstate[5]);
+        __m256i g = _mm256_set1_epi32(midstate[6]);
+        __m256i h = _mm256_set1_epi32(midstate[7]);
+        for (size_t idx = 0; idx < SHA_256_NUM_ROUNDS; idx++) {
+            __m256i t1 = AVX2_ADD(
+                AVX2_ADD(h, AVX2_BSIG1(e)),
+                AVX2_ADD(
+                    AVX2_CH(e, f, g),
+                    AVX2_ADD(
+                        _mm256_set1_epi32(SHA_256_ROUND_CONSTANTS[idx]),
+                        schedule[idx])));
+            __m256i t2 = AVX2_ADD(AVX2_BSIG0(a), AVX2_MAJ(a, b, c));
+            h = g;
+            g = f;
+            f = e;
+            e = AVX2_ADD(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = AVX2_ADD(t1, t2);
+        }
+        // The leading zero check only needs the first output word.
+        a = AVX2_ADD(a, _mm256_set1_epi32(midstate[0]));
+        _mm256_storeu_si256(
+            (__m256i *)(first_words + pass * MINING_HASH_AVX2_NUM_LANES), a);
+    }
+}
+
+#define AVX512_ADD(x, y) _mm512_add_epi32(x, y)
+#define AVX512_XOR3(x, y, z) _mm512_xor_si512(_mm512_xor_si512(x, y), z)
+#define AVX512_CH(x, y, z) \
+    _mm512_xor_si512(_mm512_and_si512(x, y), _mm512_andnot_si512(x, z))
+#define AVX512_MAJ(x, y, z) AVX512_XOR3( \
+    _mm512_and_si512(x, y), _mm512_and_si512(x, z), _mm512_and_si512(y, z))
+#define AVX512_BSIG0(x) AVX512_XOR3(_mm512_ror_epi32(x, 2), \
+    _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22))
+#define AVX512_BSIG1(x) AVX512_XOR3(_mm512_ror_epi32(x, 6), \
+    _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25))
+#define AVX512_SSIG0(x) AVX512_XOR3(_mm512_ror_epi32(x, 7), \
+    _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3))
+#define AVX512_SSIG1(x) AVX512_XOR3(_mm512_ror_epi32(x, 17), \
+    _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10))
+
+__attribute__((target("avx512f")))
+void mining_hash_first_words_avx512(
+    mining_hash_template_t *mining_template,
+    uint64_t first_proof_of_work,
+    uint32_t *first_words
+) {
+    uint32_t message[SHA_256_NUM_MESSAGE_WORDS];
+    mining_hash_parse_final_block(mining_template, message);
+    uint32_t *midstate = mining_template->midstate.words;
+    for (size_t pass = 0;
+        pass < MINING_HASH_SWEEP_SIZE / MINING_HASH_AVX512_NUM_LANES;
+        pass++) {
+        uint32_t high_words[MINING_HASH_AVX512_NUM_LANES];
+        uint32_t low_words[MINING_HASH_AVX512_NUM_LANES];
+        for (size_t lane = 0; lane < MINING_HASH_AVX512_NUM_LANES; lane++) {
+            uint64_t proof_of_work = first_proof_of_work +
+                pass * MINING_HASH_AVX512_NUM_LANES + lane;
+            high_words[lane] = proof_of_work >> 32;
+            low_words[lane] = (uint32_t)proof_of_work;
+        }
+        __m512i schedule[SHA_256_NUM_ROUNDS];
+        for (size_t idx = 0; idx < SHA_256_NUM_MESSAGE_WORDS; idx++) {
+            schedule[idx] = _mm512_set1_epi32(message[idx]);
+        }
+        schedule[MINING_HASH_PROOF_OF_WORK_HIGH_WORD] =
+            _mm512_loadu_si512(high_words);
+        schedule[MINING_HASH_PROOF_OF_WORK_LOW_WORD] =
+            _mm512_loadu_si512(low_words);
+        for (size_t idx = SHA_256_NUM_MESSAGE_WORDS;
+            idx < SHA_256_NUM_ROUNDS;
+            idx++) {
+            schedule[idx] = AVX512_ADD(
+                AVX512_ADD(
+                    AVX512_SSIG1(schedule[idx - 2]), schedule[idx - 7]),
+                AVX512_ADD(
+                    AVX512_SSIG0(schedule[idx - 15]), schedule[idx - 16]));
+        }
+        __m512i a = _mm512_set1_epi32(midstate[0]);
+        __m512i b = _mm512_set1_epi32(midstate[1]);
+        __m512i c = _mm512_set1_epi32(midstate[2]);
+        __m512i d = _mm512_set1_epi32(midstate[3]);
+        __m512i e = _mm512_set1_epi32(midstate[4]);
+        __m512i f = _mm512_set1_epi32(midstate[5]);
+        __m512i g = _mm512_set1_epi32(midstate[6]);
+        __m512i h = _mm512_set1_epi32(midstate[7]);
+        for (size_t idx = 0; idx < SHA_256_NUM_ROUNDS; idx++) {
+            __m512i t1 = AVX512_ADD(
+                AVX512_ADD(h, AVX512_BSIG1(e)),
+                AVX512_ADD(
+                    AVX512_CH(e, f, g),
+                    AVX512_ADD(
+                        _mm512_set1_epi32(SHA_256_ROUND_CONSTANTS[idx]),
+                        schedule[idx])));
+            __m512i t2 = AVX512_ADD(AVX512_BSIG0(a), AVX512_MAJ(a, b, c));
+            h = g;
+            g = f;
+            f = e;
+            e = AVX512_ADD(d, t1);
+            d = c;
+            c = b;
+            b = a;
+            a = AVX512_ADD(t1, t2);
+        }
+        a = AVX512_ADD(a, _mm512_set1_epi32(midstate[0]));
+        _mm512_storeu_si512(
+            first_words + pass * MINING_HASH_AVX512_NUM_LANES, a);
+    }
+}
+
+#endif  // MINING_HASH_HAVE_X86_KERNELS
+
+bool mining_hash_kernel_is_supported(mining_hash_kernel_t kernel) {
+    switch (kernel) {
+        case MINING_HASH_KERNEL_SCALAR:
+            return true;
+#ifdef MINING_HASH_HAVE_X86_KERNELS
+        case MINING_HASH_KERNEL_AVX2:
+            return __builtin_cpu_supports("avx2");
+        case MINING_HASH_KERNEL_AVX512:
+            return __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+mining_hash_kernel_t mining_hash_best_kernel() {
+    if (mining_hash_kernel_is_supported(MINING_HASH_KERNEL_AVX512)) {
+        return MINING_HASH_KERNEL_AVX512;
+    }
+    if (mining_hash_kernel_is_supported(MINING_HASH_KERNEL_AVX2)) {
+        return MINING_HASH_KERNEL_AVX2;
+    }
+    return MINING_HASH_KERNEL_SCALAR;
+}
+
+const char *mining_hash_kernel_name(mining_hash_kernel_t kernel) {
+    switch (kernel) {
+        case MINING_HASH_KERNEL_SCALAR:
+            return "scalar";
+        case MINING_HASH_KERNEL_AVX2:
+            return "AVX2";
+        case MINING_HASH_KERNEL_AVX512:
+            return "AVX-512";
+        default:
+            return "unknown";
+    }
+}
+
+bool mining_hash_first_word_is_valid(
+    uint32_t first_word,
+    size_t num_leading_zero_bytes
+) {
+    size_t num_bytes_to_check = num_leading_zero_bytes < sizeof(first_word) ?
+        num_leading_zero_bytes : sizeof(first_word);
+    if (0 == num_bytes_to_check) {
+        return true;
+    }
+    return 0 == first_word >> (8 * (sizeof(first_word) - num_bytes_to_check));
+}
+
+return_code_t mining_hash_sweep(
+    mining_hash_template_t *mining_template,
+    mining_hash_kernel_t kernel,
+    uint64_t first_proof_of_work,
+    size_t num_leading_zero_bytes_required_in_block_hash,
+    mining_hash_sweep_result_t *result
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == mining_template ||
+        NULL == result ||
+        !mining_hash_kernel_is_supported(kernel) ||
+        first_proof_of_work > UINT64_MAX - (MINING_HASH_SWEEP_SIZE - 1) ||
+        num_leading_zero_bytes_required_in_block_hash > sizeof(sha_256_t)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    uint32_t first_words[MINING_HASH_SWEEP_SIZE];
+    switch (kernel) {
+#ifdef MINING_HASH_HAVE_X86_KERNELS
+        case MINING_HASH_KERNEL_AVX2:
+            mining_hash_first_words_avx2(
+                mining_template, first_proof_of_work, first_words);
+            break;
+        case MINING_HASH_KERNEL_AVX512:
+            mining_hash_first_words_avx512(
+                mining_template, first_proof_of_work, first_words);
+            break;
+#endif
+        default:
+            mining_hash_first_words_scalar(
+                mining_template, first_proof_of_work, first_words);
+            break;
+    }
+    result->found = false;
+    size_t best_idx = 0;
+    for (size_t idx = 0; idx < MINING_HASH_SWEEP_SIZE; idx++) {
+        if (first_words[idx] < first_words[best_idx]) {
+            best_idx = idx;
+        }
+        if (result->found || !mining_hash_first_word_is_valid(
+            first_words[idx],
+            num_leading_zero_bytes_required_in_block_hash)) {
+            continue;
+        }
+        // Difficulties beyond the first word need the rest of the hash.
+        bool is_valid = true;
+        if (num_leading_zero_bytes_required_in_block_hash >
+            sizeof(first_words[idx])) {
+            sha_256_t hash = {0};
+            return_code = mining_hash_compute(
+                mining_template, first_proof_of_work + idx, &hash);
+            if (SUCCESS != return_code) {
+                goto end;
+            }
+            for (size_t byte_idx = sizeof(first_words[idx]);
+                byte_idx < num_leading_zero_bytes_required_in_block_hash;
+                byte_idx++) {
+                if (0 != hash.digest[byte_idx]) {
+                    is_valid = false;
+                    break;
+                }
+            }
+        }
+        if (is_valid) {
+            result->found = true;
+            result->valid_proof_of_work = first_proof_of_work + idx;
+        }
+    }
+    result->best_proof_of_work = first_proof_of_work + best_idx;
+    result->best_first_word = first_words[best_idx];
+end:
+    return return_code;
+}
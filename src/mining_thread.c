@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "include/consensus_peer_client_thread.h"
 #include "include/transaction.h"
 #include "include/mining_thread.h"
@@ -20,6 +21,8 @@ void *broadcast_blockchain(void *args) {
     run_consensus_peer_client_args.peer_info_list_mutex =
         mine_blocks_args->peer_info_list_mutex;
     run_consensus_peer_client_args.print_progress = false;
+    run_consensus_peer_client_args.num_verification_threads =
+        mine_blocks_args->num_mining_threads;
     atomic_bool run_consensus_peer_client_should_stop = false;
     run_consensus_peer_client_args.should_stop =
         &run_consensus_peer_client_should_stop;
@@ -45,43 +48,120 @@ end:
     return NULL;
 }
 
+return_code_t mining_thread_update_view(
+    synchronized_blockchain_t *sync,
+    blockchain_t **view,
+    size_t *view_version
+) {
+    return_code_t return_code = SUCCESS;
+    if (0 != pthread_mutex_lock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    // Writers increment the version under the lock, so it matches the
+    // blockchain read here.
+    size_t version = atomic_load(&sync->version);
+    // Only blocks added since the last update need to reach the view, unless
+    // sync's blockchain was replaced by one that shares none of them.
+    if (NULL != *view) {
+        bool tip_changed = false;
+        return_code = blockchain_merge(*view, sync->blockchain, &tip_changed);
+        if (FAILURE_BLOCK_NOT_FOUND == return_code) {
+            blockchain_destroy(*view);
+            *view = NULL;
+        } else if (SUCCESS != return_code) {
+            pthread_mutex_unlock(&sync->mutex);
+            goto end;
+        }
+    }
+    if (NULL == *view) {
+        return_code = blockchain_clone(view, sync->blockchain);
+        if (SUCCESS != return_code) {
+            pthread_mutex_unlock(&sync->mutex);
+            goto end;
+        }
+    }
+    *view_version = version;
+    if (0 != pthread_mutex_unlock(&sync->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+    }
+end:
+    return return_code;
+}
+
+return_code_t mining_thread_publish_block(
+    synchronized_blockchain_t *sync,
+    block_t *block
+) {
+    // Readers may hold a snapshot of the blockchain's block array, which
+    // adding a block to the tip leaves alone unless the array must grow.
+    blockchain_t *blockchain = sync->blockchain;
+    bool appends_only = 0 != blockchain->num_blocks && 0 == memcmp(
+        &block->previous_block_hash,
+        &blockchain->blocks[blockchain->num_blocks - 1]->hash,
+        sizeof(sha_256_t));
+    return_code_t return_code = synchronized_blockchain_prepare_write(
+        sync, blockchain->num_blocks + 1, appends_only);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    block_retain(block);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, block, &tip_changed);
+    if (SUCCESS != return_code) {
+        block_release(block);
+        goto end;
+    }
+    return_code = synchronized_blockchain_publish(sync, blockchain);
+end:
+    return return_code;
+}
+
 return_code_t *mine_blocks(mine_blocks_args_t *args) {
     return_code_t return_code = SUCCESS;
+    transaction_signer_t *signer = NULL;
+    blockchain_t *blockchain = NULL;
+    blockchain_log_t *log = NULL;
     if (NULL == args) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    synchronized_blockchain_t *sync = args->sync;
-    if (0 != pthread_mutex_lock(&sync->mutex)) {
-        return_code = FAILURE_PTHREAD_FUNCTION;
+    // Every block needs a new minting transaction, so parse the miner's
+    // private key once.
+    return_code = transaction_signer_create(&signer, args->miner_private_key);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    blockchain_t *blockchain = sync->blockchain;
-    if (0 != pthread_mutex_unlock(&sync->mutex)) {
-        return_code = FAILURE_PTHREAD_FUNCTION;
+    if (NULL != args->outfile) {
+        return_code = blockchain_log_open(
+            &log, args->outfile, args->outfile_blocks_per_sync);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+    // Consensus threads change sync's blockchain at any time, so the miner
+    // works on its own view that shares the blocks.
+    synchronized_blockchain_t *sync = args->sync;
+    size_t view_version = 0;
+    return_code = mining_thread_update_view(sync, &blockchain, &view_version);
+    if (SUCCESS != return_code) {
         goto end;
     }
+    size_t num_mining_threads = args->num_mining_threads;
+    if (0 == num_mining_threads) {
+        num_mining_threads = 1;
+    }
     pthread_t broadcast_thread;
     while (!*args->should_stop) {
         if (atomic_load(args->sync_version_currently_mined) !=
             atomic_load(&sync->version)) {
-            blockchain_t *old_blockchain = blockchain;
-            if (0 != pthread_mutex_lock(&sync->mutex)) {
-                return_code = FAILURE_PTHREAD_FUNCTION;
-                goto end;
-            }
-            blockchain = sync->blockchain;
-            if (0 != pthread_mutex_unlock(&sync->mutex)) {
-                return_code = FAILURE_PTHREAD_FUNCTION;
-                goto end;
-            }
-            return_code = blockchain_destroy(old_blockchain);
+            return_code = mining_thread_update_view(
+                sync, &blockchain, &view_version);
             if (SUCCESS != return_code) {
                 goto end;
             }
-            atomic_store(
-                args->sync_version_currently_mined,
-                atomic_load(&sync->version));
+            atomic_store(args->sync_version_currently_mined, view_version);
             if (0 != pthread_mutex_lock(
                 &args->sync_version_currently_mined_mutex)) {
                 return_code = FAILURE_PTHREAD_FUNCTION;
@@ -96,8 +176,14 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
         }
         bool is_valid_blockchain = false;
         block_t *first_invalid_block = NULL;
-        return_code = blockchain_verify(
-            blockchain, &is_valid_blockchain, &first_invalid_block);
+        // Only blocks added since the last check need to be verified.
+        return_code = synchronized_blockchain_verify(
+            sync,
+            blockchain,
+            &is_valid_blockchain,
+            &first_invalid_block,
+            NULL,
+            num_mining_threads);
         if (SUCCESS != return_code) {
             goto end;
         }
@@ -113,12 +199,11 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
             return_code = FAILURE_INVALID_BLOCKCHAIN;
             goto end;
         }
-        node_t *node = NULL;
-        return_code = linked_list_get_last(blockchain->block_list, &node);
+        block_t *previous_block = NULL;
+        return_code = blockchain_get_last_block(blockchain, &previous_block);
         if (SUCCESS != return_code) {
             goto end;
         }
-        block_t *previous_block = (block_t *)node->data;
         sha_256_t previous_block_hash = {0};
         return_code = block_hash(previous_block, &previous_block_hash);
         if (SUCCESS != return_code) {
@@ -130,12 +215,12 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
             goto end;
         }
         transaction_t *mint_coin_transaction = NULL;
-        return_code = transaction_create(
+        return_code = transaction_create_with_signer(
             &mint_coin_transaction,
             args->miner_public_key,
             args->miner_public_key,
             AMOUNT_GENERATED_DURING_MINTING,
-            args->miner_private_key);
+            signer);
         if (SUCCESS != return_code) {
             linked_list_destroy(transaction_list);
             goto end;
@@ -159,7 +244,8 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
             next_block,
             args->print_progress,
             args->should_stop,
-            args->sync_version_currently_mined);
+            args->sync_version_currently_mined,
+            num_mining_threads);
         if (SUCCESS != return_code) {
             block_destroy(next_block);
             if (FAILURE_COULD_NOT_FIND_VALID_PROOF_OF_WORK == return_code) {
@@ -181,27 +267,73 @@ return_code_t *mine_blocks(mine_blocks_args_t *args) {
                 goto end;
             }
         } else {
-            return_code = blockchain_add_block(blockchain, next_block);
+            // Consensus threads may merge peer blocks into the tree at the
+            // same time, so add the block under the lock. If they moved the
+            // tip meanwhile, the block simply starts a side branch. Sync's
+            // blockchain and the view share the block.
+            if (0 != pthread_mutex_lock(&sync->mutex)) {
+                block_destroy(next_block);
+                return_code = FAILURE_PTHREAD_FUNCTION;
+                goto end;
+            }
+            return_code = mining_thread_publish_block(sync, next_block);
+            pthread_mutex_unlock(&sync->mutex);
             if (SUCCESS != return_code) {
                 block_destroy(next_block);
+                // A peer blockchain without the block's parent replaced
+                // sync's, so the block is stale; the miner moves on to the
+                // new blockchain.
+                if (FAILURE_BLOCK_NOT_FOUND != return_code) {
+                    goto end;
+                }
+                return_code = SUCCESS;
+                continue;
+            }
+            return_code = blockchain_add_block(blockchain, next_block);
+            if (SUCCESS != return_code) {
+                block_release(next_block);
                 goto end;
             }
             if (args->print_progress) {
                 blockchain_print(blockchain);
             }
-            if (NULL != args->outfile) {
-                blockchain_write_to_file(blockchain, args->outfile);
+            // The log keeps a prefix of the chain if a save fails, and the
+            // next save writes whatever it lacks, so a full disk does not
+            // stop the miner.
+            if (NULL != log &&
+                SUCCESS != blockchain_log_save(log, blockchain)) {
+                fprintf(
+                    stderr,
+                    "Error saving blockchain to %s.\n",
+                    args->outfile);
             }
             pthread_join(broadcast_thread, NULL);
             pthread_create(&broadcast_thread, NULL, broadcast_blockchain, args);
         }
     }
     pthread_join(broadcast_thread, NULL);
+    // Writing the address index costs time proportional to the chain, so it
+    // is saved beside the log only on the way out.
+    if (NULL != log &&
+        (SUCCESS != blockchain_log_save(log, blockchain) ||
+        SUCCESS != blockchain_log_write_address_index(log, blockchain))) {
+        fprintf(
+            stderr, "Error saving blockchain to %s.\n", args->outfile);
+    }
     pthread_mutex_lock(&args->exit_ready_mutex);
     *args->exit_ready = true;
     pthread_cond_signal(&args->exit_ready_cond);
     pthread_mutex_unlock(&args->exit_ready_mutex);
 end:
+    if (NULL != signer) {
+        transaction_signer_destroy(signer);
+    }
+    if (NULL != blockchain) {
+        blockchain_destroy(blockchain);
+    }
+    if (NULL != log) {
+        blockchain_log_close(log);
+    }
     return_code_t *return_code_ptr = malloc(sizeof(return_code_t));
     *return_code_ptr = return_code;
     return return_code_ptr;
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <openssl/x509.h>
+#include "include/public_key_cache.h"
+
+public_key_cache_t *public_key_cache_default = NULL;
+pthread_once_t public_key_cache_default_once = PTHREAD_ONCE_INIT;
+return_code_t public_key_cache_default_return_code = SUCCESS;
+
+return_code_t public_key_cache_create(
+    public_key_cache_t **cache,
+    size_t capacity
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache || 0 == capacity) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    public_key_cache_t *new_cache = calloc(1, sizeof(public_key_cache_t));
+    if (NULL == new_cache) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_cache->entries = calloc(capacity, sizeof(public_key_cache_entry_t));
+    if (NULL == new_cache->entries) {
+        free(new_cache);
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
+    new_cache->capacity = capacity;
+    if (0 != pthread_mutex_init(&new_cache->mutex, NULL)) {
+        free(new_cache->entries);
+        free(new_cache);
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    *cache = new_cache;
+end:
+    return return_code;
+}
+
+return_code_t public_key_cache_destroy(public_key_cache_t *cache) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    for (size_t idx = 0; idx < cache->num_entries; idx++) {
+        EVP_PKEY_free(cache->entries[idx].public_key);
+    }
+    pthread_mutex_destroy(&cache->mutex);
+    free(cache->entries);
+    free(cache);
+end:
+    return return_code;
+}
+
+public_key_cache_entry_t *public_key_cache_find(
+    public_key_cache_t *cache,
+    sha_256_t *key_digest
+) {
+    for (size_t idx = 0; idx < cache->num_entries; idx++) {
+        if (0 == memcmp(
+            &cache->entries[idx].key_digest, key_digest, sizeof(sha_256_t))) {
+            return &cache->entries[idx];
+        }
+    }
+    return NULL;
+}
+
+return_code_t public_key_cache_parse(
+    public_key_t *key,
+    EVP_PKEY **public_key
+) {
+    return_code_t return_code = SUCCESS;
+    const unsigned char *key_bytes = key->bytes;
+    *public_key = d2i_PUBKEY(NULL, &key_bytes, key->length);
+    if (*public_key == NULL) {
+        fprintf(stderr, "Error reading public key.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+end:
+    return return_code;
+}
+
+return_code_t public_key_cache_get(
+    public_key_cache_t *cache,
+    public_key_t *key,
+    EVP_PKEY **public_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache ||
+        NULL == key ||
+        NULL == public_key ||
+        key->length > MAX_PUBLIC_KEY_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    sha_256_t key_digest = {0};
+    return_code = hash_sha_256(key->bytes, key->length, &key_digest);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&cache->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    cache->clock++;
+    public_key_cache_entry_t *entry = public_key_cache_find(
+        cache, &key_digest);
+    if (NULL != entry) {
+        cache->num_hits++;
+        entry->last_used = cache->clock;
+        EVP_PKEY_up_ref(entry->public_key);
+        *public_key = entry->public_key;
+        pthread_mutex_unlock(&cache->mutex);
+        goto end;
+    }
+    cache->num_misses++;
+    pthread_mutex_unlock(&cache->mutex);
+    EVP_PKEY *parsed_public_key = NULL;
+    return_code = public_key_cache_parse(key, &parsed_public_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&cache->mutex)) {
+        EVP_PKEY_free(parsed_public_key);
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    // Another thread may have cached the same key while this one parsed it.
+    entry = public_key_cache_find(cache, &key_digest);
+    if (NULL == entry) {
+        if (cache->num_entries < cache->capacity) {
+            entry = &cache->entries[cache->num_entries];
+            cache->num_entries++;
+        } else {
+            entry = &cache->entries[0];
+            for (size_t idx = 1; idx < cache->num_entries; idx++) {
+                if (cache->entries[idx].last_used < entry->last_used) {
+                    entry = &cache->entries[idx];
+                }
+            }
+            EVP_PKEY_free(entry->public_key);
+        }
+        entry->key_digest = key_digest;
+        entry->public_key = parsed_public_key;
+    } else {
+        EVP_PKEY_free(parsed_public_key);
+    }
+    entry->last_used = cache->clock;
+    EVP_PKEY_up_ref(entry->public_key);
+    *public_key = entry->public_key;
+    pthread_mutex_unlock(&cache->mutex);
+end:
+    return return_code;
+}
+
+return_code_t public_key_cache_get_stats(
+    public_key_cache_t *cache,
+    uint64_t *num_hits,
+    uint64_t *num_misses
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache || NULL == num_hits || NULL == num_misses) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != pthread_mutex_lock(&cache->mutex)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    *num_hits = cache->num_hits;
+    *num_misses = cache->num_misses;
+    pthread_mutex_unlock(&cache->mutex);
+end:
+    return return_code;
+}
+
+void public_key_cache_create_default() {
+    public_key_cache_default_return_code = public_key_cache_create(
+        &public_key_cache_default, DEFAULT_PUBLIC_KEY_CACHE_CAPACITY);
+}
+
+return_code_t public_key_cache_get_default(public_key_cache_t **cache) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == cache) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    if (0 != pthread_once(
+        &public_key_cache_default_once, public_key_cache_create_default)) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    return_code = public_key_cache_default_return_code;
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    *cache = public_key_cache_default;
+end:
+    return return_code;
+}
@@ -6,8 +6,14 @@
 #include <openssl/rsa.h>
 #include <openssl/pem.h>
 #include <openssl/bio.h>
+#include <pthread.h>
+#include "include/public_key_cache.h"
 #include "include/transaction.h"
 
+pthread_key_t transaction_md_ctx_key;
+pthread_once_t transaction_md_ctx_key_once = PTHREAD_ONCE_INIT;
+int transaction_md_ctx_key_return_value = 0;
+
 return_code_t transaction_create(
     transaction_t **transaction,
     ssh_key_t *sender_public_key,
@@ -23,26 +29,62 @@ return_code_t transaction_create(
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, sender_private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = transaction_create_with_signer(
+        transaction,
+        sender_public_key,
+        recipient_public_key,
+        amount,
+        signer);
+    transaction_signer_destroy(signer);
+end:
+    return return_code;
+}
+
+return_code_t transaction_create_with_signer(
+    transaction_t **transaction,
+    ssh_key_t *sender_public_key,
+    ssh_key_t *recipient_public_key,
+    uint64_t amount,
+    transaction_signer_t *signer
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction ||
+        NULL == sender_public_key ||
+        NULL == recipient_public_key ||
+        NULL == signer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
     transaction_t *new_transaction = calloc(1, sizeof(transaction_t));
     if (NULL == new_transaction) {
         return_code = FAILURE_COULD_NOT_MALLOC;
         goto end;
     }
     new_transaction->created_at = time(NULL);
-    memcpy(
-        &new_transaction->sender_public_key,
-        sender_public_key,
-        MAX_SSH_KEY_LENGTH);
-    memcpy(
-        &new_transaction->recipient_public_key,
-        recipient_public_key,
-        MAX_SSH_KEY_LENGTH);
+    return_code = public_key_from_ssh_key(
+        &new_transaction->sender_public_key, sender_public_key);
+    if (SUCCESS != return_code) {
+        free(new_transaction);
+        goto end;
+    }
+    return_code = public_key_from_ssh_key(
+        &new_transaction->recipient_public_key, recipient_public_key);
+    if (SUCCESS != return_code) {
+        free(new_transaction);
+        goto end;
+    }
     new_transaction->amount = amount;
-    return_code = transaction_generate_signature(
+    return_code = transaction_signer_sign(
+        signer,
         &new_transaction->sender_signature,
-        new_transaction,
-        sender_private_key);
+        new_transaction);
     if (SUCCESS != return_code) {
+        free(new_transaction);
         goto end;
     }
     *transaction = new_transaction;
@@ -61,81 +103,276 @@ end:
     return return_code;
 }
 
-return_code_t transaction_generate_signature(
-    ssh_signature_t *signature,
+return_code_t transaction_hash(transaction_t *transaction, sha_256_t *hash) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction || NULL == hash) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char preimage[TRANSACTION_PREIMAGE_SIZE];
+    return_code = transaction_get_preimage(transaction, preimage);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = hash_sha_256(preimage, sizeof(preimage), hash);
+end:
+    return return_code;
+}
+
+return_code_t transaction_get_preimage(
     transaction_t *transaction,
+    unsigned char *preimage
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == transaction ||
+        NULL == preimage ||
+        transaction->sender_signature.length > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    unsigned char *next_spot_in_preimage = preimage;
+    memcpy(
+        next_spot_in_preimage,
+        &transaction->created_at,
+        sizeof(transaction->created_at));
+    next_spot_in_preimage += sizeof(transaction->created_at);
+    return_code = public_key_to_ssh_key(
+        (ssh_key_t *)next_spot_in_preimage,
+        &transaction->sender_public_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    next_spot_in_preimage += sizeof(ssh_key_t);
+    return_code = public_key_to_ssh_key(
+        (ssh_key_t *)next_spot_in_preimage,
+        &transaction->recipient_public_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    next_spot_in_preimage += sizeof(ssh_key_t);
+    memcpy(
+        next_spot_in_preimage,
+        &transaction->amount,
+        sizeof(transaction->amount));
+    next_spot_in_preimage += sizeof(transaction->amount);
+    memcpy(
+        next_spot_in_preimage,
+        &transaction->sender_signature.length,
+        sizeof(transaction->sender_signature.length));
+    next_spot_in_preimage += sizeof(transaction->sender_signature.length);
+    memset(next_spot_in_preimage, 0, MAX_SSH_SIGNATURE_LENGTH);
+    memcpy(
+        next_spot_in_preimage,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length);
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_create(
+    transaction_signer_t **signer,
     ssh_key_t *sender_private_key
 ) {
     return_code_t return_code = SUCCESS;
-    if (NULL == signature ||
-        NULL == transaction ||
-        NULL == sender_private_key) {
+    if (NULL == signer || NULL == sender_private_key) {
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
+    transaction_signer_t *new_signer = calloc(1, sizeof(transaction_signer_t));
+    if (NULL == new_signer) {
+        return_code = FAILURE_COULD_NOT_MALLOC;
+        goto end;
+    }
     BIO *mem_bio = BIO_new_mem_buf(
         sender_private_key->bytes, MAX_SSH_KEY_LENGTH);
     if (!mem_bio) {
         fprintf(stderr, "Error creating BIO object.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
-        goto end;
+        goto cleanup;
     }
-    EVP_PKEY *private_key = PEM_read_bio_PrivateKey(mem_bio, NULL, NULL, NULL);
+    new_signer->private_key = PEM_read_bio_PrivateKey(
+        mem_bio, NULL, NULL, NULL);
     BIO_free(mem_bio);
-    if (!private_key) {
+    if (!new_signer->private_key) {
         fprintf(stderr, "Error reading private key.\n");
         return_code = FAILURE_OPENSSL_FUNCTION;
-        goto end;
+        goto cleanup;
     }
-    if (EVP_PKEY_base_id(private_key) != EVP_PKEY_RSA) {
+    if (EVP_PKEY_base_id(new_signer->private_key) != EVP_PKEY_RSA) {
         fprintf(stderr, "The provided key is not an RSA key.\n");
-        EVP_PKEY_free(private_key);
-        BIO_free(mem_bio);
         return_code = FAILURE_OPENSSL_FUNCTION;
-        goto end;
+        goto cleanup;
     }
-    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
-    if (!md_ctx) {
+    new_signer->initialized_md_ctx = EVP_MD_CTX_new();
+    new_signer->md_ctx = EVP_MD_CTX_new();
+    if (!new_signer->initialized_md_ctx || !new_signer->md_ctx) {
         fprintf(stderr, "Error creating message digest context.\n");
-        EVP_PKEY_free(private_key);
         return_code = FAILURE_OPENSSL_FUNCTION;
-        goto end;
+        goto cleanup;
     }
     if (EVP_DigestSignInit(
-            md_ctx, NULL, EVP_sha256(), NULL, private_key) <= 0) {
+            new_signer->initialized_md_ctx,
+            NULL,
+            EVP_sha256(),
+            NULL,
+            new_signer->private_key) <= 0) {
         fprintf(stderr, "Error initializing digest signing.\n");
-        EVP_PKEY_free(private_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
+        goto cleanup;
+    }
+    *signer = new_signer;
+    goto end;
+cleanup:
+    transaction_signer_destroy(new_signer);
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_destroy(transaction_signer_t *signer) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    EVP_MD_CTX_free(signer->md_ctx);
+    EVP_MD_CTX_free(signer->initialized_md_ctx);
+    EVP_PKEY_free(signer->private_key);
+    free(signer);
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_sign(
+    transaction_signer_t *signer,
+    ssh_signature_t *signature,
+    transaction_t *transaction
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer || NULL == signature || NULL == transaction) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    // Copying the initialized context skips setting up the key again.
+    if (!EVP_MD_CTX_copy_ex(signer->md_ctx, signer->initialized_md_ctx)) {
+        fprintf(stderr, "Error copying message digest context.\n");
+        return_code = FAILURE_OPENSSL_FUNCTION;
+        goto end;
+    }
+    unsigned char preimage[TRANSACTION_PREIMAGE_SIZE];
+    return_code = transaction_get_preimage(transaction, preimage);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    size_t size_without_signature = offsetof(transaction_t, sender_signature);
     if (EVP_DigestSignUpdate(
-            md_ctx, transaction, size_without_signature) <= 0) {
+            signer->md_ctx,
+            preimage,
+            TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE) <= 0) {
         fprintf(stderr, "Error updating digest signing.\n");
-        EVP_PKEY_free(private_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
     size_t sig_len = 0;
-    if (EVP_DigestSignFinal(md_ctx, NULL, &sig_len) <= 0) {
+    if (EVP_DigestSignFinal(signer->md_ctx, NULL, &sig_len) <= 0) {
         fprintf(stderr, "Error obtaining signature length.\n");
-        EVP_PKEY_free(private_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_DigestSignFinal(md_ctx, signature->bytes, &sig_len) <= 0) {
+    if (sig_len > MAX_SSH_SIGNATURE_LENGTH) {
+        return_code = FAILURE_SIGNATURE_TOO_LONG;
+        goto end;
+    }
+    if (EVP_DigestSignFinal(signer->md_ctx, signature->bytes, &sig_len) <= 0) {
         fprintf(stderr, "Error generating signature.\n");
-        EVP_PKEY_free(private_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
     signature->length = sig_len;
-    EVP_PKEY_free(private_key);
-    EVP_MD_CTX_free(md_ctx);
+end:
+    return return_code;
+}
+
+return_code_t transaction_signer_sign_batch(
+    transaction_signer_t *signer,
+    transaction_t **transactions,
+    size_t num_transactions
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signer || (NULL == transactions && 0 != num_transactions)) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    for (size_t idx = 0; idx < num_transactions; idx++) {
+        if (NULL == transactions[idx]) {
+            return_code = FAILURE_INVALID_INPUT;
+            goto end;
+        }
+        return_code = transaction_signer_sign(
+            signer,
+            &transactions[idx]->sender_signature,
+            transactions[idx]);
+        if (SUCCESS != return_code) {
+            goto end;
+        }
+    }
+end:
+    return return_code;
+}
+
+return_code_t transaction_generate_signature(
+    ssh_signature_t *signature,
+    transaction_t *transaction,
+    ssh_key_t *sender_private_key
+) {
+    return_code_t return_code = SUCCESS;
+    if (NULL == signature ||
+        NULL == transaction ||
+        NULL == sender_private_key) {
+        return_code = FAILURE_INVALID_INPUT;
+        goto end;
+    }
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, sender_private_key);
+    if (SUCCESS != return_code) {
+        goto end;
+    }
+    return_code = transaction_signer_sign(signer, signature, transaction);
+    transaction_signer_destroy(signer);
+end:
+    return return_code;
+}
+
+void transaction_destroy_md_ctx(void *md_ctx) {
+    EVP_MD_CTX_free((EVP_MD_CTX *)md_ctx);
+}
+
+void transaction_create_md_ctx_key() {
+    transaction_md_ctx_key_return_value = pthread_key_create(
+        &transaction_md_ctx_key, transaction_destroy_md_ctx);
+}
+
+return_code_t transaction_get_thread_md_ctx(EVP_MD_CTX **md_ctx) {
+    return_code_t return_code = SUCCESS;
+    if (0 != pthread_once(
+        &transaction_md_ctx_key_once, transaction_create_md_ctx_key) ||
+        0 != transaction_md_ctx_key_return_value) {
+        return_code = FAILURE_PTHREAD_FUNCTION;
+        goto end;
+    }
+    EVP_MD_CTX *thread_md_ctx = pthread_getspecific(transaction_md_ctx_key);
+    if (NULL == thread_md_ctx) {
+        thread_md_ctx = EVP_MD_CTX_new();
+        if (!thread_md_ctx) {
+            fprintf(stderr, "Error creating message digest context.\n");
+            return_code = FAILURE_OPENSSL_FUNCTION;
+            goto end;
+        }
+        if (0 != pthread_setspecific(transaction_md_ctx_key, thread_md_ctx)) {
+            EVP_MD_CTX_free(thread_md_ctx);
+            return_code = FAILURE_PTHREAD_FUNCTION;
+            goto end;
+        }
+    }
+    *md_ctx = thread_md_ctx;
 end:
     return return_code;
 }
@@ -149,39 +386,42 @@ return_code_t transaction_verify_signature(
         return_code = FAILURE_INVALID_INPUT;
         goto end;
     }
-    BIO *bio = BIO_new_mem_buf(
-        transaction->sender_public_key.bytes, MAX_SSH_KEY_LENGTH);
-    if (bio == NULL) {
-        fprintf(stderr, "Error creating BIO object.\n");
-        return_code = FAILURE_OPENSSL_FUNCTION;
+    public_key_cache_t *public_key_cache = NULL;
+    return_code = public_key_cache_get_default(&public_key_cache);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    EVP_PKEY *public_key = PEM_read_bio_PUBKEY(bio, NULL, NULL, NULL);
-    BIO_free(bio);
-    if (public_key == NULL) {
-        fprintf(stderr, "Error reading public key.\n");
-        return_code = FAILURE_OPENSSL_FUNCTION;
+    EVP_PKEY *public_key = NULL;
+    return_code = public_key_cache_get(
+        public_key_cache, &transaction->sender_public_key, &public_key);
+    if (SUCCESS != return_code) {
         goto end;
     }
-    size_t size_without_signature = offsetof(transaction_t, sender_signature);
-    EVP_MD_CTX *md_ctx = EVP_MD_CTX_new();
-    if (!md_ctx) {
-        fprintf(stderr, "Error creating message digest context.\n");
+    unsigned char preimage[TRANSACTION_PREIMAGE_SIZE];
+    return_code = transaction_get_preimage(transaction, preimage);
+    if (SUCCESS != return_code) {
+        EVP_PKEY_free(public_key);
+        goto end;
+    }
+    // Each thread reuses one digest context; EVP_VerifyInit resets it.
+    EVP_MD_CTX *md_ctx = NULL;
+    return_code = transaction_get_thread_md_ctx(&md_ctx);
+    if (SUCCESS != return_code) {
         EVP_PKEY_free(public_key);
-        return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
     if (EVP_VerifyInit(md_ctx, EVP_sha256()) <= 0) {
         fprintf(stderr, "Error initializing digest verification.\n");
         EVP_PKEY_free(public_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
-    if (EVP_VerifyUpdate(md_ctx, transaction, size_without_signature) <= 0) {
+    if (EVP_VerifyUpdate(
+            md_ctx,
+            preimage,
+            TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE) <= 0) {
         fprintf(stderr, "Error updating digest verification.\n");
         EVP_PKEY_free(public_key);
-        EVP_MD_CTX_free(md_ctx);
         return_code = FAILURE_OPENSSL_FUNCTION;
         goto end;
     }
@@ -194,7 +434,6 @@ return_code_t transaction_verify_signature(
     } else {
         *is_valid_signature = false;
     }
-    EVP_MD_CTX_free(md_ctx);
     EVP_PKEY_free(public_key);
 end:
     return return_code;
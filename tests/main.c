@@ -18,9 +18,16 @@
 #include "tests/test_linked_list.h"
 #include "tests/test_block.h"
 #include "tests/test_blockchain.h"
+#include "tests/test_block_hash_index.h"
+#include "tests/test_ledger.h"
+#include "tests/test_address_index.h"
 #include "tests/test_transaction.h"
 #include "tests/test_base64.h"
 #include "tests/test_endian.h"
+#include "tests/test_hash.h"
+#include "tests/test_mining_hash.h"
+#include "tests/test_public_key_cache.h"
+#include "tests/test_cryptography.h"
 #include "tests/test_mining_thread.h"
 #include "tests/test_peer_discovery.h"
 #include "tests/test_networking.h"
@@ -162,6 +169,20 @@ int main(int argc, char **argv) {
         cmocka_unit_test(test_block_hash_proof_of_work_included_in_hash),
         cmocka_unit_test(test_block_hash_previous_block_hash_included_in_hash),
         cmocka_unit_test(test_block_hash_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_block_compute_merkle_root_empty_list_gives_zero_root),
+        cmocka_unit_test(
+            test_block_compute_merkle_root_changes_with_transactions),
+        cmocka_unit_test(
+            test_block_compute_merkle_root_fails_on_invalid_input),
+        cmocka_unit_test(test_block_hash_merkle_root_included_in_hash),
+        cmocka_unit_test(test_block_serialize_header_puts_proof_of_work_last),
+        cmocka_unit_test(test_block_seal_keeps_hash_until_unsealed),
+        cmocka_unit_test(test_block_compute_merkle_root_unseals_block),
+        cmocka_unit_test(test_block_seal_fails_on_invalid_input),
+        cmocka_unit_test(test_block_copy_gives_independent_copy),
+        cmocka_unit_test(
+            test_block_release_destroys_block_after_last_reference),
         // test_blockchain.h
         cmocka_unit_test(test_blockchain_create_gives_blockchain),
         cmocka_unit_test(test_blockchain_create_fails_on_invalid_input),
@@ -174,6 +195,11 @@ int main(int argc, char **argv) {
         cmocka_unit_test(
             test_synchronized_blockchain_destroy_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_add_block_appends_block),
+        cmocka_unit_test(test_blockchain_add_block_grows_storage),
+        cmocka_unit_test(test_blockchain_get_block_fails_on_missing_block),
+        cmocka_unit_test(test_blockchain_find_block_by_hash_finds_every_block),
+        cmocka_unit_test(
+            test_blockchain_find_block_by_hash_fails_on_missing_block),
         cmocka_unit_test(test_blockchain_add_block_fails_on_invalid_input),
         cmocka_unit_test(
             test_blockchain_is_valid_block_hash_true_on_valid_hash),
@@ -183,17 +209,53 @@ int main(int argc, char **argv) {
             test_blockchain_is_valid_block_hash_fails_on_invalid_input),
         cmocka_unit_test(
             test_blockchain_mine_block_produces_block_with_valid_hash),
+        cmocka_unit_test(
+            test_blockchain_mine_block_with_progress_finds_same_proof_of_work),
         cmocka_unit_test(test_blockchain_mine_block_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_mine_block_multiple_threads_produces_valid_hash),
+        cmocka_unit_test(
+            test_blockchain_get_proof_of_work_range_covers_every_proof_of_work),
+        cmocka_unit_test(
+            test_synchronized_blockchain_mine_block_stops_on_should_stop),
+        cmocka_unit_test(
+            test_synchronized_blockchain_mine_block_stops_on_version_change),
+        cmocka_unit_test(
+            test_synchronized_blockchain_mine_block_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_verify_succeeds_on_valid_blockchain),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_genesis_block),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_proof_of_work),
         cmocka_unit_test(
             test_blockchain_verify_fails_on_invalid_previous_block_hash),
+        cmocka_unit_test(test_blockchain_verify_fails_on_invalid_merkle_root),
         cmocka_unit_test(
             test_blockchain_verify_fails_on_invalid_transaction_signature),
+        cmocka_unit_test(
+            test_blockchain_verify_fails_on_overspending_transaction),
         cmocka_unit_test(test_blockchain_verify_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_verify_parallel_succeeds_on_valid_blockchain),
+        cmocka_unit_test(
+            test_blockchain_verify_parallel_finds_first_invalid_block),
+        cmocka_unit_test(
+            test_blockchain_verify_parallel_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_skips_verified_prefix),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_checks_blocks_after_prefix),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_rechecks_other_blockchain),
+        cmocka_unit_test(
+            test_synchronized_blockchain_verify_records_verified_prefix),
+        cmocka_unit_test(
+            test_blockchain_verify_incremental_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_serialize_creates_nonempty_buffer),
         cmocka_unit_test(test_blockchain_serialize_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_serialize_into_buffer_matches_serialize),
+        cmocka_unit_test(test_blockchain_serialize_into_iovec_spans_buffers),
+        cmocka_unit_test(
+            test_blockchain_serialize_into_buffer_fails_on_invalid_input),
         cmocka_unit_test(test_blockchain_deserialize_reconstructs_blockchain),
         cmocka_unit_test(
             test_blockchain_deserialize_fails_on_attempted_read_past_buffer),
@@ -203,8 +265,96 @@ int main(int argc, char **argv) {
         cmocka_unit_test(
             test_blockchain_read_from_file_reconstructs_blockchain),
         cmocka_unit_test(test_blockchain_read_from_file_fails_on_invalid_input),
+        cmocka_unit_test(
+            test_blockchain_read_from_file_rejects_pre_merkle_root_file),
+        cmocka_unit_test(test_blockchain_read_from_file_loads_address_index),
         cmocka_unit_test(
             test_blockchain_serialization_does_not_alter_block_hash),
+        cmocka_unit_test(test_blockchain_serialize_migrates_legacy_blockchain),
+        cmocka_unit_test(
+            test_blockchain_deserialize_reads_compact_keys_blockchain),
+        cmocka_unit_test(
+            test_blockchain_serialize_writes_small_integers_in_one_byte),
+        cmocka_unit_test(test_blockchain_deserialize_fails_on_invalid_varint),
+        cmocka_unit_test(
+            test_blockchain_deserialize_fails_on_unsupported_version),
+        cmocka_unit_test(
+            test_blockchain_deserialize_into_arena_reconstructs_blockchain),
+        cmocka_unit_test(
+            test_blockchain_deserialize_into_arena_reads_legacy_format),
+        cmocka_unit_test(
+            test_blockchain_deserialize_into_arena_fails_on_invalid_buffer),
+        cmocka_unit_test(
+            test_blockchain_add_block_to_tree_reorganizes_onto_longer_branch),
+        cmocka_unit_test(
+            test_blockchain_add_block_to_tree_reorganizes_arena_blockchain),
+        cmocka_unit_test(
+            test_blockchain_add_block_to_tree_fails_on_invalid_block),
+        cmocka_unit_test(
+            test_blockchain_add_block_to_tree_prunes_deep_side_blocks),
+        cmocka_unit_test(
+            test_blockchain_add_block_to_tree_moves_balances_on_reorganization),
+        cmocka_unit_test(
+            test_blockchain_get_transaction_history_follows_reorganization),
+        cmocka_unit_test(test_blockchain_merge_shares_only_new_blocks),
+        cmocka_unit_test(
+            test_synchronized_blockchain_adopt_peer_blockchain_publishes_merge),
+        cmocka_unit_test(test_blockchain_clone_shares_blocks),
+        cmocka_unit_test(test_blockchain_clone_keeps_arena_until_last_view),
+        cmocka_unit_test(
+            test_synchronized_blockchain_read_section_keeps_retired_blockchain),
+        cmocka_unit_test(
+            test_synchronized_blockchain_publish_appends_in_place),
+        cmocka_unit_test(
+            test_synchronized_blockchain_read_section_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_log_save_appends_only_new_blocks),
+        cmocka_unit_test(test_blockchain_log_save_truncates_to_fork_point),
+        cmocka_unit_test(test_blockchain_log_open_drops_partial_record),
+        cmocka_unit_test(test_blockchain_log_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_mapped_log_reads_blocks_in_place),
+        cmocka_unit_test(test_blockchain_mapped_log_fails_on_invalid_input),
+        cmocka_unit_test(test_blockchain_log_open_reads_index),
+        cmocka_unit_test(
+            test_blockchain_log_write_address_index_is_loaded_until_stale),
+        cmocka_unit_test(test_blockchain_log_read_blocks_reads_range),
+        // test_block_hash_index.h
+        cmocka_unit_test(test_block_hash_index_create_gives_empty_index),
+        cmocka_unit_test(test_block_hash_index_create_fails_on_invalid_input),
+        cmocka_unit_test(test_block_hash_index_insert_then_find_gives_entry),
+        cmocka_unit_test(
+            test_block_hash_index_insert_replaces_entry_with_same_hash),
+        cmocka_unit_test(
+            test_block_hash_index_insert_grows_and_keeps_colliding_entries),
+        cmocka_unit_test(
+            test_block_hash_index_remove_keeps_colliding_entries),
+        cmocka_unit_test(
+            test_block_hash_index_spreads_hashes_with_leading_zero_bytes),
+        cmocka_unit_test(test_block_hash_index_copy_gives_independent_index),
+        cmocka_unit_test(test_block_hash_index_find_fails_on_missing_hash),
+        cmocka_unit_test(test_block_hash_index_fails_on_invalid_input),
+        // test_ledger.h
+        cmocka_unit_test(test_ledger_create_gives_empty_ledger),
+        cmocka_unit_test(
+            test_ledger_apply_block_credits_minting_and_moves_amounts),
+        cmocka_unit_test(test_ledger_apply_block_detects_overspend),
+        cmocka_unit_test(test_ledger_revert_block_restores_balances),
+        cmocka_unit_test(test_ledger_copy_gives_independent_ledger),
+        cmocka_unit_test(test_ledger_fails_on_invalid_input),
+        // test_address_index.h
+        cmocka_unit_test(test_address_index_create_gives_empty_index),
+        cmocka_unit_test(
+            test_address_index_apply_block_adds_postings_newest_first),
+        cmocka_unit_test(
+            test_address_index_get_postings_pages_through_history),
+        cmocka_unit_test(test_address_index_get_postings_skips_to_deep_pages),
+        cmocka_unit_test(test_address_index_skip_rank_reaches_lower_rank),
+        cmocka_unit_test(test_address_index_revert_block_removes_postings),
+        cmocka_unit_test(test_address_index_copy_gives_independent_index),
+        cmocka_unit_test(
+            test_address_index_read_from_file_reconstructs_index),
+        cmocka_unit_test(
+            test_address_index_read_from_file_fails_on_invalid_file),
+        cmocka_unit_test(test_address_index_fails_on_invalid_input),
         // test_transaction.h
         cmocka_unit_test(test_transaction_create_gives_transaction),
         cmocka_unit_test(test_transaction_create_fails_on_invalid_input),
@@ -219,12 +369,55 @@ int main(int argc, char **argv) {
             test_transaction_verify_signature_identifies_invalid_signature),
         cmocka_unit_test(
             test_transaction_verify_signature_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_signer_sign_gives_valid_signature),
+        cmocka_unit_test(
+            test_transaction_signer_sign_batch_signs_every_transaction),
+        cmocka_unit_test(test_transaction_create_with_signer_gives_transaction),
+        cmocka_unit_test(test_transaction_signer_fails_on_invalid_input),
+        cmocka_unit_test(test_transaction_get_preimage_gives_legacy_layout),
+        cmocka_unit_test(test_transaction_get_preimage_fails_on_invalid_input),
         // test_base64.h
         cmocka_unit_test(test_base64_decode_correctly_decodes),
         cmocka_unit_test(test_base64_decode_fails_on_invalid_input),
         // test_endian.h
         cmocka_unit_test(test_htobe64_correctly_encodes_data),
         cmocka_unit_test(test_betoh64_correctly_decodes_data),
+        // test_hash.h
+        cmocka_unit_test(test_hash_sha_256_compress_gives_known_digest),
+        cmocka_unit_test(test_hash_backends_match_openssl),
+        cmocka_unit_test(test_hash_get_backend_selects_supported_backend),
+        cmocka_unit_test(test_hash_get_backend_defaults_to_openssl),
+        cmocka_unit_test(test_hash_set_backend_fails_on_invalid_input),
+        cmocka_unit_test(test_hash_sha_256_fails_on_invalid_input),
+        // test_mining_hash.h
+        cmocka_unit_test(test_mining_hash_compute_matches_block_hash),
+        cmocka_unit_test(
+            test_mining_hash_template_init_fails_on_invalid_input),
+        cmocka_unit_test(test_mining_hash_compute_fails_on_invalid_input),
+        cmocka_unit_test(test_mining_hash_sweep_matches_block_hash),
+        cmocka_unit_test(
+            test_mining_hash_sweep_checks_bytes_beyond_first_word),
+        cmocka_unit_test(test_mining_hash_best_kernel_is_supported),
+        cmocka_unit_test(test_mining_hash_sweep_fails_on_invalid_input),
+        // test_public_key_cache.h
+        cmocka_unit_test(test_public_key_cache_create_gives_empty_cache),
+        cmocka_unit_test(test_public_key_cache_create_fails_on_invalid_input),
+        cmocka_unit_test(test_public_key_cache_get_counts_hits_and_misses),
+        cmocka_unit_test(
+            test_public_key_cache_get_evicts_least_recently_used_key),
+        cmocka_unit_test(test_public_key_cache_get_fails_on_invalid_key),
+        cmocka_unit_test(test_public_key_cache_get_fails_on_invalid_input),
+        cmocka_unit_test(test_public_key_cache_get_default_gives_same_cache),
+        // test_cryptography.h
+        cmocka_unit_test(test_public_key_from_ssh_key_gives_der_key),
+        cmocka_unit_test(
+            test_public_key_from_ssh_key_gives_empty_key_for_empty_ssh_key),
+        cmocka_unit_test(test_public_key_from_ssh_key_fails_on_invalid_key),
+        cmocka_unit_test(test_public_key_from_ssh_key_fails_on_invalid_input),
+        cmocka_unit_test(test_public_key_to_ssh_key_reproduces_pem_key),
+        cmocka_unit_test(
+            test_public_key_to_ssh_key_gives_empty_ssh_key_for_empty_key),
+        cmocka_unit_test(test_public_key_to_ssh_key_fails_on_invalid_input),
         // test_mining_thread.h
         // These tests are slow in valgrind.
         // They run very fast outside of valgrind.
@@ -0,0 +1,438 @@
+#include <stdio.h>
+#include <string.h>
+#include "include/address_index.h"
+#include "include/transaction.h"
+#include "tests/file_paths.h"
+#include "tests/test_address_index.h"
+#include "tests/test_ledger.h"
+
+void assert_address_index_postings(
+    address_index_t *index,
+    unsigned char id,
+    uint64_t expected_num_postings,
+    uint64_t *expected_heights,
+    uint64_t *expected_transaction_indices
+) {
+    public_key_t public_key = {0};
+    create_ledger_test_key(&public_key, id);
+    address_index_posting_t postings[8] = {0};
+    uint64_t num_postings = 0;
+    uint64_t total_num_postings = 0;
+    return_code_t return_code = address_index_get_postings(
+        index,
+        &public_key,
+        0,
+        8,
+        postings,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(expected_num_postings == num_postings);
+    assert_true(expected_num_postings == total_num_postings);
+    for (uint64_t idx = 0; idx < num_postings; idx++) {
+        assert_true(expected_heights[idx] == postings[idx].height);
+        assert_true(
+            expected_transaction_indices[idx] ==
+            postings[idx].transaction_index);
+    }
+}
+
+void test_address_index_create_gives_empty_index() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    assert_true(ADDRESS_INDEX_MIN_CAPACITY == index->capacity);
+    assert_true(0 == index->num_entries);
+    assert_true(0 == index->num_postings);
+    assert_true(0 == index->num_blocks);
+    assert_address_index_postings(index, 1, 0, NULL, NULL);
+    address_index_destroy(index);
+}
+
+void test_address_index_apply_block_adds_postings_newest_first() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, block);
+    assert_true(SUCCESS == return_code);
+    block_t *second_block = NULL;
+    create_ledger_test_block(
+        &second_block, 2, 3, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, second_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == index->num_blocks);
+    assert_true(3 == index->num_entries);
+    // Minting names the miner once.
+    uint64_t heights1[] = {0, 0};
+    uint64_t transaction_indices1[] = {1, 0};
+    assert_address_index_postings(index, 1, 2, heights1, transaction_indices1);
+    uint64_t heights2[] = {1, 1, 0};
+    uint64_t transaction_indices2[] = {1, 0, 1};
+    assert_address_index_postings(index, 2, 3, heights2, transaction_indices2);
+    uint64_t heights3[] = {1};
+    uint64_t transaction_indices3[] = {1};
+    assert_address_index_postings(index, 3, 1, heights3, transaction_indices3);
+    block_destroy(block);
+    block_destroy(second_block);
+    address_index_destroy(index);
+}
+
+void test_address_index_get_postings_pages_through_history() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    // Enough blocks to grow the postings and the slots.
+    block_t *blocks[20] = {0};
+    for (size_t idx = 0; idx < 20; idx++) {
+        create_ledger_test_block(
+            &blocks[idx],
+            1,
+            (unsigned char)(2 + idx),
+            AMOUNT_GENERATED_DURING_MINTING);
+        return_code = address_index_apply_block(index, blocks[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(21 == index->num_entries);
+    public_key_t public_key = {0};
+    create_ledger_test_key(&public_key, 1);
+    address_index_posting_t postings[16] = {0};
+    uint64_t num_postings = 0;
+    uint64_t total_num_postings = 0;
+    return_code = address_index_get_postings(
+        index,
+        &public_key,
+        0,
+        16,
+        postings,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(16 == num_postings);
+    assert_true(40 == total_num_postings);
+    assert_true(19 == postings[0].height);
+    assert_true(1 == postings[0].transaction_index);
+    assert_true(12 == postings[15].height);
+    assert_true(0 == postings[15].transaction_index);
+    // The last page holds whatever is left.
+    return_code = address_index_get_postings(
+        index, &public_key, 32, 16, postings, &num_postings, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(8 == num_postings);
+    assert_true(3 == postings[0].height);
+    assert_true(0 == postings[7].height);
+    assert_true(0 == postings[7].transaction_index);
+    return_code = address_index_get_postings(
+        index, &public_key, 40, 16, postings, &num_postings, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == num_postings);
+    for (size_t idx = 0; idx < 20; idx++) {
+        block_destroy(blocks[idx]);
+    }
+    address_index_destroy(index);
+}
+
+void test_address_index_get_postings_skips_to_deep_pages() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    // Each block adds the miner's postings at ranks 2 * height and
+    // 2 * height + 1, then the recipient's, so posting idx holds the miner's
+    // rank 2 * (idx / 3) + idx % 3 unless idx % 3 is 2.
+    block_t *blocks[300] = {0};
+    for (size_t idx = 0; idx < 300; idx++) {
+        create_ledger_test_block(
+            &blocks[idx], 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+        return_code = address_index_apply_block(index, blocks[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(900 == index->num_postings);
+    for (uint64_t idx = 0; idx < index->num_postings; idx++) {
+        if (2 == idx % 3) {
+            continue;
+        }
+        uint64_t rank = 2 * (idx / 3) + idx % 3;
+        uint64_t skip_posting = index->postings[idx].skip_posting;
+        if (0 == rank) {
+            assert_true(ADDRESS_INDEX_NO_POSTING == skip_posting);
+            continue;
+        }
+        assert_true(2 != skip_posting % 3);
+        assert_true(
+            address_index_skip_rank(rank) ==
+            2 * (skip_posting / 3) + skip_posting % 3);
+    }
+    // Every page starts at the right posting, however deep.
+    public_key_t public_key = {0};
+    create_ledger_test_key(&public_key, 1);
+    for (uint64_t offset = 0; offset < 600; offset++) {
+        address_index_posting_t postings[2] = {0};
+        uint64_t num_postings = 0;
+        return_code = address_index_get_postings(
+            index, &public_key, offset, 2, postings, &num_postings, NULL);
+        assert_true(SUCCESS == return_code);
+        uint64_t rank = 599 - offset;
+        assert_true((0 == rank ? 1 : 2) == num_postings);
+        assert_true(rank / 2 == postings[0].height);
+        assert_true(rank % 2 == postings[0].transaction_index);
+    }
+    for (size_t idx = 0; idx < 300; idx++) {
+        block_destroy(blocks[idx]);
+    }
+    address_index_destroy(index);
+}
+
+void test_address_index_skip_rank_reaches_lower_rank() {
+    assert_true(0 == address_index_skip_rank(0));
+    assert_true(0 == address_index_skip_rank(1));
+    assert_true(0 == address_index_skip_rank(2));
+    assert_true(1 == address_index_skip_rank(3));
+    assert_true(0 == address_index_skip_rank(4));
+    assert_true(8 == address_index_skip_rank(12));
+    assert_true(1 == address_index_skip_rank(13));
+    for (uint64_t rank = 1; rank < 4096; rank++) {
+        assert_true(address_index_skip_rank(rank) < rank);
+    }
+}
+
+void test_address_index_revert_block_removes_postings() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, block);
+    assert_true(SUCCESS == return_code);
+    block_t *second_block = NULL;
+    create_ledger_test_block(
+        &second_block, 2, 1, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, second_block);
+    assert_true(SUCCESS == return_code);
+    return_code = address_index_revert_block(index, second_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == index->num_blocks);
+    assert_true(3 == index->num_postings);
+    uint64_t heights1[] = {0, 0};
+    uint64_t transaction_indices1[] = {1, 0};
+    assert_address_index_postings(index, 1, 2, heights1, transaction_indices1);
+    uint64_t heights2[] = {0};
+    uint64_t transaction_indices2[] = {1};
+    assert_address_index_postings(index, 2, 1, heights2, transaction_indices2);
+    // A different block can take the reverted block's place.
+    block_t *replacement_block = NULL;
+    create_ledger_test_block(
+        &replacement_block, 3, 3, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, replacement_block);
+    assert_true(SUCCESS == return_code);
+    uint64_t heights3[] = {1, 1};
+    uint64_t transaction_indices3[] = {1, 0};
+    assert_address_index_postings(index, 3, 2, heights3, transaction_indices3);
+    assert_address_index_postings(index, 2, 1, heights2, transaction_indices2);
+    return_code = address_index_revert_block(index, replacement_block);
+    assert_true(SUCCESS == return_code);
+    return_code = address_index_revert_block(index, block);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == index->num_postings);
+    assert_address_index_postings(index, 1, 0, NULL, NULL);
+    // There is nothing left to revert.
+    return_code = address_index_revert_block(index, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+    block_destroy(second_block);
+    block_destroy(replacement_block);
+    address_index_destroy(index);
+}
+
+void test_address_index_copy_gives_independent_index() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, block);
+    assert_true(SUCCESS == return_code);
+    address_index_t *copy = NULL;
+    return_code = address_index_copy(&copy, index);
+    assert_true(SUCCESS == return_code);
+    block_t *second_block = NULL;
+    create_ledger_test_block(
+        &second_block, 2, 1, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(copy, second_block);
+    assert_true(SUCCESS == return_code);
+    uint64_t heights[] = {1, 1, 0};
+    uint64_t transaction_indices[] = {1, 0, 1};
+    assert_address_index_postings(copy, 2, 3, heights, transaction_indices);
+    assert_address_index_postings(
+        index, 2, 1, &heights[2], &transaction_indices[2]);
+    assert_true(1 == index->num_blocks);
+    block_destroy(block);
+    block_destroy(second_block);
+    address_index_destroy(copy);
+    address_index_destroy(index);
+}
+
+void get_address_index_test_file(char *path, char *name) {
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    int return_value = snprintf(
+        path, TESTS_MAX_PATH, "%s/%s", output_directory, name);
+    assert_true(return_value < TESTS_MAX_PATH);
+}
+
+void test_address_index_read_from_file_reconstructs_index() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *blocks[12] = {0};
+    for (size_t idx = 0; idx < 12; idx++) {
+        create_ledger_test_block(
+            &blocks[idx],
+            (unsigned char)(1 + idx % 3),
+            (unsigned char)idx,
+            AMOUNT_GENERATED_DURING_MINTING);
+        return_code = address_index_apply_block(index, blocks[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    char path[TESTS_MAX_PATH];
+    get_address_index_test_file(
+        path, "address_index_test_read_from_file_reconstructs_index");
+    sha_256_t tip_hash = {0};
+    memset(tip_hash.digest, 0xab, sizeof(tip_hash.digest));
+    return_code = address_index_write_to_file(index, &tip_hash, path);
+    assert_true(SUCCESS == return_code);
+    address_index_t *read_index = NULL;
+    sha_256_t read_tip_hash = {0};
+    return_code = address_index_read_from_file(
+        &read_index, &read_tip_hash, path);
+    assert_true(SUCCESS == return_code);
+    remove(path);
+    assert_true(0 == memcmp(&tip_hash, &read_tip_hash, sizeof(sha_256_t)));
+    assert_true(index->num_blocks == read_index->num_blocks);
+    assert_true(index->num_entries == read_index->num_entries);
+    assert_true(index->num_postings == read_index->num_postings);
+    for (unsigned char id = 0; id < 13; id++) {
+        public_key_t public_key = {0};
+        create_ledger_test_key(&public_key, id);
+        address_index_posting_t postings[32] = {0};
+        uint64_t num_postings = 0;
+        return_code = address_index_get_postings(
+            index, &public_key, 0, 32, postings, &num_postings, NULL);
+        assert_true(SUCCESS == return_code);
+        address_index_posting_t read_postings[32] = {0};
+        uint64_t num_read_postings = 0;
+        return_code = address_index_get_postings(
+            read_index,
+            &public_key,
+            0,
+            32,
+            read_postings,
+            &num_read_postings,
+            NULL);
+        assert_true(SUCCESS == return_code);
+        assert_true(num_postings == num_read_postings);
+        assert_true(0 == memcmp(
+            postings,
+            read_postings,
+            num_postings * sizeof(address_index_posting_t)));
+    }
+    // The read index keeps growing like the original.
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 20, 21, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(read_index, block);
+    assert_true(SUCCESS == return_code);
+    assert_true(13 == read_index->num_blocks);
+    for (size_t idx = 0; idx < 12; idx++) {
+        block_destroy(blocks[idx]);
+    }
+    block_destroy(block);
+    address_index_destroy(index);
+    address_index_destroy(read_index);
+}
+
+void test_address_index_read_from_file_fails_on_invalid_file() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+    return_code = address_index_apply_block(index, block);
+    assert_true(SUCCESS == return_code);
+    char path[TESTS_MAX_PATH];
+    get_address_index_test_file(
+        path, "address_index_test_read_from_file_fails_on_invalid_file");
+    sha_256_t tip_hash = {0};
+    return_code = address_index_write_to_file(index, &tip_hash, path);
+    assert_true(SUCCESS == return_code);
+    // Drop the last byte, so that the counts no longer match the file.
+    FILE *f = fopen(path, "rb");
+    assert_true(NULL != f);
+    unsigned char buffer[512] = {0};
+    size_t file_size = fread(buffer, 1, sizeof(buffer), f);
+    fclose(f);
+    assert_true(0 < file_size && file_size < sizeof(buffer));
+    f = fopen(path, "wb");
+    assert_true(NULL != f);
+    assert_true(file_size - 1 == fwrite(buffer, 1, file_size - 1, f));
+    fclose(f);
+    address_index_t *read_index = NULL;
+    return_code = address_index_read_from_file(&read_index, &tip_hash, path);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // A file that is not an address index.
+    buffer[0] ^= 0xff;
+    f = fopen(path, "wb");
+    assert_true(NULL != f);
+    assert_true(file_size == fwrite(buffer, 1, file_size, f));
+    fclose(f);
+    return_code = address_index_read_from_file(&read_index, &tip_hash, path);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    remove(path);
+    return_code = address_index_read_from_file(&read_index, &tip_hash, path);
+    assert_true(FAILURE_FILE_IO == return_code);
+    block_destroy(block);
+    address_index_destroy(index);
+}
+
+void test_address_index_fails_on_invalid_input() {
+    address_index_t *index = NULL;
+    return_code_t return_code = address_index_create(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_create(&index);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, AMOUNT_GENERATED_DURING_MINTING);
+    public_key_t public_key = {0};
+    address_index_posting_t postings[1] = {0};
+    uint64_t num_postings = 0;
+    sha_256_t tip_hash = {0};
+    return_code = address_index_apply_block(NULL, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_apply_block(index, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_revert_block(index, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_get_postings(
+        NULL, &public_key, 0, 1, postings, &num_postings, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_get_postings(
+        index, NULL, 0, 1, postings, &num_postings, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_get_postings(
+        index, &public_key, 0, 1, NULL, &num_postings, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_get_postings(
+        index, &public_key, 0, 1, postings, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_copy(NULL, index);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_reserve(NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_write_to_file(index, NULL, "unused");
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_read_from_file(NULL, &tip_hash, "unused");
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = address_index_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+    address_index_destroy(index);
+}
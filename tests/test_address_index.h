@@ -0,0 +1,32 @@
+/**
+ * @brief Tests address_index.c
+ */
+
+#ifndef TESTS_TEST_ADDRESS_INDEX_H_
+#define TESTS_TEST_ADDRESS_INDEX_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_address_index_create_gives_empty_index();
+
+void test_address_index_apply_block_adds_postings_newest_first();
+
+void test_address_index_get_postings_pages_through_history();
+
+void test_address_index_get_postings_skips_to_deep_pages();
+
+void test_address_index_skip_rank_reaches_lower_rank();
+
+void test_address_index_revert_block_removes_postings();
+
+void test_address_index_copy_gives_independent_index();
+
+void test_address_index_read_from_file_reconstructs_index();
+
+void test_address_index_read_from_file_fails_on_invalid_file();
+
+void test_address_index_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_ADDRESS_INDEX_H_
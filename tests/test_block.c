@@ -394,6 +394,8 @@ void test_block_hash_multiple_transactions_included_in_hash() {
     block2->created_at = block1->created_at;
     return_code = linked_list_prepend(transaction_list2, transaction2);
     assert_true(SUCCESS == return_code);
+    return_code = block_compute_merkle_root(block2, &block2->merkle_root);
+    assert_true(SUCCESS == return_code);
     sha_256_t hash1 = {0};
     return_code = block_hash(block1, &hash1);
     assert_true(SUCCESS == return_code);
@@ -404,6 +406,8 @@ void test_block_hash_multiple_transactions_included_in_hash() {
     // Now add a second transaction to block 1 and make sure the hash changes.
     return_code = linked_list_prepend(transaction_list1, transaction3);
     assert_true(SUCCESS == return_code);
+    return_code = block_compute_merkle_root(block1, &block1->merkle_root);
+    assert_true(SUCCESS == return_code);
     return_code = block_hash(block1, &hash1);
     assert_true(SUCCESS == return_code);
     assert_true(0 != memcmp(&hash1, &hash2, sizeof(sha_256_t)));
@@ -524,3 +528,232 @@ void test_block_hash_fails_on_invalid_input() {
     assert_true(FAILURE_INVALID_INPUT == return_code);
     block_destroy(block);
 }
+
+void test_block_compute_merkle_root_empty_list_gives_zero_root() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t merkle_root = {0};
+    merkle_root.digest[0] = 'A';
+    return_code = block_compute_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    sha_256_t empty_root = {0};
+    assert_true(0 == memcmp(&merkle_root, &empty_root, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_compute_merkle_root_changes_with_transactions() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    // Transactions are hashed as raw structs, so unsigned ones suffice here.
+    transaction_t *transaction1 = calloc(1, sizeof(transaction_t));
+    transaction1->amount = 5;
+    return_code = linked_list_append(block->transaction_list, transaction1);
+    assert_true(SUCCESS == return_code);
+    sha_256_t root1 = {0};
+    return_code = block_compute_merkle_root(block, &root1);
+    assert_true(SUCCESS == return_code);
+    sha_256_t empty_root = {0};
+    assert_true(0 != memcmp(&root1, &empty_root, sizeof(sha_256_t)));
+    // A single leaf is the root.
+    sha_256_t transaction1_hash = {0};
+    return_code = transaction_hash(transaction1, &transaction1_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&root1, &transaction1_hash, sizeof(sha_256_t)));
+    transaction_t *transaction2 = calloc(1, sizeof(transaction_t));
+    transaction2->amount = 17;
+    return_code = linked_list_append(block->transaction_list, transaction2);
+    assert_true(SUCCESS == return_code);
+    sha_256_t root2 = {0};
+    return_code = block_compute_merkle_root(block, &root2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&root1, &root2, sizeof(sha_256_t)));
+    // Changing any transaction changes the root.
+    transaction1->amount++;
+    sha_256_t root3 = {0};
+    return_code = block_compute_merkle_root(block, &root3);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&root2, &root3, sizeof(sha_256_t)));
+    // An odd number of leaves is also supported.
+    transaction_t *transaction3 = calloc(1, sizeof(transaction_t));
+    transaction3->amount = 1;
+    return_code = linked_list_append(block->transaction_list, transaction3);
+    assert_true(SUCCESS == return_code);
+    sha_256_t root4 = {0};
+    return_code = block_compute_merkle_root(block, &root4);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&root3, &root4, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_compute_merkle_root_fails_on_invalid_input() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t merkle_root = {0};
+    return_code = block_compute_merkle_root(NULL, &merkle_root);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_compute_merkle_root(block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_block_hash_merkle_root_included_in_hash() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash1 = {0};
+    return_code = block_hash(block, &hash1);
+    assert_true(SUCCESS == return_code);
+    block->merkle_root.digest[0] = 'A';
+    sha_256_t hash2 = {0};
+    return_code = block_hash(block, &hash2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&hash1, &hash2, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_serialize_header_puts_proof_of_work_last() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    block->proof_of_work = 0x0102030405060708;
+    unsigned char header[BLOCK_HEADER_SIZE] = {0};
+    return_code = block_serialize_header(block, header);
+    assert_true(SUCCESS == return_code);
+    unsigned char expected_proof_of_work[] = {1, 2, 3, 4, 5, 6, 7, 8};
+    assert_true(0 == memcmp(
+        header + BLOCK_HEADER_SIZE - sizeof(expected_proof_of_work),
+        expected_proof_of_work,
+        sizeof(expected_proof_of_work)));
+    unsigned char expected_header[BLOCK_HEADER_SIZE] = {0};
+    return_code = block_serialize_header(block, expected_header);
+    assert_true(SUCCESS == return_code);
+    // Changing only the proof of work leaves the rest of the header unchanged.
+    block->proof_of_work = 0;
+    return_code = block_serialize_header(block, header);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        header,
+        expected_header,
+        BLOCK_HEADER_SIZE - sizeof(uint64_t)));
+    return_code = block_serialize_header(NULL, header);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_serialize_header(block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_block_seal_keeps_hash_until_unsealed() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!block->is_sealed);
+    // Unsealed blocks are hashed again on every call, as miners need.
+    sha_256_t hash1 = {0};
+    return_code = block_hash(block, &hash1);
+    assert_true(SUCCESS == return_code);
+    block->proof_of_work += 1;
+    sha_256_t hash2 = {0};
+    return_code = block_hash(block, &hash2);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&hash1, &hash2, sizeof(sha_256_t)));
+    return_code = block_seal(block);
+    assert_true(SUCCESS == return_code);
+    assert_true(block->is_sealed);
+    assert_true(0 == memcmp(&hash2, &block->hash, sizeof(sha_256_t)));
+    // A sealed block returns its stored hash.
+    block->proof_of_work += 1;
+    sha_256_t hash3 = {0};
+    return_code = block_hash(block, &hash3);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&hash2, &hash3, sizeof(sha_256_t)));
+    return_code = block_unseal(block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!block->is_sealed);
+    return_code = block_hash(block, &hash3);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != memcmp(&hash2, &hash3, sizeof(sha_256_t)));
+    block_destroy(block);
+}
+
+void test_block_compute_merkle_root_unseals_block() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    return_code = block_seal(block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t merkle_root = {0};
+    return_code = block_compute_merkle_root(block, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(block->is_sealed);
+    return_code = block_compute_merkle_root(block, &block->merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(!block->is_sealed);
+    block_destroy(block);
+}
+
+void test_block_seal_fails_on_invalid_input() {
+    return_code_t return_code = block_seal(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_unseal(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_block_copy_gives_independent_copy() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = calloc(1, sizeof(transaction_t));
+    transaction->amount = 5;
+    return_code = linked_list_append(block->transaction_list, transaction);
+    assert_true(SUCCESS == return_code);
+    return_code = block_compute_merkle_root(block, &block->merkle_root);
+    assert_true(SUCCESS == return_code);
+    return_code = block_seal(block);
+    assert_true(SUCCESS == return_code);
+    block_t *copy = NULL;
+    return_code = block_copy(&copy, block);
+    assert_true(SUCCESS == return_code);
+    assert_true(copy->is_sealed);
+    assert_true(0 == memcmp(&block->hash, &copy->hash, sizeof(sha_256_t)));
+    assert_true(block->transaction_list != copy->transaction_list);
+    transaction_t *copied_transaction =
+        (transaction_t *)copy->transaction_list->head->data;
+    assert_true(transaction != copied_transaction);
+    assert_true(5 == copied_transaction->amount);
+    assert_true(NULL == copy->transaction_list->head->next);
+    block_destroy(block);
+    sha_256_t merkle_root = {0};
+    return_code = block_compute_merkle_root(copy, &merkle_root);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &merkle_root, &copy->merkle_root, sizeof(sha_256_t)));
+    return_code = block_copy(NULL, copy);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_copy(&block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(copy);
+}
+
+void test_block_release_destroys_block_after_last_reference() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == atomic_load(&block->reference_count));
+    assert_true(NULL == block->arena);
+    return_code = block_retain(block);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == atomic_load(&block->reference_count));
+    return_code = block_release(block);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == atomic_load(&block->reference_count));
+    // The last release frees the block, which the sanitizers check.
+    return_code = block_release(block);
+    assert_true(SUCCESS == return_code);
+    return_code = block_retain(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_release(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
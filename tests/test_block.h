@@ -37,4 +37,24 @@ void test_block_hash_previous_block_hash_included_in_hash();
 
 void test_block_hash_fails_on_invalid_input();
 
+void test_block_compute_merkle_root_empty_list_gives_zero_root();
+
+void test_block_compute_merkle_root_changes_with_transactions();
+
+void test_block_compute_merkle_root_fails_on_invalid_input();
+
+void test_block_hash_merkle_root_included_in_hash();
+
+void test_block_serialize_header_puts_proof_of_work_last();
+
+void test_block_seal_keeps_hash_until_unsealed();
+
+void test_block_compute_merkle_root_unseals_block();
+
+void test_block_seal_fails_on_invalid_input();
+
+void test_block_copy_gives_independent_copy();
+
+void test_block_release_destroys_block_after_last_reference();
+
 #endif  // TESTS_TEST_BLOCK_H_
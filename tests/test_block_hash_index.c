@@ -0,0 +1,280 @@
+#include <string.h>
+#include "include/block_hash_index.h"
+#include "include/hash.h"
+#include "tests/test_block_hash_index.h"
+
+#define TEST_BLOCK_HASH_INDEX_NUM_BLOCKS 100
+#define TEST_BLOCK_HASH_INDEX_NUM_MINED_BLOCKS 4096
+#define TEST_BLOCK_HASH_INDEX_NUM_LEADING_ZERO_BYTES 3
+#define TEST_BLOCK_HASH_INDEX_MAX_CLUSTER_SIZE 256
+
+void test_block_hash_index_create_gives_empty_index() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    assert_true(BLOCK_HASH_INDEX_MIN_CAPACITY == index->capacity);
+    assert_true(0 == index->num_entries);
+    block_hash_index_destroy(index);
+    return_code = block_hash_index_create(&index, 100);
+    assert_true(SUCCESS == return_code);
+    // The index holds the expected number of blocks at most half full.
+    assert_true(index->capacity >= 200);
+    assert_true(0 == (index->capacity & (index->capacity - 1)));
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_create_fails_on_invalid_input() {
+    return_code_t return_code = block_hash_index_create(NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_block_hash_index_insert_then_find_gives_entry() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t block = {0};
+    sha_256_t hash = {0};
+    memset(hash.digest, 0xab, sizeof(hash.digest));
+    return_code = block_hash_index_insert(index, &hash, &block, 7);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == index->num_entries);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(index, &hash, &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(&block == entry->block);
+    assert_true(7 == entry->height);
+    assert_true(0 == memcmp(&hash, &entry->hash, sizeof(sha_256_t)));
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_insert_replaces_entry_with_same_hash() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t first_block = {0};
+    block_t second_block = {0};
+    sha_256_t hash = {0};
+    return_code = block_hash_index_insert(index, &hash, &first_block, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = block_hash_index_insert(index, &hash, &second_block, 2);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == index->num_entries);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(index, &hash, &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(&second_block == entry->block);
+    assert_true(2 == entry->height);
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_insert_grows_and_keeps_colliding_entries() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t blocks[TEST_BLOCK_HASH_INDEX_NUM_BLOCKS] = {0};
+    sha_256_t hashes[TEST_BLOCK_HASH_INDEX_NUM_BLOCKS] = {0};
+    for (uint64_t idx = 0; idx < TEST_BLOCK_HASH_INDEX_NUM_BLOCKS; idx++) {
+        // Hashes differ only before the bytes that choose the slot, so every
+        // hash collides with every other.
+        hashes[idx].digest[0] = idx;
+        return_code = block_hash_index_insert(
+            index, &hashes[idx], &blocks[idx], idx);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(TEST_BLOCK_HASH_INDEX_NUM_BLOCKS == index->num_entries);
+    assert_true(index->capacity >= 2 * TEST_BLOCK_HASH_INDEX_NUM_BLOCKS);
+    for (uint64_t idx = 0; idx < TEST_BLOCK_HASH_INDEX_NUM_BLOCKS; idx++) {
+        block_hash_index_entry_t *entry = NULL;
+        return_code = block_hash_index_find(index, &hashes[idx], &entry);
+        assert_true(SUCCESS == return_code);
+        assert_true(&blocks[idx] == entry->block);
+        assert_true(idx == entry->height);
+    }
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_remove_keeps_colliding_entries() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t blocks[TEST_BLOCK_HASH_INDEX_NUM_BLOCKS] = {0};
+    sha_256_t hashes[TEST_BLOCK_HASH_INDEX_NUM_BLOCKS] = {0};
+    for (uint64_t idx = 0; idx < TEST_BLOCK_HASH_INDEX_NUM_BLOCKS; idx++) {
+        // Every hash collides with every other, so all of them share one
+        // probe sequence that removals must not break.
+        hashes[idx].digest[0] = idx;
+        return_code = block_hash_index_insert(
+            index, &hashes[idx], &blocks[idx], idx);
+        assert_true(SUCCESS == return_code);
+    }
+    for (uint64_t idx = 0; idx < TEST_BLOCK_HASH_INDEX_NUM_BLOCKS; idx += 3) {
+        return_code = block_hash_index_remove(index, &hashes[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    uint64_t num_removed = (TEST_BLOCK_HASH_INDEX_NUM_BLOCKS + 2) / 3;
+    assert_true(
+        TEST_BLOCK_HASH_INDEX_NUM_BLOCKS - num_removed == index->num_entries);
+    for (uint64_t idx = 0; idx < TEST_BLOCK_HASH_INDEX_NUM_BLOCKS; idx++) {
+        block_hash_index_entry_t *entry = NULL;
+        return_code = block_hash_index_find(index, &hashes[idx], &entry);
+        if (0 == idx % 3) {
+            assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+        } else {
+            assert_true(SUCCESS == return_code);
+            assert_true(&blocks[idx] == entry->block);
+            assert_true(idx == entry->height);
+        }
+    }
+    return_code = block_hash_index_remove(index, &hashes[0]);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    // Removed slots take new entries again.
+    return_code = block_hash_index_insert(index, &hashes[0], &blocks[0], 0);
+    assert_true(SUCCESS == return_code);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(index, &hashes[0], &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(&blocks[0] == entry->block);
+    assert_true(!entry->is_side_block);
+    block_hash_index_destroy(index);
+    // Probe sequences that wrap past the last slot shift back across it.
+    return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    sha_256_t wrapping_hashes[4] = {0};
+    uint64_t slots[4] = {
+        BLOCK_HASH_INDEX_MIN_CAPACITY - 1,
+        BLOCK_HASH_INDEX_MIN_CAPACITY - 1,
+        0,
+        BLOCK_HASH_INDEX_MIN_CAPACITY - 1};
+    for (uint64_t idx = 0; idx < 4; idx++) {
+        wrapping_hashes[idx].digest[0] = idx;
+        memcpy(
+            wrapping_hashes[idx].digest +
+                sizeof(wrapping_hashes[idx].digest) - sizeof(uint64_t),
+            &slots[idx],
+            sizeof(uint64_t));
+        return_code = block_hash_index_insert(
+            index, &wrapping_hashes[idx], &blocks[idx], idx);
+        assert_true(SUCCESS == return_code);
+    }
+    return_code = block_hash_index_remove(index, &wrapping_hashes[0]);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t idx = 1; idx < 4; idx++) {
+        return_code = block_hash_index_find(
+            index, &wrapping_hashes[idx], &entry);
+        assert_true(SUCCESS == return_code);
+        assert_true(&blocks[idx] == entry->block);
+    }
+    return_code = block_hash_index_remove(NULL, &hashes[0]);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_remove(index, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_spreads_hashes_with_leading_zero_bytes() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t block = {0};
+    for (uint64_t idx = 0;
+        idx < TEST_BLOCK_HASH_INDEX_NUM_MINED_BLOCKS;
+        idx++) {
+        // Mined block hashes are uniform except for their leading zeros.
+        sha_256_t hash = {0};
+        return_code = hash_sha_256(&idx, sizeof(idx), &hash);
+        assert_true(SUCCESS == return_code);
+        memset(hash.digest, 0, TEST_BLOCK_HASH_INDEX_NUM_LEADING_ZERO_BYTES);
+        return_code = block_hash_index_insert(index, &hash, &block, idx);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(TEST_BLOCK_HASH_INDEX_NUM_MINED_BLOCKS == index->num_entries);
+    // Lookups probe through a run of occupied slots, so no run may grow with
+    // the number of blocks.
+    size_t cluster_size = 0;
+    size_t max_cluster_size = 0;
+    for (size_t idx = 0; idx < index->capacity; idx++) {
+        cluster_size = NULL == index->entries[idx].block ? 0 : cluster_size + 1;
+        if (cluster_size > max_cluster_size) {
+            max_cluster_size = cluster_size;
+        }
+    }
+    assert_true(max_cluster_size < TEST_BLOCK_HASH_INDEX_MAX_CLUSTER_SIZE);
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_copy_gives_independent_index() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t first_block = {0};
+    block_t second_block = {0};
+    sha_256_t first_hash = {0};
+    sha_256_t second_hash = {0};
+    second_hash.digest[0] = 1;
+    return_code = block_hash_index_insert(index, &first_hash, &first_block, 0);
+    assert_true(SUCCESS == return_code);
+    block_hash_index_t *copy = NULL;
+    return_code = block_hash_index_copy(&copy, index);
+    assert_true(SUCCESS == return_code);
+    assert_true(index->capacity == copy->capacity);
+    assert_true(1 == copy->num_entries);
+    return_code = block_hash_index_insert(copy, &second_hash, &second_block, 1);
+    assert_true(SUCCESS == return_code);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(copy, &first_hash, &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(&first_block == entry->block);
+    return_code = block_hash_index_find(copy, &second_hash, &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(&second_block == entry->block);
+    return_code = block_hash_index_find(index, &second_hash, &entry);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    return_code = block_hash_index_copy(NULL, index);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_copy(&copy, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_hash_index_destroy(copy);
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_find_fails_on_missing_hash() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(index, &hash, &entry);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    block_t block = {0};
+    return_code = block_hash_index_insert(index, &hash, &block, 0);
+    assert_true(SUCCESS == return_code);
+    sha_256_t other_hash = {0};
+    other_hash.digest[0] = 1;
+    return_code = block_hash_index_find(index, &other_hash, &entry);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    block_hash_index_destroy(index);
+}
+
+void test_block_hash_index_fails_on_invalid_input() {
+    block_hash_index_t *index = NULL;
+    return_code_t return_code = block_hash_index_create(&index, 0);
+    assert_true(SUCCESS == return_code);
+    block_t block = {0};
+    sha_256_t hash = {0};
+    return_code = block_hash_index_insert(NULL, &hash, &block, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_insert(index, NULL, &block, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_insert(index, &hash, NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(NULL, &hash, &entry);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_find(index, NULL, &entry);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = block_hash_index_find(index, &hash, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_hash_index_destroy(index);
+}
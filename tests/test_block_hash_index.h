@@ -0,0 +1,32 @@
+/**
+ * @brief Tests block_hash_index.c
+ */
+
+#ifndef TESTS_TEST_BLOCK_HASH_INDEX_H_
+#define TESTS_TEST_BLOCK_HASH_INDEX_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_block_hash_index_create_gives_empty_index();
+
+void test_block_hash_index_create_fails_on_invalid_input();
+
+void test_block_hash_index_insert_then_find_gives_entry();
+
+void test_block_hash_index_insert_replaces_entry_with_same_hash();
+
+void test_block_hash_index_insert_grows_and_keeps_colliding_entries();
+
+void test_block_hash_index_remove_keeps_colliding_entries();
+
+void test_block_hash_index_spreads_hashes_with_leading_zero_bytes();
+
+void test_block_hash_index_copy_gives_independent_index();
+
+void test_block_hash_index_find_fails_on_missing_hash();
+
+void test_block_hash_index_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_BLOCK_HASH_INDEX_H_
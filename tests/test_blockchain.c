@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include "include/base64.h"
 #include "include/block.h"
 #include "include/blockchain.h"
 #include "include/hash.h"
@@ -10,9 +12,11 @@
 #include "include/transaction.h"
 #include "tests/file_paths.h"
 #include "tests/test_blockchain.h"
+#include "tests/test_cryptography.h"
+#include "tests/test_ledger.h"
 
 #define NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH 2
-#define EXPERIMENTALLY_FOUND_PROOF_OF_WORK 90797
+#define EXPERIMENTALLY_FOUND_PROOF_OF_WORK 13740
 
 void test_blockchain_create_gives_blockchain() {
     blockchain_t *blockchain = NULL;
@@ -20,7 +24,7 @@ void test_blockchain_create_gives_blockchain() {
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
     assert_true(NULL != blockchain);
-    assert_true(NULL != blockchain->block_list);
+    assert_true(0 == blockchain->num_blocks);
     assert_true(NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH ==
         blockchain->num_leading_zero_bytes_required_in_block_hash);
     blockchain_destroy(blockchain);
@@ -156,17 +160,151 @@ void test_blockchain_add_block_appends_block() {
         assert_true(false);
         goto end;
     }
-    block_t *first_block = (block_t *)blockchain->block_list->head->data;
-    block_t *second_block = (block_t *)blockchain->block_list->head->next->data;
-    block_t *third_block =
-        (block_t *)blockchain->block_list->head->next->next->data;
+    uint64_t length = 0;
+    return_code = blockchain_length(blockchain, &length);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == length);
+    block_t *first_block = NULL;
+    return_code = blockchain_get_block(blockchain, 0, &first_block);
+    assert_true(SUCCESS == return_code);
+    block_t *second_block = NULL;
+    return_code = blockchain_get_block(blockchain, 1, &second_block);
+    assert_true(SUCCESS == return_code);
+    block_t *third_block = NULL;
+    return_code = blockchain_get_block(blockchain, 2, &third_block);
+    assert_true(SUCCESS == return_code);
     assert_true(GENESIS_BLOCK_PROOF_OF_WORK == first_block->proof_of_work);
     assert_true(123 == second_block->proof_of_work);
     assert_true(456 == third_block->proof_of_work);
+    block_t *last_block = NULL;
+    return_code = blockchain_get_last_block(blockchain, &last_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(third_block == last_block);
 end:
     blockchain_destroy(blockchain);
 }
 
+void test_blockchain_add_block_grows_storage() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *blocks[100] = {0};
+    for (size_t idx = 0; idx < 100; idx++) {
+        return_code = block_create_genesis_block(&blocks[idx]);
+        assert_true(SUCCESS == return_code);
+        blocks[idx]->proof_of_work = idx;
+        return_code = blockchain_add_block(blockchain, blocks[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(100 == blockchain->num_blocks);
+    assert_true(blockchain->blocks_capacity >= 100);
+    for (uint64_t height = 0; height < 100; height++) {
+        block_t *block = NULL;
+        return_code = blockchain_get_block(blockchain, height, &block);
+        assert_true(SUCCESS == return_code);
+        assert_true(blocks[height] == block);
+        assert_true(height == block->proof_of_work);
+        assert_true(block->is_sealed);
+    }
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_get_block_fails_on_missing_block() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    return_code = blockchain_get_last_block(blockchain, &block);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    return_code = blockchain_get_block(blockchain, 0, &block);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_get_block(blockchain, 1, &block);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    uint64_t length = 0;
+    return_code = blockchain_length(NULL, &length);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_length(blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_block(NULL, 0, &block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_block(blockchain, 0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_last_block(NULL, &block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_last_block(blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_find_block_by_hash_finds_every_block() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *blocks[100] = {0};
+    for (size_t idx = 0; idx < 100; idx++) {
+        return_code = block_create_genesis_block(&blocks[idx]);
+        assert_true(SUCCESS == return_code);
+        blocks[idx]->proof_of_work = idx;
+        return_code = blockchain_add_block(blockchain, blocks[idx]);
+        assert_true(SUCCESS == return_code);
+    }
+    for (uint64_t height = 0; height < 100; height++) {
+        sha_256_t hash = {0};
+        return_code = block_hash(blocks[height], &hash);
+        assert_true(SUCCESS == return_code);
+        block_t *block = NULL;
+        uint64_t found_height = 0;
+        return_code = blockchain_find_block_by_hash(
+            blockchain, &hash, &block, &found_height);
+        assert_true(SUCCESS == return_code);
+        assert_true(blocks[height] == block);
+        assert_true(height == found_height);
+    }
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_find_block_by_hash_fails_on_missing_block() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    block_t *block = NULL;
+    uint64_t height = 0;
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &hash, &block, &height);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &hash, &block, &height);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    return_code = blockchain_find_block_by_hash(
+        NULL, &hash, &block, &height);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_find_block_by_hash(
+        blockchain, NULL, &block, &height);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &hash, NULL, &height);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &hash, &block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
 void test_blockchain_add_block_fails_on_invalid_input() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
@@ -262,7 +400,7 @@ void test_blockchain_mine_block_produces_block_with_valid_hash() {
     block1->created_at = 0;
     atomic_bool should_stop = false;
     return_code = blockchain_mine_block(
-        blockchain, block1, false, &should_stop);
+        blockchain, block1, false, &should_stop, 1);
     assert_true(SUCCESS == return_code);
     assert_true(0 != block1->proof_of_work);
     assert_true(EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
@@ -278,6 +416,34 @@ void test_blockchain_mine_block_produces_block_with_valid_hash() {
     blockchain_destroy(blockchain);
 }
 
+void test_blockchain_mine_block_with_progress_finds_same_proof_of_work() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block1->created_at = 0;
+    // Progress is rendered on a separate thread and must not change the
+    // search.
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        blockchain, block1, true, &should_stop, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(EXPERIMENTALLY_FOUND_PROOF_OF_WORK == block1->proof_of_work);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
 void test_blockchain_mine_block_fails_on_invalid_input() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
@@ -294,16 +460,201 @@ void test_blockchain_mine_block_fails_on_invalid_input() {
         0,
         previous_block_hash);
     atomic_bool should_stop = false;
-    return_code = blockchain_mine_block(NULL, block1, false, &should_stop);
+    return_code = blockchain_mine_block(
+        NULL, block1, false, &should_stop, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mine_block(
+        blockchain, NULL, false, &should_stop, 1);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_mine_block(blockchain, NULL, false, &should_stop);
+    return_code = blockchain_mine_block(blockchain, block1, false, NULL, 1);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_mine_block(blockchain, block1, false, NULL);
+    return_code = blockchain_mine_block(
+        blockchain, block1, false, &should_stop, 0);
     assert_true(FAILURE_INVALID_INPUT == return_code);
     block_destroy(block1);
     blockchain_destroy(blockchain);
 }
 
+void test_blockchain_mine_block_multiple_threads_produces_valid_hash() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    block1->created_at = 0;
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        blockchain, block1, false, &should_stop, 4);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = block_hash(block1, &hash);
+    assert_true(SUCCESS == return_code);
+    bool is_valid_block_hash = false;
+    return_code = blockchain_is_valid_block_hash(
+        blockchain, hash, &is_valid_block_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_block_hash);
+    block_destroy(block1);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_get_proof_of_work_range_covers_every_proof_of_work() {
+    size_t nums_workers[] = {1, 2, 3, 7, 64};
+    for (size_t num_idx = 0;
+        num_idx < sizeof(nums_workers) / sizeof(nums_workers[0]);
+        num_idx++) {
+        size_t num_workers = nums_workers[num_idx];
+        uint64_t next_proof_of_work = 0;
+        uint64_t last_proof_of_work = 0;
+        for (size_t worker_idx = 0; worker_idx < num_workers; worker_idx++) {
+            uint64_t first_proof_of_work = 0;
+            return_code_t return_code = blockchain_get_proof_of_work_range(
+                worker_idx,
+                num_workers,
+                &first_proof_of_work,
+                &last_proof_of_work);
+            assert_true(SUCCESS == return_code);
+            // Each range starts right after the previous one ends.
+            assert_true(next_proof_of_work == first_proof_of_work);
+            assert_true(first_proof_of_work <= last_proof_of_work);
+            next_proof_of_work = last_proof_of_work + 1;
+        }
+        assert_true(UINT64_MAX == last_proof_of_work);
+    }
+    uint64_t first_proof_of_work = 0;
+    uint64_t last_proof_of_work = 0;
+    return_code_t return_code = blockchain_get_proof_of_work_range(
+        0, 0, &first_proof_of_work, &last_proof_of_work);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_proof_of_work_range(
+        2, 2, &first_proof_of_work, &last_proof_of_work);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_proof_of_work_range(
+        0, 1, NULL, &last_proof_of_work);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_proof_of_work_range(
+        0, 1, &first_proof_of_work, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_synchronized_blockchain_mine_block_stops_on_should_stop() {
+    blockchain_t *blockchain = NULL;
+    // No block will ever hash to all zeros, so mining can only stop early.
+    return_code_t return_code = blockchain_create(
+        &blockchain, sizeof(sha_256_t));
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    atomic_bool should_stop = true;
+    atomic_size_t sync_version_currently_mined = atomic_load(&sync->version);
+    return_code = synchronized_blockchain_mine_block(
+        sync,
+        block1,
+        false,
+        &should_stop,
+        &sync_version_currently_mined,
+        4);
+    assert_true(FAILURE_STOPPED_EARLY == return_code);
+    block_destroy(block1);
+    synchronized_blockchain_destroy(sync);
+}
+
+void test_synchronized_blockchain_mine_block_stops_on_version_change() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, sizeof(sha_256_t));
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    atomic_bool should_stop = false;
+    atomic_size_t sync_version_currently_mined = atomic_load(&sync->version);
+    atomic_fetch_add(&sync->version, 1);
+    return_code = synchronized_blockchain_mine_block(
+        sync,
+        block1,
+        false,
+        &should_stop,
+        &sync_version_currently_mined,
+        4);
+    assert_true(FAILURE_LONGER_BLOCKCHAIN_DETECTED == return_code);
+    block_destroy(block1);
+    synchronized_blockchain_destroy(sync);
+}
+
+void test_synchronized_blockchain_mine_block_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    linked_list_t *transaction_list1 = NULL;
+    return_code = linked_list_create(&transaction_list1, free, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *block1 = NULL;
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        &block1,
+        transaction_list1,
+        0,
+        previous_block_hash);
+    assert_true(SUCCESS == return_code);
+    atomic_bool should_stop = false;
+    atomic_size_t sync_version_currently_mined = atomic_load(&sync->version);
+    return_code = synchronized_blockchain_mine_block(
+        NULL, block1, false, &should_stop, &sync_version_currently_mined, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_mine_block(
+        sync, NULL, false, &should_stop, &sync_version_currently_mined, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_mine_block(
+        sync, block1, false, NULL, &sync_version_currently_mined, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_mine_block(
+        sync, block1, false, &should_stop, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_mine_block(
+        sync, block1, false, &should_stop, &sync_version_currently_mined, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block1);
+    synchronized_blockchain_destroy(sync);
+}
+
 void test_blockchain_verify_succeeds_on_valid_blockchain() {
     char fixture_directory[TESTS_MAX_PATH];
     get_fixture_directory(fixture_directory);
@@ -313,7 +664,7 @@ void test_blockchain_verify_succeeds_on_valid_blockchain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
@@ -337,12 +688,12 @@ void test_blockchain_verify_fails_on_invalid_genesis_block() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = (block_t *)blockchain->block_list->head->data;
+    block_t *genesis_block = blockchain->blocks[0];
     genesis_block->proof_of_work += 1;
     bool is_valid = false;
     block_t *first_invalid_block = NULL;
@@ -372,12 +723,14 @@ void test_blockchain_verify_fails_on_invalid_proof_of_work() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
     assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->data;
+    block_t *block = blockchain->blocks[1];
+    // Blocks in a chain are sealed, so drop the stored hash before tampering.
+    block_unseal(block);
     block->proof_of_work += 1;
     bool is_valid = false;
     block_t *first_invalid_block = NULL;
@@ -398,12 +751,12 @@ void test_blockchain_verify_fails_on_invalid_previous_block_hash() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
     assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    block_t *block = blockchain->blocks[2];
     block->previous_block_hash.digest[0] = 'A';
     block->previous_block_hash.digest[1] = 'A';
     block->previous_block_hash.digest[2] = 'A';
@@ -417,7 +770,7 @@ void test_blockchain_verify_fails_on_invalid_previous_block_hash() {
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_verify_fails_on_invalid_transaction_signature() {
+void test_blockchain_verify_fails_on_invalid_merkle_root() {
     char fixture_directory[TESTS_MAX_PATH];
     get_fixture_directory(fixture_directory);
     char infile[TESTS_MAX_PATH];
@@ -426,17 +779,16 @@ void test_blockchain_verify_fails_on_invalid_transaction_signature() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
     assert_true(SUCCESS == return_code);
-    block_t *block = (block_t *)blockchain->block_list->head->next->next->data;
+    block_t *block = blockchain->blocks[2];
+    // The header is unchanged, so only the Merkle root check can catch this.
     transaction_t *minting_transaction =
         (transaction_t *)block->transaction_list->head->data;
-    minting_transaction->sender_signature.bytes[0] = 'A';
-    minting_transaction->sender_signature.bytes[1] = 'A';
-    minting_transaction->sender_signature.bytes[2] = 'A';
+    minting_transaction->amount++;
     bool is_valid = false;
     block_t *first_invalid_block = NULL;
     return_code = blockchain_verify(
@@ -447,7 +799,7 @@ void test_blockchain_verify_fails_on_invalid_transaction_signature() {
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_verify_fails_on_invalid_input() {
+void test_blockchain_verify_fails_on_invalid_transaction_signature() {
     char fixture_directory[TESTS_MAX_PATH];
     get_fixture_directory(fixture_directory);
     char infile[TESTS_MAX_PATH];
@@ -456,23 +808,28 @@ void test_blockchain_verify_fails_on_invalid_input() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
     assert_true(SUCCESS == return_code);
+    block_t *block = blockchain->blocks[2];
+    transaction_t *minting_transaction =
+        (transaction_t *)block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] = 'A';
+    minting_transaction->sender_signature.bytes[1] = 'A';
+    minting_transaction->sender_signature.bytes[2] = 'A';
     bool is_valid = false;
     block_t *first_invalid_block = NULL;
     return_code = blockchain_verify(
-        NULL, &is_valid, &first_invalid_block);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_verify(
-        blockchain, NULL, &first_invalid_block);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_serialize_creates_nonempty_buffer() {
+void test_blockchain_verify_fails_on_overspending_transaction() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
@@ -482,23 +839,435 @@ void test_blockchain_serialize_creates_nonempty_buffer() {
     assert_true(SUCCESS == return_code);
     return_code = blockchain_add_block(blockchain, genesis_block);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    char *ssh_public_key_contents_base64 = getenv(
+        TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t miner_public_key = {0};
+    return_code = base64_decode(
+        ssh_public_key_contents_base64,
+        strlen(ssh_public_key_contents_base64),
+        miner_public_key.bytes);
+    assert_true(SUCCESS == return_code);
+    char *ssh_private_key_contents_base64 = getenv(
+        TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t miner_private_key = {0};
+    return_code = base64_decode(
+        ssh_private_key_contents_base64,
+        strlen(ssh_private_key_contents_base64),
+        miner_private_key.bytes);
+    assert_true(SUCCESS == return_code);
+    // Every signature in the block is valid, but the miner sends more than
+    // the coin it just minted.
+    linked_list_t *transaction_list = NULL;
+    return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *minting_transaction = NULL;
+    return_code = transaction_create(
+        &minting_transaction,
+        &miner_public_key,
+        &miner_public_key,
+        AMOUNT_GENERATED_DURING_MINTING,
+        &miner_private_key);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(transaction_list, minting_transaction);
+    assert_true(SUCCESS == return_code);
+    transaction_t *overspending_transaction = NULL;
+    return_code = transaction_create(
+        &overspending_transaction,
+        &miner_public_key,
+        &miner_public_key,
+        AMOUNT_GENERATED_DURING_MINTING + 1,
+        &miner_private_key);
+    assert_true(SUCCESS == return_code);
+    return_code = linked_list_append(
+        transaction_list, overspending_transaction);
+    assert_true(SUCCESS == return_code);
+    sha_256_t genesis_block_hash = {0};
+    return_code = block_hash(genesis_block, &genesis_block_hash);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    return_code = block_create(
+        &block, transaction_list, 0, genesis_block_hash);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != buffer);
-    assert_true(0 != buffer_size);
-    unsigned char *empty_buffer = calloc(buffer_size, 1);
-    assert_true(0 != memcmp(buffer, empty_buffer, buffer_size));
-    free(buffer);
-    free(empty_buffer);
+    atomic_bool should_stop = false;
+    return_code = blockchain_mine_block(
+        blockchain, block, false, &should_stop, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+    int64_t balance = 0;
+    return_code = blockchain_get_balance(
+        blockchain, &minting_transaction->sender_public_key, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == balance);
+    bool is_valid = true;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        blockchain, &is_valid, &first_invalid_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_serialize_fails_on_invalid_input() {
+void test_blockchain_verify_fails_on_invalid_input() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_create(
-        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify(
+        NULL, &is_valid, &first_invalid_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify(
+        blockchain, NULL, &first_invalid_block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_parallel_succeeds_on_valid_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    for (size_t num_threads = 1; num_threads <= 4; num_threads++) {
+        bool is_valid = false;
+        return_code = blockchain_verify_parallel(
+            blockchain, &is_valid, NULL, num_threads);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid);
+    }
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_parallel_finds_first_invalid_block() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    // Invalidate two blocks. Whichever a worker reaches first, the result is
+    // the earlier one, as in the sequential verification.
+    block_t *second_block = blockchain->blocks[1];
+    block_t *last_block = blockchain->blocks[3];
+    transaction_t *minting_transaction =
+        (transaction_t *)last_block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] ^= 0xff;
+    second_block->previous_block_hash.digest[0] ^= 0xff;
+    for (size_t num_threads = 1; num_threads <= 4; num_threads++) {
+        bool is_valid = true;
+        block_t *first_invalid_block = NULL;
+        return_code = blockchain_verify_parallel(
+            blockchain, &is_valid, &first_invalid_block, num_threads);
+        assert_true(SUCCESS == return_code);
+        assert_true(!is_valid);
+        assert_true(first_invalid_block == second_block);
+    }
+    // Once the earlier block is fixed, the later one is reported.
+    second_block->previous_block_hash.digest[0] ^= 0xff;
+    for (size_t num_threads = 1; num_threads <= 4; num_threads++) {
+        bool is_valid = true;
+        block_t *first_invalid_block = NULL;
+        return_code = blockchain_verify_parallel(
+            blockchain, &is_valid, &first_invalid_block, num_threads);
+        assert_true(SUCCESS == return_code);
+        assert_true(!is_valid);
+        assert_true(first_invalid_block == last_block);
+    }
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_parallel_fails_on_invalid_input() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    return_code = blockchain_verify_parallel(NULL, &is_valid, NULL, 2);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_parallel(blockchain, NULL, NULL, 2);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_parallel(blockchain, &is_valid, NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_incremental_skips_verified_prefix() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    blockchain_verified_prefix_t verified_prefix = {0};
+    bool is_valid = false;
+    return_code = blockchain_verify_incremental(
+        blockchain, &verified_prefix, &is_valid, NULL, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(4 == verified_prefix.num_blocks);
+    block_t *last_block = NULL;
+    return_code = blockchain_get_last_block(blockchain, &last_block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t tip_hash = {0};
+    return_code = block_hash(last_block, &tip_hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &tip_hash, &verified_prefix.tip_hash, sizeof(sha_256_t)));
+    // Invalidate a signature without changing any block header. Only a full
+    // verification notices, which shows that the prefix is not rechecked.
+    block_t *block = blockchain->blocks[1];
+    transaction_t *minting_transaction =
+        (transaction_t *)block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] ^= 0xff;
+    return_code = blockchain_verify_incremental(
+        blockchain, &verified_prefix, &is_valid, NULL, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_incremental_checks_blocks_after_prefix() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    // Pretend the first 3 blocks were verified before the last was appended.
+    blockchain_verified_prefix_t verified_prefix = {0};
+    verified_prefix.num_blocks = 3;
+    verified_prefix.num_leading_zero_bytes_required_in_block_hash =
+        blockchain->num_leading_zero_bytes_required_in_block_hash;
+    return_code = block_hash(blockchain->blocks[2], &verified_prefix.tip_hash);
+    assert_true(SUCCESS == return_code);
+    block_t *block = blockchain->blocks[3];
+    transaction_t *minting_transaction =
+        (transaction_t *)block->transaction_list->head->data;
+    minting_transaction->sender_signature.bytes[0] ^= 0xff;
+    bool is_valid = true;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify_incremental(
+        blockchain,
+        &verified_prefix,
+        &is_valid,
+        &first_invalid_block,
+        1);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
+    // The prefix is unchanged when verification fails.
+    assert_true(3 == verified_prefix.num_blocks);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_verify_incremental_rechecks_other_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    blockchain_verified_prefix_t verified_prefix = {0};
+    bool is_valid = false;
+    return_code = blockchain_verify_incremental(
+        blockchain, &verified_prefix, &is_valid, NULL, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    // Another blockchain with the same tip block but a broken link before it
+    // does not share the prefix, so it is checked in full.
+    blockchain_t *other_blockchain = NULL;
+    return_code = blockchain_read_from_file(&other_blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    block_t *block = other_blockchain->blocks[1];
+    block->previous_block_hash.digest[0] ^= 0xff;
+    block_t *first_invalid_block = NULL;
+    return_code = blockchain_verify_incremental(
+        other_blockchain,
+        &verified_prefix,
+        &is_valid,
+        &first_invalid_block,
+        1);
+    assert_true(SUCCESS == return_code);
+    assert_true(!is_valid);
+    assert_true(first_invalid_block == block);
+    blockchain_destroy(other_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_synchronized_blockchain_verify_records_verified_prefix() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == sync->verified_prefix.num_blocks);
+    bool is_valid = false;
+    return_code = synchronized_blockchain_verify(
+        sync, blockchain, &is_valid, NULL, NULL, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(4 == sync->verified_prefix.num_blocks);
+    // The prefix keeps its tip block alive, so no other block can take its
+    // address while sync trusts it.
+    assert_true(blockchain->blocks[3] == sync->verified_prefix.tip_block);
+    assert_true(2 == atomic_load(&blockchain->blocks[3]->reference_count));
+    // Verifying a different blockchain reports its prefix but leaves sync's
+    // alone.
+    blockchain_t *peer_blockchain = NULL;
+    return_code = blockchain_read_from_file(&peer_blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    sync->verified_prefix.num_blocks = 1;
+    return_code = block_hash(
+        blockchain->blocks[0],
+        &sync->verified_prefix.tip_hash);
+    assert_true(SUCCESS == return_code);
+    blockchain_verified_prefix_t peer_verified_prefix = {0};
+    return_code = synchronized_blockchain_verify(
+        sync, peer_blockchain, &is_valid, NULL, &peer_verified_prefix, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(4 == peer_verified_prefix.num_blocks);
+    assert_true(1 == sync->verified_prefix.num_blocks);
+    blockchain_destroy(peer_blockchain);
+    synchronized_blockchain_destroy(sync);
+}
+
+void test_blockchain_verify_incremental_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    blockchain_verified_prefix_t verified_prefix = {0};
+    bool is_valid = false;
+    return_code = blockchain_verify_incremental(
+        NULL, &verified_prefix, &is_valid, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_incremental(
+        blockchain, NULL, &is_valid, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_incremental(
+        blockchain, &verified_prefix, NULL, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_verify_incremental(
+        blockchain, &verified_prefix, &is_valid, NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_verify(
+        NULL, blockchain, &is_valid, NULL, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_verify(
+        sync, NULL, &is_valid, NULL, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_verify(
+        sync, blockchain, NULL, NULL, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_verify(
+        sync, blockchain, &is_valid, NULL, NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    synchronized_blockchain_destroy(sync);
+}
+
+void test_blockchain_serialize_creates_nonempty_buffer() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != buffer);
+    assert_true(0 != buffer_size);
+    unsigned char *empty_buffer = calloc(buffer_size, 1);
+    assert_true(0 != memcmp(buffer, empty_buffer, buffer_size));
+    free(buffer);
+    free(empty_buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
     assert_true(SUCCESS == return_code);
     block_t *genesis_block = NULL;
     return_code = block_create_genesis_block(&genesis_block);
@@ -516,103 +1285,2244 @@ void test_blockchain_serialize_fails_on_invalid_input() {
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_deserialize_reconstructs_blockchain() {
-    // See test_blockchain_read_from_file_reconstructs_blockchain. Since
-    // blockchain_read_from_file calls blockchain_deserialize, the
-    // aforementioned test already covers deserialization fairly well. Here we
-    // will just test on a single-block blockchain to preserve compute and add
-    // diversity to the tests.
+void test_blockchain_serialize_into_buffer_matches_serialize() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    uint64_t size = 0;
+    return_code = blockchain_serialized_size(blockchain, &size);
+    assert_true(SUCCESS == return_code);
+    assert_true(buffer_size == size);
+    // A larger buffer keeps its extra bytes untouched.
+    unsigned char *caller_buffer = malloc(size + 1);
+    assert_true(NULL != caller_buffer);
+    caller_buffer[size] = 0xa5;
+    uint64_t bytes_written = 0;
+    return_code = blockchain_serialize_into_buffer(
+        blockchain, caller_buffer, size + 1, &bytes_written);
+    assert_true(SUCCESS == return_code);
+    assert_true(size == bytes_written);
+    assert_true(0 == memcmp(buffer, caller_buffer, size));
+    assert_true(0xa5 == caller_buffer[size]);
+    // A buffer one byte short is left as it was.
+    memset(caller_buffer, 0, size + 1);
+    return_code = blockchain_serialize_into_buffer(
+        blockchain, caller_buffer, size - 1, &bytes_written);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    assert_true(0 == caller_buffer[0]);
+    free(caller_buffer);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_into_iovec_spans_buffers() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // Cut the output into pieces of odd sizes, including empty ones, so that
+    // fields of every width straddle a boundary.
+    unsigned char *output = calloc(1, buffer_size);
+    assert_true(NULL != output);
+    size_t piece_sizes[] = {0, 1, 3, 0, 7, 13};
+    struct iovec buffers[1024] = {0};
+    size_t num_buffers = 0;
+    uint64_t offset = 0;
+    while (offset < buffer_size) {
+        assert_true(num_buffers < sizeof(buffers) / sizeof(buffers[0]));
+        size_t piece_size =
+            piece_sizes[num_buffers % (sizeof(piece_sizes) / sizeof(size_t))];
+        if (piece_size > buffer_size - offset) {
+            piece_size = buffer_size - offset;
+        }
+        buffers[num_buffers].iov_base = output + offset;
+        buffers[num_buffers].iov_len = piece_size;
+        offset += piece_size;
+        num_buffers++;
+    }
+    uint64_t bytes_written = 0;
+    return_code = blockchain_serialize_into_iovec(
+        blockchain, buffers, num_buffers, &bytes_written);
+    assert_true(SUCCESS == return_code);
+    assert_true(buffer_size == bytes_written);
+    assert_true(0 == memcmp(buffer, output, buffer_size));
+    return_code = blockchain_serialize_into_iovec(
+        blockchain, buffers, num_buffers - 1, &bytes_written);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(output);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_serialize_into_buffer_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    unsigned char buffer[64] = {0};
+    struct iovec buffers[1] = {0};
+    uint64_t bytes_written = 0;
+    uint64_t size = 0;
+    return_code = blockchain_serialized_size(NULL, &size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialized_size(blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_into_buffer(
+        NULL, buffer, sizeof(buffer), &bytes_written);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_into_buffer(
+        blockchain, NULL, sizeof(buffer), &bytes_written);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_into_buffer(
+        blockchain, buffer, sizeof(buffer), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_serialize_into_iovec(
+        blockchain, NULL, 1, &bytes_written);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    buffers[0].iov_len = sizeof(buffer);
+    return_code = blockchain_serialize_into_iovec(
+        blockchain, buffers, 1, &bytes_written);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_reconstructs_blockchain() {
+    // See test_blockchain_read_from_file_reconstructs_blockchain. Since
+    // blockchain_read_from_file calls blockchain_deserialize, the
+    // aforementioned test already covers deserialization fairly well. Here we
+    // will just test on a single-block blockchain to preserve compute and add
+    // diversity to the tests.
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != deserialized_blockchain);
+    uint64_t num_blocks = 0;
+    return_code = blockchain_length(deserialized_blockchain, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_blocks);
+    block_t *deserialized_genesis_block = deserialized_blockchain->blocks[0];
+    assert_true(
+        genesis_block->created_at == deserialized_genesis_block->created_at);
+    assert_true(0 == memcmp(
+        &genesis_block->previous_block_hash,
+        &deserialized_genesis_block->previous_block_hash,
+        sizeof(sha_256_t)));
+    assert_true(
+        genesis_block->proof_of_work ==
+        deserialized_genesis_block->proof_of_work);
+    bool is_empty = false;
+    return_code = linked_list_is_empty(
+        deserialized_genesis_block->transaction_list, &is_empty);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_empty);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(deserialized_blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_attempted_read_past_buffer() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size - 50);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(NULL, buffer, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, NULL, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_write_to_file_creates_nonempty_file() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_creates_nonempty_file");
+    assert_true(return_value < TESTS_MAX_PATH);
+    struct stat file_stats = {0};
+    assert_true(0 != stat(outfile, &file_stats));
+    return_code = blockchain_write_to_file(blockchain, outfile);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == stat(outfile, &file_stats));
+    assert_true(0 != file_stats.st_size);
+    // The address index is saved beside the blockchain.
+    char address_index_file[TESTS_MAX_PATH];
+    return_value = snprintf(
+        address_index_file,
+        TESTS_MAX_PATH,
+        "%s%s",
+        outfile,
+        ADDRESS_INDEX_FILE_SUFFIX);
+    assert_true(return_value < TESTS_MAX_PATH);
+    address_index_t *address_index = NULL;
+    sha_256_t tip_hash = {0};
+    return_code = address_index_read_from_file(
+        &address_index, &tip_hash, address_index_file);
+    assert_true(SUCCESS == return_code);
+    remove(address_index_file);
+    assert_true(1 == address_index->num_blocks);
+    assert_true(0 == memcmp(&genesis_block->hash, &tip_hash, sizeof(tip_hash)));
+    address_index_destroy(address_index);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_write_to_file_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    char outfile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        outfile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        output_directory,
+        "blockchain_test_blockchain_write_to_file_fails_on_invalid_input");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_write_to_file(blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_write_to_file(NULL, outfile);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_read_from_file_reconstructs_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != blockchain);
+    assert_true(blockchain->num_leading_zero_bytes_required_in_block_hash != 0);
+    assert_true(NULL != blockchain->blocks);
+    uint64_t num_blocks = 0;
+    return_code = blockchain_length(blockchain, &num_blocks);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == num_blocks);
+    block_t *block1 = blockchain->blocks[0];
+    assert_true(GENESIS_BLOCK_PROOF_OF_WORK == block1->proof_of_work);
+    sha_256_t empty_block_hash = {0};
+    assert_true(0 == memcmp(
+        &block1->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    bool transaction_list_is_empty = true;
+    return_code = linked_list_is_empty(
+        block1->transaction_list, &transaction_list_is_empty);
+    assert_true(SUCCESS == return_code);
+    assert_true(transaction_list_is_empty);
+    block_t *block2 = blockchain->blocks[1];
+    assert_true(0 != block2->proof_of_work);
+    assert_true(0 != block2->created_at);
+    assert_true(0 != memcmp(
+        &block2->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    uint64_t num_transactions = 0;
+    return_code = linked_list_length(
+        block2->transaction_list, &num_transactions);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_transactions);
+    transaction_t *transaction =
+        (transaction_t *)block2->transaction_list->head->data;
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
+    assert_true(0 != transaction->created_at);
+    public_key_t empty_key = {0};
+    assert_true(0 != memcmp(
+        &transaction->sender_public_key, &empty_key, sizeof(public_key_t)));
+    assert_true(0 == memcmp(
+        &transaction->sender_public_key,
+        &transaction->recipient_public_key,
+        sizeof(public_key_t)));
+    ssh_signature_t empty_signature = {0};
+    assert_true(0 != memcmp(
+        &transaction->sender_signature,
+        &empty_signature,
+        sizeof(ssh_signature_t)));
+    block_t *block3 = blockchain->blocks[2];
+    assert_true(0 != block3->proof_of_work);
+    assert_true(0 != block3->created_at);
+    assert_true(0 != memcmp(
+        &block3->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
+    return_code = linked_list_length(
+        block3->transaction_list, &num_transactions);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_transactions);
+    transaction = (transaction_t *)block3->transaction_list->head->data;
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
+    assert_true(0 != transaction->created_at);
+    assert_true(0 != memcmp(
+        &transaction->sender_public_key, &empty_key, sizeof(public_key_t)));
+    assert_true(0 == memcmp(
+        &transaction->sender_public_key,
+        &transaction->recipient_public_key,
+        sizeof(public_key_t)));
+    assert_true(0 != memcmp(
+        &transaction->sender_signature,
+        &empty_signature,
+        sizeof(ssh_signature_t)));
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_read_from_file_fails_on_invalid_input() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(NULL, infile);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_read_from_file(&blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_blockchain_read_from_file_rejects_pre_merkle_root_file() {
+    // The fixture was written before block headers committed to a Merkle
+    // root; its hashes and proofs of work do not hold under current rules.
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_no_transactions");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(FAILURE_UNSUPPORTED_SERIALIZATION_VERSION == return_code);
+    assert_true(NULL == blockchain);
+}
+
+void test_blockchain_serialization_does_not_alter_block_hash() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    // Set created_at to get a consistent hash between test suite executions.
+    // This is just for debugging. We might want to print out the hashes and
+    // make sure they don't change between runs as a sanity check.
+    genesis_block->created_at = 1;
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t genesis_block_hash_before_serialization = {0};
+    return_code = block_hash(
+        genesis_block, &genesis_block_hash_before_serialization);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    block_t *deserialized_genesis_block = deserialized_blockchain->blocks[0];
+    sha_256_t genesis_block_hash_after_serialization = {0};
+    return_code = block_hash(
+        deserialized_genesis_block, &genesis_block_hash_after_serialization);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &genesis_block_hash_before_serialization,
+        &genesis_block_hash_after_serialization,
+        sizeof(sha_256_t)));
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(deserialized_blockchain);
+}
+
+void test_blockchain_serialize_migrates_legacy_blockchain() {
+    // The fixture is in the legacy format, which stored every key and
+    // signature at its maximum size.
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        buffer,
+        BLOCKCHAIN_SERIALIZATION_MAGIC,
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE));
+    // Each legacy transaction took TRANSACTION_PREIMAGE_SIZE bytes. Compact
+    // keys and signatures should shrink transactions by more than 10x. Header
+    // integers take at least one byte each, so this overestimates the size.
+    uint64_t num_transactions = blockchain->num_blocks - 1;
+    uint64_t transactions_size =
+        buffer_size -
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE -
+        sizeof(uint32_t) -
+        2 -
+        blockchain->num_blocks * (2 * sizeof(sha_256_t) + 3);
+    assert_true(
+        10 * transactions_size < num_transactions * TRANSACTION_PREIMAGE_SIZE);
+    // Migrated transactions keep their hashes and signatures.
+    blockchain_t *migrated_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &migrated_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    return_code = blockchain_verify(migrated_blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        assert_true(0 == memcmp(
+            &blockchain->blocks[height]->merkle_root,
+            &migrated_blockchain->blocks[height]->merkle_root,
+            sizeof(sha_256_t)));
+    }
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(migrated_blockchain);
+}
+
+void test_blockchain_deserialize_reads_compact_keys_blockchain() {
+    // The fixtures hold the same chain, one in the legacy format and one in
+    // the compact keys format that preceded varints.
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char legacy_infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        legacy_infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    char compact_keys_infile[TESTS_MAX_PATH];
+    return_value = snprintf(
+        compact_keys_infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_compact_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *legacy_blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(
+        &legacy_blockchain, legacy_infile);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *compact_keys_blockchain = NULL;
+    return_code = blockchain_read_from_file(
+        &compact_keys_blockchain, compact_keys_infile);
+    assert_true(SUCCESS == return_code);
+    bool is_valid = false;
+    return_code = blockchain_verify(compact_keys_blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    assert_true(legacy_blockchain->num_blocks ==
+        compact_keys_blockchain->num_blocks);
+    for (uint64_t height = 0; height < legacy_blockchain->num_blocks;
+        height++) {
+        sha_256_t legacy_hash = {0};
+        return_code = block_hash(
+            legacy_blockchain->blocks[height], &legacy_hash);
+        assert_true(SUCCESS == return_code);
+        sha_256_t compact_keys_hash = {0};
+        return_code = block_hash(
+            compact_keys_blockchain->blocks[height], &compact_keys_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &legacy_hash, &compact_keys_hash, sizeof(sha_256_t)));
+    }
+    // Saving the chain again writes the current format, which is smaller.
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(
+        compact_keys_blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    FILE *compact_keys_file = fopen(compact_keys_infile, "rb");
+    assert_true(NULL != compact_keys_file);
+    assert_true(0 == fseek(compact_keys_file, 0, SEEK_END));
+    long compact_keys_size = ftell(compact_keys_file);
+    fclose(compact_keys_file);
+    assert_true(buffer_size < (uint64_t)compact_keys_size);
+    free(buffer);
+    blockchain_destroy(legacy_blockchain);
+    blockchain_destroy(compact_keys_blockchain);
+}
+
+void test_blockchain_serialize_writes_small_integers_in_one_byte() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // The difficulty and the number of blocks follow the version.
+    unsigned char *header_integers =
+        buffer + BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE + sizeof(uint32_t);
+    assert_true(NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH == header_integers[0]);
+    assert_true(1 == header_integers[1]);
+    // The genesis block has no transactions, so its count is the last byte.
+    assert_true(0 == buffer[buffer_size - 1]);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_invalid_varint() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // A varint longer than any 64 bit value takes is invalid.
+    size_t header_size =
+        BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE + sizeof(uint32_t);
+    assert_true(buffer_size >= header_size + BLOCKCHAIN_VARINT_MAX_SIZE);
+    memset(buffer + header_size, 0xff, BLOCKCHAIN_VARINT_MAX_SIZE);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    // A varint cut off by the end of the buffer is truncated.
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, header_size + 1);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(buffer);
+    // A varint padded with a zero byte is not minimal, so it is invalid even
+    // though it decodes to the right value.
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(buffer[header_size] < 0x80);
+    unsigned char *padded_buffer = malloc(buffer_size + 1);
+    assert_true(NULL != padded_buffer);
+    memcpy(padded_buffer, buffer, header_size);
+    padded_buffer[header_size] = buffer[header_size] | 0x80;
+    padded_buffer[header_size + 1] = 0x00;
+    memcpy(
+        padded_buffer + header_size + 2,
+        buffer + header_size + 1,
+        buffer_size - header_size - 1);
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, padded_buffer, buffer_size + 1);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    // Without the padding, the same buffer deserializes.
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_destroy(deserialized_blockchain);
+    free(padded_buffer);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_fails_on_unsupported_version() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    // The version follows the magic string; its last byte is the lowest.
+    buffer[BLOCKCHAIN_SERIALIZATION_MAGIC_SIZE + sizeof(uint32_t) - 1] = 0xff;
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize(
+        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(FAILURE_UNSUPPORTED_SERIALIZATION_VERSION == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_into_arena_reconstructs_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL == blockchain->blocks[0]->arena);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *arena_blockchain = NULL;
+    return_code = blockchain_deserialize_into_arena(
+        &arena_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == arena_blockchain->num_blocks);
+    block_arena_t *arena = arena_blockchain->blocks[0]->arena;
+    assert_true(NULL != arena);
+    assert_true(4 == atomic_load(&arena->reference_count));
+    for (uint64_t height = 0; height < blockchain->num_blocks; height++) {
+        block_t *block = blockchain->blocks[height];
+        block_t *arena_block = arena_blockchain->blocks[height];
+        sha_256_t hash = {0};
+        return_code = block_hash(block, &hash);
+        assert_true(SUCCESS == return_code);
+        sha_256_t arena_hash = {0};
+        return_code = block_hash(arena_block, &arena_hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&hash, &arena_hash, sizeof(sha_256_t)));
+        assert_true(arena == arena_block->arena);
+        block_t *found_block = NULL;
+        uint64_t found_height = 0;
+        return_code = blockchain_find_block_by_hash(
+            arena_blockchain, &hash, &found_block, &found_height);
+        assert_true(SUCCESS == return_code);
+        assert_true(arena_block == found_block);
+        assert_true(height == found_height);
+        node_t *arena_node = arena_block->transaction_list->head;
+        for (node_t *node = block->transaction_list->head;
+            NULL != node;
+            node = node->next) {
+            assert_true(NULL != arena_node);
+            assert_true(0 == memcmp(
+                node->data, arena_node->data, sizeof(transaction_t)));
+            arena_node = arena_node->next;
+        }
+        assert_true(NULL == arena_node);
+    }
+    bool is_valid = false;
+    return_code = blockchain_verify(arena_blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    // Blocks added after deserialization are not in the arena, but the
+    // blockchain still frees them.
+    block_t *new_block = NULL;
+    return_code = block_create_genesis_block(&new_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(arena_blockchain, new_block);
+    assert_true(SUCCESS == return_code);
+    assert_true(5 == arena_blockchain->num_blocks);
+    assert_true(NULL == new_block->arena);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    return_code = blockchain_destroy(arena_blockchain);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_deserialize_into_arena_reads_legacy_format() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    FILE *f = fopen(infile, "rb");
+    assert_true(NULL != f);
+    fseek(f, 0, SEEK_END);
+    uint64_t buffer_size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char *buffer = malloc(buffer_size);
+    assert_true(NULL != buffer);
+    assert_true(buffer_size == fread(buffer, 1, buffer_size, f));
+    fclose(f);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_deserialize_into_arena(
+        &blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != blockchain->blocks[3]->arena);
+    bool is_valid = false;
+    return_code = blockchain_verify(blockchain, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_deserialize_into_arena_fails_on_invalid_buffer() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *deserialized_blockchain = NULL;
+    return_code = blockchain_deserialize_into_arena(
+        NULL, buffer, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_deserialize_into_arena(
+        &deserialized_blockchain, NULL, buffer_size);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_deserialize_into_arena(
+        &deserialized_blockchain, buffer, buffer_size - 50);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+}
+
+void create_child_block(
+    block_t **block,
+    block_t *parent,
+    uint64_t proof_of_work
+) {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    sha_256_t parent_hash = {0};
+    return_code = block_hash(parent, &parent_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = block_create(
+        block, transaction_list, proof_of_work, parent_hash);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_add_block_to_tree_reorganizes_onto_longer_branch() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, genesis_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    // Active chain: genesis, a1, a2.
+    block_t *a1 = NULL;
+    create_child_block(&a1, genesis_block, 1);
+    return_code = blockchain_add_block_to_tree(blockchain, a1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    block_t *a2 = NULL;
+    create_child_block(&a2, a1, 2);
+    return_code = blockchain_add_block_to_tree(blockchain, a2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    // A competing branch from the genesis block stays on the side until it
+    // is strictly longer.
+    block_t *b1 = NULL;
+    create_child_block(&b1, genesis_block, 3);
+    return_code = blockchain_add_block_to_tree(blockchain, b1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    block_t *b2 = NULL;
+    create_child_block(&b2, b1, 4);
+    return_code = blockchain_add_block_to_tree(blockchain, b2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    assert_true(3 == blockchain->num_blocks);
+    assert_true(a2 == blockchain->blocks[2]);
+    assert_true(2 == blockchain->num_side_blocks);
+    block_t *b3 = NULL;
+    create_child_block(&b3, b2, 5);
+    return_code = blockchain_add_block_to_tree(blockchain, b3, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(4 == blockchain->num_blocks);
+    assert_true(genesis_block == blockchain->blocks[0]);
+    assert_true(b1 == blockchain->blocks[1]);
+    assert_true(b2 == blockchain->blocks[2]);
+    assert_true(b3 == blockchain->blocks[3]);
+    assert_true(2 == blockchain->num_side_blocks);
+    // The old branch is still in the tree, and can take the lead back.
+    block_t *found_block = NULL;
+    uint64_t found_height = 0;
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &a2->hash, &found_block, &found_height);
+    assert_true(SUCCESS == return_code);
+    assert_true(a2 == found_block);
+    assert_true(2 == found_height);
+    block_t *a3 = NULL;
+    create_child_block(&a3, a2, 6);
+    return_code = blockchain_add_block_to_tree(blockchain, a3, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    block_t *a4 = NULL;
+    create_child_block(&a4, a3, 7);
+    return_code = blockchain_add_block_to_tree(blockchain, a4, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(5 == blockchain->num_blocks);
+    assert_true(a1 == blockchain->blocks[1]);
+    assert_true(a4 == blockchain->blocks[4]);
+    assert_true(3 == blockchain->num_side_blocks);
+    // A clone shares the whole tree, side branches included.
+    blockchain_t *clone = NULL;
+    return_code = blockchain_clone(&clone, blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == clone->num_side_blocks);
+    return_code = blockchain_find_block_by_hash(
+        clone, &b3->hash, &found_block, &found_height);
+    assert_true(SUCCESS == return_code);
+    assert_true(b3 == found_block);
+    assert_true(3 == found_height);
+    return_code = blockchain_destroy(blockchain);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_destroy(clone);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_add_block_to_tree_reorganizes_arena_blockchain() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *arena_blockchain = NULL;
+    return_code = blockchain_deserialize_into_arena(
+        &arena_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    // Displace the last two arena blocks with a longer branch. Destroying the
+    // blockchain must free the new blocks but not the displaced ones.
+    block_t *parent = arena_blockchain->blocks[1];
+    for (uint64_t proof_of_work = 0; proof_of_work < 3; proof_of_work++) {
+        block_t *block = NULL;
+        create_child_block(&block, parent, proof_of_work);
+        bool tip_changed = false;
+        return_code = blockchain_add_block_to_tree(
+            arena_blockchain, block, &tip_changed);
+        assert_true(SUCCESS == return_code);
+        assert_true(tip_changed == (2 == proof_of_work));
+        parent = block;
+    }
+    assert_true(5 == arena_blockchain->num_blocks);
+    assert_true(parent == arena_blockchain->blocks[4]);
+    assert_true(2 == arena_blockchain->num_side_blocks);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    return_code = blockchain_destroy(arena_blockchain);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_add_block_to_tree_fails_on_invalid_block() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, genesis_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *child_block = NULL;
+    create_child_block(&child_block, genesis_block, 1);
+    block_t *orphan_block = NULL;
+    create_child_block(&orphan_block, child_block, 2);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, orphan_block, &tip_changed);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, child_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *duplicate_block = NULL;
+    return_code = block_copy(&duplicate_block, child_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, duplicate_block, &tip_changed);
+    assert_true(FAILURE_DUPLICATE_BLOCK == return_code);
+    return_code = blockchain_add_block_to_tree(
+        NULL, orphan_block, &tip_changed);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, NULL, &tip_changed);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, orphan_block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(orphan_block);
+    block_destroy(duplicate_block);
+    blockchain_destroy(blockchain);
+}
+
+/**
+ * @brief Fills block with a child of parent whose minting transaction pays
+ * the miner named by miner_id.
+ */
+void test_blockchain_add_block_to_tree_prunes_deep_side_blocks() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, genesis_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *a1 = NULL;
+    create_child_block(&a1, genesis_block, 1);
+    return_code = blockchain_add_block_to_tree(blockchain, a1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *a2 = NULL;
+    create_child_block(&a2, a1, 5);
+    return_code = blockchain_add_block_to_tree(blockchain, a2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    // Side branches fork at heights 0 and 1, and the second one takes over.
+    block_t *b1 = NULL;
+    create_child_block(&b1, genesis_block, 2);
+    return_code = blockchain_add_block_to_tree(blockchain, b1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *c2 = NULL;
+    create_child_block(&c2, a1, 3);
+    return_code = blockchain_add_block_to_tree(blockchain, c2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *c3 = NULL;
+    create_child_block(&c3, c2, 4);
+    return_code = blockchain_add_block_to_tree(blockchain, c3, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(c3 == blockchain->blocks[3]);
+    assert_true(2 == blockchain->num_side_blocks);
+    sha_256_t b1_hash = b1->hash;
+    // Every side block's index entry knows where the block is.
+    for (uint64_t idx = 0; idx < blockchain->num_side_blocks; idx++) {
+        block_hash_index_entry_t *entry = NULL;
+        return_code = block_hash_index_find(
+            blockchain->hash_index,
+            &blockchain->side_blocks[idx]->hash,
+            &entry);
+        assert_true(SUCCESS == return_code);
+        assert_true(entry->is_side_block);
+        assert_true(idx == entry->side_block_position);
+    }
+    // Extend the active chain until b1 falls too deep, but not yet a2, which
+    // the reorganization moved to the side.
+    block_t *tip = c3;
+    for (uint64_t height = 4;
+        height <= 1 + BLOCKCHAIN_MAX_SIDE_BLOCK_DEPTH + 1;
+        height++) {
+        block_t *block = NULL;
+        create_child_block(&block, tip, 2 + height);
+        return_code = blockchain_add_block_to_tree(
+            blockchain, block, &tip_changed);
+        assert_true(SUCCESS == return_code);
+        assert_true(tip_changed);
+        tip = block;
+    }
+    assert_true(1 == blockchain->num_side_blocks);
+    block_t *found_block = NULL;
+    uint64_t found_height = 0;
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &b1_hash, &found_block, &found_height);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    block_hash_index_entry_t *entry = NULL;
+    return_code = block_hash_index_find(
+        blockchain->hash_index, &blockchain->side_blocks[0]->hash, &entry);
+    assert_true(SUCCESS == return_code);
+    assert_true(a2 == entry->block);
+    assert_true(0 == entry->side_block_position);
+    // A block that would start that deep is released instead of kept.
+    block_t *b1_again = NULL;
+    create_child_block(&b1_again, genesis_block, 2);
+    sha_256_t b1_again_hash = {0};
+    return_code = block_hash(b1_again, &b1_again_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block_to_tree(
+        blockchain, b1_again, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    assert_true(1 == blockchain->num_side_blocks);
+    return_code = blockchain_find_block_by_hash(
+        blockchain, &b1_again_hash, &found_block, &found_height);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    return_code = blockchain_destroy(blockchain);
+    assert_true(SUCCESS == return_code);
+}
+
+void create_minting_child_block(
+    block_t **block,
+    block_t *parent,
+    uint64_t proof_of_work,
+    unsigned char miner_id,
+    public_key_t *miner_public_key
+) {
+    create_ledger_test_key(miner_public_key, miner_id);
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    transaction_t *minting_transaction = calloc(1, sizeof(transaction_t));
+    assert_true(NULL != minting_transaction);
+    minting_transaction->sender_public_key = *miner_public_key;
+    minting_transaction->recipient_public_key = *miner_public_key;
+    minting_transaction->amount = AMOUNT_GENERATED_DURING_MINTING;
+    return_code = linked_list_append(transaction_list, minting_transaction);
+    assert_true(SUCCESS == return_code);
+    sha_256_t parent_hash = {0};
+    return_code = block_hash(parent, &parent_hash);
+    assert_true(SUCCESS == return_code);
+    return_code = block_create(
+        block, transaction_list, proof_of_work, parent_hash);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_add_block_to_tree_moves_balances_on_reorganization() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, genesis_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    public_key_t miner_a = {0};
+    public_key_t miner_b = {0};
+    block_t *a1 = NULL;
+    create_minting_child_block(&a1, genesis_block, 1, 'a', &miner_a);
+    return_code = blockchain_add_block_to_tree(blockchain, a1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    int64_t balance = 0;
+    return_code = blockchain_get_balance(blockchain, &miner_a, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == balance);
+    // Blocks on a side branch do not count.
+    block_t *b1 = NULL;
+    create_minting_child_block(&b1, genesis_block, 2, 'b', &miner_b);
+    return_code = blockchain_add_block_to_tree(blockchain, b1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_get_balance(blockchain, &miner_b, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == balance);
+    // Once the side branch takes the lead, the displaced block's coin is
+    // rolled back.
+    block_t *b2 = NULL;
+    create_minting_child_block(&b2, b1, 3, 'b', &miner_b);
+    return_code = blockchain_add_block_to_tree(blockchain, b2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    return_code = blockchain_get_balance(blockchain, &miner_a, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == balance);
+    return_code = blockchain_get_balance(blockchain, &miner_b, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 * AMOUNT_GENERATED_DURING_MINTING == balance);
+    assert_true(3 == blockchain->ledger->num_blocks);
+    return_code = blockchain_get_balance(NULL, &miner_b, &balance);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_balance(blockchain, NULL, &balance);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_get_balance(blockchain, &miner_b, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_get_transaction_history_follows_reorganization() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    bool tip_changed = false;
+    return_code = blockchain_add_block_to_tree(
+        blockchain, genesis_block, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    public_key_t miner_a = {0};
+    public_key_t miner_b = {0};
+    block_t *a1 = NULL;
+    create_minting_child_block(&a1, genesis_block, 1, 'a', &miner_a);
+    return_code = blockchain_add_block_to_tree(blockchain, a1, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    block_t *a2 = NULL;
+    create_minting_child_block(&a2, a1, 2, 'a', &miner_a);
+    return_code = blockchain_add_block_to_tree(blockchain, a2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    address_index_posting_t postings[4] = {0};
+    uint64_t num_postings = 0;
+    uint64_t total_num_postings = 0;
+    return_code = blockchain_get_transaction_history(
+        blockchain,
+        &miner_a,
+        0,
+        4,
+        postings,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == num_postings);
+    assert_true(2 == total_num_postings);
+    assert_true(2 == postings[0].height);
+    assert_true(1 == postings[1].height);
+    // Once a competing branch takes the lead, only the shared block's
+    // transactions remain in the displaced miner's history.
+    block_t *b2 = NULL;
+    create_minting_child_block(&b2, a1, 3, 'b', &miner_b);
+    return_code = blockchain_add_block_to_tree(blockchain, b2, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    block_t *b3 = NULL;
+    create_minting_child_block(&b3, b2, 4, 'b', &miner_b);
+    return_code = blockchain_add_block_to_tree(blockchain, b3, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    return_code = blockchain_get_transaction_history(
+        blockchain,
+        &miner_a,
+        0,
+        4,
+        postings,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_postings);
+    assert_true(1 == postings[0].height);
+    return_code = blockchain_get_transaction_history(
+        blockchain,
+        &miner_b,
+        1,
+        4,
+        postings,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_postings);
+    assert_true(2 == total_num_postings);
+    assert_true(2 == postings[0].height);
+    assert_true(0 == postings[0].transaction_index);
+    // A clone has its own copy of the history.
+    blockchain_t *clone = NULL;
+    return_code = blockchain_clone(&clone, blockchain);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_get_transaction_history(
+        clone, &miner_b, 0, 4, postings, &num_postings, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == num_postings);
+    assert_true(3 == postings[0].height);
+    return_code = blockchain_get_transaction_history(
+        NULL, &miner_b, 0, 4, postings, &num_postings, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(blockchain);
+    blockchain_destroy(clone);
+}
+
+void test_blockchain_merge_shares_only_new_blocks() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *other = NULL;
+    return_code = blockchain_create(
+        &other, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    block_t *other_genesis_block = NULL;
+    return_code = block_copy(&other_genesis_block, genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(other, other_genesis_block);
+    assert_true(SUCCESS == return_code);
+    block_t *our_block = NULL;
+    create_child_block(&our_block, genesis_block, 1);
+    return_code = blockchain_add_block(blockchain, our_block);
+    assert_true(SUCCESS == return_code);
+    block_t *parent = other_genesis_block;
+    for (uint64_t proof_of_work = 2; proof_of_work < 5; proof_of_work++) {
+        block_t *block = NULL;
+        create_child_block(&block, parent, proof_of_work);
+        return_code = blockchain_add_block(other, block);
+        assert_true(SUCCESS == return_code);
+        parent = block;
+    }
+    bool tip_changed = false;
+    return_code = blockchain_merge(blockchain, other, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(4 == blockchain->num_blocks);
+    assert_true(genesis_block == blockchain->blocks[0]);
+    assert_true(1 == blockchain->num_side_blocks);
+    assert_true(our_block == blockchain->side_blocks[0]);
+    assert_true(other->blocks[0] != blockchain->blocks[0]);
+    for (uint64_t height = 1; height < 4; height++) {
+        assert_true(other->blocks[height] == blockchain->blocks[height]);
+        assert_true(2 == atomic_load(
+            &blockchain->blocks[height]->reference_count));
+    }
+    // Merging again finds nothing new.
+    return_code = blockchain_merge(blockchain, other, &tip_changed);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    // The merged blocks are shared, so they outlive the other blockchain.
+    blockchain_destroy(other);
+    for (uint64_t height = 1; height < 4; height++) {
+        assert_true(1 == atomic_load(
+            &blockchain->blocks[height]->reference_count));
+        sha_256_t hash = {0};
+        return_code = block_hash(blockchain->blocks[height - 1], &hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &hash,
+            &blockchain->blocks[height]->previous_block_hash,
+            sizeof(sha_256_t)));
+    }
+    // A blockchain with another genesis block has nothing to merge.
+    blockchain_t *unrelated = NULL;
+    return_code = blockchain_create(
+        &unrelated, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *unrelated_genesis_block = NULL;
+    return_code = block_create_genesis_block(&unrelated_genesis_block);
+    assert_true(SUCCESS == return_code);
+    unrelated_genesis_block->created_at = genesis_block->created_at + 1;
+    return_code = blockchain_add_block(unrelated, unrelated_genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_merge(blockchain, unrelated, &tip_changed);
+    assert_true(FAILURE_BLOCK_NOT_FOUND == return_code);
+    assert_true(4 == blockchain->num_blocks);
+    return_code = blockchain_merge(NULL, unrelated, &tip_changed);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_merge(blockchain, NULL, &tip_changed);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_merge(blockchain, unrelated, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_destroy(unrelated);
+    blockchain_destroy(blockchain);
+}
+
+void test_synchronized_blockchain_adopt_peer_blockchain_publishes_merge() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(&blockchain, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *peer_blockchain = NULL;
+    return_code = blockchain_create(&peer_blockchain, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *peer_genesis_block = NULL;
+    return_code = block_copy(&peer_genesis_block, genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(peer_blockchain, peer_genesis_block);
+    assert_true(SUCCESS == return_code);
+    block_t *peer_block = NULL;
+    create_child_block(&peer_block, peer_genesis_block, 1);
+    return_code = blockchain_add_block(peer_blockchain, peer_block);
+    assert_true(SUCCESS == return_code);
+    blockchain_verified_prefix_t peer_verified_prefix = {0};
+    peer_verified_prefix.num_blocks = 2;
+    peer_verified_prefix.tip_block = peer_block;
+    peer_verified_prefix.tip_hash = peer_block->hash;
+    bool tip_changed = false;
+    bool took_ownership = true;
+    return_code = synchronized_blockchain_adopt_peer_blockchain(
+        sync,
+        peer_blockchain,
+        &peer_verified_prefix,
+        &tip_changed,
+        &took_ownership);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(!took_ownership);
+    // Sync merged the peer's block into its own blockchain and, with no
+    // readers, freed the old snapshot.
+    assert_true(blockchain == sync->blockchain);
+    assert_true(1 == atomic_load(&sync->version));
+    assert_true(2 == blockchain->num_blocks);
+    assert_true(peer_block == blockchain->blocks[1]);
+    assert_true(0 == sync->num_retired);
+    assert_true(2 == sync->verified_prefix.num_blocks);
+    assert_true(blockchain->blocks[1] == sync->verified_prefix.tip_block);
+    // Adopting the same blockchain again publishes nothing.
+    return_code = synchronized_blockchain_adopt_peer_blockchain(
+        sync,
+        peer_blockchain,
+        &peer_verified_prefix,
+        &tip_changed,
+        &took_ownership);
+    assert_true(SUCCESS == return_code);
+    assert_true(!tip_changed);
+    assert_true(!took_ownership);
+    assert_true(blockchain == sync->blockchain);
+    return_code = blockchain_destroy(peer_blockchain);
+    assert_true(SUCCESS == return_code);
+    // A blockchain with no blocks in common replaces ours if it is longer.
+    return_code = blockchain_create(&peer_blockchain, 0);
+    assert_true(SUCCESS == return_code);
+    return_code = block_create_genesis_block(&peer_genesis_block);
+    assert_true(SUCCESS == return_code);
+    peer_genesis_block->created_at = genesis_block->created_at + 1;
+    return_code = blockchain_add_block(peer_blockchain, peer_genesis_block);
+    assert_true(SUCCESS == return_code);
+    block_t *parent = peer_genesis_block;
+    for (uint64_t proof_of_work = 0; proof_of_work < 2; proof_of_work++) {
+        create_child_block(&peer_block, parent, proof_of_work);
+        return_code = blockchain_add_block(peer_blockchain, peer_block);
+        assert_true(SUCCESS == return_code);
+        parent = peer_block;
+    }
+    return_code = synchronized_blockchain_adopt_peer_blockchain(
+        sync,
+        peer_blockchain,
+        &peer_verified_prefix,
+        &tip_changed,
+        &took_ownership);
+    assert_true(SUCCESS == return_code);
+    assert_true(tip_changed);
+    assert_true(took_ownership);
+    assert_true(peer_blockchain == sync->blockchain);
+    assert_true(2 == atomic_load(&sync->version));
+    return_code = synchronized_blockchain_adopt_peer_blockchain(
+        NULL,
+        peer_blockchain,
+        &peer_verified_prefix,
+        &tip_changed,
+        &took_ownership);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // Sync destroyed the blockchain that the peer blockchain replaced.
+    synchronized_blockchain_destroy(sync);
+}
+
+void test_blockchain_clone_shares_blocks() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *parent = NULL;
+    return_code = block_create_genesis_block(&parent);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, parent);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t proof_of_work = 0; proof_of_work < 2; proof_of_work++) {
+        block_t *block = NULL;
+        create_child_block(&block, parent, proof_of_work);
+        return_code = blockchain_add_block(blockchain, block);
+        assert_true(SUCCESS == return_code);
+        parent = block;
+    }
+    blockchain_t *clone = NULL;
+    return_code = blockchain_clone(&clone, blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == clone->num_blocks);
+    assert_true(
+        blockchain->num_leading_zero_bytes_required_in_block_hash ==
+        clone->num_leading_zero_bytes_required_in_block_hash);
+    for (uint64_t height = 0; height < 3; height++) {
+        assert_true(blockchain->blocks[height] == clone->blocks[height]);
+        assert_true(2 == atomic_load(&clone->blocks[height]->reference_count));
+        block_t *found_block = NULL;
+        uint64_t found_height = 0;
+        return_code = blockchain_find_block_by_hash(
+            clone, &clone->blocks[height]->hash, &found_block, &found_height);
+        assert_true(SUCCESS == return_code);
+        assert_true(height == found_height);
+    }
+    // The clone grows without affecting the original.
+    block_t *block = NULL;
+    create_child_block(&block, parent, 2);
+    return_code = blockchain_add_block(clone, block);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == clone->num_blocks);
+    assert_true(3 == blockchain->num_blocks);
+    return_code = blockchain_clone(NULL, blockchain);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_clone(&clone, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // The shared blocks outlive the original.
+    return_code = blockchain_destroy(blockchain);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t height = 1; height < 4; height++) {
+        assert_true(1 == atomic_load(
+            &clone->blocks[height - 1]->reference_count));
+        assert_true(0 == memcmp(
+            &clone->blocks[height - 1]->hash,
+            &clone->blocks[height]->previous_block_hash,
+            sizeof(sha_256_t)));
+    }
+    return_code = blockchain_destroy(clone);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_blockchain_clone_keeps_arena_until_last_view() {
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_fixed_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    assert_true(SUCCESS == return_code);
+    unsigned char *buffer = NULL;
+    uint64_t buffer_size = 0;
+    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *arena_blockchain = NULL;
+    return_code = blockchain_deserialize_into_arena(
+        &arena_blockchain, buffer, buffer_size);
+    assert_true(SUCCESS == return_code);
+    free(buffer);
+    blockchain_destroy(blockchain);
+    blockchain_t *clone = NULL;
+    return_code = blockchain_clone(&clone, arena_blockchain);
+    assert_true(SUCCESS == return_code);
+    block_arena_t *arena = clone->blocks[0]->arena;
+    assert_true(4 == atomic_load(&arena->reference_count));
+    // Destroying the original leaves the arena to the clone.
+    return_code = blockchain_destroy(arena_blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == atomic_load(&arena->reference_count));
+    bool is_valid = false;
+    return_code = blockchain_verify(clone, &is_valid, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid);
+    return_code = blockchain_clone(&arena_blockchain, clone);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_destroy(clone);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_destroy(arena_blockchain);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_synchronized_blockchain_read_section_keeps_retired_blockchain() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *read_blockchain = NULL;
+    size_t reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        sync, &read_blockchain, &reader);
+    assert_true(SUCCESS == return_code);
+    assert_true(blockchain->blocks == read_blockchain->blocks);
+    assert_true(1 == read_blockchain->num_blocks);
+    blockchain_t *new_blockchain = NULL;
+    return_code = blockchain_clone(&new_blockchain, blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_lock(&sync->mutex);
+    return_code = synchronized_blockchain_publish(sync, new_blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_unlock(&sync->mutex);
+    assert_true(new_blockchain == sync->blockchain);
+    // The reader still holds the old snapshot and blockchain, so they are not
+    // freed yet.
+    assert_true(2 == sync->num_retired);
+    assert_true(read_blockchain == sync->retired[0].data);
+    assert_true(blockchain == sync->retired[1].data);
+    assert_true(genesis_block == read_blockchain->blocks[0]);
+    // A reader that enters now sees only the new blockchain.
+    blockchain_t *later_read_blockchain = NULL;
+    size_t later_reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        sync, &later_read_blockchain, &later_reader);
+    assert_true(SUCCESS == return_code);
+    assert_true(new_blockchain->blocks == later_read_blockchain->blocks);
+    assert_true(reader != later_reader);
+    return_code = synchronized_blockchain_read_end(sync, reader);
+    assert_true(SUCCESS == return_code);
+    // The next publication frees the old blockchain, but not the snapshot
+    // that the later reader holds.
+    blockchain_t *newest_blockchain = NULL;
+    return_code = blockchain_clone(&newest_blockchain, new_blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_lock(&sync->mutex);
+    return_code = synchronized_blockchain_publish(sync, newest_blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_unlock(&sync->mutex);
+    assert_true(2 == sync->num_retired);
+    for (size_t idx = 0; idx < sync->num_retired; idx++) {
+        assert_true(
+            later_read_blockchain == sync->retired[idx].data ||
+            new_blockchain == sync->retired[idx].data);
+    }
+    assert_true(sync->retired[0].data != sync->retired[1].data);
+    assert_true(genesis_block == later_read_blockchain->blocks[0]);
+    return_code = synchronized_blockchain_read_end(sync, later_reader);
+    assert_true(SUCCESS == return_code);
+    return_code = synchronized_blockchain_destroy(sync);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_synchronized_blockchain_publish_appends_in_place() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(&blockchain, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *genesis_block = NULL;
+    return_code = block_create_genesis_block(&genesis_block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *read_blockchain = NULL;
+    size_t reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        sync, &read_blockchain, &reader);
+    assert_true(SUCCESS == return_code);
+    // Appending to the tip shares the block array with the reader's
+    // snapshot, which still ends at the old tip.
+    block_t *block = NULL;
+    create_child_block(&block, genesis_block, 1);
+    pthread_mutex_lock(&sync->mutex);
+    return_code = synchronized_blockchain_prepare_write(sync, 2, true);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+    return_code = synchronized_blockchain_publish(sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_unlock(&sync->mutex);
+    assert_true(blockchain == sync->blockchain);
+    assert_true(blockchain->blocks == read_blockchain->blocks);
+    assert_true(1 == read_blockchain->num_blocks);
+    assert_true(NULL == sync->stale_blocks);
+    // Any other write moves the writers to a private copy of the array, so
+    // the reader's snapshot keeps its blocks.
+    block_t **read_blocks = read_blockchain->blocks;
+    pthread_mutex_lock(&sync->mutex);
+    return_code = synchronized_blockchain_prepare_write(sync, 2, false);
+    assert_true(SUCCESS == return_code);
+    assert_true(read_blocks == sync->stale_blocks);
+    assert_true(read_blocks != blockchain->blocks);
+    assert_true(block == blockchain->blocks[1]);
+    blockchain->blocks[1] = NULL;
+    assert_true(block == read_blocks[1]);
+    blockchain->blocks[1] = block;
+    return_code = synchronized_blockchain_publish(sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    pthread_mutex_unlock(&sync->mutex);
+    assert_true(NULL == sync->stale_blocks);
+    assert_true(genesis_block == read_blockchain->blocks[0]);
+    return_code = synchronized_blockchain_read_end(sync, reader);
+    assert_true(SUCCESS == return_code);
+    return_code = synchronized_blockchain_read_begin(
+        sync, &read_blockchain, &reader);
+    assert_true(SUCCESS == return_code);
+    assert_true(blockchain->blocks == read_blockchain->blocks);
+    assert_true(2 == read_blockchain->num_blocks);
+    return_code = synchronized_blockchain_read_end(sync, reader);
+    assert_true(SUCCESS == return_code);
+    return_code = synchronized_blockchain_prepare_write(NULL, 2, true);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_destroy(sync);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_synchronized_blockchain_read_section_fails_on_invalid_input() {
+    blockchain_t *blockchain = NULL;
+    return_code_t return_code = blockchain_create(
+        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    synchronized_blockchain_t *sync = NULL;
+    return_code = synchronized_blockchain_create(&sync, blockchain);
+    assert_true(SUCCESS == return_code);
+    blockchain_t *read_blockchain = NULL;
+    size_t reader = 0;
+    return_code = synchronized_blockchain_read_begin(
+        NULL, &read_blockchain, &reader);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_read_begin(sync, NULL, &reader);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_read_begin(
+        sync, &read_blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_read_end(NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_read_end(
+        sync, SYNCHRONIZED_BLOCKCHAIN_MAX_READERS);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_publish(NULL, blockchain);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = synchronized_blockchain_publish(sync, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    synchronized_blockchain_destroy(sync);
+}
+
+void create_log_test_blockchain(
+    blockchain_t **blockchain,
+    uint64_t num_blocks
+) {
+    return_code_t return_code = blockchain_create(
+        blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_add_block(*blockchain, block);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t height = 1; height < num_blocks; height++) {
+        block_t *child = NULL;
+        create_child_block(&child, block, height);
+        return_code = blockchain_add_block(*blockchain, child);
+        assert_true(SUCCESS == return_code);
+        block = child;
+    }
+}
+
+void remove_log_test_files(char *path) {
+    char index_path[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        index_path,
+        TESTS_MAX_PATH,
+        "%s%s",
+        path,
+        BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX);
+    assert_true(return_value < TESTS_MAX_PATH);
+    char address_index_path[TESTS_MAX_PATH];
+    return_value = snprintf(
+        address_index_path,
+        TESTS_MAX_PATH,
+        "%s%s",
+        path,
+        ADDRESS_INDEX_FILE_SUFFIX);
+    assert_true(return_value < TESTS_MAX_PATH);
+    remove(path);
+    remove(index_path);
+    remove(address_index_path);
+}
+
+void get_log_test_path(char *path, char *test_name) {
+    char output_directory[TESTS_MAX_PATH];
+    get_output_directory(output_directory);
+    int return_value = snprintf(
+        path, TESTS_MAX_PATH, "%s/%s", output_directory, test_name);
+    assert_true(return_value < TESTS_MAX_PATH);
+    remove_log_test_files(path);
+}
+
+void test_blockchain_log_save_appends_only_new_blocks() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_log_save_appends_only_new_blocks");
+    blockchain_t *blockchain = NULL;
+    create_log_test_blockchain(&blockchain, 2);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == log->num_records);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == log->num_records);
+    struct stat file_stats = {0};
+    assert_true(0 == stat(path, &file_stats));
+    assert_true(log->end_offset == (uint64_t)file_stats.st_size);
+    FILE *f = fopen(path, "rb");
+    assert_true(NULL != f);
+    unsigned char original_bytes[BLOCKCHAIN_LOG_HEADER_SIZE];
+    assert_true(sizeof(original_bytes) ==
+        fread(original_bytes, 1, sizeof(original_bytes), f));
+    fclose(f);
+    uint64_t original_size = log->end_offset;
+    // Saving the grown chain writes only the new block's record.
+    block_t *block = NULL;
+    create_child_block(&block, blockchain->blocks[1], 2);
+    return_code = blockchain_add_block(blockchain, block);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == log->num_records);
+    assert_true(original_size == log->records[2].offset);
+    assert_true(0 == stat(path, &file_stats));
+    assert_true(original_size + log->records[2].length ==
+        (uint64_t)file_stats.st_size);
+    f = fopen(path, "rb");
+    assert_true(NULL != f);
+    unsigned char new_bytes[BLOCKCHAIN_LOG_HEADER_SIZE];
+    assert_true(sizeof(new_bytes) ==
+        fread(new_bytes, 1, sizeof(new_bytes), f));
+    fclose(f);
+    assert_true(0 == memcmp(original_bytes, new_bytes, sizeof(new_bytes)));
+    return_code = blockchain_log_close(log);
+    assert_true(SUCCESS == return_code);
+    // Reopening the log finds every block, and loading it rebuilds the chain.
+    return_code = blockchain_log_open(&log, path, 0);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == log->num_records);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == read_blockchain->num_blocks);
+    for (uint64_t height = 0; height < 3; height++) {
+        assert_true(0 == memcmp(
+            &blockchain->blocks[height]->hash,
+            &log->records[height].block_hash,
+            sizeof(sha_256_t)));
+        assert_true(0 == memcmp(
+            &blockchain->blocks[height]->hash,
+            &read_blockchain->blocks[height]->hash,
+            sizeof(sha_256_t)));
+    }
+    blockchain_log_close(log);
+    remove_log_test_files(path);
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_log_save_truncates_to_fork_point() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_log_save_truncates_to_fork_point");
+    blockchain_t *blockchain = NULL;
+    create_log_test_blockchain(&blockchain, 3);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    uint64_t fork_offset = log->records[2].offset;
+    // The other chain shares the first two blocks, then takes another branch
+    // that is one block longer.
+    blockchain_t *other_blockchain = NULL;
+    return_code = blockchain_create(
+        &other_blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t height = 0; height < 2; height++) {
+        block_retain(blockchain->blocks[height]);
+        return_code = blockchain_add_block(
+            other_blockchain, blockchain->blocks[height]);
+        assert_true(SUCCESS == return_code);
+    }
+    for (uint64_t height = 2; height < 4; height++) {
+        block_t *block = NULL;
+        create_child_block(
+            &block, other_blockchain->blocks[height - 1], 100 + height);
+        return_code = blockchain_add_block(other_blockchain, block);
+        assert_true(SUCCESS == return_code);
+    }
+    return_code = blockchain_log_save(log, other_blockchain);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == log->num_records);
+    assert_true(fork_offset == log->records[2].offset);
+    struct stat file_stats = {0};
+    assert_true(0 == stat(path, &file_stats));
+    assert_true(log->end_offset == (uint64_t)file_stats.st_size);
+    blockchain_log_close(log);
+    // The index follows the log back to the fork point.
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == log->num_indexed_records);
+    for (uint64_t height = 0; height < 4; height++) {
+        assert_true(0 == memcmp(
+            &other_blockchain->blocks[height]->hash,
+            &log->records[height].block_hash,
+            sizeof(sha_256_t)));
+    }
+    blockchain_log_close(log);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    assert_true(4 == read_blockchain->num_blocks);
+    for (uint64_t height = 0; height < 4; height++) {
+        assert_true(0 == memcmp(
+            &other_blockchain->blocks[height]->hash,
+            &read_blockchain->blocks[height]->hash,
+            sizeof(sha_256_t)));
+    }
+    remove_log_test_files(path);
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(other_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_log_open_drops_partial_record() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_log_open_drops_partial_record");
+    blockchain_t *blockchain = NULL;
+    create_log_test_blockchain(&blockchain, 2);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    uint64_t end_offset = log->end_offset;
+    blockchain_log_close(log);
+    // Simulate a crash partway through appending a record.
+    FILE *f = fopen(path, "ab");
+    assert_true(NULL != f);
+    unsigned char partial_record[] = {0, 0, 1, 0, 42, 42, 42};
+    assert_true(sizeof(partial_record) ==
+        fwrite(partial_record, 1, sizeof(partial_record), f));
+    fclose(f);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == read_blockchain->num_blocks);
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(2 == log->num_records);
+    assert_true(end_offset == log->end_offset);
+    struct stat file_stats = {0};
+    assert_true(0 == stat(path, &file_stats));
+    assert_true(end_offset == (uint64_t)file_stats.st_size);
+    blockchain_log_close(log);
+    remove_log_test_files(path);
+    blockchain_destroy(read_blockchain);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_log_fails_on_invalid_input() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_log_fails_on_invalid_input");
+    blockchain_t *blockchain = NULL;
+    create_log_test_blockchain(&blockchain, 1);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(NULL, path, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_open(&log, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_save(NULL, blockchain);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_close(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_log_read_from_file(NULL, path);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_read_from_file(&read_blockchain, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // Files that are not block logs are left alone.
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_compact_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_log_open(&log, infile, 1);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    return_code = blockchain_log_read_from_file(&read_blockchain, infile);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_log_close(log);
+    remove_log_test_files(path);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_mapped_log_reads_blocks_in_place() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_mapped_log_reads_blocks_in_place");
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_create(
-        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
-    assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    create_log_test_blockchain(&blockchain, 1);
+    public_key_t miner_public_key = {0};
+    for (uint64_t height = 1; height < 3; height++) {
+        block_t *block = NULL;
+        create_minting_child_block(
+            &block,
+            blockchain->blocks[height - 1],
+            height,
+            'a' + height,
+            &miner_public_key);
+        return_code_t return_code = blockchain_add_block(blockchain, block);
+        assert_true(SUCCESS == return_code);
+    }
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 0);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    return_code = blockchain_log_save(log, blockchain);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    blockchain_log_close(log);
+    blockchain_mapped_log_t *mapped_log = NULL;
+    return_code = blockchain_mapped_log_open(&mapped_log, path);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, buffer, buffer_size);
+    assert_true(3 == mapped_log->num_blocks);
+    assert_true(NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH ==
+        mapped_log->num_leading_zero_bytes_required_in_block_hash);
+    for (uint64_t height = 0; height < 3; height++) {
+        sha_256_t hash = {0};
+        return_code = block_hash(&mapped_log->blocks[height].header, &hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &blockchain->blocks[height]->hash, &hash, sizeof(sha_256_t)));
+    }
+    assert_true(0 == mapped_log->blocks[0].num_transactions);
+    assert_true(1 == mapped_log->blocks[2].num_transactions);
+    // Views point into the mapping instead of copying.
+    blockchain_transaction_view_t view = {0};
+    uint64_t num_views = 0;
+    return_code = blockchain_mapped_log_get_transactions(
+        mapped_log, 2, &view, 1, &num_views);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_views);
+    assert_true(AMOUNT_GENERATED_DURING_MINTING == view.amount);
+    assert_true(miner_public_key.length == view.recipient_public_key_length);
+    assert_true(0 == memcmp(
+        miner_public_key.bytes,
+        view.recipient_public_key,
+        miner_public_key.length));
+    assert_true(view.recipient_public_key >= mapped_log->mapping);
+    assert_true(view.recipient_public_key <
+        mapped_log->mapping + mapped_log->mapping_size);
+    return_code = blockchain_mapped_log_get_transactions(
+        mapped_log, 2, &view, 0, &num_views);
+    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
+    // Decoding a whole block gives a copy with the same hash.
+    block_t *block = NULL;
+    return_code = blockchain_mapped_log_get_block(mapped_log, 2, &block);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != deserialized_blockchain);
-    uint64_t num_blocks = 0;
-    return_code = linked_list_length(
-        deserialized_blockchain->block_list, &num_blocks);
+    sha_256_t hash = {0};
+    return_code = block_hash(block, &hash);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_blocks);
-    block_t *deserialized_genesis_block =
-        (block_t *)deserialized_blockchain->block_list->head->data;
-    assert_true(
-        genesis_block->created_at == deserialized_genesis_block->created_at);
     assert_true(0 == memcmp(
-        &genesis_block->previous_block_hash,
-        &deserialized_genesis_block->previous_block_hash,
-        sizeof(sha_256_t)));
-    assert_true(
-        genesis_block->proof_of_work ==
-        deserialized_genesis_block->proof_of_work);
-    bool is_empty = false;
-    return_code = linked_list_is_empty(
-        deserialized_genesis_block->transaction_list, &is_empty);
+        &blockchain->blocks[2]->hash, &hash, sizeof(sha_256_t)));
+    block_destroy(block);
+    return_code = blockchain_mapped_log_close(mapped_log);
     assert_true(SUCCESS == return_code);
-    assert_true(is_empty);
-    free(buffer);
+    remove_log_test_files(path);
     blockchain_destroy(blockchain);
-    blockchain_destroy(deserialized_blockchain);
 }
 
-void test_blockchain_deserialize_fails_on_attempted_read_past_buffer() {
+void test_blockchain_mapped_log_fails_on_invalid_input() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_mapped_log_fails_on_invalid_input");
+    blockchain_mapped_log_t *mapped_log = NULL;
+    return_code_t return_code = blockchain_mapped_log_open(NULL, path);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_open(&mapped_log, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_open(&mapped_log, path);
+    assert_true(FAILURE_FILE_IO == return_code);
+    return_code = blockchain_mapped_log_close(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    char fixture_directory[TESTS_MAX_PATH];
+    get_fixture_directory(fixture_directory);
+    char infile[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        infile,
+        TESTS_MAX_PATH,
+        "%s/%s",
+        fixture_directory,
+        "blockchain_4_blocks_compact_keys");
+    assert_true(return_value < TESTS_MAX_PATH);
+    return_code = blockchain_mapped_log_open(&mapped_log, infile);
+    assert_true(FAILURE_INVALID_BLOCKCHAIN == return_code);
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_create(
-        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    create_log_test_blockchain(&blockchain, 1);
+    blockchain_log_t *log = NULL;
+    return_code = blockchain_log_open(&log, path, 0);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
-    assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    return_code = blockchain_log_save(log, blockchain);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    blockchain_log_close(log);
+    return_code = blockchain_mapped_log_open(&mapped_log, path);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, buffer, buffer_size - 50);
-    assert_true(FAILURE_BUFFER_TOO_SMALL == return_code);
-    free(buffer);
+    blockchain_transaction_view_t view = {0};
+    uint64_t num_views = 0;
+    return_code = blockchain_mapped_log_get_transactions(
+        NULL, 0, &view, 1, &num_views);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_get_transactions(
+        mapped_log, 1, &view, 1, &num_views);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_get_transactions(
+        mapped_log, 0, &view, 1, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_t *block = NULL;
+    return_code = blockchain_mapped_log_get_block(NULL, 0, &block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_get_block(mapped_log, 1, &block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_mapped_log_get_block(mapped_log, 0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_mapped_log_close(mapped_log);
+    remove_log_test_files(path);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_deserialize_fails_on_invalid_input() {
+void test_blockchain_log_open_reads_index() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(path, "blockchain_test_blockchain_log_open_reads_index");
+    char index_path[TESTS_MAX_PATH];
+    int return_value = snprintf(
+        index_path,
+        TESTS_MAX_PATH,
+        "%s%s",
+        path,
+        BLOCKCHAIN_LOG_INDEX_FILE_SUFFIX);
+    assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_create(
-        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    create_log_test_blockchain(&blockchain, 3);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 1);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    return_code = blockchain_log_save(log, blockchain);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(3 == log->num_indexed_records);
+    blockchain_log_record_t records[3];
+    memcpy(records, log->records, sizeof(records));
+    uint64_t end_offset = log->end_offset;
+    blockchain_log_close(log);
+    struct stat file_stats = {0};
+    assert_true(0 == stat(index_path, &file_stats));
+    assert_true(
+        BLOCKCHAIN_LOG_INDEX_HEADER_SIZE +
+        3 * BLOCKCHAIN_LOG_INDEX_RECORD_SIZE ==
+        (uint64_t)file_stats.st_size);
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == log->num_records);
+    assert_true(3 == log->num_indexed_records);
+    assert_true(end_offset == log->end_offset);
+    assert_true(0 == memcmp(records, log->records, sizeof(records)));
+    blockchain_log_close(log);
+    // A missing index is rebuilt from the log.
+    assert_true(0 == remove(index_path));
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(records, log->records, sizeof(records)));
+    blockchain_log_close(log);
+    assert_true(0 == stat(index_path, &file_stats));
+    assert_true(
+        BLOCKCHAIN_LOG_INDEX_HEADER_SIZE +
+        3 * BLOCKCHAIN_LOG_INDEX_RECORD_SIZE ==
+        (uint64_t)file_stats.st_size);
+    // So is an index that no longer matches the log.
+    FILE *f = fopen(index_path, "r+b");
+    assert_true(NULL != f);
+    assert_true(1 == fwrite("X", 1, 1, f));
+    fclose(f);
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(records, log->records, sizeof(records)));
+    blockchain_log_close(log);
+    f = fopen(path, "ab");
+    assert_true(NULL != f);
+    unsigned char partial_record[] = {0, 0, 1, 0, 42, 42, 42};
+    assert_true(sizeof(partial_record) ==
+        fwrite(partial_record, 1, sizeof(partial_record), f));
+    fclose(f);
+    return_code = blockchain_log_open(&log, path, 1);
+    assert_true(SUCCESS == return_code);
+    assert_true(3 == log->num_records);
+    assert_true(end_offset == log->end_offset);
+    assert_true(0 == memcmp(records, log->records, sizeof(records)));
+    blockchain_log_close(log);
+    remove_log_test_files(path);
+    blockchain_destroy(blockchain);
+}
+
+void test_blockchain_log_read_blocks_reads_range() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path, "blockchain_test_blockchain_log_read_blocks_reads_range");
+    blockchain_t *blockchain = NULL;
+    create_log_test_blockchain(&blockchain, 4);
+    blockchain_log_t *log = NULL;
+    return_code_t return_code = blockchain_log_open(&log, path, 0);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    block_t *blocks[2] = {NULL};
+    return_code = blockchain_log_read_blocks(log, 1, 2, blocks);
+    assert_true(SUCCESS == return_code);
+    for (uint64_t idx = 0; idx < 2; idx++) {
+        sha_256_t hash = {0};
+        return_code = block_hash(blocks[idx], &hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(
+            &blockchain->blocks[1 + idx]->hash, &hash, sizeof(sha_256_t)));
+        block_destroy(blocks[idx]);
+    }
+    return_code = blockchain_log_read_blocks(log, 3, 1, blocks);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    block_destroy(blocks[0]);
+    return_code = blockchain_log_read_blocks(log, 4, 0, NULL);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(NULL, buffer, buffer_size);
+    return_code = blockchain_log_read_blocks(NULL, 0, 1, blocks);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, NULL, buffer_size);
+    return_code = blockchain_log_read_blocks(log, 0, 1, NULL);
     assert_true(FAILURE_INVALID_INPUT == return_code);
-    free(buffer);
+    return_code = blockchain_log_read_blocks(log, 3, 2, blocks);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_read_blocks(log, 5, 0, blocks);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_read_blocks(log, 1, UINT64_MAX, blocks);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_log_close(log);
+    remove_log_test_files(path);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_write_to_file_creates_nonempty_file() {
+void test_blockchain_read_from_file_loads_address_index() {
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
@@ -622,6 +3532,15 @@ void test_blockchain_write_to_file_creates_nonempty_file() {
     assert_true(SUCCESS == return_code);
     return_code = blockchain_add_block(blockchain, genesis_block);
     assert_true(SUCCESS == return_code);
+    public_key_t miner = {0};
+    block_t *parent = genesis_block;
+    for (uint64_t proof_of_work = 0; proof_of_work < 3; proof_of_work++) {
+        block_t *block = NULL;
+        create_minting_child_block(&block, parent, proof_of_work, 'm', &miner);
+        return_code = blockchain_add_block(blockchain, block);
+        assert_true(SUCCESS == return_code);
+        parent = block;
+    }
     char output_directory[TESTS_MAX_PATH];
     get_output_directory(output_directory);
     char outfile[TESTS_MAX_PATH];
@@ -630,145 +3549,71 @@ void test_blockchain_write_to_file_creates_nonempty_file() {
         TESTS_MAX_PATH,
         "%s/%s",
         output_directory,
-        "blockchain_test_blockchain_write_to_file_creates_nonempty_file");
+        "blockchain_test_blockchain_read_from_file_loads_address_index");
+    assert_true(return_value < TESTS_MAX_PATH);
+    char address_index_file[TESTS_MAX_PATH];
+    return_value = snprintf(
+        address_index_file,
+        TESTS_MAX_PATH,
+        "%s%s",
+        outfile,
+        ADDRESS_INDEX_FILE_SUFFIX);
     assert_true(return_value < TESTS_MAX_PATH);
-    struct stat file_stats = {0};
-    assert_true(0 != stat(outfile, &file_stats));
     return_code = blockchain_write_to_file(blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(0 == stat(outfile, &file_stats));
-    assert_true(0 != file_stats.st_size);
-    blockchain_destroy(blockchain);
-}
-
-void test_blockchain_write_to_file_fails_on_invalid_input() {
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_create(
-        &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    block_t *genesis_block = NULL;
-    return_code = block_create_genesis_block(&genesis_block);
+    address_index_posting_t postings[4] = {0};
+    uint64_t num_postings = 0;
+    return_code = blockchain_get_transaction_history(
+        read_blockchain, &miner, 0, 4, postings, &num_postings, NULL);
     assert_true(SUCCESS == return_code);
-    return_code = blockchain_add_block(blockchain, genesis_block);
+    assert_true(3 == num_postings);
+    assert_true(3 == postings[0].height);
+    blockchain_destroy(read_blockchain);
+    // An index file that matches the chain's length and tip is trusted as is,
+    // so an empty one that claims to cover the chain shows no postings.
+    address_index_t *address_index = NULL;
+    return_code = address_index_create(&address_index);
     assert_true(SUCCESS == return_code);
-    char output_directory[TESTS_MAX_PATH];
-    get_output_directory(output_directory);
-    char outfile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        outfile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        output_directory,
-        "blockchain_test_blockchain_write_to_file_fails_on_invalid_input");
-    assert_true(return_value < TESTS_MAX_PATH);
-    return_code = blockchain_write_to_file(blockchain, NULL);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_write_to_file(NULL, outfile);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    blockchain_destroy(blockchain);
-}
-
-void test_blockchain_read_from_file_reconstructs_blockchain() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(&blockchain, infile);
+    address_index->num_blocks = blockchain->num_blocks;
+    return_code = address_index_write_to_file(
+        address_index, &parent->hash, address_index_file);
     assert_true(SUCCESS == return_code);
-    assert_true(NULL != blockchain);
-    assert_true(blockchain->num_leading_zero_bytes_required_in_block_hash != 0);
-    assert_true(NULL != blockchain->block_list);
-    uint64_t num_blocks = 0;
-    return_code = linked_list_length(blockchain->block_list, &num_blocks);
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(4 == num_blocks);
-    block_t *block1 = (block_t *)blockchain->block_list->head->data;
-    assert_true(GENESIS_BLOCK_PROOF_OF_WORK == block1->proof_of_work);
-    sha_256_t empty_block_hash = {0};
-    assert_true(0 == memcmp(
-        &block1->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    bool transaction_list_is_empty = true;
-    return_code = linked_list_is_empty(
-        block1->transaction_list, &transaction_list_is_empty);
+    assert_true(0 == read_blockchain->address_index->num_postings);
+    blockchain_destroy(read_blockchain);
+    // A stale index file is rebuilt from the blocks.
+    return_code = address_index_write_to_file(
+        address_index, &genesis_block->hash, address_index_file);
     assert_true(SUCCESS == return_code);
-    assert_true(transaction_list_is_empty);
-    block_t *block2 = (block_t *)blockchain->block_list->head->next->data;
-    assert_true(0 != block2->proof_of_work);
-    assert_true(0 != block2->created_at);
-    assert_true(0 != memcmp(
-        &block2->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    uint64_t num_transactions = 0;
-    return_code = linked_list_length(
-        block2->transaction_list, &num_transactions);
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_transactions);
-    transaction_t *transaction =
-        (transaction_t *)block2->transaction_list->head->data;
-    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
-    assert_true(0 != transaction->created_at);
-    ssh_key_t empty_key = {0};
-    assert_true(0 != memcmp(
-        &transaction->sender_public_key, &empty_key, sizeof(ssh_key_t)));
-    assert_true(0 == memcmp(
-        &transaction->sender_public_key,
-        &transaction->recipient_public_key,
-        sizeof(ssh_key_t)));
-    ssh_signature_t empty_signature = {0};
-    assert_true(0 != memcmp(
-        &transaction->sender_signature,
-        &empty_signature,
-        sizeof(ssh_signature_t)));
-    block_t *block3 = (block_t *)blockchain->block_list->head->next->next->data;
-    assert_true(0 != block3->proof_of_work);
-    assert_true(0 != block3->created_at);
-    assert_true(0 != memcmp(
-        &block3->previous_block_hash, &empty_block_hash, sizeof(sha_256_t)));
-    return_code = linked_list_length(
-        block3->transaction_list, &num_transactions);
+    assert_true(
+        blockchain->address_index->num_postings ==
+        read_blockchain->address_index->num_postings);
+    blockchain_destroy(read_blockchain);
+    // So is a missing one.
+    remove(address_index_file);
+    return_code = blockchain_read_from_file(&read_blockchain, outfile);
     assert_true(SUCCESS == return_code);
-    assert_true(1 == num_transactions);
-    transaction = (transaction_t *)block3->transaction_list->head->data;
-    assert_true(AMOUNT_GENERATED_DURING_MINTING == transaction->amount);
-    assert_true(0 != transaction->created_at);
-    assert_true(0 != memcmp(
-        &transaction->sender_public_key, &empty_key, sizeof(ssh_key_t)));
-    assert_true(0 == memcmp(
-        &transaction->sender_public_key,
-        &transaction->recipient_public_key,
-        sizeof(ssh_key_t)));
-    assert_true(0 != memcmp(
-        &transaction->sender_signature,
-        &empty_signature,
-        sizeof(ssh_signature_t)));
+    assert_true(
+        blockchain->address_index->num_postings ==
+        read_blockchain->address_index->num_postings);
+    blockchain_destroy(read_blockchain);
+    remove(outfile);
+    address_index_destroy(address_index);
     blockchain_destroy(blockchain);
 }
 
-void test_blockchain_read_from_file_fails_on_invalid_input() {
-    char fixture_directory[TESTS_MAX_PATH];
-    get_fixture_directory(fixture_directory);
-    char infile[TESTS_MAX_PATH];
-    int return_value = snprintf(
-        infile,
-        TESTS_MAX_PATH,
-        "%s/%s",
-        fixture_directory,
-        "blockchain_4_blocks_no_transactions");
-    assert_true(return_value < TESTS_MAX_PATH);
-    blockchain_t *blockchain = NULL;
-    return_code_t return_code = blockchain_read_from_file(NULL, infile);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-    return_code = blockchain_read_from_file(&blockchain, NULL);
-    assert_true(FAILURE_INVALID_INPUT == return_code);
-}
-
-void test_blockchain_serialization_does_not_alter_block_hash() {
+void test_blockchain_log_write_address_index_is_loaded_until_stale() {
+    char path[TESTS_MAX_PATH];
+    get_log_test_path(
+        path,
+        "blockchain_test_blockchain_log_write_address_index_is_loaded_until_"
+        "stale");
     blockchain_t *blockchain = NULL;
     return_code_t return_code = blockchain_create(
         &blockchain, NUM_LEADING_ZERO_BYTES_IN_BLOCK_HASH);
@@ -776,35 +3621,71 @@ void test_blockchain_serialization_does_not_alter_block_hash() {
     block_t *genesis_block = NULL;
     return_code = block_create_genesis_block(&genesis_block);
     assert_true(SUCCESS == return_code);
-    // Set created_at to get a consistent hash between test suite executions.
-    // This is just for debugging. We might want to print out the hashes and
-    // make sure they don't change between runs as a sanity check.
-    genesis_block->created_at = 1;
     return_code = blockchain_add_block(blockchain, genesis_block);
     assert_true(SUCCESS == return_code);
-    sha_256_t genesis_block_hash_before_serialization = {0};
-    return_code = block_hash(
-        genesis_block, &genesis_block_hash_before_serialization);
+    public_key_t miner = {0};
+    block_t *block = NULL;
+    create_minting_child_block(&block, genesis_block, 1, 'm', &miner);
+    return_code = blockchain_add_block(blockchain, block);
     assert_true(SUCCESS == return_code);
-    unsigned char *buffer = NULL;
-    uint64_t buffer_size = 0;
-    return_code = blockchain_serialize(blockchain, &buffer, &buffer_size);
+    blockchain_log_t *log = NULL;
+    return_code = blockchain_log_open(&log, path, 0);
     assert_true(SUCCESS == return_code);
-    blockchain_t *deserialized_blockchain = NULL;
-    return_code = blockchain_deserialize(
-        &deserialized_blockchain, buffer, buffer_size);
+    // The index file must match the log's tip.
+    return_code = blockchain_log_write_address_index(log, blockchain);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_save(log, blockchain);
     assert_true(SUCCESS == return_code);
-    block_t *deserialized_genesis_block =
-        (block_t *)deserialized_blockchain->block_list->head->data;
-    sha_256_t genesis_block_hash_after_serialization = {0};
-    return_code = block_hash(
-        deserialized_genesis_block, &genesis_block_hash_after_serialization);
+    return_code = blockchain_log_write_address_index(log, blockchain);
     assert_true(SUCCESS == return_code);
-    assert_true(0 == memcmp(
-        &genesis_block_hash_before_serialization,
-        &genesis_block_hash_after_serialization,
-        sizeof(sha_256_t)));
-    free(buffer);
+    blockchain_t *read_blockchain = NULL;
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    uint64_t num_postings = 0;
+    uint64_t total_num_postings = 0;
+    return_code = blockchain_get_transaction_history(
+        read_blockchain,
+        &miner,
+        0,
+        0,
+        NULL,
+        &num_postings,
+        &total_num_postings);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == total_num_postings);
+    blockchain_destroy(read_blockchain);
+    // A matching index file is loaded rather than rebuilt, so an empty one
+    // that claims to cover the log shows no postings.
+    address_index_t *address_index = NULL;
+    return_code = address_index_create(&address_index);
+    assert_true(SUCCESS == return_code);
+    address_index->num_blocks = blockchain->num_blocks;
+    return_code = address_index_write_to_file(
+        address_index, &block->hash, log->address_index_path);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == read_blockchain->address_index->num_postings);
+    blockchain_destroy(read_blockchain);
+    // Once another block is saved, the index file is stale and rebuilt.
+    block_t *child = NULL;
+    create_minting_child_block(&child, block, 2, 'm', &miner);
+    return_code = blockchain_add_block(blockchain, child);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_save(log, blockchain);
+    assert_true(SUCCESS == return_code);
+    return_code = blockchain_log_read_from_file(&read_blockchain, path);
+    assert_true(SUCCESS == return_code);
+    assert_true(
+        blockchain->address_index->num_postings ==
+        read_blockchain->address_index->num_postings);
+    blockchain_destroy(read_blockchain);
+    return_code = blockchain_log_write_address_index(NULL, blockchain);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = blockchain_log_write_address_index(log, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    blockchain_log_close(log);
+    remove_log_test_files(path);
+    address_index_destroy(address_index);
     blockchain_destroy(blockchain);
-    blockchain_destroy(deserialized_blockchain);
 }
@@ -27,6 +27,14 @@ void test_synchronized_blockchain_destroy_fails_on_invalid_input();
 
 void test_blockchain_add_block_appends_block();
 
+void test_blockchain_add_block_grows_storage();
+
+void test_blockchain_get_block_fails_on_missing_block();
+
+void test_blockchain_find_block_by_hash_finds_every_block();
+
+void test_blockchain_find_block_by_hash_fails_on_missing_block();
+
 void test_blockchain_add_block_fails_on_invalid_input();
 
 void test_blockchain_is_valid_block_hash_true_on_valid_hash();
@@ -37,8 +45,20 @@ void test_blockchain_is_valid_block_hash_fails_on_invalid_input();
 
 void test_blockchain_mine_block_produces_block_with_valid_hash();
 
+void test_blockchain_mine_block_with_progress_finds_same_proof_of_work();
+
 void test_blockchain_mine_block_fails_on_invalid_input();
 
+void test_blockchain_mine_block_multiple_threads_produces_valid_hash();
+
+void test_blockchain_get_proof_of_work_range_covers_every_proof_of_work();
+
+void test_synchronized_blockchain_mine_block_stops_on_should_stop();
+
+void test_synchronized_blockchain_mine_block_stops_on_version_change();
+
+void test_synchronized_blockchain_mine_block_fails_on_invalid_input();
+
 void test_blockchain_verify_succeeds_on_valid_blockchain();
 
 void test_blockchain_verify_fails_on_invalid_genesis_block();
@@ -47,14 +67,40 @@ void test_blockchain_verify_fails_on_invalid_proof_of_work();
 
 void test_blockchain_verify_fails_on_invalid_previous_block_hash();
 
+void test_blockchain_verify_fails_on_invalid_merkle_root();
+
 void test_blockchain_verify_fails_on_invalid_transaction_signature();
 
+void test_blockchain_verify_fails_on_overspending_transaction();
+
 void test_blockchain_verify_fails_on_invalid_input();
 
+void test_blockchain_verify_parallel_succeeds_on_valid_blockchain();
+
+void test_blockchain_verify_parallel_finds_first_invalid_block();
+
+void test_blockchain_verify_parallel_fails_on_invalid_input();
+
+void test_blockchain_verify_incremental_skips_verified_prefix();
+
+void test_blockchain_verify_incremental_checks_blocks_after_prefix();
+
+void test_blockchain_verify_incremental_rechecks_other_blockchain();
+
+void test_synchronized_blockchain_verify_records_verified_prefix();
+
+void test_blockchain_verify_incremental_fails_on_invalid_input();
+
 void test_blockchain_serialize_creates_nonempty_buffer();
 
 void test_blockchain_serialize_fails_on_invalid_input();
 
+void test_blockchain_serialize_into_buffer_matches_serialize();
+
+void test_blockchain_serialize_into_iovec_spans_buffers();
+
+void test_blockchain_serialize_into_buffer_fails_on_invalid_input();
+
 void test_blockchain_deserialize_reconstructs_blockchain();
 
 void test_blockchain_deserialize_fails_on_attempted_read_past_buffer();
@@ -69,6 +115,69 @@ void test_blockchain_read_from_file_reconstructs_blockchain();
 
 void test_blockchain_read_from_file_fails_on_invalid_input();
 
+void test_blockchain_read_from_file_rejects_pre_merkle_root_file();
+
+void test_blockchain_read_from_file_loads_address_index();
+
 void test_blockchain_serialization_does_not_alter_block_hash();
 
+void test_blockchain_serialize_migrates_legacy_blockchain();
+
+void test_blockchain_deserialize_reads_compact_keys_blockchain();
+
+void test_blockchain_serialize_writes_small_integers_in_one_byte();
+
+void test_blockchain_deserialize_fails_on_invalid_varint();
+
+void test_blockchain_deserialize_fails_on_unsupported_version();
+
+void test_blockchain_deserialize_into_arena_reconstructs_blockchain();
+
+void test_blockchain_deserialize_into_arena_reads_legacy_format();
+
+void test_blockchain_deserialize_into_arena_fails_on_invalid_buffer();
+
+void test_blockchain_add_block_to_tree_reorganizes_onto_longer_branch();
+
+void test_blockchain_add_block_to_tree_reorganizes_arena_blockchain();
+
+void test_blockchain_add_block_to_tree_fails_on_invalid_block();
+
+void test_blockchain_add_block_to_tree_prunes_deep_side_blocks();
+
+void test_blockchain_add_block_to_tree_moves_balances_on_reorganization();
+
+void test_blockchain_get_transaction_history_follows_reorganization();
+
+void test_blockchain_merge_shares_only_new_blocks();
+
+void test_synchronized_blockchain_adopt_peer_blockchain_publishes_merge();
+
+void test_blockchain_clone_shares_blocks();
+
+void test_blockchain_clone_keeps_arena_until_last_view();
+
+void test_synchronized_blockchain_read_section_keeps_retired_blockchain();
+void test_synchronized_blockchain_publish_appends_in_place();
+
+void test_synchronized_blockchain_read_section_fails_on_invalid_input();
+
+void test_blockchain_log_save_appends_only_new_blocks();
+
+void test_blockchain_log_save_truncates_to_fork_point();
+
+void test_blockchain_log_open_drops_partial_record();
+
+void test_blockchain_log_fails_on_invalid_input();
+
+void test_blockchain_mapped_log_reads_blocks_in_place();
+
+void test_blockchain_mapped_log_fails_on_invalid_input();
+
+void test_blockchain_log_open_reads_index();
+
+void test_blockchain_log_write_address_index_is_loaded_until_stale();
+
+void test_blockchain_log_read_blocks_reads_range();
+
 #endif  // TESTS_TEST_BLOCKCHAIN_H_
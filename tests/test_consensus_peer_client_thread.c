@@ -103,8 +103,7 @@ void test_run_consensus_peer_client_once_receives_peer_blockchain() {
     pthread_mutex_init(&args.exit_ready_mutex, NULL);
     return_code = run_consensus_peer_client_once(&args, peer1);
     assert_true(SUCCESS == return_code);
-    block_t *updated_genesis_block =
-        (block_t *)args.sync->blockchain->block_list->head->data;
+    block_t *updated_genesis_block = args.sync->blockchain->blocks[0];
     // No change in blockchain because the peer's blockchain was not bigger.
     assert_true(200 == updated_genesis_block->created_at);
     blockchain_destroy(peer_blockchain);
@@ -133,7 +132,7 @@ void test_run_consensus_peer_client_once_switches_to_longest_chain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *peer_blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(
@@ -214,18 +213,15 @@ void test_run_consensus_peer_client_once_switches_to_longest_chain() {
     atomic_size_t original_sync_version = atomic_load(&sync->version);
     return_code = run_consensus_peer_client_once(&args, peer1);
     assert_true(SUCCESS == return_code);
-    block_t *updated_genesis_block =
-        (block_t *)args.sync->blockchain->block_list->head->data;
+    block_t *updated_genesis_block = args.sync->blockchain->blocks[0];
     // Switched to peer blockchain.
     assert_true(200 != updated_genesis_block->created_at);
     uint64_t new_blockchain_len = 0;
-    return_code = linked_list_length(
-        args.sync->blockchain->block_list, &new_blockchain_len);
+    return_code = blockchain_length(args.sync->blockchain, &new_blockchain_len);
     assert_true(SUCCESS == return_code);
     assert_true(4 == new_blockchain_len);
     atomic_size_t new_sync_version = atomic_load(&sync->version);
     assert_true(new_sync_version > original_sync_version);
-    blockchain_destroy(blockchain);
     blockchain_destroy(peer_blockchain);
     free(send_blockchain_buffer);
     free(command_send_blockchain.blockchain_data);
@@ -252,15 +248,14 @@ void test_run_consensus_peer_client_once_rejects_invalid_chain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *peer_blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(
         &peer_blockchain, infile);
     assert_true(SUCCESS == return_code);
     // Change something in the peer's blockchain to make it invalid.
-    block_t *second_block =
-        (block_t *)peer_blockchain->block_list->head->next->data;
+    block_t *second_block = peer_blockchain->blocks[1];
     second_block->created_at++;
     return_code = blockchain_serialize(
         peer_blockchain,
@@ -336,8 +331,7 @@ void test_run_consensus_peer_client_once_rejects_invalid_chain() {
     pthread_mutex_init(&args.exit_ready_mutex, NULL);
     return_code = run_consensus_peer_client_once(&args, peer1);
     assert_true(SUCCESS == return_code);
-    block_t *updated_genesis_block =
-        (block_t *)args.sync->blockchain->block_list->head->data;
+    block_t *updated_genesis_block = args.sync->blockchain->blocks[0];
     // No change in blockchain because the peer's blockchain was invalid.
     assert_true(200 == updated_genesis_block->created_at);
     blockchain_destroy(peer_blockchain);
@@ -80,8 +80,7 @@ void test_handle_one_consensus_request_receives_peer_blockchain() {
     pthread_mutex_init(&args.exit_ready_mutex, NULL);
     return_code = handle_one_consensus_request(&args, conn_fd);
     assert_true(SUCCESS == return_code);
-    block_t *updated_genesis_block =
-        (block_t *)args.sync->blockchain->block_list->head->data;
+    block_t *updated_genesis_block = args.sync->blockchain->blocks[0];
     // No change in blockchain because the peer's blockchain was not bigger.
     assert_true(200 == updated_genesis_block->created_at);
     blockchain_destroy(peer_blockchain);
@@ -104,7 +103,7 @@ void test_handle_one_consensus_request_switches_to_longest_chain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *peer_blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(
@@ -166,13 +165,11 @@ void test_handle_one_consensus_request_switches_to_longest_chain() {
     return_code = handle_one_consensus_request(&args, conn_fd);
     assert_true(SUCCESS == return_code);
     uint64_t new_blockchain_len = 0;
-    return_code = linked_list_length(
-        args.sync->blockchain->block_list, &new_blockchain_len);
+    return_code = blockchain_length(args.sync->blockchain, &new_blockchain_len);
     assert_true(SUCCESS == return_code);
     assert_true(4 == new_blockchain_len);
     atomic_size_t new_sync_version = atomic_load(&sync->version);
     assert_true(new_sync_version > original_sync_version);
-    blockchain_destroy(blockchain);
     blockchain_destroy(peer_blockchain);
     free(send_blockchain_buffer);
     free(command_send_blockchain.blockchain_data);
@@ -193,15 +190,14 @@ void test_handle_one_consensus_request_rejects_invalid_chain() {
         TESTS_MAX_PATH,
         "%s/%s",
         fixture_directory,
-        "blockchain_4_blocks_no_transactions");
+        "blockchain_4_blocks_fixed_keys");
     assert_true(return_value < TESTS_MAX_PATH);
     blockchain_t *peer_blockchain = NULL;
     return_code_t return_code = blockchain_read_from_file(
         &peer_blockchain, infile);
     assert_true(SUCCESS == return_code);
     // Change something in the peer's blockchain to make it invalid.
-    block_t *second_block =
-        (block_t *)peer_blockchain->block_list->head->next->data;
+    block_t *second_block = peer_blockchain->blocks[1];
     second_block->created_at++;
     command_header_t command_header = COMMAND_HEADER_INITIALIZER;
     command_header.command = COMMAND_SEND_BLOCKCHAIN;
@@ -258,8 +254,7 @@ void test_handle_one_consensus_request_rejects_invalid_chain() {
     return_code = handle_one_consensus_request(&args, conn_fd);
     assert_true(SUCCESS == return_code);
     uint64_t new_blockchain_len = 0;
-    return_code = linked_list_length(
-        args.sync->blockchain->block_list, &new_blockchain_len);
+    return_code = blockchain_length(args.sync->blockchain, &new_blockchain_len);
     assert_true(SUCCESS == return_code);
     assert_true(1 == new_blockchain_len);
     blockchain_destroy(peer_blockchain);
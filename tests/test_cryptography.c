@@ -0,0 +1,100 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/base64.h"
+#include "include/cryptography.h"
+#include "include/return_codes.h"
+#include "tests/test_cryptography.h"
+
+void load_test_ssh_key(ssh_key_t *key, char *environment_variable) {
+    char *key_contents_base64 = getenv(environment_variable);
+    memset(key, 0, sizeof(ssh_key_t));
+    return_code_t return_code = base64_decode(
+        key_contents_base64,
+        strlen(key_contents_base64),
+        key->bytes);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_public_key_from_ssh_key_gives_der_key() {
+    ssh_key_t ssh_key = {0};
+    load_test_ssh_key(&ssh_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    public_key_t public_key = {0};
+    return_code_t return_code = public_key_from_ssh_key(&public_key, &ssh_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 != public_key.length);
+    // The DER form is much smaller than the PEM form.
+    assert_true(public_key.length < strlen(ssh_key.bytes));
+    // A DER SubjectPublicKeyInfo starts with a SEQUENCE tag.
+    assert_true(0x30 == public_key.bytes[0]);
+    unsigned char padding[MAX_PUBLIC_KEY_LENGTH] = {0};
+    assert_true(0 == memcmp(
+        public_key.bytes + public_key.length,
+        padding,
+        MAX_PUBLIC_KEY_LENGTH - public_key.length));
+}
+
+void test_public_key_from_ssh_key_gives_empty_key_for_empty_ssh_key() {
+    ssh_key_t ssh_key = {0};
+    public_key_t public_key = {0};
+    memset(&public_key, 0xff, sizeof(public_key));
+    return_code_t return_code = public_key_from_ssh_key(&public_key, &ssh_key);
+    assert_true(SUCCESS == return_code);
+    public_key_t empty_key = {0};
+    assert_true(0 == memcmp(&public_key, &empty_key, sizeof(public_key_t)));
+}
+
+void test_public_key_from_ssh_key_fails_on_invalid_key() {
+    ssh_key_t ssh_key = {0};
+    memset(ssh_key.bytes, 'A', sizeof(ssh_key.bytes) - 1);
+    public_key_t public_key = {0};
+    return_code_t return_code = public_key_from_ssh_key(&public_key, &ssh_key);
+    assert_true(FAILURE_OPENSSL_FUNCTION == return_code);
+    // A private key is valid PEM, but not a public key.
+    load_test_ssh_key(&ssh_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    return_code = public_key_from_ssh_key(&public_key, &ssh_key);
+    assert_true(FAILURE_OPENSSL_FUNCTION == return_code);
+}
+
+void test_public_key_from_ssh_key_fails_on_invalid_input() {
+    ssh_key_t ssh_key = {0};
+    public_key_t public_key = {0};
+    return_code_t return_code = public_key_from_ssh_key(NULL, &ssh_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_from_ssh_key(&public_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_public_key_to_ssh_key_reproduces_pem_key() {
+    ssh_key_t ssh_key = {0};
+    load_test_ssh_key(&ssh_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    public_key_t public_key = {0};
+    return_code_t return_code = public_key_from_ssh_key(&public_key, &ssh_key);
+    assert_true(SUCCESS == return_code);
+    ssh_key_t converted_ssh_key = {0};
+    memset(&converted_ssh_key, 0xff, sizeof(converted_ssh_key));
+    return_code = public_key_to_ssh_key(&converted_ssh_key, &public_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&converted_ssh_key, &ssh_key, sizeof(ssh_key_t)));
+}
+
+void test_public_key_to_ssh_key_gives_empty_ssh_key_for_empty_key() {
+    public_key_t public_key = {0};
+    ssh_key_t ssh_key = {0};
+    memset(&ssh_key, 0xff, sizeof(ssh_key));
+    return_code_t return_code = public_key_to_ssh_key(&ssh_key, &public_key);
+    assert_true(SUCCESS == return_code);
+    ssh_key_t empty_ssh_key = {0};
+    assert_true(0 == memcmp(&ssh_key, &empty_ssh_key, sizeof(ssh_key_t)));
+}
+
+void test_public_key_to_ssh_key_fails_on_invalid_input() {
+    ssh_key_t ssh_key = {0};
+    public_key_t public_key = {0};
+    return_code_t return_code = public_key_to_ssh_key(NULL, &public_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_to_ssh_key(&ssh_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    public_key.length = MAX_PUBLIC_KEY_LENGTH + 1;
+    return_code = public_key_to_ssh_key(&ssh_key, &public_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
@@ -4,6 +4,11 @@
 
 #ifndef TESTS_TEST_CRYPTOGRAPHY_H_
 #define TESTS_TEST_CRYPTOGRAPHY_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "include/cryptography.h"
 
 // These environment variables need to contain a base64 encoded RSA key pair.
 #define TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE \
@@ -11,4 +16,27 @@
 #define TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE \
     "LEOCOIN_TEST_PUBLIC_KEY"
 
+/**
+ * @brief Fills key with the test key that environment_variable holds in
+ * base64.
+ * 
+ * Cryptography, transaction, and public key cache tests share it to load the
+ * test key pair.
+ */
+void load_test_ssh_key(ssh_key_t *key, char *environment_variable);
+
+void test_public_key_from_ssh_key_gives_der_key();
+
+void test_public_key_from_ssh_key_gives_empty_key_for_empty_ssh_key();
+
+void test_public_key_from_ssh_key_fails_on_invalid_key();
+
+void test_public_key_from_ssh_key_fails_on_invalid_input();
+
+void test_public_key_to_ssh_key_reproduces_pem_key();
+
+void test_public_key_to_ssh_key_gives_empty_ssh_key_for_empty_key();
+
+void test_public_key_to_ssh_key_fails_on_invalid_input();
+
 #endif  // TESTS_TEST_CRYPTOGRAPHY_H_
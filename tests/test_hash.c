@@ -0,0 +1,104 @@
+#include <string.h>
+#include <openssl/evp.h>
+#include "include/hash.h"
+#include "include/return_codes.h"
+#include "tests/test_hash.h"
+
+void test_hash_sha_256_compress_gives_known_digest() {
+    // "abc", padded to one block (FIPS 180-2 appendix B.1).
+    unsigned char block[SHA_256_BLOCK_SIZE] = {'a', 'b', 'c', 0x80};
+    block[SHA_256_BLOCK_SIZE - 1] = 24;
+    unsigned char expected_digest[] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+        0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+        0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    sha_256_state_t state;
+    hash_sha_256_init_state(&state);
+    hash_sha_256_compress(&state, block);
+    sha_256_t hash = {0};
+    hash_sha_256_state_to_digest(&state, &hash);
+    assert_true(0 == memcmp(
+        hash.digest, expected_digest, sizeof(expected_digest)));
+}
+
+void test_hash_backends_match_openssl() {
+    const char *original_backend_name = hash_get_backend()->name;
+    unsigned char data[3 * SHA_256_BLOCK_SIZE];
+    for (size_t idx = 0; idx < sizeof(data); idx++) {
+        data[idx] = idx * 7 + 3;
+    }
+    // Cover every padding case: none, one, and two extra blocks.
+    size_t sizes[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, sizeof(data)};
+    size_t num_backends_tested = 0;
+    for (size_t backend_idx = 0;
+        backend_idx < HASH_NUM_BACKENDS;
+        backend_idx++) {
+        const hash_backend_t *backend = &HASH_BACKENDS[backend_idx];
+        if (!hash_backend_is_supported(backend)) {
+            continue;
+        }
+        return_code_t return_code = hash_set_backend(backend->name);
+        assert_true(SUCCESS == return_code);
+        assert_true(backend == hash_get_backend());
+        assert_true(NULL != hash_get_compress_backend()->compress);
+        for (size_t size_idx = 0;
+            size_idx < sizeof(sizes) / sizeof(sizes[0]);
+            size_idx++) {
+            sha_256_t expected_hash = {0};
+            assert_true(1 == EVP_Digest(
+                data,
+                sizes[size_idx],
+                expected_hash.digest,
+                NULL,
+                EVP_sha256(),
+                NULL));
+            sha_256_t hash = {0};
+            return_code = hash_sha_256(data, sizes[size_idx], &hash);
+            assert_true(SUCCESS == return_code);
+            assert_true(0 == memcmp(&hash, &expected_hash, sizeof(hash)));
+        }
+        num_backends_tested++;
+    }
+    // The generic backend always runs.
+    assert_true(num_backends_tested >= 1);
+    hash_set_backend(original_backend_name);
+}
+
+void test_hash_get_backend_selects_supported_backend() {
+    const hash_backend_t *backend = hash_get_backend();
+    assert_true(NULL != backend);
+    assert_true(hash_backend_is_supported(backend));
+}
+
+void test_hash_get_backend_defaults_to_openssl() {
+    assert_true(0 == strcmp(HASH_BACKEND_OPENSSL, hash_get_backend()->name));
+    // OpenSSL only hashes whole messages, so compression falls back to a
+    // hand-written backend.
+    const hash_backend_t *compress_backend = hash_get_compress_backend();
+    assert_true(NULL != compress_backend->compress);
+    assert_true(hash_backend_is_supported(compress_backend));
+}
+
+void test_hash_set_backend_fails_on_invalid_input() {
+    return_code_t return_code = hash_set_backend(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = hash_set_backend("no such backend");
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    for (size_t idx = 0; idx < HASH_NUM_BACKENDS; idx++) {
+        if (!hash_backend_is_supported(&HASH_BACKENDS[idx])) {
+            return_code = hash_set_backend(HASH_BACKENDS[idx].name);
+            assert_true(FAILURE_HASH_BACKEND_NOT_SUPPORTED == return_code);
+        }
+    }
+}
+
+void test_hash_sha_256_fails_on_invalid_input() {
+    sha_256_t hash = {0};
+    return_code_t return_code = hash_sha_256(NULL, 1, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    unsigned char data[1] = {0};
+    return_code = hash_sha_256(data, sizeof(data), NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
@@ -0,0 +1,24 @@
+/**
+ * @brief Tests hash.c
+ */
+
+#ifndef TESTS_TEST_HASH_H_
+#define TESTS_TEST_HASH_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_hash_sha_256_compress_gives_known_digest();
+
+void test_hash_backends_match_openssl();
+
+void test_hash_get_backend_selects_supported_backend();
+
+void test_hash_get_backend_defaults_to_openssl();
+
+void test_hash_set_backend_fails_on_invalid_input();
+
+void test_hash_sha_256_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_HASH_H_
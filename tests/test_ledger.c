@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/ledger.h"
+#include "include/linked_list.h"
+#include "include/transaction.h"
+#include "tests/test_ledger.h"
+
+void create_ledger_test_key(public_key_t *public_key, unsigned char id) {
+    memset(public_key, 0, sizeof(public_key_t));
+    public_key->length = 4;
+    memset(public_key->bytes, id, public_key->length);
+}
+
+void append_ledger_test_transaction(
+    linked_list_t *transaction_list,
+    unsigned char sender_id,
+    unsigned char recipient_id,
+    uint64_t amount
+) {
+    transaction_t *transaction = calloc(1, sizeof(transaction_t));
+    assert_true(NULL != transaction);
+    create_ledger_test_key(&transaction->sender_public_key, sender_id);
+    create_ledger_test_key(&transaction->recipient_public_key, recipient_id);
+    transaction->amount = amount;
+    return_code_t return_code = linked_list_append(
+        transaction_list, transaction);
+    assert_true(SUCCESS == return_code);
+}
+
+void create_ledger_test_block(
+    block_t **block,
+    unsigned char miner_id,
+    unsigned char recipient_id,
+    uint64_t amount
+) {
+    linked_list_t *transaction_list = NULL;
+    return_code_t return_code = linked_list_create(
+        &transaction_list, (free_function_t *)transaction_destroy, NULL);
+    assert_true(SUCCESS == return_code);
+    append_ledger_test_transaction(
+        transaction_list, miner_id, miner_id, AMOUNT_GENERATED_DURING_MINTING);
+    append_ledger_test_transaction(
+        transaction_list, miner_id, recipient_id, amount);
+    sha_256_t previous_block_hash = {0};
+    return_code = block_create(
+        block, transaction_list, 0, previous_block_hash);
+    assert_true(SUCCESS == return_code);
+}
+
+void assert_ledger_balance(
+    ledger_t *ledger,
+    unsigned char id,
+    int64_t expected_balance
+) {
+    public_key_t public_key = {0};
+    create_ledger_test_key(&public_key, id);
+    int64_t balance = 0;
+    return_code_t return_code = ledger_get_balance(
+        ledger, &public_key, &balance);
+    assert_true(SUCCESS == return_code);
+    assert_true(expected_balance == balance);
+}
+
+void test_ledger_create_gives_empty_ledger() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    assert_true(LEDGER_MIN_CAPACITY == ledger->capacity);
+    assert_true(0 == ledger->num_entries);
+    assert_true(0 == ledger->num_blocks);
+    assert_true(0 == ledger->num_blocks_without_overspend);
+    assert_ledger_balance(ledger, 1, 0);
+    ledger_destroy(ledger);
+    return_code = ledger_create(&ledger, 100);
+    assert_true(SUCCESS == return_code);
+    assert_true(ledger->capacity >= 200);
+    ledger_destroy(ledger);
+}
+
+void test_ledger_apply_block_credits_minting_and_moves_amounts() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    // The miner can spend the coin it mints in the same block.
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, 1);
+    bool overspends = true;
+    return_code = ledger_apply_block(ledger, block, &overspends);
+    assert_true(SUCCESS == return_code);
+    assert_true(!overspends);
+    assert_ledger_balance(ledger, 1, 0);
+    assert_ledger_balance(ledger, 2, 1);
+    assert_true(2 == ledger->num_entries);
+    assert_true(1 == ledger->num_blocks);
+    assert_true(1 == ledger->num_blocks_without_overspend);
+    // Spending nothing is always allowed.
+    block_t *second_block = NULL;
+    create_ledger_test_block(&second_block, 3, 1, 0);
+    return_code = ledger_apply_block(ledger, second_block, &overspends);
+    assert_true(SUCCESS == return_code);
+    assert_true(!overspends);
+    assert_ledger_balance(ledger, 3, 1);
+    assert_true(2 == ledger->num_blocks_without_overspend);
+    block_destroy(block);
+    block_destroy(second_block);
+    ledger_destroy(ledger);
+}
+
+void test_ledger_apply_block_detects_overspend() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, 1);
+    return_code = ledger_apply_block(ledger, block, NULL);
+    assert_true(SUCCESS == return_code);
+    // The miner holds only the coin it just minted.
+    block_t *overspending_block = NULL;
+    create_ledger_test_block(&overspending_block, 1, 2, 2);
+    bool overspends = false;
+    return_code = ledger_apply_block(ledger, overspending_block, &overspends);
+    assert_true(SUCCESS == return_code);
+    assert_true(overspends);
+    assert_ledger_balance(ledger, 1, -1);
+    assert_ledger_balance(ledger, 2, 3);
+    assert_true(2 == ledger->num_blocks);
+    assert_true(1 == ledger->num_blocks_without_overspend);
+    // Later blocks do not move the first overspending block.
+    block_t *later_block = NULL;
+    create_ledger_test_block(&later_block, 2, 3, 1);
+    return_code = ledger_apply_block(ledger, later_block, &overspends);
+    assert_true(SUCCESS == return_code);
+    assert_true(!overspends);
+    assert_true(3 == ledger->num_blocks);
+    assert_true(1 == ledger->num_blocks_without_overspend);
+    block_destroy(block);
+    block_destroy(overspending_block);
+    block_destroy(later_block);
+    ledger_destroy(ledger);
+}
+
+void test_ledger_revert_block_restores_balances() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, 1);
+    return_code = ledger_apply_block(ledger, block, NULL);
+    assert_true(SUCCESS == return_code);
+    block_t *overspending_block = NULL;
+    create_ledger_test_block(&overspending_block, 1, 2, 5);
+    return_code = ledger_apply_block(ledger, overspending_block, NULL);
+    assert_true(SUCCESS == return_code);
+    return_code = ledger_revert_block(ledger, overspending_block);
+    assert_true(SUCCESS == return_code);
+    assert_ledger_balance(ledger, 1, 0);
+    assert_ledger_balance(ledger, 2, 1);
+    assert_true(1 == ledger->num_blocks);
+    assert_true(1 == ledger->num_blocks_without_overspend);
+    return_code = ledger_revert_block(ledger, block);
+    assert_true(SUCCESS == return_code);
+    assert_ledger_balance(ledger, 1, 0);
+    assert_ledger_balance(ledger, 2, 0);
+    assert_true(0 == ledger->num_blocks);
+    assert_true(0 == ledger->num_blocks_without_overspend);
+    // There is nothing left to revert.
+    return_code = ledger_revert_block(ledger, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+    block_destroy(overspending_block);
+    ledger_destroy(ledger);
+}
+
+void test_ledger_copy_gives_independent_ledger() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, 1);
+    return_code = ledger_apply_block(ledger, block, NULL);
+    assert_true(SUCCESS == return_code);
+    ledger_t *copy = NULL;
+    return_code = ledger_copy(&copy, ledger);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == copy->num_blocks);
+    assert_ledger_balance(copy, 2, 1);
+    block_t *second_block = NULL;
+    create_ledger_test_block(&second_block, 3, 2, 1);
+    return_code = ledger_apply_block(copy, second_block, NULL);
+    assert_true(SUCCESS == return_code);
+    assert_ledger_balance(copy, 2, 2);
+    assert_ledger_balance(ledger, 2, 1);
+    assert_true(1 == ledger->num_blocks);
+    block_destroy(block);
+    block_destroy(second_block);
+    ledger_destroy(copy);
+    ledger_destroy(ledger);
+}
+
+void test_ledger_fails_on_invalid_input() {
+    ledger_t *ledger = NULL;
+    return_code_t return_code = ledger_create(NULL, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_create(&ledger, 0);
+    assert_true(SUCCESS == return_code);
+    block_t *block = NULL;
+    create_ledger_test_block(&block, 1, 2, 1);
+    public_key_t public_key = {0};
+    int64_t balance = 0;
+    return_code = ledger_apply_block(NULL, block, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_apply_block(ledger, NULL, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_revert_block(NULL, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_get_balance(NULL, &public_key, &balance);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_get_balance(ledger, NULL, &balance);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_get_balance(ledger, &public_key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_copy(NULL, ledger);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_reserve(NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = ledger_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+    ledger_destroy(ledger);
+}
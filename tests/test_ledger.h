@@ -0,0 +1,46 @@
+/**
+ * @brief Tests ledger.c
+ */
+
+#ifndef TESTS_TEST_LEDGER_H_
+#define TESTS_TEST_LEDGER_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include "include/block.h"
+#include "include/cryptography.h"
+
+/**
+ * @brief Fills public_key with a short test key whose bytes all equal id.
+ * 
+ * Ledger, address index, and blockchain tests share it to name accounts.
+ */
+void create_ledger_test_key(public_key_t *public_key, unsigned char id);
+
+/**
+ * @brief Fills block with a block in which miner_id mints a coin and then
+ * sends amount to recipient_id.
+ * 
+ * Address index tests share it to build blocks that name test keys.
+ */
+void create_ledger_test_block(
+    block_t **block,
+    unsigned char miner_id,
+    unsigned char recipient_id,
+    uint64_t amount
+);
+
+void test_ledger_create_gives_empty_ledger();
+
+void test_ledger_apply_block_credits_minting_and_moves_amounts();
+
+void test_ledger_apply_block_detects_overspend();
+
+void test_ledger_revert_block_restores_balances();
+
+void test_ledger_copy_gives_independent_ledger();
+
+void test_ledger_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_LEDGER_H_
@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <string.h>
+#include "include/block.h"
+#include "include/hash.h"
+#include "include/mining_hash.h"
+#include "include/return_codes.h"
+#include "include/transaction.h"
+#include "tests/test_mining_hash.h"
+
+void test_mining_hash_compute_matches_block_hash() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    // Use nonzero values in every header field.
+    block->created_at = 0x0123456789;
+    for (size_t idx = 0; idx < sizeof(block->previous_block_hash); idx++) {
+        block->previous_block_hash.digest[idx] = idx;
+    }
+    transaction_t *transaction = calloc(1, sizeof(transaction_t));
+    transaction->amount = 5;
+    return_code = linked_list_append(block->transaction_list, transaction);
+    assert_true(SUCCESS == return_code);
+    return_code = block_compute_merkle_root(block, &block->merkle_root);
+    assert_true(SUCCESS == return_code);
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, block);
+    assert_true(SUCCESS == return_code);
+    uint64_t proofs_of_work[] = {
+        0, 1, 255, 256, 0x0102030405060708, UINT64_MAX};
+    for (size_t idx = 0;
+        idx < sizeof(proofs_of_work) / sizeof(proofs_of_work[0]);
+        idx++) {
+        block->proof_of_work = proofs_of_work[idx];
+        sha_256_t expected_hash = {0};
+        return_code = block_hash(block, &expected_hash);
+        assert_true(SUCCESS == return_code);
+        sha_256_t hash = {0};
+        return_code = mining_hash_compute(
+            &mining_template, proofs_of_work[idx], &hash);
+        assert_true(SUCCESS == return_code);
+        assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+    }
+    block_destroy(block);
+}
+
+void test_mining_hash_template_init_fails_on_invalid_input() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(NULL, block);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_hash_template_init(&mining_template, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_mining_hash_compute_fails_on_invalid_input() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, block);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = mining_hash_compute(NULL, 0, &hash);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_hash_compute(&mining_template, 0, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
+
+void test_mining_hash_sweep_matches_block_hash() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    block->created_at = 0x0123456789;
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, block);
+    assert_true(SUCCESS == return_code);
+    // Include a sweep in which the high word of the proof of work changes.
+    uint64_t first_proofs_of_work[] = {0, 0xfffffff8, 0x0102030405060708};
+    size_t num_leading_zero_bytes = 1;
+    size_t num_sweeps = 64;
+    mining_hash_kernel_t kernels[] = {
+        MINING_HASH_KERNEL_SCALAR,
+        MINING_HASH_KERNEL_AVX2,
+        MINING_HASH_KERNEL_AVX512};
+    for (size_t kernel_idx = 0;
+        kernel_idx < sizeof(kernels) / sizeof(kernels[0]);
+        kernel_idx++) {
+        mining_hash_kernel_t kernel = kernels[kernel_idx];
+        if (!mining_hash_kernel_is_supported(kernel)) {
+            continue;
+        }
+        for (size_t start_idx = 0;
+            start_idx < sizeof(first_proofs_of_work) /
+                sizeof(first_proofs_of_work[0]);
+            start_idx++) {
+            for (size_t sweep = 0; sweep < num_sweeps; sweep++) {
+                uint64_t first_proof_of_work = first_proofs_of_work[
+                    start_idx] + sweep * MINING_HASH_SWEEP_SIZE;
+                mining_hash_sweep_result_t result;
+                return_code = mining_hash_sweep(
+                    &mining_template,
+                    kernel,
+                    first_proof_of_work,
+                    num_leading_zero_bytes,
+                    &result);
+                assert_true(SUCCESS == return_code);
+                // Find the expected results one hash at a time.
+                bool expected_found = false;
+                uint64_t expected_valid_proof_of_work = 0;
+                uint64_t expected_best_proof_of_work = first_proof_of_work;
+                sha_256_t best_hash = {0};
+                for (size_t idx = 0; idx < MINING_HASH_SWEEP_SIZE; idx++) {
+                    block->proof_of_work = first_proof_of_work + idx;
+                    sha_256_t hash = {0};
+                    return_code = block_hash(block, &hash);
+                    assert_true(SUCCESS == return_code);
+                    if (!expected_found && 0 == hash.digest[0]) {
+                        expected_found = true;
+                        expected_valid_proof_of_work = block->proof_of_work;
+                    }
+                    if (0 == idx || memcmp(&hash, &best_hash, 4) < 0) {
+                        best_hash = hash;
+                        expected_best_proof_of_work = block->proof_of_work;
+                    }
+                }
+                assert_true(expected_found == result.found);
+                if (expected_found) {
+                    assert_true(
+                        expected_valid_proof_of_work ==
+                        result.valid_proof_of_work);
+                }
+                assert_true(
+                    expected_best_proof_of_work == result.best_proof_of_work);
+                uint32_t expected_best_first_word =
+                    (uint32_t)best_hash.digest[0] << 24 |
+                    (uint32_t)best_hash.digest[1] << 16 |
+                    (uint32_t)best_hash.digest[2] << 8 |
+                    (uint32_t)best_hash.digest[3];
+                assert_true(expected_best_first_word == result.best_first_word);
+            }
+        }
+    }
+    block_destroy(block);
+}
+
+void test_mining_hash_sweep_checks_bytes_beyond_first_word() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, block);
+    assert_true(SUCCESS == return_code);
+    // Requiring every byte to be zero can only be satisfied by an all-zero
+    // hash, so no sweep may report a valid proof of work.
+    mining_hash_sweep_result_t result;
+    return_code = mining_hash_sweep(
+        &mining_template,
+        mining_hash_best_kernel(),
+        0,
+        sizeof(sha_256_t),
+        &result);
+    assert_true(SUCCESS == return_code);
+    assert_true(!result.found);
+    // No difficulty accepts the first proof of work.
+    return_code = mining_hash_sweep(
+        &mining_template, mining_hash_best_kernel(), 0, 0, &result);
+    assert_true(SUCCESS == return_code);
+    assert_true(result.found);
+    assert_true(0 == result.valid_proof_of_work);
+    block_destroy(block);
+}
+
+void test_mining_hash_best_kernel_is_supported() {
+    mining_hash_kernel_t kernel = mining_hash_best_kernel();
+    assert_true(mining_hash_kernel_is_supported(kernel));
+    assert_true(mining_hash_kernel_is_supported(MINING_HASH_KERNEL_SCALAR));
+    assert_true(NULL != mining_hash_kernel_name(kernel));
+}
+
+void test_mining_hash_sweep_fails_on_invalid_input() {
+    block_t *block = NULL;
+    return_code_t return_code = block_create_genesis_block(&block);
+    assert_true(SUCCESS == return_code);
+    mining_hash_template_t mining_template;
+    return_code = mining_hash_template_init(&mining_template, block);
+    assert_true(SUCCESS == return_code);
+    mining_hash_kernel_t kernel = MINING_HASH_KERNEL_SCALAR;
+    mining_hash_sweep_result_t result;
+    return_code = mining_hash_sweep(NULL, kernel, 0, 1, &result);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_hash_sweep(&mining_template, kernel, 0, 1, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // The sweep may not wrap around.
+    return_code = mining_hash_sweep(
+        &mining_template, kernel, UINT64_MAX, 1, &result);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = mining_hash_sweep(
+        &mining_template, kernel, 0, sizeof(sha_256_t) + 1, &result);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    block_destroy(block);
+}
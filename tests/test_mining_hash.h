@@ -0,0 +1,26 @@
+/**
+ * @brief Tests mining_hash.c
+ */
+
+#ifndef TESTS_TEST_MINING_HASH_H_
+#define TESTS_TEST_MINING_HASH_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_mining_hash_compute_matches_block_hash();
+
+void test_mining_hash_template_init_fails_on_invalid_input();
+
+void test_mining_hash_compute_fails_on_invalid_input();
+
+void test_mining_hash_sweep_matches_block_hash();
+
+void test_mining_hash_sweep_checks_bytes_beyond_first_word();
+
+void test_mining_hash_best_kernel_is_supported();
+
+void test_mining_hash_sweep_fails_on_invalid_input();
+
+#endif  // TESTS_TEST_MINING_HASH_H_
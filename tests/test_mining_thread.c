@@ -145,7 +145,8 @@ void test_mine_blocks_mines_new_blockchain_when_version_incremented() {
     return_code = blockchain_add_block(new_blockchain, new_genesis_block);
     assert_true(SUCCESS == return_code);
     pthread_mutex_lock(&sync->mutex);
-    sync->blockchain = new_blockchain;
+    return_code = synchronized_blockchain_publish(sync, new_blockchain);
+    assert_true(SUCCESS == return_code);
     pthread_mutex_unlock(&sync->mutex);
     atomic_fetch_add(&sync->version, 1);
     struct timespec ts;
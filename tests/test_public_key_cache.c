@@ -0,0 +1,153 @@
+#include <string.h>
+#include "include/public_key_cache.h"
+#include "include/return_codes.h"
+#include "tests/test_cryptography.h"
+#include "tests/test_public_key_cache.h"
+
+void get_test_public_key(public_key_t *key) {
+    ssh_key_t ssh_key = {0};
+    load_test_ssh_key(&ssh_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    return_code_t return_code = public_key_from_ssh_key(key, &ssh_key);
+    assert_true(SUCCESS == return_code);
+}
+
+void test_public_key_cache_create_gives_empty_cache() {
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(&cache, 4);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != cache);
+    assert_true(4 == cache->capacity);
+    assert_true(0 == cache->num_entries);
+    uint64_t num_hits = 1;
+    uint64_t num_misses = 1;
+    return_code = public_key_cache_get_stats(cache, &num_hits, &num_misses);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == num_hits);
+    assert_true(0 == num_misses);
+    public_key_cache_destroy(cache);
+}
+
+void test_public_key_cache_create_fails_on_invalid_input() {
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(NULL, 4);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_create(&cache, 0);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
+
+void test_public_key_cache_get_counts_hits_and_misses() {
+    public_key_t key = {0};
+    get_test_public_key(&key);
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(&cache, 4);
+    assert_true(SUCCESS == return_code);
+    EVP_PKEY *first_public_key = NULL;
+    return_code = public_key_cache_get(cache, &key, &first_public_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != first_public_key);
+    assert_true(EVP_PKEY_RSA == EVP_PKEY_base_id(first_public_key));
+    EVP_PKEY *second_public_key = NULL;
+    return_code = public_key_cache_get(cache, &key, &second_public_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(first_public_key == second_public_key);
+    uint64_t num_hits = 0;
+    uint64_t num_misses = 0;
+    return_code = public_key_cache_get_stats(cache, &num_hits, &num_misses);
+    assert_true(SUCCESS == return_code);
+    assert_true(1 == num_hits);
+    assert_true(1 == num_misses);
+    assert_true(1 == cache->num_entries);
+    EVP_PKEY_free(first_public_key);
+    EVP_PKEY_free(second_public_key);
+    public_key_cache_destroy(cache);
+}
+
+void test_public_key_cache_get_evicts_least_recently_used_key() {
+    // The cache is addressed by the key bytes, so keys that differ only in
+    // a trailing byte after the DER data occupy different entries.
+    public_key_t keys[3];
+    for (size_t idx = 0; idx < 3; idx++) {
+        get_test_public_key(&keys[idx]);
+        assert_true(keys[idx].length < MAX_PUBLIC_KEY_LENGTH);
+        keys[idx].bytes[keys[idx].length] = idx;
+        keys[idx].length++;
+    }
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(&cache, 2);
+    assert_true(SUCCESS == return_code);
+    // Look up keys 0, 1, 0, 2. Key 1 is then the least recently used, so
+    // caching key 2 evicts it.
+    size_t lookups[] = {0, 1, 0, 2, 0, 1};
+    uint64_t expected_num_hits[] = {0, 0, 1, 1, 2, 2};
+    uint64_t expected_num_misses[] = {1, 2, 2, 3, 3, 4};
+    for (size_t idx = 0; idx < sizeof(lookups) / sizeof(lookups[0]); idx++) {
+        EVP_PKEY *public_key = NULL;
+        return_code = public_key_cache_get(
+            cache, &keys[lookups[idx]], &public_key);
+        assert_true(SUCCESS == return_code);
+        EVP_PKEY_free(public_key);
+        uint64_t num_hits = 0;
+        uint64_t num_misses = 0;
+        return_code = public_key_cache_get_stats(
+            cache, &num_hits, &num_misses);
+        assert_true(SUCCESS == return_code);
+        assert_true(expected_num_hits[idx] == num_hits);
+        assert_true(expected_num_misses[idx] == num_misses);
+        assert_true(cache->num_entries <= 2);
+    }
+    public_key_cache_destroy(cache);
+}
+
+void test_public_key_cache_get_fails_on_invalid_key() {
+    public_key_t key = {0};
+    memset(key.bytes, 'A', sizeof(key.bytes));
+    key.length = sizeof(key.bytes);
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(&cache, 4);
+    assert_true(SUCCESS == return_code);
+    EVP_PKEY *public_key = NULL;
+    return_code = public_key_cache_get(cache, &key, &public_key);
+    assert_true(FAILURE_OPENSSL_FUNCTION == return_code);
+    assert_true(0 == cache->num_entries);
+    public_key_cache_destroy(cache);
+}
+
+void test_public_key_cache_get_fails_on_invalid_input() {
+    public_key_t key = {0};
+    get_test_public_key(&key);
+    public_key_cache_t *cache = NULL;
+    return_code_t return_code = public_key_cache_create(&cache, 4);
+    assert_true(SUCCESS == return_code);
+    EVP_PKEY *public_key = NULL;
+    return_code = public_key_cache_get(NULL, &key, &public_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_get(cache, NULL, &public_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_get(cache, &key, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    uint64_t num_hits = 0;
+    uint64_t num_misses = 0;
+    return_code = public_key_cache_get_stats(NULL, &num_hits, &num_misses);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_get_stats(cache, NULL, &num_misses);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = public_key_cache_get_stats(cache, &num_hits, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    public_key_cache_destroy(cache);
+}
+
+void test_public_key_cache_get_default_gives_same_cache() {
+    public_key_cache_t *first_cache = NULL;
+    return_code_t return_code = public_key_cache_get_default(&first_cache);
+    assert_true(SUCCESS == return_code);
+    assert_true(NULL != first_cache);
+    assert_true(DEFAULT_PUBLIC_KEY_CACHE_CAPACITY == first_cache->capacity);
+    public_key_cache_t *second_cache = NULL;
+    return_code = public_key_cache_get_default(&second_cache);
+    assert_true(SUCCESS == return_code);
+    assert_true(first_cache == second_cache);
+    return_code = public_key_cache_get_default(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
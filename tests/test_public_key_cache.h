@@ -0,0 +1,26 @@
+/**
+ * @brief Tests public_key_cache.c
+ */
+
+#ifndef TESTS_TEST_PUBLIC_KEY_CACHE_H_
+#define TESTS_TEST_PUBLIC_KEY_CACHE_H_
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+void test_public_key_cache_create_gives_empty_cache();
+
+void test_public_key_cache_create_fails_on_invalid_input();
+
+void test_public_key_cache_get_counts_hits_and_misses();
+
+void test_public_key_cache_get_evicts_least_recently_used_key();
+
+void test_public_key_cache_get_fails_on_invalid_key();
+
+void test_public_key_cache_get_fails_on_invalid_input();
+
+void test_public_key_cache_get_default_gives_same_cache();
+
+#endif  // TESTS_TEST_PUBLIC_KEY_CACHE_H_
@@ -39,14 +39,18 @@ void test_transaction_create_gives_transaction() {
         amount,
         &sender_private_key);
     assert_true(SUCCESS == return_code);
+    public_key_t expected_public_key = {0};
+    return_code = public_key_from_ssh_key(
+        &expected_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
     assert_true(0 == memcmp(
         &transaction->sender_public_key,
-        &sender_public_key,
-        MAX_SSH_KEY_LENGTH));
+        &expected_public_key,
+        sizeof(public_key_t)));
     assert_true(0 == memcmp(
         &transaction->recipient_public_key,
-        &recipient_public_key,
-        MAX_SSH_KEY_LENGTH));
+        &expected_public_key,
+        sizeof(public_key_t)));
     assert_true(transaction->amount == amount);
     assert_true(0 != transaction->created_at);
     char empty_signature[MAX_SSH_SIGNATURE_LENGTH] = {0};
@@ -153,10 +157,14 @@ void test_transaction_generate_signature_gives_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -190,10 +198,14 @@ void test_transaction_generate_signature_fails_on_invalid_input() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -224,10 +236,14 @@ void test_transaction_verify_signature_identifies_valid_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -256,10 +272,14 @@ void test_transaction_verify_signature_identifies_invalid_signature() {
     transaction_t transaction = {0};
     char *ssh_public_key_contents_base64 = getenv(
         TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    ssh_key_t sender_public_key = {0};
     return_code_t return_code = base64_decode(
         ssh_public_key_contents_base64,
         strlen(ssh_public_key_contents_base64),
-        transaction.sender_public_key.bytes);
+        sender_public_key.bytes);
+    return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
     char *ssh_private_key_contents_base64 = getenv(
         TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
     ssh_key_t sender_private_key = {0};
@@ -303,14 +323,10 @@ void test_transaction_verify_signature_fails_on_invalid_input() {
         ssh_public_key_contents,
         sizeof(ssh_public_key.bytes));
     transaction.created_at = time(NULL);
-    memcpy(
-        &transaction.sender_public_key,
-        &ssh_public_key,
-        sizeof(transaction.sender_public_key));
-    memcpy(
-        &transaction.recipient_public_key,
-        &ssh_public_key,
-        sizeof(transaction.recipient_public_key));
+    return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &ssh_public_key);
+    assert_true(SUCCESS == return_code);
+    transaction.recipient_public_key = transaction.sender_public_key;
     transaction.amount = 17;
     ssh_signature_t signature = {0};
     // Fill the signature with garbage bytes.
@@ -325,3 +341,231 @@ void test_transaction_verify_signature_fails_on_invalid_input() {
         &is_valid_signature, NULL);
     assert_true(FAILURE_INVALID_INPUT == return_code);
 }
+
+void test_transaction_signer_sign_gives_valid_signature() {
+    transaction_t transaction = {0};
+    ssh_key_t sender_public_key = {0};
+    ssh_key_t sender_private_key = {0};
+    load_test_ssh_key(
+        &sender_public_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    load_test_ssh_key(
+        &sender_private_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    return_code_t return_code = public_key_from_ssh_key(
+        &transaction.sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
+    transaction.created_at = time(NULL);
+    // In these test transactions, the sender and recipient are the same.
+    memcpy(
+        &transaction.recipient_public_key,
+        &transaction.sender_public_key,
+        sizeof(transaction.recipient_public_key));
+    transaction.amount = 17;
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    // The signer can be reused, and RSA PKCS #1 v1.5 signatures are
+    // deterministic, so signing twice gives the same signature.
+    ssh_signature_t signatures[2] = {0};
+    for (size_t idx = 0; idx < 2; idx++) {
+        return_code = transaction_signer_sign(
+            signer, &signatures[idx], &transaction);
+        assert_true(SUCCESS == return_code);
+    }
+    assert_true(0 == memcmp(
+        &signatures[0], &signatures[1], sizeof(ssh_signature_t)));
+    ssh_signature_t expected_signature = {0};
+    return_code = transaction_generate_signature(
+        &expected_signature, &transaction, &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &signatures[0], &expected_signature, sizeof(ssh_signature_t)));
+    transaction.sender_signature = signatures[0];
+    bool is_valid_signature = false;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, &transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_signature);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_signer_sign_batch_signs_every_transaction() {
+    ssh_key_t sender_public_key = {0};
+    ssh_key_t sender_private_key = {0};
+    load_test_ssh_key(
+        &sender_public_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    load_test_ssh_key(
+        &sender_private_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    public_key_t compact_sender_public_key = {0};
+    return_code_t return_code = public_key_from_ssh_key(
+        &compact_sender_public_key, &sender_public_key);
+    assert_true(SUCCESS == return_code);
+    transaction_t transactions[3] = {0};
+    transaction_t *transaction_pointers[3] = {0};
+    for (size_t idx = 0; idx < 3; idx++) {
+        transactions[idx].created_at = time(NULL);
+        transactions[idx].sender_public_key = compact_sender_public_key;
+        transactions[idx].recipient_public_key = compact_sender_public_key;
+        transactions[idx].amount = idx + 1;
+        transaction_pointers[idx] = &transactions[idx];
+    }
+    transaction_signer_t *signer = NULL;
+    return_code = transaction_signer_create(&signer, &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    return_code = transaction_signer_sign_batch(
+        signer, transaction_pointers, 3);
+    assert_true(SUCCESS == return_code);
+    for (size_t idx = 0; idx < 3; idx++) {
+        bool is_valid_signature = false;
+        return_code = transaction_verify_signature(
+            &is_valid_signature, &transactions[idx]);
+        assert_true(SUCCESS == return_code);
+        assert_true(is_valid_signature);
+    }
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_create_with_signer_gives_transaction() {
+    ssh_key_t sender_public_key = {0};
+    ssh_key_t sender_private_key = {0};
+    load_test_ssh_key(
+        &sender_public_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    load_test_ssh_key(
+        &sender_private_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    transaction_signer_t *signer = NULL;
+    return_code_t return_code = transaction_signer_create(
+        &signer, &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_t *transaction = NULL;
+    uint64_t amount = 5;
+    return_code = transaction_create_with_signer(
+        &transaction,
+        &sender_public_key,
+        &sender_public_key,
+        amount,
+        signer);
+    assert_true(SUCCESS == return_code);
+    assert_true(transaction->amount == amount);
+    ssh_key_t converted_public_key = {0};
+    return_code = public_key_to_ssh_key(
+        &converted_public_key, &transaction->sender_public_key);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(
+        &converted_public_key, &sender_public_key, sizeof(ssh_key_t)));
+    bool is_valid_signature = false;
+    return_code = transaction_verify_signature(
+        &is_valid_signature, transaction);
+    assert_true(SUCCESS == return_code);
+    assert_true(is_valid_signature);
+    transaction_destroy(transaction);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_signer_fails_on_invalid_input() {
+    ssh_key_t sender_public_key = {0};
+    ssh_key_t sender_private_key = {0};
+    load_test_ssh_key(
+        &sender_public_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    load_test_ssh_key(
+        &sender_private_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    transaction_signer_t *signer = NULL;
+    return_code_t return_code = transaction_signer_create(
+        NULL, &sender_private_key);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_create(&signer, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    // A public key is not a private key.
+    return_code = transaction_signer_create(&signer, &sender_public_key);
+    assert_true(FAILURE_OPENSSL_FUNCTION == return_code);
+    return_code = transaction_signer_destroy(NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_create(&signer, &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    transaction_t transaction = {0};
+    ssh_signature_t signature = {0};
+    return_code = transaction_signer_sign(NULL, &signature, &transaction);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign(signer, NULL, &transaction);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign(signer, &signature, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_t *transactions[] = {&transaction, NULL};
+    return_code = transaction_signer_sign_batch(NULL, transactions, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign_batch(signer, NULL, 1);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_signer_sign_batch(signer, transactions, 2);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_t *created_transaction = NULL;
+    return_code = transaction_create_with_signer(
+        &created_transaction, &sender_public_key, &sender_public_key, 1, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_create_with_signer(
+        NULL, &sender_public_key, &sender_public_key, 1, signer);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction_signer_destroy(signer);
+}
+
+void test_transaction_get_preimage_gives_legacy_layout() {
+    ssh_key_t sender_public_key = {0};
+    ssh_key_t sender_private_key = {0};
+    load_test_ssh_key(
+        &sender_public_key, TEST_PUBLIC_KEY_ENVIRONMENT_VARIABLE);
+    load_test_ssh_key(
+        &sender_private_key, TEST_PRIVATE_KEY_ENVIRONMENT_VARIABLE);
+    transaction_t *transaction = NULL;
+    return_code_t return_code = transaction_create(
+        &transaction,
+        &sender_public_key,
+        &sender_public_key,
+        9,
+        &sender_private_key);
+    assert_true(SUCCESS == return_code);
+    unsigned char preimage[TRANSACTION_PREIMAGE_SIZE];
+    return_code = transaction_get_preimage(transaction, preimage);
+    assert_true(SUCCESS == return_code);
+    unsigned char *next_spot_in_preimage = preimage;
+    assert_true(0 == memcmp(
+        next_spot_in_preimage, &transaction->created_at, sizeof(time_t)));
+    next_spot_in_preimage += sizeof(time_t);
+    // Both keys appear as the original, zero-padded PEM strings.
+    for (size_t idx = 0; idx < 2; idx++) {
+        assert_true(0 == memcmp(
+            next_spot_in_preimage, &sender_public_key, sizeof(ssh_key_t)));
+        next_spot_in_preimage += sizeof(ssh_key_t);
+    }
+    assert_true(0 == memcmp(
+        next_spot_in_preimage, &transaction->amount, sizeof(uint64_t)));
+    next_spot_in_preimage += sizeof(uint64_t);
+    assert_true(
+        TRANSACTION_PREIMAGE_SIZE_WITHOUT_SIGNATURE ==
+        next_spot_in_preimage - preimage);
+    assert_true(0 == memcmp(
+        next_spot_in_preimage,
+        &transaction->sender_signature.length,
+        sizeof(size_t)));
+    next_spot_in_preimage += sizeof(size_t);
+    assert_true(0 == memcmp(
+        next_spot_in_preimage,
+        transaction->sender_signature.bytes,
+        transaction->sender_signature.length));
+    sha_256_t expected_hash = {0};
+    return_code = hash_sha_256(preimage, sizeof(preimage), &expected_hash);
+    assert_true(SUCCESS == return_code);
+    sha_256_t hash = {0};
+    return_code = transaction_hash(transaction, &hash);
+    assert_true(SUCCESS == return_code);
+    assert_true(0 == memcmp(&hash, &expected_hash, sizeof(sha_256_t)));
+    transaction_destroy(transaction);
+}
+
+void test_transaction_get_preimage_fails_on_invalid_input() {
+    transaction_t transaction = {0};
+    unsigned char preimage[TRANSACTION_PREIMAGE_SIZE];
+    return_code_t return_code = transaction_get_preimage(NULL, preimage);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    return_code = transaction_get_preimage(&transaction, NULL);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+    transaction.sender_signature.length = MAX_SSH_SIGNATURE_LENGTH + 1;
+    return_code = transaction_get_preimage(&transaction, preimage);
+    assert_true(FAILURE_INVALID_INPUT == return_code);
+}
@@ -27,4 +27,16 @@ void test_transaction_verify_signature_identifies_invalid_signature();
 
 void test_transaction_verify_signature_fails_on_invalid_input();
 
+void test_transaction_signer_sign_gives_valid_signature();
+
+void test_transaction_signer_sign_batch_signs_every_transaction();
+
+void test_transaction_create_with_signer_gives_transaction();
+
+void test_transaction_signer_fails_on_invalid_input();
+
+void test_transaction_get_preimage_gives_legacy_layout();
+
+void test_transaction_get_preimage_fails_on_invalid_input();
+
 #endif  // TESTS_TEST_TRANSACTION_H_